@@ -0,0 +1,2 @@
+\set id random(1, 30000)
+SELECT filler FROM bench_hot WHERE id = :id;
@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+# Buffer eviction benchmark; see README.
+#
+# Usage: run.sh [seconds]
+#
+# Connection parameters are taken from the usual PG* environment variables.
+# The server should run with shared_buffers = 16MB, and the database must
+# have pg_buffercache installed and the tables of setup.sql loaded.  The
+# strategy counters are cumulative, so restart the server before each run.
+
+set -e
+
+dir=`dirname "$0"`
+secs=${1:-60}
+
+# warm up the working set, then start counting afresh
+pgbench -n -f "$dir/hot.sql" -T 10 >/dev/null
+psql -X -q -c "SELECT pg_stat_reset()"
+
+pgbench -n -f "$dir/hot.sql@10" -f "$dir/scan.sql@1" -c 4 -j 4 -T "$secs" -r \
+	| grep -E '^(tps|SQL script|  - weight| *[0-9.]+ +SELECT)'
+
+# give the stats collector a moment
+sleep 1
+psql -X -c "
+SELECT relname, heap_blks_read, heap_blks_hit,
+       round(100.0 * heap_blks_hit / nullif(heap_blks_hit + heap_blks_read, 0), 2)
+         AS heap_hit_pct
+FROM pg_statio_user_tables
+WHERE relname IN ('bench_hot', 'bench_cold')
+ORDER BY relname"
+psql -X -c "SELECT * FROM pg_buffercache_strategy()" -x
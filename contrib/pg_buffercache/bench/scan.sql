@@ -0,0 +1,4 @@
+\set lo random(0, 799950)
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(filler) FROM bench_cold WHERE r BETWEEN :lo AND :lo + 49;
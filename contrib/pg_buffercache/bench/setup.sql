@@ -0,0 +1,22 @@
+-- Tables for the buffer eviction benchmark; see README.
+--
+-- bench_hot is the working set: about 900 pages, to be read at random by
+-- primary key.  bench_cold is about 24000 pages, to be read through an index
+-- on a column uncorrelated with the physical order, so that each index scan
+-- touches heap pages all over the table.  Index scans don't use a buffer
+-- ring, so every page they touch competes with the working set.
+
+DROP TABLE IF EXISTS bench_hot, bench_cold;
+
+CREATE TABLE bench_hot (id int PRIMARY KEY, filler text);
+INSERT INTO bench_hot
+  SELECT g, repeat('x', 200) FROM generate_series(1, 30000) g;
+
+CREATE TABLE bench_cold (id int, r int, filler text);
+INSERT INTO bench_cold
+  SELECT g, (g::int8 * 7919) % 800000, repeat('x', 200)
+  FROM generate_series(1, 800000) g;
+CREATE INDEX bench_cold_r ON bench_cold (r);
+
+VACUUM ANALYZE bench_hot;
+VACUUM ANALYZE bench_cold;
@@ -0,0 +1,37 @@
+/* contrib/pg_buffercache/pg_buffercache--1.3--1.4.sql */
+
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION pg_buffercache UPDATE TO '1.4'" to load this file. \quit
+
+CREATE FUNCTION pg_buffercache_strategy(
+    OUT buffers_alloc int8,
+    OUT freelist_hits int8,
+    OUT ring_reuses int8,
+    OUT clock_ticks int8,
+    OUT clock_pinned int8,
+    OUT clock_decrements int8,
+    OUT clock_protected int8,
+    OUT promotions int8,
+    OUT ghost_hits int8,
+    OUT probation_victims int8,
+    OUT protected_victims int8,
+    OUT protected_buffers int8,
+    OUT complete_passes int8)
+AS 'MODULE_PATHNAME', 'pg_buffercache_strategy'
+LANGUAGE C PARALLEL SAFE;
+
+-- Don't want this to be available to public.
+REVOKE ALL ON FUNCTION pg_buffercache_strategy() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_buffercache_strategy() TO pg_monitor;
+
+CREATE FUNCTION pg_buffercache_numa(
+    OUT node int4,
+    OUT buffers int4,
+    OUT local_accesses int8,
+    OUT remote_accesses int8)
+RETURNS SETOF record
+AS 'MODULE_PATHNAME', 'pg_buffercache_numa'
+LANGUAGE C PARALLEL SAFE;
+
+REVOKE ALL ON FUNCTION pg_buffercache_numa() FROM PUBLIC;
+GRANT EXECUTE ON FUNCTION pg_buffercache_numa() TO pg_monitor;
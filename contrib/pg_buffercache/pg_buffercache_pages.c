@@ -17,6 +17,8 @@
 
 #define NUM_BUFFERCACHE_PAGES_MIN_ELEM	8
 #define NUM_BUFFERCACHE_PAGES_ELEM	9
+#define NUM_BUFFERCACHE_STRATEGY_ELEM	13
+#define NUM_BUFFERCACHE_NUMA_ELEM	4
 
 PG_MODULE_MAGIC;
 
@@ -237,3 +239,105 @@ pg_buffercache_pages(PG_FUNCTION_ARGS)
 	else
 		SRF_RETURN_DONE(funcctx);
 }
+
+/*
+ * Function returning the buffer replacement strategy's cumulative counters.
+ */
+PG_FUNCTION_INFO_V1(pg_buffercache_strategy);
+
+Datum
+pg_buffercache_strategy(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	BufferStrategyStats stats;
+	Datum		values[NUM_BUFFERCACHE_STRATEGY_ELEM];
+	bool		nulls[NUM_BUFFERCACHE_STRATEGY_ELEM];
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	StrategyGetStats(&stats);
+
+	memset(nulls, 0, sizeof(nulls));
+	values[0] = Int64GetDatum((int64) stats.buffers_alloc);
+	values[1] = Int64GetDatum((int64) stats.freelist_hits);
+	values[2] = Int64GetDatum((int64) stats.ring_reuses);
+	values[3] = Int64GetDatum((int64) stats.clock_ticks);
+	values[4] = Int64GetDatum((int64) stats.clock_pinned);
+	values[5] = Int64GetDatum((int64) stats.clock_decrements);
+	values[6] = Int64GetDatum((int64) stats.clock_protected);
+	values[7] = Int64GetDatum((int64) stats.promotions);
+	values[8] = Int64GetDatum((int64) stats.ghost_hits);
+	values[9] = Int64GetDatum((int64) stats.probation_victims);
+	values[10] = Int64GetDatum((int64) stats.protected_victims);
+	values[11] = Int64GetDatum((int64) stats.protected_buffers);
+	values[12] = Int64GetDatum((int64) stats.complete_passes);
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+/*
+ * Function returning the NUMA partitions of the buffer pool, with counts of
+ * local and remote accesses.
+ */
+PG_FUNCTION_INFO_V1(pg_buffercache_numa);
+
+Datum
+pg_buffercache_numa(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *funcctx;
+	BufferNumaStats *stats;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		MemoryContext oldcontext;
+		TupleDesc	tupdesc;
+
+		funcctx = SRF_FIRSTCALL_INIT();
+		oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+		if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+			elog(ERROR, "return type must be a row type");
+		funcctx->tuple_desc = tupdesc;
+
+		stats = (BufferNumaStats *)
+			palloc(sizeof(BufferNumaStats) * MAX_BUFFER_NUMA_PARTITIONS);
+		funcctx->max_calls = StrategyGetNumaStats(stats);
+		funcctx->user_fctx = stats;
+
+		MemoryContextSwitchTo(oldcontext);
+	}
+
+	funcctx = SRF_PERCALL_SETUP();
+	stats = (BufferNumaStats *) funcctx->user_fctx;
+
+	if (funcctx->call_cntr < funcctx->max_calls)
+	{
+		BufferNumaStats *part = &stats[funcctx->call_cntr];
+		Datum		values[NUM_BUFFERCACHE_NUMA_ELEM];
+		bool		nulls[NUM_BUFFERCACHE_NUMA_ELEM];
+		HeapTuple	tuple;
+
+		memset(nulls, 0, sizeof(nulls));
+		values[1] = Int32GetDatum(part->buffers);
+
+		/* Without partitioning, there's no node and nothing is counted */
+		if (part->node < 0)
+		{
+			nulls[0] = true;
+			nulls[2] = true;
+			nulls[3] = true;
+		}
+		else
+		{
+			values[0] = Int32GetDatum(part->node);
+			values[2] = Int64GetDatum((int64) part->local_accesses);
+			values[3] = Int64GetDatum((int64) part->remote_accesses);
+		}
+
+		tuple = heap_form_tuple(funcctx->tuple_desc, values, nulls);
+		SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(tuple));
+	}
+	else
+		SRF_RETURN_DONE(funcctx);
+}
@@ -72,6 +72,66 @@
 	((att)->attstorage != 'p')
 
 
+/* ----------------------------------------------------------------
+ *						fixed-width prefix support
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * Check whether none of the first natts attributes of a tuple is NULL,
+ * examining the null bitmap a byte at a time.
+ */
+static inline bool
+att_prefix_notnull(bits8 *bp, int natts)
+{
+	int			nbytes = natts >> 3;
+	bits8		mask = (1 << (natts & 0x07)) - 1;
+	int			i;
+
+	for (i = 0; i < nbytes; i++)
+	{
+		if (bp[i] != 0xFF)
+			return false;
+	}
+
+	return mask == 0 || (bp[nbytes] & mask) == mask;
+}
+
+/*
+ * deform_fixed_prefix
+ *		Extract the fixed-width leading attributes of a tuple in one pass.
+ *
+ * Up to natts attributes are extracted, starting from the first one, using
+ * the offsets precomputed for the tuple descriptor's fixed-width prefix.
+ * That's only possible if none of those attributes is NULL; otherwise
+ * nothing is done.  Returns the number of attributes extracted, and sets
+ * *offp to the offset just past the last of them.
+ */
+static inline int
+deform_fixed_prefix(TupleDesc tupleDesc, char *tp, bits8 *bp, bool hasnulls,
+					int natts, Datum *values, bool *isnull, uint32 *offp)
+{
+	int			nfixed = Min(natts, TupleDescFixedPrefix(tupleDesc));
+	Form_pg_attribute att;
+	int			attnum;
+
+	if (nfixed == 0 || (hasnulls && !att_prefix_notnull(bp, nfixed)))
+		return 0;
+
+	for (attnum = 0; attnum < nfixed; attnum++)
+	{
+		att = TupleDescAttr(tupleDesc, attnum);
+		values[attnum] = fetchatt(att, tp + att->attcacheoff);
+	}
+	memset(isnull, false, nfixed * sizeof(bool));
+
+	att = TupleDescAttr(tupleDesc, nfixed - 1);
+	*offp = att->attcacheoff + att->attlen;
+
+	return nfixed;
+}
+
+
 /* ----------------------------------------------------------------
  *						misc support routines
  * ----------------------------------------------------------------
@@ -1337,7 +1397,11 @@ heap_deform_tuple(HeapTuple tuple, TupleDesc tupleDesc,
 
 	off = 0;
 
-	for (attnum = 0; attnum < natts; attnum++)
+	/* Extract the fixed-width prefix at once, if it has no NULLs */
+	attnum = deform_fixed_prefix(tupleDesc, tp, bp, hasnulls, natts,
+								 values, isnull, &off);
+
+	for (; attnum < natts; attnum++)
 	{
 		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
 
@@ -1426,12 +1490,19 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 	 * Check whether the first call for this tuple, and initialize or restore
 	 * loop state.
 	 */
+	tp = (char *) tup + tup->t_hoff;
+
 	attnum = slot->tts_nvalid;
 	if (attnum == 0)
 	{
-		/* Start from the first attribute */
+		/*
+		 * Start from the first attribute.  If the fixed-width prefix has no
+		 * NULLs, extract it at once.
+		 */
 		off = 0;
 		slow = false;
+		attnum = deform_fixed_prefix(tupleDesc, tp, bp, hasnulls, natts,
+									 values, isnull, &off);
 	}
 	else
 	{
@@ -1440,8 +1511,6 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 		slow = slot->tts_slow;
 	}
 
-	tp = (char *) tup + tup->t_hoff;
-
 	for (; attnum < natts; attnum++)
 	{
 		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
@@ -75,6 +75,7 @@ CreateTemplateTupleDesc(int natts, bool hasoid)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tdfixedprefix = -1;
 
 	return desc;
 }
@@ -296,6 +297,7 @@ TupleDescCopyEntry(TupleDesc dst, AttrNumber dstAttno,
 	 */
 	dstAtt->attnum = dstAttno;
 	dstAtt->attcacheoff = -1;
+	dst->tdfixedprefix = -1;
 
 	/* since we're not copying constraints or defaults, clear these */
 	dstAtt->attnotnull = false;
@@ -304,6 +306,40 @@ TupleDescCopyEntry(TupleDesc dst, AttrNumber dstAttno,
 	dstAtt->attidentity = '\0';
 }
 
+/*
+ * TupleDescComputeFixedPrefix
+ *		Compute the layout of the fixed-width prefix of a tuple descriptor.
+ *
+ * The prefix consists of the leading attributes that have a fixed width.
+ * As long as none of them is NULL, their offsets within the tuple data do
+ * not depend on the tuple, so we store them in attcacheoff.  This lets
+ * tuple deforming extract the whole prefix without per-attribute alignment
+ * or null checks.  The result is cached in tdfixedprefix; callers normally
+ * use the TupleDescFixedPrefix macro.
+ */
+int
+TupleDescComputeFixedPrefix(TupleDesc tupdesc)
+{
+	uint32		off = 0;
+	int			attnum;
+
+	for (attnum = 0; attnum < tupdesc->natts; attnum++)
+	{
+		Form_pg_attribute att = TupleDescAttr(tupdesc, attnum);
+
+		if (att->attlen <= 0)
+			break;
+
+		off = att_align_nominal(off, att->attalign);
+		att->attcacheoff = off;
+		off += att->attlen;
+	}
+
+	tupdesc->tdfixedprefix = attnum;
+
+	return attnum;
+}
+
 /*
  * Free a TupleDesc including all substructure
  */
@@ -634,6 +670,7 @@ TupleDescInitEntry(TupleDesc desc,
 
 	att->attstattarget = -1;
 	att->attcacheoff = -1;
+	desc->tdfixedprefix = -1;
 	att->atttypmod = typmod;
 
 	att->attnum = attributeNumber;
@@ -693,6 +730,7 @@ TupleDescInitBuiltinEntry(TupleDesc desc,
 
 	att->attstattarget = -1;
 	att->attcacheoff = -1;
+	desc->tdfixedprefix = -1;
 	att->atttypmod = typmod;
 
 	att->attnum = attributeNumber;
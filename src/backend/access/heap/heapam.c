@@ -38,6 +38,8 @@
  */
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/bufmask.h"
 #include "access/heapam.h"
 #include "access/heapam_xlog.h"
@@ -61,6 +63,7 @@
 #include "pgstat.h"
 #include "port/atomics.h"
 #include "storage/bufmgr.h"
+#include "storage/fd.h"
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
 #include "storage/predicate.h"
@@ -73,6 +76,7 @@
 #include "utils/lsyscache.h"
 #include "utils/relcache.h"
 #include "utils/snapmgr.h"
+#include "utils/spccache.h"
 #include "utils/syscache.h"
 #include "utils/tqual.h"
 #include "utils/memutils.h"
@@ -93,6 +97,7 @@ static HeapScanDesc heap_beginscan_internal(Relation relation,
 						bool is_bitmapscan,
 						bool is_samplescan,
 						bool temp_snap);
+static void heap_prefetch_ahead(HeapScanDesc scan, BlockNumber page);
 static void heap_parallelscan_startblock_init(HeapScanDesc scan);
 static BlockNumber heap_parallelscan_nextpage(HeapScanDesc scan);
 static HeapTuple heap_prepare_insert(Relation relation, HeapTuple tup,
@@ -304,6 +309,10 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 	scan->rs_cbuf = InvalidBuffer;
 	scan->rs_cblock = InvalidBlockNumber;
 
+	scan->rs_prefetch_target = 0;
+	scan->rs_prefetch_ahead = 0;
+	scan->rs_prefetch_last = InvalidBlockNumber;
+
 	/* page-at-a-time fields are always invalid when not rs_inited */
 
 	/*
@@ -340,6 +349,61 @@ heap_setscanlimits(HeapScanDesc scan, BlockNumber startBlk, BlockNumber numBlks)
 	scan->rs_numblocks = numBlks;
 }
 
+/*
+ * heap_prefetch_ahead - prefetch the pages a serial scan will read next
+ *
+ * We keep up to rs_prefetch_maximum pages following "page" prefetched, so
+ * that the read-ahead workers have several reads in flight while we process
+ * this one.
+ * As in bitmap heap scans, the distance ramps up from zero so that a scan
+ * stopped early, say by a LIMIT, doesn't issue much useless I/O.  Only a
+ * scan that moves forward one page at a time is prefetched; any other move,
+ * such as a backward fetch, resets the window.
+ */
+static void
+heap_prefetch_ahead(HeapScanDesc scan, BlockNumber page)
+{
+#ifdef USE_PREFETCH
+	uint64		remaining;
+
+	if (scan->rs_prefetch_last == InvalidBlockNumber ||
+		page != (scan->rs_prefetch_last + 1) % scan->rs_nblocks)
+	{
+		scan->rs_prefetch_last = page;
+		scan->rs_prefetch_target = 0;
+		scan->rs_prefetch_ahead = 0;
+		return;
+	}
+	scan->rs_prefetch_last = page;
+
+	/* this page was one of those prefetched, if any were */
+	if (scan->rs_prefetch_ahead > 0)
+		scan->rs_prefetch_ahead--;
+
+	if (scan->rs_prefetch_target >= scan->rs_prefetch_maximum / 2)
+		scan->rs_prefetch_target = scan->rs_prefetch_maximum;
+	else if (scan->rs_prefetch_target > 0)
+		scan->rs_prefetch_target *= 2;
+	else
+		scan->rs_prefetch_target++;
+
+	/* don't prefetch past the point where the scan will stop */
+	remaining = ((uint64) scan->rs_startblock + scan->rs_nblocks - page - 1) %
+		scan->rs_nblocks;
+	if (scan->rs_numblocks != InvalidBlockNumber)
+		remaining = Min(remaining, scan->rs_numblocks - 1);
+
+	while (scan->rs_prefetch_ahead < scan->rs_prefetch_target &&
+		   scan->rs_prefetch_ahead < remaining)
+	{
+		scan->rs_prefetch_ahead++;
+		PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM,
+					   ((uint64) page + scan->rs_prefetch_ahead) %
+					   scan->rs_nblocks);
+	}
+#endif							/* USE_PREFETCH */
+}
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -380,6 +444,14 @@ heapgetpage(HeapScanDesc scan, BlockNumber page)
 									   RBM_NORMAL, scan->rs_strategy);
 	scan->rs_cblock = page;
 
+	/*
+	 * Issue prefetch requests after reading the current page, so that they
+	 * don't compete with the read we're about to wait for.  Parallel scans
+	 * prefetch as blocks are allocated instead.
+	 */
+	if (scan->rs_prefetch_maximum > 0 && scan->rs_parallel == NULL)
+		heap_prefetch_ahead(scan, page);
+
 	if (!scan->rs_pageatatime)
 		return;
 
@@ -1506,6 +1578,41 @@ heap_beginscan_internal(Relation relation, Snapshot snapshot,
 	/* we only need to set this up once */
 	scan->rs_ctup.t_tableOid = RelationGetRelid(relation);
 
+	/*
+	 * Determine how far ahead heapgetpage may prefetch.  We only do that if
+	 * data files are opened with io_direct, so that the kernel does no
+	 * readahead of its own, and there are read-ahead workers to read the
+	 * pages into shared buffers.  Otherwise kernel readahead does better for
+	 * sequential reads, both than hints and than handing each page over to
+	 * a worker.  Temporary tables aren't in shared buffers, so they aren't
+	 * prefetched either.  Bitmap scans do
+	 * their own prefetching, and sample scans may visit blocks in any order,
+	 * so only plain scans prefetch.  As for bitmap heap scans, a tablespace
+	 * setting of effective_io_concurrency overrides the GUC; but don't look
+	 * that up for catalogs, since we may be in the middle of filling the
+	 * caches it relies on.
+	 */
+	scan->rs_prefetch_maximum = 0;
+	if ((io_direct_flags & IO_DIRECT_DATA) && readahead_workers > 0 &&
+		!RelationUsesLocalBuffers(relation) &&
+		!is_bitmapscan && !is_samplescan)
+	{
+		int			io_concurrency = effective_io_concurrency;
+
+		if (!IsCatalogRelation(relation))
+			io_concurrency =
+				get_tablespace_io_concurrency(relation->rd_rel->reltablespace);
+		if (io_concurrency == effective_io_concurrency)
+			scan->rs_prefetch_maximum = target_prefetch_pages;
+		else
+		{
+			double		maximum;
+
+			if (ComputeIoConcurrency(io_concurrency, &maximum))
+				scan->rs_prefetch_maximum = rint(maximum);
+		}
+	}
+
 	/*
 	 * we do this here instead of in initscan() because heap_rescan also calls
 	 * initscan() and we don't want to allocate memory again
@@ -1656,6 +1763,25 @@ heap_parallelscan_reinitialize(ParallelHeapScanDesc parallel_scan)
 	pg_atomic_write_u64(&parallel_scan->phs_nallocated, 0);
 }
 
+/* ----------------
+ *		heap_parallelscan_remaining - count blocks not yet handed out
+ *
+ *		The result is only a snapshot: other participants may allocate
+ *		blocks concurrently.  It is meant for callers, such as Parallel
+ *		Append, that want to send idle workers where the most work is left.
+ * ----------------
+ */
+BlockNumber
+heap_parallelscan_remaining(ParallelHeapScanDesc parallel_scan)
+{
+	uint64		nallocated;
+
+	nallocated = pg_atomic_read_u64(&parallel_scan->phs_nallocated);
+	if (nallocated >= parallel_scan->phs_nblocks)
+		return 0;
+	return parallel_scan->phs_nblocks - (BlockNumber) nallocated;
+}
+
 /* ----------------
  *		heap_beginscan_parallel - join a parallel scan
  *
@@ -1773,6 +1899,27 @@ heap_parallelscan_nextpage(HeapScanDesc scan)
 	else
 		page = (nallocated + parallel_scan->phs_startblock) % scan->rs_nblocks;
 
+#ifdef USE_PREFETCH
+
+	/*
+	 * Each participant prefetches the block rs_prefetch_maximum beyond the
+	 * one it was just allocated, so that between them they keep that many
+	 * blocks in flight ahead of the shared allocation point.  Whoever gets
+	 * the first block also prefetches the ones in between.
+	 */
+	if (scan->rs_prefetch_maximum > 0 && page != InvalidBlockNumber)
+	{
+		uint64		i;
+
+		i = (nallocated == 0) ? 1 : scan->rs_prefetch_maximum;
+		for (; i <= scan->rs_prefetch_maximum &&
+			 nallocated + i < scan->rs_nblocks; i++)
+			PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM,
+						   (nallocated + i + parallel_scan->phs_startblock) %
+						   scan->rs_nblocks);
+	}
+#endif							/* USE_PREFETCH */
+
 	/*
 	 * Report scan location.  Normally, we report the current page number.
 	 * When we reach the end of the scan, though, we report the starting page,
@@ -2627,13 +2774,13 @@ heap_prepare_insert(Relation relation, HeapTuple tup, TransactionId xid,
 {
 	/*
 	 * Parallel operations are required to be strictly read-only in a parallel
-	 * worker.  Parallel inserts are not safe even in the leader in the
-	 * general case, because group locking means that heavyweight locks for
-	 * relation extension or GIN page locks will not conflict between members
-	 * of a lock group, but we don't prohibit that case here because there are
-	 * useful special cases that we can safely allow, such as CREATE TABLE AS.
+	 * worker, unless the operation arranged for its workers to insert using
+	 * the master's command ID, as parallel COPY FROM does.  (Relation
+	 * extension and GIN page locks conflict even between members of a lock
+	 * group, so concurrent inserts are safe as such.)  The operation must
+	 * also make sure that whatever the workers evaluate is parallel safe.
 	 */
-	if (IsParallelWorker())
+	if (IsParallelWorker() && !IsCurrentCommandIdUsed())
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_TRANSACTION_STATE),
 				 errmsg("cannot insert tuples in a parallel worker")));
@@ -0,0 +1,67 @@
+/*-------------------------------------------------------------------------
+ *
+ * heapam_handler.c
+ *	  heap table access method code
+ *
+ * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/heap/heapam_handler.c
+ *
+ *
+ * NOTES
+ *	  This file wires the heap's entry points in heapam.c into the table
+ *	  access method API, so that callers going through tableam.h reach
+ *	  them via the relation's TableAmRoutine.
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/heapam.h"
+#include "access/tableam.h"
+#include "utils/builtins.h"
+
+
+static const TableAmRoutine heapam_methods = {
+	T_TableAmRoutine,
+
+	heap_parallelscan_estimate,
+	heap_parallelscan_initialize,
+	heap_parallelscan_reinitialize,
+	heap_parallelscan_remaining,
+
+	heap_beginscan,
+	heap_beginscan_parallel,
+	heap_rescan,
+	heap_endscan,
+	heap_getnext,
+
+	heap_fetch,
+
+	heap_insert,
+	heap_multi_insert
+};
+
+
+/*
+ * GetHeapamTableAmRoutine
+ *		Return the heap table access method's callbacks.
+ */
+const TableAmRoutine *
+GetHeapamTableAmRoutine(void)
+{
+	return &heapam_methods;
+}
+
+/*
+ * heap_tableam_handler
+ *		Handler function of the heap table access method.
+ */
+Datum
+heap_tableam_handler(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(&heapam_methods);
+}
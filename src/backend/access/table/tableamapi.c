@@ -0,0 +1,126 @@
+/*-------------------------------------------------------------------------
+ *
+ * tableamapi.c
+ *	  Support routines for API for Postgres table access methods.
+ *
+ * Copyright (c) 2018, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/table/tableamapi.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/tableam.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "utils/guc.h"
+#include "utils/syscache.h"
+
+
+/* GUC variable */
+char	   *default_table_access_method = DEFAULT_TABLE_ACCESS_METHOD;
+
+
+/*
+ * GetTableAmRoutine - call the specified access method handler routine to get
+ * its TableAmRoutine struct.
+ *
+ * Unlike an IndexAmRoutine, the struct must be a constant owned by the AM,
+ * since the relcache keeps pointing to it.  As with GetIndexAmRoutine, a
+ * built-in handler is called without any catalog access, which lets the
+ * relcache set up the system catalogs while bootstrapping.
+ *
+ * The struct must be heap's, as much of the backend still accesses every
+ * table through heapam.c directly; see tableam.h.  CREATE ACCESS METHOD
+ * checks this too, so we get here with another one only if pg_am has been
+ * modified by hand.
+ */
+const TableAmRoutine *
+GetTableAmRoutine(Oid amhandler)
+{
+	Datum		datum;
+	const TableAmRoutine *routine;
+
+	datum = OidFunctionCall0(amhandler);
+	routine = (const TableAmRoutine *) DatumGetPointer(datum);
+
+	if (routine == NULL || !IsA(routine, TableAmRoutine))
+		elog(ERROR, "table access method handler function %u did not return a TableAmRoutine struct",
+			 amhandler);
+	if (routine != GetHeapamTableAmRoutine())
+		elog(ERROR, "table access method handler function %u did not return the heap table access method",
+			 amhandler);
+
+	return routine;
+}
+
+/* check_hook: validate new default_table_access_method */
+bool
+check_default_table_access_method(char **newval, void **extra,
+								  GucSource source)
+{
+	if (**newval == '\0')
+	{
+		GUC_check_errdetail("%s cannot be empty.",
+							"default_table_access_method");
+		return false;
+	}
+
+	if (strlen(*newval) >= NAMEDATALEN)
+	{
+		GUC_check_errdetail("%s is too long (maximum %d characters).",
+							"default_table_access_method", NAMEDATALEN - 1);
+		return false;
+	}
+
+	/*
+	 * If we aren't inside a transaction, we cannot do database access so
+	 * cannot verify the name.  Must accept the value on faith.
+	 */
+	if (IsTransactionState())
+	{
+		HeapTuple	tuple;
+		char		amtype = '\0';
+
+		tuple = SearchSysCache1(AMNAME, CStringGetDatum(*newval));
+		if (HeapTupleIsValid(tuple))
+		{
+			amtype = ((Form_pg_am) GETSTRUCT(tuple))->amtype;
+			ReleaseSysCache(tuple);
+		}
+
+		if (amtype != AMTYPE_TABLE)
+		{
+			/*
+			 * When source == PGC_S_TEST, don't throw a hard error for a
+			 * nonexistent table access method, only a NOTICE.  See comments
+			 * in guc.h.
+			 */
+			if (source == PGC_S_TEST && amtype == '\0')
+			{
+				ereport(NOTICE,
+						(errcode(ERRCODE_UNDEFINED_OBJECT),
+						 errmsg("table access method \"%s\" does not exist",
+								*newval)));
+			}
+			else if (amtype == '\0')
+			{
+				GUC_check_errdetail("Table access method \"%s\" does not exist.",
+									*newval);
+				return false;
+			}
+			else
+			{
+				GUC_check_errdetail("Access method \"%s\" is not a table access method.",
+									*newval);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,919 @@
+/*-------------------------------------------------------------------------
+ *
+ * parallelredo.c
+ *	  Parallel WAL replay on standby servers
+ *
+ * Once a standby has reached a consistent state, the Startup process can
+ * hand WAL records over to a set of redo workers instead of replaying all of
+ * them itself.  The Startup process keeps reading WAL and acts as the
+ * dispatcher: a record whose block references all belong to one relation is
+ * sent to the worker chosen by hashing that relation, so that the changes to
+ * any one relation are still replayed in WAL order, by a single process.
+ * Partitioning by relation rather than by block also means that only one
+ * process ever extends a given relation.
+ *
+ * Every other record is a barrier: the Startup process waits for all workers
+ * to finish the records already sent to them, and then replays the record
+ * itself.  That covers records without block references, such as commits
+ * and checkpoints, records touching several relations, and records that
+ * request a consistency check.  Replaying commits only after everything
+ * before them means that hot standby queries never see a transaction as
+ * committed before all of its changes are in place.
+ *
+ * Queries may look at several relations at once, for example an index and
+ * its table, while the workers replay them at different paces.  Changes made
+ * by transactions that haven't committed yet are invisible anyway, so that
+ * only matters for the few changes that take effect without a commit.  When
+ * hot standby queries can run, those are barriers as well: heap line pointers
+ * being freed for reuse, which must not happen before the index entries
+ * pointing to them are gone, and in-place catalog updates, like the one that
+ * marks a concurrently built index as valid once its contents are in place.
+ * So are index deletions whose redo looks up the heap tuples the index
+ * entries pointed to, to find the queries they conflict with; the heap
+ * belongs to another worker and might not have caught up yet.
+ *
+ * Records go to the workers through shared memory queues, one per worker,
+ * carrying the raw record together with the part of the Startup process's
+ * state that redo routines depend on.  The workers advance the shared
+ * replay position as they go; it is the end of the last record before which
+ * everything has been replayed.
+ *
+ * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/parallelredo.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/hash_xlog.h"
+#include "access/heapam_xlog.h"
+#include "access/nbtxlog.h"
+#include "access/parallelredo.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/startup.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "storage/standby.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+#include "utils/pg_lsn.h"
+#include "utils/resowner.h"
+#include "utils/timeout.h"
+
+
+/* Size of the queue through which each worker receives records */
+#define REDO_WORKER_QUEUE_SIZE		((Size) 1024 * 1024)
+
+/* How often a busy worker advances the shared replay position */
+#define REDO_PROGRESS_INTERVAL		64
+
+/* Message types */
+#define REDO_MSG_RECORD				'R'	/* a WAL record to replay */
+#define REDO_MSG_CLOSE_FILES		'C' /* close all relation files */
+
+/*
+ * Header of a message to a worker.  For REDO_MSG_RECORD, the record itself
+ * follows, starting at REDO_MSG_HDRSZ.
+ */
+typedef struct RedoWorkMessage
+{
+	XLogRecPtr	ReadRecPtr;		/* start of the record */
+	XLogRecPtr	EndRecPtr;		/* end+1 of the record */
+	TimestampTz receiptTime;	/* see GetXLogReceiptTime */
+	bool		receiptFromStream;
+	HotStandbyState standbyState;
+	char		type;			/* REDO_MSG_* */
+} RedoWorkMessage;
+
+#define REDO_MSG_HDRSZ		MAXALIGN(sizeof(RedoWorkMessage))
+
+/*
+ * Shared state of one worker.  The counters only ever advance, and the
+ * dispatcher bumps 'dispatched' before sending a record, so the worker has
+ * caught up when 'replayed' equals 'dispatched'.
+ */
+typedef struct RedoWorkerSlot
+{
+	int			pid;			/* worker's PID, or 0 if not started */
+	pg_atomic_uint64 dispatched;	/* number of records sent */
+	pg_atomic_uint64 replayed;	/* number of records replayed */
+	pg_atomic_uint64 dispatchedPtr; /* end of last record sent */
+	pg_atomic_uint64 replayedPtr;	/* end of last record replayed */
+} RedoWorkerSlot;
+
+typedef struct ParallelRedoCtlData
+{
+	PGPROC	   *dispatcher;		/* the Startup process */
+	int			nworkers;		/* number of workers started */
+	bool		draining;		/* is the dispatcher waiting for workers? */
+	pg_atomic_uint64 dispatchPtr;	/* end of last record sent to any worker */
+	RedoWorkerSlot workers[FLEXIBLE_ARRAY_MEMBER];
+} ParallelRedoCtlData;
+
+static ParallelRedoCtlData *ParallelRedoCtl = NULL;
+
+/* the queues follow the control struct */
+#define RedoWorkerQueue(i) \
+	((shm_mq *) ((char *) ParallelRedoCtl + ParallelRedoCtlSize() + \
+				 (Size) (i) * REDO_WORKER_QUEUE_SIZE))
+
+/* GUC variable */
+int			max_redo_workers = 0;
+
+int			ParallelRedoWorkerNumber = -1;
+
+/* State of the dispatcher, in the Startup process */
+static bool redoWorkersLaunched = false;
+static int	nRedoWorkers = 0;
+static BackgroundWorkerHandle *redoWorkerHandles[MAX_REDO_WORKERS];
+static shm_mq_handle *redoWorkerQueues[MAX_REDO_WORKERS];
+static bool redoHotStandby = false;
+static bool redoCloseFilesPending = false;
+
+static Size ParallelRedoCtlSize(void);
+static int	RedoWorkerForRecord(XLogReaderState *record);
+static bool RedoRecordIsStandbyBarrier(XLogReaderState *record);
+static bool RedoRecordMayDropFiles(XLogReaderState *record);
+static void RedoWorkerSend(int worker, char type, XLogReaderState *record);
+static void RedoWorkerCheckAlive(int worker);
+static void ParallelRedoDetach(int code, Datum arg);
+static void RedoWorkerReportProgress(void);
+static void redo_worker_error_callback(void *arg);
+
+
+/*
+ * Size of the control struct, including the worker slots.
+ */
+static Size
+ParallelRedoCtlSize(void)
+{
+	return MAXALIGN(add_size(offsetof(ParallelRedoCtlData, workers),
+							 mul_size(max_redo_workers,
+									  sizeof(RedoWorkerSlot))));
+}
+
+/*
+ * Report shared-memory space needed by ParallelRedoShmemInit
+ */
+Size
+ParallelRedoShmemSize(void)
+{
+	return add_size(ParallelRedoCtlSize(),
+					mul_size(max_redo_workers, REDO_WORKER_QUEUE_SIZE));
+}
+
+/*
+ * Allocate and initialize parallel redo shared memory
+ */
+void
+ParallelRedoShmemInit(void)
+{
+	bool		found;
+	int			i;
+
+	ParallelRedoCtl = (ParallelRedoCtlData *)
+		ShmemInitStruct("Parallel Redo Ctl", ParallelRedoShmemSize(), &found);
+
+	if (!found)
+	{
+		ParallelRedoCtl->dispatcher = NULL;
+		ParallelRedoCtl->nworkers = 0;
+		ParallelRedoCtl->draining = false;
+		pg_atomic_init_u64(&ParallelRedoCtl->dispatchPtr, InvalidXLogRecPtr);
+
+		for (i = 0; i < max_redo_workers; i++)
+		{
+			RedoWorkerSlot *slot = &ParallelRedoCtl->workers[i];
+
+			slot->pid = 0;
+			pg_atomic_init_u64(&slot->dispatched, 0);
+			pg_atomic_init_u64(&slot->replayed, 0);
+			pg_atomic_init_u64(&slot->dispatchedPtr, InvalidXLogRecPtr);
+			pg_atomic_init_u64(&slot->replayedPtr, InvalidXLogRecPtr);
+		}
+	}
+}
+
+/*
+ * Launch the redo workers, if max_redo_workers is set.
+ *
+ * Called by the Startup process for each record once recovery has reached a
+ * consistent state; only the first call does anything.  Workers that can't
+ * be registered are logged and done without.
+ */
+void
+ParallelRedoStartWorkers(void)
+{
+	MemoryContext oldcontext;
+	int			i;
+
+	if (redoWorkersLaunched || max_redo_workers == 0)
+		return;
+	redoWorkersLaunched = true;
+
+	ParallelRedoCtl->dispatcher = MyProc;
+	redoHotStandby = (standbyState != STANDBY_DISABLED);
+
+	oldcontext = MemoryContextSwitchTo(TopMemoryContext);
+
+	for (i = 0; i < max_redo_workers; i++)
+	{
+		BackgroundWorker worker;
+		shm_mq	   *mq;
+
+		mq = shm_mq_create(RedoWorkerQueue(i), REDO_WORKER_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+
+		memset(&worker, 0, sizeof(worker));
+		worker.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		worker.bgw_start_time = BgWorkerStart_PostmasterStart;
+		worker.bgw_restart_time = BGW_NEVER_RESTART;
+		sprintf(worker.bgw_library_name, "postgres");
+		sprintf(worker.bgw_function_name, "ParallelRedoWorkerMain");
+		snprintf(worker.bgw_name, BGW_MAXLEN, "parallel redo worker %d", i);
+		snprintf(worker.bgw_type, BGW_MAXLEN, "parallel redo worker");
+		worker.bgw_main_arg = Int32GetDatum(i);
+		worker.bgw_notify_pid = MyProcPid;
+
+		if (!RegisterDynamicBackgroundWorker(&worker, &redoWorkerHandles[i]))
+		{
+			ereport(LOG,
+					(errcode(ERRCODE_CONFIGURATION_LIMIT_EXCEEDED),
+					 errmsg("could only register %d of %d parallel redo workers",
+							i, max_redo_workers),
+					 errhint("You might need to increase max_worker_processes.")));
+			break;
+		}
+
+		redoWorkerQueues[i] = shm_mq_attach(mq, NULL, redoWorkerHandles[i]);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	nRedoWorkers = i;
+	if (nRedoWorkers == 0)
+		return;
+
+	on_shmem_exit(ParallelRedoDetach, 0);
+
+	/* workers look at this to find the other workers' slots */
+	ParallelRedoCtl->nworkers = nRedoWorkers;
+
+	ereport(LOG,
+			(errmsg("parallel redo started with %d workers", nRedoWorkers)));
+}
+
+/*
+ * Hand a record over to a redo worker, if it can be replayed out of order
+ * with respect to the records of other relations.
+ *
+ * Returns true if a worker will replay the record.  Otherwise all earlier
+ * records have been replayed when this returns, and the caller must replay
+ * the record itself.
+ */
+bool
+ParallelRedoDispatch(XLogReaderState *record)
+{
+	int			worker;
+	int			i;
+
+	if (nRedoWorkers == 0)
+		return false;
+
+	worker = RedoWorkerForRecord(record);
+	if (worker < 0)
+	{
+		ParallelRedoDrain();
+
+		/*
+		 * The workers could still have files open for the relations this
+		 * record removes, and a new relation could reuse the relfilenode.
+		 * Have them close their files before the next record.
+		 */
+		if (RedoRecordMayDropFiles(record))
+			redoCloseFilesPending = true;
+
+		return false;
+	}
+
+	if (redoCloseFilesPending)
+	{
+		for (i = 0; i < nRedoWorkers; i++)
+			RedoWorkerSend(i, REDO_MSG_CLOSE_FILES, NULL);
+		redoCloseFilesPending = false;
+	}
+
+	RedoWorkerSend(worker, REDO_MSG_RECORD, record);
+
+	return true;
+}
+
+/*
+ * Wait for all workers to replay every record sent to them.
+ */
+void
+ParallelRedoDrain(void)
+{
+	int			i;
+
+	if (nRedoWorkers == 0)
+		return;
+
+	/*
+	 * Workers only wake us up while we're draining.  Set the flag before
+	 * checking their progress; they check it after advancing it.
+	 */
+	ParallelRedoCtl->draining = true;
+	pg_memory_barrier();
+
+	for (i = 0; i < nRedoWorkers; i++)
+	{
+		RedoWorkerSlot *slot = &ParallelRedoCtl->workers[i];
+
+		while (pg_atomic_read_u64(&slot->replayed) <
+			   pg_atomic_read_u64(&slot->dispatched))
+		{
+			RedoWorkerCheckAlive(i);
+
+			(void) WaitLatch(MyLatch,
+							 WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+							 100L, WAIT_EVENT_REDO_DRAIN);
+			ResetLatch(MyLatch);
+			HandleStartupProcInterrupts();
+		}
+	}
+
+	ParallelRedoCtl->draining = false;
+
+	/* everything dispatched so far has been replayed */
+	XLogAdvanceReplayRecPtr(pg_atomic_read_u64(&ParallelRedoCtl->dispatchPtr));
+}
+
+/*
+ * Wait for the workers to replay what they have been sent, then make them
+ * exit.  Called by the Startup process at the end of the redo loop.
+ */
+void
+ParallelRedoShutdownWorkers(void)
+{
+	int			i;
+
+	if (nRedoWorkers == 0)
+		return;
+
+	ParallelRedoDrain();
+
+	/* detaching from the queues tells the workers to exit */
+	ParallelRedoDetach(0, (Datum) 0);
+
+	for (i = 0; i < nRedoWorkers; i++)
+	{
+		pid_t		pid;
+
+		while (GetBackgroundWorkerPid(redoWorkerHandles[i], &pid) != BGWH_STOPPED)
+		{
+			(void) WaitLatch(MyLatch,
+							 WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+							 100L, WAIT_EVENT_BGWORKER_SHUTDOWN);
+			ResetLatch(MyLatch);
+			HandleStartupProcInterrupts();
+		}
+	}
+
+	ParallelRedoCtl->nworkers = 0;
+	nRedoWorkers = 0;
+}
+
+/*
+ * Choose the worker to replay a record, or return -1 if the Startup process
+ * must replay it itself.
+ */
+static int
+RedoWorkerForRecord(XLogReaderState *record)
+{
+	RelFileNode rnode;
+	bool		found = false;
+	uint32		hashcode;
+	int			block_id;
+
+	/* checkXLogConsistency() is only available to the Startup process */
+	if ((XLogRecGetInfo(record) & XLR_CHECK_CONSISTENCY) != 0)
+		return -1;
+
+	for (block_id = 0; block_id <= record->max_block_id; block_id++)
+	{
+		RelFileNode blk_rnode;
+
+		if (!XLogRecGetBlockTag(record, block_id, &blk_rnode, NULL, NULL))
+			continue;
+
+		if (!found)
+		{
+			rnode = blk_rnode;
+			found = true;
+		}
+		else if (!RelFileNodeEquals(blk_rnode, rnode))
+			return -1;
+	}
+
+	if (!found)
+		return -1;
+
+	if (redoHotStandby && RedoRecordIsStandbyBarrier(record))
+		return -1;
+
+	hashcode = DatumGetUInt32(hash_any((unsigned char *) &rnode,
+									   sizeof(RelFileNode)));
+
+	return hashcode % nRedoWorkers;
+}
+
+/*
+ * Must this record wait for the other relations to catch up, for the sake of
+ * hot standby queries?  That's the case if replaying it could change what
+ * queries see in other relations before any commit, or if its redo routine
+ * reads another relation.
+ */
+static bool
+RedoRecordIsStandbyBarrier(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_BTREE_ID:
+			return info == XLOG_BTREE_DELETE;
+
+		case RM_HASH_ID:
+			return info == XLOG_HASH_VACUUM_ONE_PAGE;
+
+		case RM_HEAP_ID:
+			return (info & XLOG_HEAP_OPMASK) == XLOG_HEAP_INPLACE;
+
+		case RM_HEAP2_ID:
+			if ((info & XLOG_HEAP_OPMASK) == XLOG_HEAP2_CLEAN)
+			{
+				xl_heap_clean *xlrec = (xl_heap_clean *) XLogRecGetData(record);
+				Size		datalen;
+
+				/*
+				 * The unused offsets come last in the block data.  If the
+				 * record carries a full-page image instead, assume the worst.
+				 */
+				if (XLogRecGetBlockData(record, 0, &datalen) == NULL)
+					return true;
+				return datalen > (xlrec->nredirected * 2 + xlrec->ndead) *
+					sizeof(OffsetNumber);
+			}
+			break;
+	}
+
+	return false;
+}
+
+/*
+ * Could replaying this record remove relation files?
+ */
+static bool
+RedoRecordMayDropFiles(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_SMGR_ID:
+		case RM_DBASE_ID:
+		case RM_TBLSPC_ID:
+			return true;
+
+		case RM_XACT_ID:
+			switch (info & XLOG_XACT_OPMASK)
+			{
+				case XLOG_XACT_COMMIT:
+				case XLOG_XACT_COMMIT_PREPARED:
+					{
+						xl_xact_parsed_commit parsed;
+
+						ParseCommitRecord(XLogRecGetInfo(record),
+										  (xl_xact_commit *) XLogRecGetData(record),
+										  &parsed);
+						return parsed.nrels > 0;
+					}
+				case XLOG_XACT_ABORT:
+				case XLOG_XACT_ABORT_PREPARED:
+					{
+						xl_xact_parsed_abort parsed;
+
+						ParseAbortRecord(XLogRecGetInfo(record),
+										 (xl_xact_abort *) XLogRecGetData(record),
+										 &parsed);
+						return parsed.nrels > 0;
+					}
+			}
+			break;
+	}
+
+	return false;
+}
+
+/*
+ * Send a message to a worker, waiting for room in its queue if necessary.
+ */
+static void
+RedoWorkerSend(int worker, char type, XLogReaderState *record)
+{
+	RedoWorkerSlot *slot = &ParallelRedoCtl->workers[worker];
+	union
+	{
+		RedoWorkMessage msg;
+		char		data[REDO_MSG_HDRSZ];
+	}			hdr;
+	shm_mq_iovec iov[2];
+	int			iovcnt = 1;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.msg.type = type;
+	iov[0].data = hdr.data;
+	iov[0].len = REDO_MSG_HDRSZ;
+
+	if (type == REDO_MSG_RECORD)
+	{
+		hdr.msg.ReadRecPtr = record->ReadRecPtr;
+		hdr.msg.EndRecPtr = record->EndRecPtr;
+		hdr.msg.standbyState = standbyState;
+		GetXLogReceiptTime(&hdr.msg.receiptTime, &hdr.msg.receiptFromStream);
+
+		iov[1].data = (char *) record->decoded_record;
+		iov[1].len = record->decoded_record->xl_tot_len;
+		iovcnt = 2;
+
+		pg_atomic_write_u64(&slot->dispatchedPtr, record->EndRecPtr);
+		pg_atomic_fetch_add_u64(&slot->dispatched, 1);
+	}
+
+	for (;;)
+	{
+		shm_mq_result res;
+
+		res = shm_mq_sendv(redoWorkerQueues[worker], iov, iovcnt, true);
+		if (res == SHM_MQ_SUCCESS)
+			break;
+		if (res == SHM_MQ_DETACHED)
+			ereport(FATAL,
+					(errmsg("parallel redo worker %d exited unexpectedly",
+							worker)));
+
+		(void) WaitLatch(MyLatch,
+						 WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+						 100L, WAIT_EVENT_REDO_DISPATCH);
+		ResetLatch(MyLatch);
+		HandleStartupProcInterrupts();
+	}
+
+	if (type == REDO_MSG_RECORD)
+		pg_atomic_write_u64(&ParallelRedoCtl->dispatchPtr, record->EndRecPtr);
+}
+
+/*
+ * Error out if a worker has exited while it still had records to replay.
+ */
+static void
+RedoWorkerCheckAlive(int worker)
+{
+	pid_t		pid;
+
+	if (GetBackgroundWorkerPid(redoWorkerHandles[worker], &pid) == BGWH_STOPPED)
+		ereport(FATAL,
+				(errmsg("parallel redo worker %d exited unexpectedly",
+						worker)));
+}
+
+/*
+ * Detach from the workers' queues.  Also an on_shmem_exit callback, so that
+ * the workers exit if the Startup process does.
+ */
+static void
+ParallelRedoDetach(int code, Datum arg)
+{
+	int			i;
+
+	for (i = 0; i < nRedoWorkers; i++)
+	{
+		if (redoWorkerQueues[i] != NULL)
+		{
+			shm_mq_detach(redoWorkerQueues[i]);
+			redoWorkerQueues[i] = NULL;
+		}
+	}
+}
+
+/*
+ * Main entry point for a redo worker.
+ */
+void
+ParallelRedoWorkerMain(Datum main_arg)
+{
+	int			worker = DatumGetInt32(main_arg);
+	RedoWorkerSlot *slot = &ParallelRedoCtl->workers[worker];
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	XLogReaderState *xlogreader;
+	MemoryContext redo_context;
+	ErrorContextCallback errcallback;
+	int			rmid;
+
+	BackgroundWorkerUnblockSignals();
+
+	ParallelRedoWorkerNumber = worker;
+	slot->pid = MyProcPid;
+
+	/*
+	 * Make ourselves known to ProcSendSignal(), which is how UnpinBuffer()
+	 * wakes up a process waiting for a cleanup lock.
+	 */
+	InitProcessPhase2();
+
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "parallel redo worker");
+
+	/* Set up to replay records the way the Startup process does */
+	InRecovery = true;
+	reachedConsistency = true;
+	XLogLoadMinRecoveryPoint();
+
+	RegisterTimeout(STANDBY_DEADLOCK_TIMEOUT, StandbyDeadLockHandler);
+	RegisterTimeout(STANDBY_TIMEOUT, StandbyTimeoutHandler);
+
+	mq = RedoWorkerQueue(worker);
+	shm_mq_set_receiver(mq, MyProc);
+	mqh = shm_mq_attach(mq, NULL, NULL);
+
+	xlogreader = XLogReaderAllocate(wal_segment_size, NULL, NULL);
+	if (!xlogreader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+
+	redo_context = AllocSetContextCreate(TopMemoryContext,
+										 "parallel redo",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	for (rmid = 0; rmid <= RM_MAX_ID; rmid++)
+	{
+		if (RmgrTable[rmid].rm_startup != NULL)
+			RmgrTable[rmid].rm_startup();
+	}
+
+	errcallback.callback = redo_worker_error_callback;
+	errcallback.arg = (void *) xlogreader;
+
+	for (;;)
+	{
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+		RedoWorkMessage msg;
+		char	   *errormsg;
+		uint64		replayed;
+		MemoryContext oldcontext;
+
+		res = shm_mq_receive(mqh, &nbytes, &data, true);
+		if (res == SHM_MQ_WOULD_BLOCK)
+		{
+			/* out of work; publish our progress before going to sleep */
+			RedoWorkerReportProgress();
+			res = shm_mq_receive(mqh, &nbytes, &data, false);
+		}
+
+		/* the Startup process detaches once recovery is over */
+		if (res != SHM_MQ_SUCCESS)
+			break;
+
+		if (nbytes < REDO_MSG_HDRSZ)
+			elog(ERROR, "invalid parallel redo message size %zu", nbytes);
+		memcpy(&msg, data, sizeof(msg));
+
+		if (msg.type == REDO_MSG_CLOSE_FILES)
+		{
+			smgrcloseall();
+			continue;
+		}
+		else if (msg.type != REDO_MSG_RECORD)
+			elog(ERROR, "invalid parallel redo message type %d", msg.type);
+
+		xlogreader->ReadRecPtr = msg.ReadRecPtr;
+		xlogreader->EndRecPtr = msg.EndRecPtr;
+		standbyState = msg.standbyState;
+		SetXLogReceiptTime(msg.receiptTime, msg.receiptFromStream);
+
+		if (!DecodeXLogRecord(xlogreader,
+							  (XLogRecord *) ((char *) data + REDO_MSG_HDRSZ),
+							  &errormsg))
+			elog(ERROR, "could not decode WAL record at %X/%X: %s",
+				 (uint32) (msg.ReadRecPtr >> 32), (uint32) msg.ReadRecPtr,
+				 errormsg);
+
+		errcallback.previous = error_context_stack;
+		error_context_stack = &errcallback;
+		oldcontext = MemoryContextSwitchTo(redo_context);
+
+		RmgrTable[XLogRecGetRmid(xlogreader)].rm_redo(xlogreader);
+
+		MemoryContextSwitchTo(oldcontext);
+		MemoryContextReset(redo_context);
+		error_context_stack = errcallback.previous;
+
+		pg_atomic_write_u64(&slot->replayedPtr, msg.EndRecPtr);
+		replayed = pg_atomic_add_fetch_u64(&slot->replayed, 1);
+
+		/* wake up the dispatcher if it's waiting for us to catch up */
+		if (replayed == pg_atomic_read_u64(&slot->dispatched) &&
+			ParallelRedoCtl->draining)
+			SetLatch(&ParallelRedoCtl->dispatcher->procLatch);
+
+		if (replayed % REDO_PROGRESS_INTERVAL == 0)
+			RedoWorkerReportProgress();
+
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	for (rmid = 0; rmid <= RM_MAX_ID; rmid++)
+	{
+		if (RmgrTable[rmid].rm_cleanup != NULL)
+			RmgrTable[rmid].rm_cleanup();
+	}
+
+	proc_exit(0);
+}
+
+/*
+ * Advance the shared replay position as far as all workers allow.
+ *
+ * Every record up to the end of the last one dispatched has been replayed,
+ * except in workers that are behind; for those, we know only that their
+ * records up to the end of the last one they replayed are done.
+ */
+static void
+RedoWorkerReportProgress(void)
+{
+	XLogRecPtr	upto;
+	int			nworkers = ParallelRedoCtl->nworkers;
+	int			i;
+
+	upto = pg_atomic_read_u64(&ParallelRedoCtl->dispatchPtr);
+	pg_read_barrier();
+
+	for (i = 0; i < nworkers; i++)
+	{
+		RedoWorkerSlot *slot = &ParallelRedoCtl->workers[i];
+		uint64		dispatched;
+
+		dispatched = pg_atomic_read_u64(&slot->dispatched);
+		pg_read_barrier();
+		if (pg_atomic_read_u64(&slot->replayed) < dispatched)
+			upto = Min(upto, pg_atomic_read_u64(&slot->replayedPtr));
+	}
+
+	XLogAdvanceReplayRecPtr(upto);
+}
+
+/*
+ * Error context callback for errors during redo in a worker.
+ */
+static void
+redo_worker_error_callback(void *arg)
+{
+	XLogReaderState *record = (XLogReaderState *) arg;
+	RmgrId		rmid = XLogRecGetRmid(record);
+	uint8		info = XLogRecGetInfo(record);
+	const char *id;
+	StringInfoData buf;
+
+	initStringInfo(&buf);
+	appendStringInfo(&buf, "%s/", RmgrTable[rmid].rm_name);
+	id = RmgrTable[rmid].rm_identify(info);
+	if (id == NULL)
+		appendStringInfo(&buf, "UNKNOWN (%X): ", info & ~XLR_INFO_MASK);
+	else
+		appendStringInfo(&buf, "%s: ", id);
+	RmgrTable[rmid].rm_desc(&buf, record);
+
+	/* translator: %s is a WAL record description */
+	errcontext("WAL redo at %X/%X in parallel redo worker %d for %s",
+			   (uint32) (record->ReadRecPtr >> 32),
+			   (uint32) record->ReadRecPtr,
+			   ParallelRedoWorkerNumber, buf.data);
+
+	pfree(buf.data);
+}
+
+/*
+ * Returns activity of the parallel redo workers.
+ */
+Datum
+pg_stat_get_redo_workers(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_REDO_WORKERS_COLS	7
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	int			nworkers;
+	int			i;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	nworkers = ParallelRedoCtl->nworkers;
+	for (i = 0; i < nworkers; i++)
+	{
+		RedoWorkerSlot *slot = &ParallelRedoCtl->workers[i];
+		Datum		values[PG_STAT_GET_REDO_WORKERS_COLS];
+		bool		nulls[PG_STAT_GET_REDO_WORKERS_COLS];
+		uint64		replayed;
+		uint64		dispatched;
+		XLogRecPtr	replayedPtr;
+		XLogRecPtr	dispatchedPtr;
+		int			pid = slot->pid;
+
+		/* read replay progress first, so that it can't run ahead */
+		replayed = pg_atomic_read_u64(&slot->replayed);
+		replayedPtr = pg_atomic_read_u64(&slot->replayedPtr);
+		pg_read_barrier();
+		dispatched = pg_atomic_read_u64(&slot->dispatched);
+		dispatchedPtr = pg_atomic_read_u64(&slot->dispatchedPtr);
+
+		memset(nulls, 0, sizeof(nulls));
+
+		values[0] = Int32GetDatum(i);
+		if (pid != 0)
+			values[1] = Int32GetDatum(pid);
+		else
+			nulls[1] = true;
+		values[2] = Int64GetDatum((int64) dispatched);
+		values[3] = Int64GetDatum((int64) replayed);
+
+		if (dispatched > 0)
+			values[4] = LSNGetDatum(dispatchedPtr);
+		else
+			nulls[4] = true;
+
+		if (replayed > 0)
+			values[5] = LSNGetDatum(replayedPtr);
+		else
+			nulls[5] = true;
+
+		/* WAL sent to the worker but not replayed yet */
+		if (replayed >= dispatched)
+			values[6] = Int64GetDatum(0);
+		else if (replayed > 0 && dispatchedPtr > replayedPtr)
+			values[6] = Int64GetDatum((int64) (dispatchedPtr - replayedPtr));
+		else
+			nulls[6] = true;
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
@@ -683,16 +683,41 @@ GetCurrentCommandId(bool used)
 	{
 		/*
 		 * Forbid setting currentCommandIdUsed in a parallel worker, because
-		 * we have no provision for communicating this back to the master.  We
-		 * could relax this restriction when currentCommandIdUsed was already
-		 * true at the start of the parallel operation.
+		 * we have no provision for communicating this back to the master,
+		 * unless the master already marked it used before starting the
+		 * parallel operation (see SetCurrentCommandIdUsedForWorker).
 		 */
-		Assert(!IsParallelWorker());
+		Assert(!IsParallelWorker() || currentCommandIdUsed);
 		currentCommandIdUsed = true;
 	}
 	return currentCommandId;
 }
 
+/*
+ *	SetCurrentCommandIdUsedForWorker
+ *
+ * For a parallel worker, record that the current command ID is used to
+ * modify data.  This is only safe if the master marked it used before
+ * launching the worker, which the caller is responsible for ensuring.
+ */
+void
+SetCurrentCommandIdUsedForWorker(void)
+{
+	Assert(IsParallelWorker() && !currentCommandIdUsed &&
+		   currentCommandId != InvalidCommandId);
+
+	currentCommandIdUsed = true;
+}
+
+/*
+ *	IsCurrentCommandIdUsed
+ */
+bool
+IsCurrentCommandIdUsed(void)
+{
+	return currentCommandIdUsed;
+}
+
 /*
  *	GetCurrentTransactionStartTimestamp
  */
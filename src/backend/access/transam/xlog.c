@@ -25,6 +25,7 @@
 #include "access/clog.h"
 #include "access/commit_ts.h"
 #include "access/multixact.h"
+#include "access/parallelredo.h"
 #include "access/rewriteheap.h"
 #include "access/subtrans.h"
 #include "access/timeline.h"
@@ -43,6 +44,7 @@
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "port/atomics.h"
+#include "portability/instr_time.h"
 #include "postmaster/bgwriter.h"
 #include "postmaster/walwriter.h"
 #include "postmaster/startup.h"
@@ -96,7 +98,7 @@ char	   *XLogArchiveCommand = NULL;
 bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
-bool		wal_compression = false;
+int			wal_compression = WAL_COMPRESSION_NONE;
 char	   *wal_consistency_checking_string = NULL;
 bool	   *wal_consistency_checking = NULL;
 bool		log_checkpoints = false;
@@ -113,11 +115,11 @@ bool		XLOG_DEBUG = false;
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Number of WAL insertion locks to use (wal_insert_locks). A higher value
+ * allows more insertions to happen concurrently, but adds some CPU overhead
+ * to flushing the WAL, which needs to iterate all the locks.
  */
-#define NUM_XLOGINSERT_LOCKS  8
+int			num_xloginsert_locks = 8;
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -702,6 +704,21 @@ typedef struct XLogCtlData
 	XLogRecPtr	lastFpwDisableRecPtr;
 
 	slock_t		info_lck;		/* locks shared variables shown above */
+
+	/*
+	 * WAL flush statistics, shown in pg_stat_wal_flush.  Times are in
+	 * microseconds.  flushCount, flushTime and flushTimeAvg describe the
+	 * writes and syncs done by backends that became flush leader in
+	 * XLogFlush, and are only updated while holding WALWriteLock.  The
+	 * others describe how long XLogFlush calls had to wait for their WAL to
+	 * become durable, whether they did the flush themselves or not.
+	 */
+	pg_atomic_uint64 flushCount;
+	pg_atomic_uint64 flushTime;
+	pg_atomic_uint64 flushTimeAvg;	/* moving average of flush time */
+	pg_atomic_uint64 flushWaits;
+	pg_atomic_uint64 flushWaitTime;
+	pg_atomic_uint64 flushWaitHist[XLOG_FLUSH_WAIT_BUCKETS];
 } XLogCtlData;
 
 static XLogCtlData *XLogCtl = NULL;
@@ -1002,8 +1019,8 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * To keep track of which insertions are still in-progress, each concurrent
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
-	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * has progressed. There is a small number of insertion locks, fixed at
+	 * server start by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1619,7 +1636,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProc->pgprocno % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProc->pgprocno % num_xloginsert_locks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1637,7 +1654,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % num_xloginsert_locks;
 	}
 }
 
@@ -1655,7 +1672,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < num_xloginsert_locks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1681,7 +1698,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < num_xloginsert_locks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1709,8 +1726,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-						&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[num_xloginsert_locks - 1].l.lock,
+						&WALInsertLocks[num_xloginsert_locks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1777,7 +1794,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < num_xloginsert_locks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -2786,6 +2803,90 @@ UpdateMinRecoveryPoint(XLogRecPtr lsn, bool force)
 	LWLockRelease(ControlFileLock);
 }
 
+/*
+ * Return the number of microseconds a flush leader should sleep before
+ * flushing, to let more commits join the group.
+ *
+ * With commit_delay set to -1, sleep for half of the recent average time a
+ * flush takes.  A commit arriving during that window would otherwise have
+ * had to wait for the next flush after this one, so this catches most of
+ * them while adding at most half a flush to the leader's own latency.
+ */
+static int
+XLogCommitDelay(void)
+{
+	uint64		avg;
+
+	if (CommitDelay >= 0)
+		return CommitDelay;
+
+	avg = pg_atomic_read_u64(&XLogCtl->flushTimeAvg);
+	return (int) Min(avg / 2, XLOG_MAX_COMMIT_DELAY);
+}
+
+/*
+ * Account for a write and sync of WAL done by a flush leader in XLogFlush,
+ * which took the given number of microseconds.  Caller must hold
+ * WALWriteLock, which serializes updates of the moving average.
+ */
+static void
+XLogReportFlush(uint64 usecs)
+{
+	uint64		avg;
+
+	pg_atomic_fetch_add_u64(&XLogCtl->flushCount, 1);
+	pg_atomic_fetch_add_u64(&XLogCtl->flushTime, usecs);
+
+	/* exponential moving average with weight 1/8 for the new sample */
+	avg = pg_atomic_read_u64(&XLogCtl->flushTimeAvg);
+	if (avg == 0)
+		avg = usecs;
+	else
+		avg = avg - avg / 8 + usecs / 8;
+	pg_atomic_write_u64(&XLogCtl->flushTimeAvg, avg);
+}
+
+/*
+ * Account for an XLogFlush call that had to wait the given number of
+ * microseconds for its WAL to be flushed.  The histogram has power-of-two
+ * buckets: bucket i counts waits of less than 2^(i+1) microseconds that
+ * don't fit in a lower bucket, and the last bucket takes all longer waits.
+ */
+static void
+XLogReportFlushWait(uint64 usecs)
+{
+	int			bucket = 0;
+
+	while (bucket < XLOG_FLUSH_WAIT_BUCKETS - 1 &&
+		   usecs >= (UINT64CONST(2) << bucket))
+		bucket++;
+
+	pg_atomic_fetch_add_u64(&XLogCtl->flushWaits, 1);
+	pg_atomic_fetch_add_u64(&XLogCtl->flushWaitTime, usecs);
+	pg_atomic_fetch_add_u64(&XLogCtl->flushWaitHist[bucket], 1);
+}
+
+/*
+ * Return a snapshot of the WAL flush statistics.
+ *
+ * The counters are read one at a time without locking, so they may be
+ * slightly out of step with each other.
+ */
+void
+GetXLogFlushStats(XLogFlushStats *stats)
+{
+	int			i;
+
+	stats->flushes = pg_atomic_read_u64(&XLogCtl->flushCount);
+	stats->flush_time = pg_atomic_read_u64(&XLogCtl->flushTime);
+	stats->flush_waits = pg_atomic_read_u64(&XLogCtl->flushWaits);
+	stats->flush_wait_time = pg_atomic_read_u64(&XLogCtl->flushWaitTime);
+	for (i = 0; i < XLOG_FLUSH_WAIT_BUCKETS; i++)
+		stats->flush_wait_hist[i] =
+			pg_atomic_read_u64(&XLogCtl->flushWaitHist[i]);
+	stats->commit_delay = XLogCommitDelay();
+}
+
 /*
  * Ensure that all XLOG data through the given position is flushed to disk.
  *
@@ -2797,6 +2898,11 @@ XLogFlush(XLogRecPtr record)
 {
 	XLogRecPtr	WriteRqstPtr;
 	XLogwrtRqst WriteRqst;
+	instr_time	wait_start;
+	instr_time	wait_time;
+	instr_time	flush_start;
+	instr_time	flush_time;
+	int			delay;
 
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
@@ -2823,6 +2929,8 @@ XLogFlush(XLogRecPtr record)
 			 (uint32) (LogwrtResult.Flush >> 32), (uint32) LogwrtResult.Flush);
 #endif
 
+	INSTR_TIME_SET_CURRENT(wait_start);
+
 	START_CRIT_SECTION();
 
 	/*
@@ -2890,15 +2998,17 @@ XLogFlush(XLogRecPtr record)
 		 * Sleep before flush! By adding a delay here, we may give further
 		 * backends the opportunity to join the backlog of group commit
 		 * followers; this can significantly improve transaction throughput,
-		 * at the risk of increasing transaction latency.
+		 * at the risk of increasing transaction latency.  With commit_delay
+		 * set to -1, the delay follows the recent flush time; see
+		 * XLogCommitDelay.
 		 *
 		 * We do not sleep if enableFsync is not turned on, nor if there are
 		 * fewer than CommitSiblings other backends with active transactions.
 		 */
-		if (CommitDelay > 0 && enableFsync &&
+		if ((delay = XLogCommitDelay()) > 0 && enableFsync &&
 			MinimumActiveBackends(CommitSiblings))
 		{
-			pg_usleep(CommitDelay);
+			pg_usleep(delay);
 
 			/*
 			 * Re-check how far we can now flush the WAL. It's generally not
@@ -2917,7 +3027,11 @@ XLogFlush(XLogRecPtr record)
 		WriteRqst.Write = insertpos;
 		WriteRqst.Flush = insertpos;
 
+		INSTR_TIME_SET_CURRENT(flush_start);
 		XLogWrite(WriteRqst, false);
+		INSTR_TIME_SET_CURRENT(flush_time);
+		INSTR_TIME_SUBTRACT(flush_time, flush_start);
+		XLogReportFlush(INSTR_TIME_GET_MICROSEC(flush_time));
 
 		LWLockRelease(WALWriteLock);
 		/* done */
@@ -2926,6 +3040,10 @@ XLogFlush(XLogRecPtr record)
 
 	END_CRIT_SECTION();
 
+	INSTR_TIME_SET_CURRENT(wait_time);
+	INSTR_TIME_SUBTRACT(wait_time, wait_start);
+	XLogReportFlushWait(INSTR_TIME_GET_MICROSEC(wait_time));
+
 	/* wake up walsenders now that we've released heavily contended locks */
 	WalSndWakeupProcessRequests();
 
@@ -4951,7 +5069,8 @@ XLOGShmemSize(void)
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded),
+								   num_xloginsert_locks + 1));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(XLogRecPtr), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -5043,10 +5162,10 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) % sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * num_xloginsert_locks;
 
 	LWLockRegisterTranche(LWTRANCHE_WAL_INSERT, "wal_insert");
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < num_xloginsert_locks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
@@ -5075,6 +5194,14 @@ XLOGShmemInit(void)
 	SpinLockInit(&XLogCtl->info_lck);
 	SpinLockInit(&XLogCtl->ulsn_lck);
 	InitSharedLatch(&XLogCtl->recoveryWakeupLatch);
+
+	pg_atomic_init_u64(&XLogCtl->flushCount, 0);
+	pg_atomic_init_u64(&XLogCtl->flushTime, 0);
+	pg_atomic_init_u64(&XLogCtl->flushTimeAvg, 0);
+	pg_atomic_init_u64(&XLogCtl->flushWaits, 0);
+	pg_atomic_init_u64(&XLogCtl->flushWaitTime, 0);
+	for (i = 0; i < XLOG_FLUSH_WAIT_BUCKETS; i++)
+		pg_atomic_init_u64(&XLogCtl->flushWaitHist[i], 0);
 }
 
 /*
@@ -6072,6 +6199,9 @@ recoveryPausesHere(void)
 	if (!LocalHotStandbyActive)
 		return;
 
+	/* Let parallel redo workers replay everything read so far */
+	ParallelRedoDrain();
+
 	ereport(LOG,
 			(errmsg("recovery has paused"),
 			 errhint("Execute pg_wal_replay_resume() to continue.")));
@@ -6273,6 +6403,38 @@ GetXLogReceiptTime(TimestampTz *rtime, bool *fromStream)
 	*fromStream = (XLogReceiptSource == XLOG_FROM_STREAM);
 }
 
+/*
+ * Set the time of receipt of the WAL being replayed.
+ *
+ * Used by parallel redo workers, which don't read WAL themselves, to adopt
+ * the Startup process's values for the records they are given, so that
+ * recovery conflicts are resolved against the right standby delay.
+ */
+void
+SetXLogReceiptTime(TimestampTz rtime, bool fromStream)
+{
+	Assert(InRecovery);
+
+	XLogReceiptTime = rtime;
+	XLogReceiptSource = fromStream ? XLOG_FROM_STREAM : XLOG_FROM_ARCHIVE;
+}
+
+/*
+ * Initialize our local copy of minRecoveryPoint from the control file.
+ *
+ * A parallel redo worker starts out with an invalid local copy, which
+ * UpdateMinRecoveryPoint would take to mean crash recovery.  Workers only
+ * run during archive recovery, so the control file's value is valid.
+ */
+void
+XLogLoadMinRecoveryPoint(void)
+{
+	LWLockAcquire(ControlFileLock, LW_SHARED);
+	minRecoveryPoint = ControlFile->minRecoveryPoint;
+	minRecoveryPointTLI = ControlFile->minRecoveryPointTLI;
+	LWLockRelease(ControlFileLock);
+}
+
 /*
  * Note that text field supplied is a parameter name and does not require
  * translation
@@ -7188,6 +7350,7 @@ StartupXLOG(void)
 			do
 			{
 				bool		switchedTLI = false;
+				bool		dispatched;
 
 #ifdef WAL_DEBUG
 				if (XLOG_DEBUG ||
@@ -7335,29 +7498,40 @@ StartupXLOG(void)
 					TransactionIdIsValid(record->xl_xid))
 					RecordKnownAssignedTransactionIds(record->xl_xid);
 
-				/* Now apply the WAL record itself */
-				RmgrTable[record->xl_rmid].rm_redo(xlogreader);
-
 				/*
-				 * After redo, check whether the backup pages associated with
-				 * the WAL record are consistent with the existing pages. This
-				 * check is done only if consistency check is enabled for this
-				 * record.
+				 * Now apply the WAL record itself, unless it can be handed
+				 * to a parallel redo worker.
 				 */
-				if ((record->xl_info & XLR_CHECK_CONSISTENCY) != 0)
-					checkXLogConsistency(xlogreader);
+				dispatched = ParallelRedoDispatch(xlogreader);
+				if (!dispatched)
+				{
+					RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+
+					/*
+					 * After redo, check whether the backup pages associated
+					 * with the WAL record are consistent with the existing
+					 * pages. This check is done only if consistency check is
+					 * enabled for this record.
+					 */
+					if ((record->xl_info & XLR_CHECK_CONSISTENCY) != 0)
+						checkXLogConsistency(xlogreader);
+				}
 
 				/* Pop the error context stack */
 				error_context_stack = errcallback.previous;
 
 				/*
 				 * Update lastReplayedEndRecPtr after this record has been
-				 * successfully replayed.
+				 * successfully replayed.  The worker that replays a
+				 * dispatched record advances it instead.
 				 */
-				SpinLockAcquire(&XLogCtl->info_lck);
-				XLogCtl->lastReplayedEndRecPtr = EndRecPtr;
-				XLogCtl->lastReplayedTLI = ThisTimeLineID;
-				SpinLockRelease(&XLogCtl->info_lck);
+				if (!dispatched)
+				{
+					SpinLockAcquire(&XLogCtl->info_lck);
+					XLogCtl->lastReplayedEndRecPtr = EndRecPtr;
+					XLogCtl->lastReplayedTLI = ThisTimeLineID;
+					SpinLockRelease(&XLogCtl->info_lck);
+				}
 
 				/*
 				 * If rm_redo called XLogRequestWalReceiverReply, then we wake
@@ -7376,6 +7550,14 @@ StartupXLOG(void)
 				/* Allow read-only connections if we're consistent now */
 				CheckRecoveryConsistency();
 
+				/*
+				 * Once consistent, start parallel redo workers if configured.
+				 * They run as background workers, which the postmaster only
+				 * launches during archive recovery.
+				 */
+				if (reachedConsistency && bgwriterLaunched)
+					ParallelRedoStartWorkers();
+
 				/* Is this a timeline switch? */
 				if (switchedTLI)
 				{
@@ -7409,6 +7591,9 @@ StartupXLOG(void)
 			 * end of main redo apply loop
 			 */
 
+			/* Wait for parallel redo workers to finish and exit */
+			ParallelRedoShutdownWorkers();
+
 			if (reachedStopPoint)
 			{
 				if (!reachedConsistency)
@@ -8409,7 +8594,7 @@ GetLastImportantRecPtr(void)
 	XLogRecPtr	res = InvalidXLogRecPtr;
 	int			i;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < num_xloginsert_locks; i++)
 	{
 		XLogRecPtr	last_important;
 
@@ -10185,9 +10370,16 @@ get_sync_bit(int method)
 {
 	int			o_direct_flag = 0;
 
+	/*
+	 * With io_direct = wal, always bypass the kernel cache, whatever the
+	 * sync method.  walreceiver is still excluded, for the reasons below.
+	 */
+	if ((io_direct_flags & IO_DIRECT_WAL) && !AmWalReceiverProcess())
+		o_direct_flag = PG_O_DIRECT;
+
 	/* If fsync is disabled, never open in sync mode */
 	if (!enableFsync)
-		return 0;
+		return o_direct_flag;
 
 	/*
 	 * Optimize writes by bypassing kernel cache with O_DIRECT when using
@@ -10217,7 +10409,7 @@ get_sync_bit(int method)
 		case SYNC_METHOD_FSYNC:
 		case SYNC_METHOD_FSYNC_WRITETHROUGH:
 		case SYNC_METHOD_FDATASYNC:
-			return 0;
+			return (io_direct_flags & IO_DIRECT_WAL) ? o_direct_flag : 0;
 #ifdef OPEN_SYNC_FLAG
 		case SYNC_METHOD_OPEN:
 			return OPEN_SYNC_FLAG | o_direct_flag;
@@ -11327,6 +11519,21 @@ GetXLogReplayRecPtr(TimeLineID *replayTLI)
 	return recptr;
 }
 
+/*
+ * Advance the latest redo apply position.
+ *
+ * Parallel redo workers call this once every record up to 'recptr' has been
+ * replayed.  Workers report independently, so never move backwards.
+ */
+void
+XLogAdvanceReplayRecPtr(XLogRecPtr recptr)
+{
+	SpinLockAcquire(&XLogCtl->info_lck);
+	if (XLogCtl->lastReplayedEndRecPtr < recptr)
+		XLogCtl->lastReplayedEndRecPtr = recptr;
+	SpinLockRelease(&XLogCtl->info_lck);
+}
+
 /*
  * Get latest WAL insert pointer
  */
@@ -24,6 +24,7 @@
 #include "access/xlog_internal.h"
 #include "access/xloginsert.h"
 #include "catalog/pg_control.h"
+#include "common/pg_lz4.h"
 #include "common/pg_lzcompress.h"
 #include "miscadmin.h"
 #include "replication/origin.h"
@@ -32,8 +33,21 @@
 #include "utils/memutils.h"
 #include "pg_trace.h"
 
-/* Buffer size required to store a compressed version of backup block image */
-#define PGLZ_MAX_BLCKSZ PGLZ_MAX_OUTPUT(BLCKSZ)
+/*
+ * Buffer size required to store a compressed version of backup block image,
+ * with any of the compression methods.
+ */
+#define COMPRESS_MAX_BLCKSZ \
+	Max(PGLZ_MAX_OUTPUT(BLCKSZ), PG_LZ4_MAX_OUTPUT(BLCKSZ))
+
+/*
+ * Range of data sizes for which we try to compress the data of a whole
+ * record, when it has no full-page images.  Below the lower bound there's
+ * too little to gain; the upper bound sizes the preallocated work buffers,
+ * since the compression happens inside a critical section.
+ */
+#define XLOG_COMPRESS_DATA_MIN		256
+#define XLOG_COMPRESS_DATA_MAX		(2 * BLCKSZ)
 
 /*
  * For each block reference registered with XLogRegisterBuffer, we fill in
@@ -57,7 +71,7 @@ typedef struct
 								 * backup block data in XLogRecordAssemble() */
 
 	/* buffer to store a compressed version of backup block image */
-	char		compressed_page[PGLZ_MAX_BLCKSZ];
+	char		compressed_page[COMPRESS_MAX_BLCKSZ];
 } registered_buffer;
 
 static registered_buffer *registered_buffers;
@@ -92,7 +106,22 @@ static char *hdr_scratch = NULL;
 #define HEADER_SCRATCH_SIZE \
 	(SizeOfXLogRecord + \
 	 MaxSizeOfXLogRecordBlockHeader * (XLR_MAX_BLOCK_ID + 1) + \
-	 SizeOfXLogRecordDataHeaderLong + SizeOfXlogOrigin)
+	 SizeOfXLogRecordDataHeaderLong + SizeOfXlogOrigin + \
+	 SizeOfXLogRecordCompressedHeader)
+
+/*
+ * Work areas for compressing the data of a whole record: 'data_scratch'
+ * holds the data flattened into one piece, and 'compressed_data' the
+ * compressed result, which 'compressed_rdt' points to.  Both are allocated
+ * at initialization, like hdr_scratch.
+ */
+static XLogRecData compressed_rdt;
+static char *data_scratch = NULL;
+static char *compressed_data = NULL;
+
+#define COMPRESSED_DATA_SIZE \
+	Max(PGLZ_MAX_OUTPUT(XLOG_COMPRESS_DATA_MAX), \
+		PG_LZ4_MAX_OUTPUT(XLOG_COMPRESS_DATA_MAX))
 
 /*
  * An array of XLogRecData structs, to hold registered data.
@@ -111,6 +140,8 @@ static XLogRecData *XLogRecordAssemble(RmgrId rmid, uint8 info,
 				   XLogRecPtr *fpw_lsn);
 static bool XLogCompressBackupBlock(char *page, uint16 hole_offset,
 						uint16 hole_length, char *dest, uint16 *dlen);
+static bool XLogCompressRecordData(XLogRecData *rdata, uint32 len,
+					   uint32 *dlen);
 
 /*
  * Begin constructing a WAL record. This must be called before the
@@ -492,6 +523,7 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	XLogRecData *rdt_datas_last;
 	XLogRecord *rechdr;
 	char	   *scratch = hdr_scratch;
+	bool		has_image = false;
 
 	/*
 	 * Note: this function can be called multiple times for the same record.
@@ -620,7 +652,7 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 			/*
 			 * Try to compress a block image if wal_compression is enabled
 			 */
-			if (wal_compression)
+			if (wal_compression != WAL_COMPRESSION_NONE)
 			{
 				is_compressed =
 					XLogCompressBackupBlock(page, bimg.hole_offset,
@@ -655,7 +687,10 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 			if (is_compressed)
 			{
 				bimg.length = compressed_len;
-				bimg.bimg_info |= BKPIMAGE_IS_COMPRESSED;
+				if (wal_compression == WAL_COMPRESSION_LZ4)
+					bimg.bimg_info |= BKPIMAGE_COMPRESS_LZ4;
+				else
+					bimg.bimg_info |= BKPIMAGE_COMPRESS_PGLZ;
 
 				rdt_datas_last->data = regbuf->compressed_page;
 				rdt_datas_last->len = compressed_len;
@@ -686,6 +721,7 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 			}
 
 			total_len += bimg.length;
+			has_image = true;
 		}
 
 		if (needs_data)
@@ -763,6 +799,35 @@ XLogRecordAssemble(RmgrId rmid, uint8 info,
 	}
 	rdt_datas_last->next = NULL;
 
+	/*
+	 * If wal_compression is enabled, try to compress the data of the record
+	 * as a whole.  Records with full-page images are left alone: the images
+	 * were compressed on their own above, and make up most of the record.
+	 * If it pays off, the data chain is replaced by the compressed copy, and
+	 * a header saying how it was compressed is appended to the others.
+	 */
+	if (wal_compression != WAL_COMPRESSION_NONE && !has_image &&
+		total_len >= XLOG_COMPRESS_DATA_MIN &&
+		total_len <= XLOG_COMPRESS_DATA_MAX)
+	{
+		uint32		compressed_len;
+
+		if (XLogCompressRecordData(hdr_rdt.next, total_len, &compressed_len))
+		{
+			*(scratch++) = (char) XLR_BLOCK_ID_COMPRESSED;
+			*(scratch++) = (char) ((wal_compression == WAL_COMPRESSION_LZ4) ?
+								   XLR_COMPRESS_LZ4 : XLR_COMPRESS_PGLZ);
+
+			compressed_rdt.data = compressed_data;
+			compressed_rdt.len = compressed_len;
+			compressed_rdt.next = NULL;
+			hdr_rdt.next = &compressed_rdt;
+
+			total_len = compressed_len;
+			info |= XLR_COMPRESSED_DATA;
+		}
+	}
+
 	hdr_rdt.len = (scratch - hdr_scratch);
 	total_len += hdr_rdt.len;
 
@@ -830,11 +895,14 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
 		source = page;
 
 	/*
-	 * We recheck the actual size even if pglz_compress() reports success and
+	 * We recheck the actual size even if the compressor reports success and
 	 * see if the number of bytes saved by compression is larger than the
 	 * length of extra data needed for the compressed version of block image.
 	 */
-	len = pglz_compress(source, orig_len, dest, PGLZ_strategy_default);
+	if (wal_compression == WAL_COMPRESSION_LZ4)
+		len = pg_lz4_compress(source, orig_len, dest);
+	else
+		len = pglz_compress(source, orig_len, dest, PGLZ_strategy_default);
 	if (len >= 0 &&
 		len + extra_bytes < orig_len)
 	{
@@ -844,6 +912,43 @@ XLogCompressBackupBlock(char *page, uint16 hole_offset, uint16 hole_length,
 	return false;
 }
 
+/*
+ * Create a compressed version of the data in an rdata chain of 'len' bytes,
+ * in 'compressed_data', using the method selected by wal_compression.
+ *
+ * Returns false if compression doesn't save more than the extra header it
+ * requires.  Otherwise, returns true and sets 'dlen' to the compressed length.
+ */
+static bool
+XLogCompressRecordData(XLogRecData *rdata, uint32 len, uint32 *dlen)
+{
+	char	   *ptr = data_scratch;
+	int32		clen;
+
+	Assert(len <= XLOG_COMPRESS_DATA_MAX);
+
+	/* the compressors want their input in one piece */
+	for (; rdata != NULL; rdata = rdata->next)
+	{
+		memcpy(ptr, rdata->data, rdata->len);
+		ptr += rdata->len;
+	}
+	Assert(ptr - data_scratch == len);
+
+	if (wal_compression == WAL_COMPRESSION_LZ4)
+		clen = pg_lz4_compress(data_scratch, len, compressed_data);
+	else
+		clen = pglz_compress(data_scratch, len, compressed_data,
+							 PGLZ_strategy_default);
+	if (clen >= 0 &&
+		clen + SizeOfXLogRecordCompressedHeader < len)
+	{
+		*dlen = (uint32) clen;	/* successful compression */
+		return true;
+	}
+	return false;
+}
+
 /*
  * Determine whether the buffer referenced has to be backed up.
  *
@@ -1055,4 +1160,15 @@ InitXLogInsert(void)
 	if (hdr_scratch == NULL)
 		hdr_scratch = MemoryContextAllocZero(xloginsert_cxt,
 											 HEADER_SCRATCH_SIZE);
+
+	/*
+	 * And the work areas for compressing record data.  wal_compression can
+	 * be enabled at any time, so allocate them regardless.
+	 */
+	if (data_scratch == NULL)
+		data_scratch = MemoryContextAlloc(xloginsert_cxt,
+										  XLOG_COMPRESS_DATA_MAX);
+	if (compressed_data == NULL)
+		compressed_data = MemoryContextAlloc(xloginsert_cxt,
+											 COMPRESSED_DATA_SIZE);
 }
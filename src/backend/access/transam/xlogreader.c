@@ -22,6 +22,7 @@
 #include "access/xlog_internal.h"
 #include "access/xlogreader.h"
 #include "catalog/pg_control.h"
+#include "common/pg_lz4.h"
 #include "common/pg_lzcompress.h"
 #include "replication/origin.h"
 
@@ -137,6 +138,8 @@ XLogReaderFree(XLogReaderState *state)
 	}
 	if (state->main_data)
 		pfree(state->main_data);
+	if (state->decompressed_data)
+		pfree(state->decompressed_data);
 
 	pfree(state->errormsg_buf);
 	if (state->readRecordBuf)
@@ -1058,6 +1061,8 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 	uint32		datatotal;
 	RelFileNode *rnode = NULL;
 	uint8		block_id;
+	bool		compressed;
+	uint8		compress_method = 0;
 
 	ResetDecoder(state);
 
@@ -1068,9 +1073,14 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 	ptr += SizeOfXLogRecord;
 	remaining = record->xl_tot_len - SizeOfXLogRecord;
 
-	/* Decode the headers */
+	/*
+	 * Decode the headers.  If the data is compressed, the lengths in the
+	 * headers don't add up to what's left of the record, so we instead stop
+	 * at the compressed data header, which comes last.
+	 */
+	compressed = (record->xl_info & XLR_COMPRESSED_DATA) != 0;
 	datatotal = 0;
-	while (remaining > datatotal)
+	while (compressed || remaining > datatotal)
 	{
 		COPY_HEADER_FIELD(&block_id, sizeof(uint8));
 
@@ -1083,7 +1093,8 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 
 			state->main_data_len = main_data_len;
 			datatotal += main_data_len;
-			break;				/* by convention, the main data fragment is
+			if (!compressed)
+				break;			/* by convention, the main data fragment is
 								 * always last */
 		}
 		else if (block_id == XLR_BLOCK_ID_DATA_LONG)
@@ -1094,13 +1105,20 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 			COPY_HEADER_FIELD(&main_data_len, sizeof(uint32));
 			state->main_data_len = main_data_len;
 			datatotal += main_data_len;
-			break;				/* by convention, the main data fragment is
+			if (!compressed)
+				break;			/* by convention, the main data fragment is
 								 * always last */
 		}
 		else if (block_id == XLR_BLOCK_ID_ORIGIN)
 		{
 			COPY_HEADER_FIELD(&state->record_origin, sizeof(RepOriginId));
 		}
+		else if (block_id == XLR_BLOCK_ID_COMPRESSED && compressed)
+		{
+			/* XLogRecordCompressedHeader */
+			COPY_HEADER_FIELD(&compress_method, sizeof(uint8));
+			break;				/* the compressed data follows */
+		}
 		else if (block_id <= XLR_MAX_BLOCK_ID)
 		{
 			/* XLogRecordBlockHeader */
@@ -1155,7 +1173,7 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 
 				blk->apply_image = ((blk->bimg_info & BKPIMAGE_APPLY) != 0);
 
-				if (blk->bimg_info & BKPIMAGE_IS_COMPRESSED)
+				if (BKPIMAGE_COMPRESSED(blk->bimg_info))
 				{
 					if (blk->bimg_info & BKPIMAGE_HAS_HOLE)
 						COPY_HEADER_FIELD(&blk->hole_length, sizeof(uint16));
@@ -1200,14 +1218,14 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 				}
 
 				/*
-				 * cross-check that bimg_len < BLCKSZ if the IS_COMPRESSED
-				 * flag is set.
+				 * cross-check that bimg_len < BLCKSZ if a compression flag is
+				 * set.
 				 */
-				if ((blk->bimg_info & BKPIMAGE_IS_COMPRESSED) &&
+				if (BKPIMAGE_COMPRESSED(blk->bimg_info) &&
 					blk->bimg_len == BLCKSZ)
 				{
 					report_invalid_record(state,
-										  "BKPIMAGE_IS_COMPRESSED set, but block image length %u at %X/%X",
+										  "BKPIMAGE_COMPRESSED set, but block image length %u at %X/%X",
 										  (unsigned int) blk->bimg_len,
 										  (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
 					goto err;
@@ -1215,14 +1233,14 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 
 				/*
 				 * cross-check that bimg_len = BLCKSZ if neither HAS_HOLE nor
-				 * IS_COMPRESSED flag is set.
+				 * a compression flag is set.
 				 */
 				if (!(blk->bimg_info & BKPIMAGE_HAS_HOLE) &&
-					!(blk->bimg_info & BKPIMAGE_IS_COMPRESSED) &&
+					!BKPIMAGE_COMPRESSED(blk->bimg_info) &&
 					blk->bimg_len != BLCKSZ)
 				{
 					report_invalid_record(state,
-										  "neither BKPIMAGE_HAS_HOLE nor BKPIMAGE_IS_COMPRESSED set, but block image length is %u at %X/%X",
+										  "neither BKPIMAGE_HAS_HOLE nor BKPIMAGE_COMPRESSED set, but block image length is %u at %X/%X",
 										  (unsigned int) blk->data_len,
 										  (uint32) (state->ReadRecPtr >> 32), (uint32) state->ReadRecPtr);
 					goto err;
@@ -1258,6 +1276,50 @@ DecodeXLogRecord(XLogReaderState *state, XLogRecord *record, char **errormsg)
 		}
 	}
 
+	/*
+	 * If the data is compressed, decompress it into a separate buffer, and
+	 * continue from there as if it had been stored uncompressed.
+	 */
+	if (compressed)
+	{
+		int32		decomp_len;
+
+		if (!state->decompressed_data ||
+			datatotal > state->decompressed_data_bufsz)
+		{
+			if (state->decompressed_data)
+				pfree(state->decompressed_data);
+
+			/* as with the other buffers, don't start out too small */
+			state->decompressed_data_bufsz = MAXALIGN(Max(datatotal, BLCKSZ));
+			state->decompressed_data = palloc(state->decompressed_data_bufsz);
+		}
+
+		if (compress_method == XLR_COMPRESS_LZ4)
+			decomp_len = pg_lz4_decompress(ptr, remaining,
+										   state->decompressed_data,
+										   datatotal);
+		else if (compress_method == XLR_COMPRESS_PGLZ)
+			decomp_len = pglz_decompress(ptr, remaining,
+										 state->decompressed_data,
+										 datatotal);
+		else
+			decomp_len = -1;
+
+		if (decomp_len < 0 || (uint32) decomp_len != datatotal)
+		{
+			report_invalid_record(state,
+								  "invalid compressed data with method %u at %X/%X",
+								  (unsigned int) compress_method,
+								  (uint32) (state->ReadRecPtr >> 32),
+								  (uint32) state->ReadRecPtr);
+			goto err;
+		}
+
+		ptr = state->decompressed_data;
+		remaining = datatotal;
+	}
+
 	if (remaining != datatotal)
 		goto shortdata_err;
 
@@ -1422,11 +1484,18 @@ RestoreBlockImage(XLogReaderState *record, uint8 block_id, char *page)
 	bkpb = &record->blocks[block_id];
 	ptr = bkpb->bkp_image;
 
-	if (bkpb->bimg_info & BKPIMAGE_IS_COMPRESSED)
+	if (BKPIMAGE_COMPRESSED(bkpb->bimg_info))
 	{
+		int32		decomp_len;
+
 		/* If a backup block image is compressed, decompress it */
-		if (pglz_decompress(ptr, bkpb->bimg_len, tmp,
-							BLCKSZ - bkpb->hole_length) < 0)
+		if (bkpb->bimg_info & BKPIMAGE_COMPRESS_LZ4)
+			decomp_len = pg_lz4_decompress(ptr, bkpb->bimg_len, tmp,
+										   BLCKSZ - bkpb->hole_length);
+		else
+			decomp_len = pglz_decompress(ptr, bkpb->bimg_len, tmp,
+										 BLCKSZ - bkpb->hole_length);
+		if (decomp_len < 0)
 		{
 			report_invalid_record(record, "invalid compressed image at %X/%X, block %d",
 								  (uint32) (record->ReadRecPtr >> 32),
@@ -160,7 +160,7 @@ my $PG_CATALOG_NAMESPACE =
 # Build lookup tables for OID macro substitutions and for pg_attribute
 # copies of pg_type values.
 
-# index access method OID lookup
+# access method OID lookup
 my %amoids;
 foreach my $row (@{ $catalog_data{pg_am} })
 {
@@ -506,6 +506,12 @@ CREATE VIEW pg_config AS
 REVOKE ALL on pg_config FROM PUBLIC;
 REVOKE EXECUTE ON FUNCTION pg_config() FROM PUBLIC;
 
+CREATE VIEW pg_shmem_numa AS
+    SELECT * FROM pg_get_shmem_numa();
+
+REVOKE ALL on pg_shmem_numa FROM PUBLIC;
+REVOKE EXECUTE ON FUNCTION pg_get_shmem_numa() FROM PUBLIC;
+
 -- Statistics views
 
 CREATE VIEW pg_stat_all_tables AS
@@ -758,6 +764,17 @@ CREATE VIEW pg_stat_wal_receiver AS
     FROM pg_stat_get_wal_receiver() s
     WHERE s.pid IS NOT NULL;
 
+CREATE VIEW pg_stat_redo_workers AS
+    SELECT
+            s.worker_id,
+            s.pid,
+            s.dispatched_records,
+            s.replayed_records,
+            s.dispatched_lsn,
+            s.replayed_lsn,
+            s.replay_lag_bytes
+    FROM pg_stat_get_redo_workers() s;
+
 CREATE VIEW pg_stat_subscription AS
     SELECT
             su.oid AS subid,
@@ -871,6 +888,17 @@ CREATE VIEW pg_stat_archiver AS
         s.stats_reset
     FROM pg_stat_get_archiver() s;
 
+CREATE VIEW pg_stat_wal_flush AS
+    SELECT
+        s.flushes,
+        s.flush_time,
+        s.flush_waits,
+        s.flush_wait_time,
+        s.flush_wait_p50,
+        s.flush_wait_p99,
+        s.commit_delay
+    FROM pg_stat_get_wal_flush() s;
+
 CREATE VIEW pg_stat_bgwriter AS
     SELECT
         pg_stat_get_bgwriter_timed_checkpoints() AS checkpoints_timed,
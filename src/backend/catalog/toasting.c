@@ -266,6 +266,7 @@ create_toast_table(Relation rel, Oid toastOid, Oid toastIndexOid,
 										   toast_typid,
 										   InvalidOid,
 										   rel->rd_rel->relowner,
+										   HEAP_TABLE_AM_OID,
 										   tupdesc,
 										   NIL,
 										   RELKIND_TOASTVALUE,
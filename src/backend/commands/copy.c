@@ -20,11 +20,14 @@
 
 #include "access/heapam.h"
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "access/sysattr.h"
+#include "access/tableam.h"
 #include "access/xact.h"
 #include "access/xlog.h"
 #include "catalog/dependency.h"
 #include "catalog/pg_authid.h"
+#include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "commands/copy.h"
 #include "commands/defrem.h"
@@ -40,11 +43,18 @@
 #include "optimizer/planner.h"
 #include "nodes/makefuncs.h"
 #include "parser/parse_relation.h"
+#include "pgstat.h"
 #include "port/pg_bswap.h"
+#include "port/simd.h"
+#include "portability/instr_time.h"
+#include "postmaster/bgworker_internals.h"
 #include "rewrite/rewriteHandler.h"
+#include "storage/condition_variable.h"
 #include "storage/fd.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
+#include "utils/dsa.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/partcache.h"
@@ -123,10 +133,13 @@ typedef struct CopyStateData
 	Relation	rel;			/* relation to copy to or from */
 	QueryDesc  *queryDesc;		/* executable query to copy from */
 	List	   *attnumlist;		/* integer list of attnums to copy */
+	List	   *attnamelist;	/* column names as given, for parallel COPY */
+	List	   *options;		/* options as given, for parallel COPY */
 	char	   *filename;		/* filename, or NULL for STDIN/STDOUT */
 	bool		is_program;		/* is 'filename' a program to popen? */
 	copy_data_source_cb data_source_cb; /* function for reading data */
 	bool		binary;			/* binary format? */
+	bool		columnar;		/* columnar binary format? (implies binary) */
 	bool		oids;			/* include OIDs? */
 	bool		freeze;			/* freeze rows on loading? */
 	bool		csv_mode;		/* Comma Separated Value format? */
@@ -147,6 +160,7 @@ typedef struct CopyStateData
 	bool		convert_selectively;	/* do selective binary conversion? */
 	List	   *convert_select; /* list of column names (can be NIL) */
 	bool	   *convert_select_flags;	/* per-column CSV/TEXT CS flags */
+	int			nworkers;		/* # of parallel workers requested */
 
 	/* these are just for error messages, see CopyFromErrorCallback */
 	const char *cur_relname;	/* table name for error messages */
@@ -165,6 +179,16 @@ typedef struct CopyStateData
 	FmgrInfo   *out_functions;	/* lookup info for output functions */
 	MemoryContext rowcontext;	/* per-row evaluation context */
 
+	/*
+	 * In columnar format, rows are collected into blocks and sent one column
+	 * at a time.  These hold the current block's null bitmaps and value data
+	 * for each column in attnumlist.
+	 */
+	StringInfoData *col_nulls;
+	StringInfoData *col_values;
+	int			block_rows;		/* # of rows in current block */
+	int			block_size;		/* total bytes of value data in block */
+
 	/*
 	 * Working state for COPY FROM
 	 */
@@ -181,6 +205,14 @@ typedef struct CopyStateData
 
 	TransitionCaptureState *transition_capture;
 
+	/*
+	 * In parallel COPY FROM, lines are taken from a chunk the leader has
+	 * already split off the input, rather than from the data source.
+	 */
+	struct ParallelCopyChunk *chunk;	/* chunk being loaded, or NULL */
+	int			chunk_line;		/* index of next line in chunk */
+	int			chunk_pos;		/* offset of next line in chunk data */
+
 	/*
 	 * These variables are used to reduce overhead in textual COPY FROM.
 	 *
@@ -228,6 +260,75 @@ typedef struct
 	uint64		processed;		/* # of tuples processed */
 } DR_copy;
 
+/*
+ * Parallel COPY FROM.
+ *
+ * The leader reads the input and splits it into chunks of whole lines,
+ * using the same CopyReadLine() logic as a serial COPY so that quoted
+ * newlines and encoding conversion are dealt with before a line is handed
+ * out.  Chunks are allocated in a DSA area and passed to the workers through
+ * a small ring of dsa_pointers in shared memory.  The workers, and the
+ * leader whenever the ring is full, run input functions, check constraints
+ * and insert whole chunks with heap_multi_insert().
+ */
+#define PARALLEL_KEY_COPY_SHARED		UINT64CONST(0xC000000000000001)
+#define PARALLEL_KEY_COPY_ATTNAMES		UINT64CONST(0xC000000000000002)
+#define PARALLEL_KEY_COPY_OPTIONS		UINT64CONST(0xC000000000000003)
+#define PARALLEL_KEY_QUERY_TEXT			UINT64CONST(0xC000000000000004)
+#define PARALLEL_KEY_COPY_DSA			UINT64CONST(0xC000000000000005)
+
+/* Target number of input bytes per chunk */
+#define PARALLEL_COPY_CHUNK_SIZE		65536
+
+/* Maximum number of chunks waiting to be loaded */
+#define PARALLEL_COPY_QUEUE_SIZE		64
+
+/*
+ * A chunk of input lines, already converted to the server encoding.  Each
+ * line is stored as a uint32 length word followed by the line's bytes,
+ * without the end-of-line marker.
+ */
+typedef struct ParallelCopyChunk
+{
+	uint64		first_lineno;	/* input line number of first line */
+	int			nlines;			/* number of lines in chunk */
+	char		data[FLEXIBLE_ARRAY_MEMBER];
+} ParallelCopyChunk;
+
+/* Per-worker results, reported back to the leader */
+typedef struct ParallelCopyWorkerStats
+{
+	uint64		processed;		/* # of tuples inserted */
+	double		elapsed;		/* seconds spent loading */
+} ParallelCopyWorkerStats;
+
+typedef struct ParallelCopyShared
+{
+	/*
+	 * These fields are not modified during the load.  They primarily exist
+	 * for the benefit of worker processes that need to set up their own
+	 * state to match the leader's.
+	 */
+	Oid			relid;
+	CommandId	mycid;
+	int			hi_options;
+	int			queue_size;		/* usable entries in queue[] */
+
+	/*
+	 * mutex protects all fields below.  Workers sleep on chunk_added_cv
+	 * while the queue is empty and input_done has not been set.
+	 */
+	slock_t		mutex;
+	ConditionVariable chunk_added_cv;
+	int			queue_head;		/* index of oldest queued chunk */
+	int			queue_count;	/* # of queued chunks */
+	bool		input_done;		/* leader has queued its last chunk */
+	dsa_pointer queue[PARALLEL_COPY_QUEUE_SIZE];
+
+	uint64		processed;		/* # of tuples inserted by workers */
+	ParallelCopyWorkerStats stats[FLEXIBLE_ARRAY_MEMBER];
+} ParallelCopyShared;
+
 
 /*
  * These macros centralize code used to process line_buf and raw_buf buffers.
@@ -295,6 +396,14 @@ if (1) \
 } else ((void) 0)
 
 static const char BinarySignature[11] = "PGCOPY\n\377\r\n\0";
+static const char ColumnarSignature[11] = "PGCOLS\n\377\r\n\0";
+
+/*
+ * A columnar COPY TO block is sent once it holds this many rows, or this
+ * many bytes of value data, whichever comes first.
+ */
+#define COLUMNAR_BLOCK_ROWS		8192
+#define COLUMNAR_BLOCK_SIZE		(1024 * 1024)
 
 
 /* non-export function prototypes */
@@ -309,8 +418,25 @@ static CopyState BeginCopyTo(ParseState *pstate, Relation rel, RawStmt *query,
 static void EndCopyTo(CopyState cstate);
 static uint64 DoCopyTo(CopyState cstate);
 static uint64 CopyTo(CopyState cstate);
+static void CopyOneRowToColumnar(CopyState cstate, Datum *values,
+					 bool *nulls);
+static void CopySendColumnarBlock(CopyState cstate);
 static void CopyOneRowTo(CopyState cstate, Oid tupleOid,
 			 Datum *values, bool *nulls);
+static bool CopyFromParallelSafe(CopyState cstate,
+					 ResultRelInfo *resultRelInfo);
+static uint64 CopyFromParallel(CopyState cstate, EState *estate,
+				 ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
+				 BulkInsertState bistate, CommandId mycid, int hi_options);
+static uint64 CopyFromChunk(CopyState cstate, ParallelCopyChunk *chunk,
+			  EState *estate, ResultRelInfo *resultRelInfo,
+			  TupleTableSlot *myslot, BulkInsertState bistate,
+			  CommandId mycid, int hi_options);
+static bool ParallelCopyQueueChunk(ParallelCopyShared *shared,
+					   dsa_pointer chunk);
+static dsa_pointer ParallelCopyDequeueChunk(ParallelCopyShared *shared,
+						 bool wait);
+static int	ParallelCopyNoData(void *outbuf, int minread, int maxread);
 static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					CommandId mycid, int hi_options,
 					ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
@@ -318,6 +444,7 @@ static void CopyFromInsertBatch(CopyState cstate, EState *estate,
 					int nBufferedTuples, HeapTuple *bufferedTuples,
 					uint64 firstBufferedLineNo);
 static bool CopyReadLine(CopyState cstate);
+static bool CopyReadChunkLine(CopyState cstate);
 static bool CopyReadLineText(CopyState cstate);
 static int	CopyReadAttributesText(CopyState cstate);
 static int	CopyReadAttributesCSV(CopyState cstate);
@@ -1042,6 +1169,7 @@ ProcessCopyOptions(ParseState *pstate,
 				   List *options)
 {
 	bool		format_specified = false;
+	bool		parallel_specified = false;
 	ListCell   *option;
 
 	/* Support external use for option sanity checking */
@@ -1071,6 +1199,8 @@ ProcessCopyOptions(ParseState *pstate,
 				cstate->csv_mode = true;
 			else if (strcmp(fmt, "binary") == 0)
 				cstate->binary = true;
+			else if (strcmp(fmt, "columnar") == 0)
+				cstate->binary = cstate->columnar = true;
 			else
 				ereport(ERROR,
 						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
@@ -1211,6 +1341,23 @@ ProcessCopyOptions(ParseState *pstate,
 								defel->defname),
 						 parser_errposition(pstate, defel->location)));
 		}
+		else if (strcmp(defel->defname, "parallel") == 0)
+		{
+			if (parallel_specified)
+				ereport(ERROR,
+						(errcode(ERRCODE_SYNTAX_ERROR),
+						 errmsg("conflicting or redundant options"),
+						 parser_errposition(pstate, defel->location)));
+			parallel_specified = true;
+			cstate->nworkers = defGetInt32(defel);
+			if (cstate->nworkers < 0 ||
+				cstate->nworkers > MAX_PARALLEL_WORKER_LIMIT)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("argument to option \"%s\" must be between %d and %d",
+								defel->defname, 0, MAX_PARALLEL_WORKER_LIMIT),
+						 parser_errposition(pstate, defel->location)));
+		}
 		else if (strcmp(defel->defname, "encoding") == 0)
 		{
 			if (cstate->file_encoding >= 0)
@@ -1364,6 +1511,22 @@ ProcessCopyOptions(ParseState *pstate,
 				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
 				 errmsg("COPY force null only available using COPY FROM")));
 
+	/* Check columnar */
+	if (cstate->columnar && is_from)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY columnar format only available using COPY TO")));
+	if (cstate->columnar && cstate->oids)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY OIDS not supported in columnar format")));
+
+	/* Check parallel */
+	if (cstate->nworkers > 0 && !is_from)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("COPY parallel only available using COPY FROM")));
+
 	/* Don't allow the delimiter to appear in the null string. */
 	if (strchr(cstate->null_print, cstate->delim[0]) != NULL)
 		ereport(ERROR,
@@ -1977,6 +2140,10 @@ CopyTo(CopyState cstate)
 		bool		isvarlena;
 		Form_pg_attribute attr = TupleDescAttr(tupDesc, attnum - 1);
 
+		/* Columnar format sends values as stored, without output functions */
+		if (cstate->columnar)
+			continue;
+
 		if (cstate->binary)
 			getTypeBinaryOutputInfo(attr->atttypid,
 									&out_func_oid,
@@ -1998,7 +2165,47 @@ CopyTo(CopyState cstate)
 											   "COPY TO",
 											   ALLOCSET_DEFAULT_SIZES);
 
-	if (cstate->binary)
+	if (cstate->columnar)
+	{
+		/* Generate header for a columnar copy */
+		int32		tmp;
+		int			ncolumns = list_length(cstate->attnumlist);
+		int			i;
+
+		/* Signature */
+		CopySendData(cstate, ColumnarSignature, 11);
+		/* Flags field: bit 0 says fixed-width values are little-endian */
+		tmp = 0;
+#ifndef WORDS_BIGENDIAN
+		tmp |= 1;
+#endif
+		CopySendInt32(cstate, tmp);
+		/* No header extension */
+		tmp = 0;
+		CopySendInt32(cstate, tmp);
+
+		/* Column descriptions */
+		CopySendInt16(cstate, ncolumns);
+		foreach(cur, cstate->attnumlist)
+		{
+			int			attnum = lfirst_int(cur);
+			Form_pg_attribute attr = TupleDescAttr(tupDesc, attnum - 1);
+
+			CopySendInt32(cstate, attr->atttypid);
+			CopySendInt16(cstate, attr->attlen);
+		}
+
+		cstate->col_nulls = palloc(ncolumns * sizeof(StringInfoData));
+		cstate->col_values = palloc(ncolumns * sizeof(StringInfoData));
+		for (i = 0; i < ncolumns; i++)
+		{
+			initStringInfo(&cstate->col_nulls[i]);
+			initStringInfo(&cstate->col_values[i]);
+		}
+		cstate->block_rows = 0;
+		cstate->block_size = 0;
+	}
+	else if (cstate->binary)
 	{
 		/* Generate header for a binary copy */
 		int32		tmp;
@@ -2059,10 +2266,10 @@ CopyTo(CopyState cstate)
 		values = (Datum *) palloc(num_phys_attrs * sizeof(Datum));
 		nulls = (bool *) palloc(num_phys_attrs * sizeof(bool));
 
-		scandesc = heap_beginscan(cstate->rel, GetActiveSnapshot(), 0, NULL);
+		scandesc = table_beginscan(cstate->rel, GetActiveSnapshot(), 0, NULL);
 
 		processed = 0;
-		while ((tuple = heap_getnext(scandesc, ForwardScanDirection)) != NULL)
+		while ((tuple = table_getnext(scandesc, ForwardScanDirection)) != NULL)
 		{
 			CHECK_FOR_INTERRUPTS();
 
@@ -2074,7 +2281,7 @@ CopyTo(CopyState cstate)
 			processed++;
 		}
 
-		heap_endscan(scandesc);
+		table_endscan(scandesc);
 
 		pfree(values);
 		pfree(nulls);
@@ -2086,7 +2293,15 @@ CopyTo(CopyState cstate)
 		processed = ((DR_copy *) cstate->queryDesc->dest)->processed;
 	}
 
-	if (cstate->binary)
+	if (cstate->columnar)
+	{
+		/* Send the last partial block, then the trailer */
+		if (cstate->block_rows > 0)
+			CopySendColumnarBlock(cstate);
+		CopySendInt32(cstate, -1);
+		CopySendEndOfRow(cstate);
+	}
+	else if (cstate->binary)
 	{
 		/* Generate trailer for a binary copy */
 		CopySendInt16(cstate, -1);
@@ -2111,6 +2326,12 @@ CopyOneRowTo(CopyState cstate, Oid tupleOid, Datum *values, bool *nulls)
 	ListCell   *cur;
 	char	   *string;
 
+	if (cstate->columnar)
+	{
+		CopyOneRowToColumnar(cstate, values, nulls);
+		return;
+	}
+
 	MemoryContextReset(cstate->rowcontext);
 	oldcontext = MemoryContextSwitchTo(cstate->rowcontext);
 
@@ -2191,6 +2412,130 @@ CopyOneRowTo(CopyState cstate, Oid tupleOid, Datum *values, bool *nulls)
 }
 
 
+/*
+ * Add one row to the current block during a columnar CopyTo().
+ *
+ * Fixed-width values are copied in their stored form, and varlenas are sent
+ * as their contents, detoasting only values that are compressed or stored
+ * out of line.  No output or send functions are called.
+ */
+static void
+CopyOneRowToColumnar(CopyState cstate, Datum *values, bool *nulls)
+{
+	TupleDesc	tupDesc;
+	int			rowno = cstate->block_rows;
+	int			colno = 0;
+	MemoryContext oldcontext;
+	ListCell   *cur;
+
+	if (cstate->rel)
+		tupDesc = RelationGetDescr(cstate->rel);
+	else
+		tupDesc = cstate->queryDesc->tupDesc;
+
+	MemoryContextReset(cstate->rowcontext);
+	oldcontext = MemoryContextSwitchTo(cstate->rowcontext);
+
+	foreach(cur, cstate->attnumlist)
+	{
+		int			attnum = lfirst_int(cur);
+		Form_pg_attribute attr = TupleDescAttr(tupDesc, attnum - 1);
+		Datum		value = values[attnum - 1];
+		StringInfo	nullmap = &cstate->col_nulls[colno];
+		StringInfo	data = &cstate->col_values[colno];
+		int			oldlen = data->len;
+
+		colno++;
+
+		/* Null bitmap: bit set means not null, as in heap tuples */
+		if (rowno % BITS_PER_BYTE == 0)
+			appendStringInfoCharMacro(nullmap, 0);
+		if (nulls[attnum - 1])
+			continue;
+		nullmap->data[rowno / BITS_PER_BYTE] |= 1 << (rowno % BITS_PER_BYTE);
+
+		if (attr->attlen > 0)
+		{
+			if (attr->attbyval)
+			{
+				Datum		stored;
+
+				store_att_byval(&stored, value, attr->attlen);
+				appendBinaryStringInfo(data, (char *) &stored, attr->attlen);
+			}
+			else
+				appendBinaryStringInfo(data, DatumGetPointer(value),
+									   attr->attlen);
+		}
+		else
+		{
+			char	   *ptr;
+			uint32		len;
+			uint32		netlen;
+
+			if (attr->attlen == -1)
+			{
+				struct varlena *vl;
+
+				vl = pg_detoast_datum_packed((struct varlena *) DatumGetPointer(value));
+				ptr = VARDATA_ANY(vl);
+				len = VARSIZE_ANY_EXHDR(vl);
+			}
+			else
+			{
+				ptr = DatumGetCString(value);
+				len = strlen(ptr);
+			}
+
+			netlen = pg_hton32(len);
+			appendBinaryStringInfo(data, (char *) &netlen, sizeof(netlen));
+			appendBinaryStringInfo(data, ptr, len);
+		}
+
+		cstate->block_size += data->len - oldlen;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	cstate->block_rows++;
+	if (cstate->block_rows >= COLUMNAR_BLOCK_ROWS ||
+		cstate->block_size >= COLUMNAR_BLOCK_SIZE)
+		CopySendColumnarBlock(cstate);
+}
+
+/*
+ * Send the current block of a columnar CopyTo().
+ *
+ * A block consists of its row count, followed by each column's null bitmap
+ * and value data in turn.  The block goes out as one CopyData message, so
+ * that a slow client holds us up in pq_putmessage() rather than letting
+ * unsent data pile up in memory.
+ */
+static void
+CopySendColumnarBlock(CopyState cstate)
+{
+	int			ncolumns = list_length(cstate->attnumlist);
+	int			i;
+
+	CopySendInt32(cstate, cstate->block_rows);
+	for (i = 0; i < ncolumns; i++)
+	{
+		StringInfo	nullmap = &cstate->col_nulls[i];
+		StringInfo	data = &cstate->col_values[i];
+
+		CopySendData(cstate, nullmap->data, nullmap->len);
+		CopySendInt32(cstate, data->len);
+		CopySendData(cstate, data->data, data->len);
+
+		resetStringInfo(nullmap);
+		resetStringInfo(data);
+	}
+	CopySendEndOfRow(cstate);
+
+	cstate->block_rows = 0;
+	cstate->block_size = 0;
+}
+
 /*
  * error context callback for COPY FROM
  *
@@ -2643,6 +2988,17 @@ CopyFrom(CopyState cstate)
 	errcallback.previous = error_context_stack;
 	error_context_stack = &errcallback;
 
+	/*
+	 * If parallel workers were requested and can do the job, let them load
+	 * the data.  That reads all of the input, so the loop below then only
+	 * finds its end; if no workers could be launched, nothing has been read
+	 * and the loop does all the work.
+	 */
+	if (cstate->nworkers > 0 && insertMethod == CIM_MULTI &&
+		CopyFromParallelSafe(cstate, resultRelInfo))
+		processed = CopyFromParallel(cstate, estate, resultRelInfo, myslot,
+									 bistate, mycid, hi_options);
+
 	for (;;)
 	{
 		TupleTableSlot *slot;
@@ -2969,8 +3325,8 @@ CopyFrom(CopyState cstate)
 						tuple->t_tableOid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
 					}
 					else
-						heap_insert(resultRelInfo->ri_RelationDesc, tuple,
-									mycid, hi_options, bistate);
+						table_insert(resultRelInfo->ri_RelationDesc, tuple,
+									 mycid, hi_options, bistate);
 
 					/* And create index entries for it */
 					if (resultRelInfo->ri_NumIndices > 0)
@@ -3096,16 +3452,16 @@ CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
 	save_cur_lineno = cstate->cur_lineno;
 
 	/*
-	 * heap_multi_insert leaks memory, so switch to short-lived memory context
-	 * before calling it.
+	 * table_multi_insert may leak memory, so switch to short-lived memory
+	 * context before calling it.
 	 */
 	oldcontext = MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
-	heap_multi_insert(resultRelInfo->ri_RelationDesc,
-					  bufferedTuples,
-					  nBufferedTuples,
-					  mycid,
-					  hi_options,
-					  bistate);
+	table_multi_insert(resultRelInfo->ri_RelationDesc,
+					   bufferedTuples,
+					   nBufferedTuples,
+					   mycid,
+					   hi_options,
+					   bistate);
 	MemoryContextSwitchTo(oldcontext);
 
 	/*
@@ -3152,6 +3508,597 @@ CopyFromInsertBatch(CopyState cstate, EState *estate, CommandId mycid,
 	cstate->cur_lineno = save_cur_lineno;
 }
 
+/*
+ * Can the rows of this COPY FROM be loaded by parallel workers?
+ *
+ * The caller has already checked that we're inserting into a plain table
+ * with no BEFORE or INSTEAD OF row triggers and no volatile defaults.
+ * Workers can't queue AFTER triggers for the leader, and everything they
+ * evaluate on a row's behalf must be parallel safe.
+ */
+static bool
+CopyFromParallelSafe(CopyState cstate, ResultRelInfo *resultRelInfo)
+{
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	PlannerInfo *root;
+	ListCell   *cur;
+	int			i;
+
+	if (cstate->binary || IsInParallelMode())
+		return false;
+
+	/* Workers can't access the leader's temporary tables */
+	if (RelationUsesLocalBuffers(rel))
+		return false;
+
+	if (resultRelInfo->ri_TrigDesc != NULL &&
+		(resultRelInfo->ri_TrigDesc->trig_insert_after_row ||
+		 resultRelInfo->ri_TrigDesc->trig_insert_new_table))
+		return false;
+
+	/*
+	 * Input functions are run on every copied column.  Domain input also
+	 * checks the domain's constraints, which we don't look into.
+	 */
+	foreach(cur, cstate->attnumlist)
+	{
+		int			attnum = lfirst_int(cur);
+		Form_pg_attribute att = TupleDescAttr(tupDesc, attnum - 1);
+
+		if (get_typtype(att->atttypid) == TYPTYPE_DOMAIN ||
+			func_parallel(cstate->in_functions[attnum - 1].fn_oid) != PROPARALLEL_SAFE)
+			return false;
+	}
+
+	/* Set up largely-dummy planner state for is_parallel_safe() */
+	root = makeNode(PlannerInfo);
+	root->glob = makeNode(PlannerGlobal);
+
+	for (i = 0; i < cstate->num_defaults; i++)
+	{
+		if (!is_parallel_safe(root, (Node *) cstate->defexprs[i]->expr))
+			return false;
+	}
+
+	if (tupDesc->constr)
+	{
+		for (i = 0; i < tupDesc->constr->num_check; i++)
+		{
+			Node	   *checkexpr = stringToNode(tupDesc->constr->check[i].ccbin);
+
+			if (!is_parallel_safe(root, checkexpr))
+				return false;
+		}
+	}
+
+	if (!is_parallel_safe(root, (Node *) resultRelInfo->ri_PartitionCheck))
+		return false;
+
+	for (i = 0; i < resultRelInfo->ri_NumIndices; i++)
+	{
+		Relation	index = resultRelInfo->ri_IndexRelationDescs[i];
+
+		if (!is_parallel_safe(root, (Node *) RelationGetIndexExpressions(index)) ||
+			!is_parallel_safe(root, (Node *) RelationGetIndexPredicate(index)))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * A subroutine of CopyFrom, to load the input with the help of parallel
+ * workers.  We read the input and split it into chunks of whole lines,
+ * which are queued for the workers.  When the queue is full we load the
+ * oldest queued chunk ourselves, and once the input is exhausted we help
+ * drain whatever is left.
+ *
+ * Returns the number of rows inserted by all participants.  If no workers
+ * could be launched, returns 0 without having read any input, and the
+ * caller loads the data serially.
+ */
+static uint64
+CopyFromParallel(CopyState cstate, EState *estate,
+				 ResultRelInfo *resultRelInfo, TupleTableSlot *myslot,
+				 BulkInsertState bistate, CommandId mycid, int hi_options)
+{
+	ParallelContext *pcxt;
+	ParallelCopyShared *shared;
+	Size		estshared;
+	char	   *attnamestr;
+	char	   *optionstr;
+	char	   *sharedattnames;
+	char	   *sharedoptions;
+	char	   *sharedquery;
+	int			querylen;
+	void	   *area_space;
+	dsa_area   *area;
+	dsa_pointer chunk;
+	StringInfoData chunkbuf;
+	uint64		processed = 0;
+	uint64		leader_processed;
+	instr_time	start;
+	instr_time	elapsed;
+	bool		done = false;
+	int			i;
+
+	/*
+	 * Workers insert with our transaction ID and command ID.  CopyFrom()
+	 * has already marked the command ID used; make sure we have an XID
+	 * before entering parallel mode, where it can't be assigned.
+	 */
+	(void) GetCurrentTransactionId();
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("postgres", "ParallelCopyMain",
+								 cstate->nworkers, false);
+
+	/* Estimate size of the shared state and of everything else we pass */
+	estshared = add_size(offsetof(ParallelCopyShared, stats),
+						 mul_size(sizeof(ParallelCopyWorkerStats),
+								  pcxt->nworkers));
+	attnamestr = nodeToString(cstate->attnamelist);
+	optionstr = nodeToString(cstate->options);
+	querylen = strlen(debug_query_string);
+	shm_toc_estimate_chunk(&pcxt->estimator, estshared);
+	shm_toc_estimate_chunk(&pcxt->estimator, strlen(attnamestr) + 1);
+	shm_toc_estimate_chunk(&pcxt->estimator, strlen(optionstr) + 1);
+	shm_toc_estimate_chunk(&pcxt->estimator, querylen + 1);
+	shm_toc_estimate_chunk(&pcxt->estimator, dsa_minimum_size());
+	shm_toc_estimate_keys(&pcxt->estimator, 5);
+
+	InitializeParallelDSM(pcxt);
+
+	/* Without a DSM segment, there's no way to hand out chunks */
+	if (pcxt->seg == NULL)
+	{
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return 0;
+	}
+
+	shared = (ParallelCopyShared *) shm_toc_allocate(pcxt->toc, estshared);
+	shared->relid = RelationGetRelid(resultRelInfo->ri_RelationDesc);
+	shared->mycid = mycid;
+	shared->hi_options = hi_options;
+	shared->queue_size = Min(PARALLEL_COPY_QUEUE_SIZE, 4 * pcxt->nworkers);
+	SpinLockInit(&shared->mutex);
+	ConditionVariableInit(&shared->chunk_added_cv);
+	shared->queue_head = 0;
+	shared->queue_count = 0;
+	shared->input_done = false;
+	shared->processed = 0;
+	memset(shared->stats, 0, sizeof(ParallelCopyWorkerStats) * pcxt->nworkers);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_SHARED, shared);
+
+	sharedattnames = shm_toc_allocate(pcxt->toc, strlen(attnamestr) + 1);
+	strcpy(sharedattnames, attnamestr);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_ATTNAMES, sharedattnames);
+
+	sharedoptions = shm_toc_allocate(pcxt->toc, strlen(optionstr) + 1);
+	strcpy(sharedoptions, optionstr);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_OPTIONS, sharedoptions);
+
+	/* Store query string for workers */
+	sharedquery = shm_toc_allocate(pcxt->toc, querylen + 1);
+	memcpy(sharedquery, debug_query_string, querylen + 1);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_QUERY_TEXT, sharedquery);
+
+	/* Chunks are allocated in a DSA area created in the segment */
+	area_space = shm_toc_allocate(pcxt->toc, dsa_minimum_size());
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_COPY_DSA, area_space);
+	area = dsa_create_in_place(area_space, dsa_minimum_size(),
+							   LWTRANCHE_PARALLEL_COPY_DSA, pcxt->seg);
+
+	LaunchParallelWorkers(pcxt);
+
+	if (pcxt->nworkers_launched == 0)
+	{
+		dsa_detach(area);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return 0;
+	}
+
+	INSTR_TIME_SET_CURRENT(start);
+
+	/* on input just throw the header line away */
+	if (cstate->header_line)
+	{
+		cstate->cur_lineno++;
+		done = CopyReadLine(cstate);
+	}
+
+	initStringInfo(&chunkbuf);
+	while (!done)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		cstate->cur_lineno++;
+		done = CopyReadLine(cstate);
+
+		/*
+		 * EOF at start of line means there's no line; see
+		 * NextCopyFromRawFields.
+		 */
+		if (!done || cstate->line_buf.len > 0)
+		{
+			uint32		linelen = cstate->line_buf.len;
+
+			if (chunkbuf.len == 0)
+			{
+				ParallelCopyChunk header;
+
+				header.first_lineno = cstate->cur_lineno;
+				header.nlines = 0;
+				appendBinaryStringInfo(&chunkbuf, (char *) &header,
+									   offsetof(ParallelCopyChunk, data));
+			}
+			appendBinaryStringInfo(&chunkbuf, (char *) &linelen,
+								   sizeof(uint32));
+			appendBinaryStringInfo(&chunkbuf, cstate->line_buf.data, linelen);
+			((ParallelCopyChunk *) chunkbuf.data)->nlines++;
+		}
+
+		if (chunkbuf.len >= PARALLEL_COPY_CHUNK_SIZE ||
+			(done && chunkbuf.len > 0))
+		{
+			chunk = dsa_allocate(area, chunkbuf.len);
+			memcpy(dsa_get_address(area, chunk), chunkbuf.data, chunkbuf.len);
+			resetStringInfo(&chunkbuf);
+
+			/* If the queue is full, load its oldest chunk ourselves */
+			while (!ParallelCopyQueueChunk(shared, chunk))
+			{
+				dsa_pointer oldest = ParallelCopyDequeueChunk(shared, false);
+
+				if (DsaPointerIsValid(oldest))
+				{
+					processed += CopyFromChunk(cstate,
+											   dsa_get_address(area, oldest),
+											   estate, resultRelInfo, myslot,
+											   bistate, mycid, hi_options);
+					dsa_free(area, oldest);
+				}
+			}
+		}
+	}
+
+	/* Tell the workers there's no more input, and help finish the queue */
+	SpinLockAcquire(&shared->mutex);
+	shared->input_done = true;
+	SpinLockRelease(&shared->mutex);
+	ConditionVariableBroadcast(&shared->chunk_added_cv);
+
+	while (DsaPointerIsValid(chunk = ParallelCopyDequeueChunk(shared, false)))
+	{
+		processed += CopyFromChunk(cstate, dsa_get_address(area, chunk),
+								   estate, resultRelInfo, myslot, bistate,
+								   mycid, hi_options);
+		dsa_free(area, chunk);
+	}
+
+	WaitForParallelWorkersToFinish(pcxt);
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+
+	leader_processed = processed;
+	processed += shared->processed;
+
+	for (i = 0; i < pcxt->nworkers_launched; i++)
+	{
+		ParallelCopyWorkerStats *stats = &shared->stats[i];
+
+		elog(DEBUG1, "parallel COPY worker %d inserted " UINT64_FORMAT " rows in %.3f s (%.0f rows/s)",
+			 i, stats->processed, stats->elapsed,
+			 stats->elapsed > 0 ? stats->processed / stats->elapsed : 0.0);
+	}
+	elog(DEBUG1, "parallel COPY leader inserted " UINT64_FORMAT " of " UINT64_FORMAT " rows in %.3f s (%.0f rows/s in total)",
+		 leader_processed, processed, INSTR_TIME_GET_DOUBLE(elapsed),
+		 INSTR_TIME_GET_DOUBLE(elapsed) > 0 ?
+		 processed / INSTR_TIME_GET_DOUBLE(elapsed) : 0.0);
+
+	pfree(chunkbuf.data);
+	dsa_detach(area);
+	DestroyParallelContext(pcxt);
+	ExitParallelMode();
+
+	return processed;
+}
+
+/*
+ * Load all the lines of one chunk, in the manner of CopyFrom() with
+ * CIM_MULTI.  The buffered tuples are always flushed before returning, so
+ * that the caller can free the chunk.
+ */
+static uint64
+CopyFromChunk(CopyState cstate, ParallelCopyChunk *chunk,
+			  EState *estate, ResultRelInfo *resultRelInfo,
+			  TupleTableSlot *myslot, BulkInsertState bistate,
+			  CommandId mycid, int hi_options)
+{
+	Relation	rel = resultRelInfo->ri_RelationDesc;
+	TupleDesc	tupDesc = RelationGetDescr(rel);
+	ExprContext *econtext = GetPerTupleExprContext(estate);
+	MemoryContext oldcontext = CurrentMemoryContext;
+	uint64		save_cur_lineno = cstate->cur_lineno;
+	HeapTuple  *bufferedTuples;
+	int			nBufferedTuples = 0;
+	Size		bufferedTuplesSize = 0;
+	uint64		firstBufferedLineNo = 0;
+	uint64		processed = 0;
+	Datum	   *values;
+	bool	   *nulls;
+
+	bufferedTuples = palloc(MAX_BUFFERED_TUPLES * sizeof(HeapTuple));
+	values = (Datum *) palloc(tupDesc->natts * sizeof(Datum));
+	nulls = (bool *) palloc(tupDesc->natts * sizeof(bool));
+
+	cstate->chunk = chunk;
+	cstate->chunk_line = 0;
+	cstate->chunk_pos = 0;
+
+	for (;;)
+	{
+		HeapTuple	tuple;
+		Oid			loaded_oid = InvalidOid;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (nBufferedTuples == 0)
+			ResetPerTupleExprContext(estate);
+
+		MemoryContextSwitchTo(GetPerTupleMemoryContext(estate));
+
+		if (!NextCopyFrom(cstate, econtext, values, nulls, &loaded_oid))
+			break;
+
+		tuple = heap_form_tuple(tupDesc, values, nulls);
+
+		if (loaded_oid != InvalidOid)
+			HeapTupleSetOid(tuple, loaded_oid);
+
+		tuple->t_tableOid = RelationGetRelid(rel);
+
+		MemoryContextSwitchTo(oldcontext);
+
+		ExecStoreTuple(tuple, myslot, InvalidBuffer, false);
+
+		if (rel->rd_att->constr)
+			ExecConstraints(resultRelInfo, myslot, estate);
+
+		if (resultRelInfo->ri_PartitionCheck)
+			ExecPartitionCheck(resultRelInfo, myslot, estate, true);
+
+		if (nBufferedTuples == 0)
+			firstBufferedLineNo = cstate->cur_lineno;
+		bufferedTuples[nBufferedTuples++] = tuple;
+		bufferedTuplesSize += tuple->t_len;
+
+		if (nBufferedTuples == MAX_BUFFERED_TUPLES ||
+			bufferedTuplesSize > 65535)
+		{
+			CopyFromInsertBatch(cstate, estate, mycid, hi_options,
+								resultRelInfo, myslot, bistate,
+								nBufferedTuples, bufferedTuples,
+								firstBufferedLineNo);
+			nBufferedTuples = 0;
+			bufferedTuplesSize = 0;
+		}
+
+		processed++;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	if (nBufferedTuples > 0)
+		CopyFromInsertBatch(cstate, estate, mycid, hi_options,
+							resultRelInfo, myslot, bistate,
+							nBufferedTuples, bufferedTuples,
+							firstBufferedLineNo);
+
+	cstate->chunk = NULL;
+	cstate->cur_lineno = save_cur_lineno;
+
+	pfree(bufferedTuples);
+	pfree(values);
+	pfree(nulls);
+
+	return processed;
+}
+
+/*
+ * Add a chunk to the parallel COPY queue.  Returns false if the queue is
+ * full.
+ */
+static bool
+ParallelCopyQueueChunk(ParallelCopyShared *shared, dsa_pointer chunk)
+{
+	bool		queued = false;
+
+	SpinLockAcquire(&shared->mutex);
+	if (shared->queue_count < shared->queue_size)
+	{
+		shared->queue[(shared->queue_head + shared->queue_count) %
+					  PARALLEL_COPY_QUEUE_SIZE] = chunk;
+		shared->queue_count++;
+		queued = true;
+	}
+	SpinLockRelease(&shared->mutex);
+
+	if (queued)
+		ConditionVariableSignal(&shared->chunk_added_cv);
+
+	return queued;
+}
+
+/*
+ * Take the oldest chunk off the parallel COPY queue.  If the queue is empty,
+ * returns InvalidDsaPointer, unless 'wait' is true, in which case we wait
+ * until a chunk is queued or the leader has run out of input.
+ */
+static dsa_pointer
+ParallelCopyDequeueChunk(ParallelCopyShared *shared, bool wait)
+{
+	dsa_pointer chunk = InvalidDsaPointer;
+
+	for (;;)
+	{
+		bool		input_done;
+
+		SpinLockAcquire(&shared->mutex);
+		if (shared->queue_count > 0)
+		{
+			chunk = shared->queue[shared->queue_head];
+			shared->queue_head = (shared->queue_head + 1) %
+				PARALLEL_COPY_QUEUE_SIZE;
+			shared->queue_count--;
+		}
+		input_done = shared->input_done;
+		SpinLockRelease(&shared->mutex);
+
+		if (DsaPointerIsValid(chunk) || input_done || !wait)
+			break;
+
+		ConditionVariableSleep(&shared->chunk_added_cv,
+							   WAIT_EVENT_PARALLEL_COPY_INPUT);
+	}
+	if (wait)
+		ConditionVariableCancelSleep();
+
+	return chunk;
+}
+
+/*
+ * Data source callback for a parallel COPY worker's CopyState.  Workers only
+ * load lines from chunks queued by the leader, never from the data source.
+ */
+static int
+ParallelCopyNoData(void *outbuf, int minread, int maxread)
+{
+	elog(ERROR, "parallel COPY worker cannot read COPY data");
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * Perform work within a launched parallel process.
+ */
+void
+ParallelCopyMain(dsm_segment *seg, shm_toc *toc)
+{
+	ParallelCopyShared *shared;
+	char	   *sharedquery;
+	dsa_area   *area;
+	List	   *attnamelist;
+	List	   *options;
+	Relation	rel;
+	ParseState *pstate;
+	RangeTblEntry *rte;
+	CopyState	cstate;
+	EState	   *estate;
+	ResultRelInfo *resultRelInfo;
+	TupleTableSlot *myslot;
+	BulkInsertState bistate;
+	ErrorContextCallback errcallback;
+	dsa_pointer chunk;
+	uint64		processed = 0;
+	instr_time	start;
+	instr_time	elapsed;
+	ListCell   *cur;
+
+	/* Set debug_query_string for individual workers first */
+	sharedquery = shm_toc_lookup(toc, PARALLEL_KEY_QUERY_TEXT, false);
+	debug_query_string = sharedquery;
+
+	/* Report the query string from leader */
+	pgstat_report_activity(STATE_RUNNING, debug_query_string);
+
+	shared = shm_toc_lookup(toc, PARALLEL_KEY_COPY_SHARED, false);
+	area = dsa_attach_in_place(shm_toc_lookup(toc, PARALLEL_KEY_COPY_DSA, false),
+							   seg);
+	attnamelist = (List *)
+		stringToNode(shm_toc_lookup(toc, PARALLEL_KEY_COPY_ATTNAMES, false));
+	options = (List *)
+		stringToNode(shm_toc_lookup(toc, PARALLEL_KEY_COPY_OPTIONS, false));
+
+	/* We insert with the leader's command ID, which it has marked used */
+	SetCurrentCommandIdUsedForWorker();
+
+	rel = heap_open(shared->relid, RowExclusiveLock);
+
+	/* Build the same range table DoCopy() did, for error reporting */
+	pstate = make_parsestate(NULL);
+	rte = addRangeTableEntryForRelation(pstate, rel, NULL, false, false);
+	rte->requiredPerms = ACL_INSERT;
+
+	cstate = BeginCopyFrom(pstate, rel, NULL, false, ParallelCopyNoData,
+						   attnamelist, options);
+
+	foreach(cur, cstate->attnumlist)
+	{
+		int			attno = lfirst_int(cur) -
+		FirstLowInvalidHeapAttributeNumber;
+
+		rte->insertedCols = bms_add_member(rte->insertedCols, attno);
+	}
+
+	estate = CreateExecutorState();
+	resultRelInfo = makeNode(ResultRelInfo);
+	InitResultRelInfo(resultRelInfo,
+					  rel,
+					  1,		/* dummy rangetable index */
+					  NULL,
+					  0);
+	ExecOpenIndices(resultRelInfo, false);
+
+	estate->es_result_relations = resultRelInfo;
+	estate->es_num_result_relations = 1;
+	estate->es_result_relation_info = resultRelInfo;
+	estate->es_range_table = cstate->range_table;
+
+	myslot = ExecInitExtraTupleSlot(estate, RelationGetDescr(rel));
+	bistate = GetBulkInsertState();
+
+	/* Set up callback to identify error line number */
+	errcallback.callback = CopyFromErrorCallback;
+	errcallback.arg = (void *) cstate;
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	INSTR_TIME_SET_CURRENT(start);
+
+	while (DsaPointerIsValid(chunk = ParallelCopyDequeueChunk(shared, true)))
+	{
+		processed += CopyFromChunk(cstate, dsa_get_address(area, chunk),
+								   estate, resultRelInfo, myslot, bistate,
+								   shared->mycid, shared->hi_options);
+		dsa_free(area, chunk);
+	}
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+
+	error_context_stack = errcallback.previous;
+
+	/* Report our results to the leader */
+	SpinLockAcquire(&shared->mutex);
+	shared->processed += processed;
+	shared->stats[ParallelWorkerNumber].processed = processed;
+	shared->stats[ParallelWorkerNumber].elapsed =
+		INSTR_TIME_GET_DOUBLE(elapsed);
+	SpinLockRelease(&shared->mutex);
+
+	FreeBulkInsertState(bistate);
+	ExecResetTupleTable(estate->es_tupleTable, false);
+	ExecCloseIndices(resultRelInfo);
+	FreeExecutorState(estate);
+	EndCopyFrom(cstate);
+	heap_close(rel, RowExclusiveLock);
+	dsa_detach(area);
+}
+
 /*
  * Setup to read tuples from a file for COPY FROM.
  *
@@ -3188,6 +4135,10 @@ BeginCopyFrom(ParseState *pstate,
 	cstate = BeginCopy(pstate, true, rel, NULL, InvalidOid, attnamelist, options);
 	oldcontext = MemoryContextSwitchTo(cstate->copycontext);
 
+	/* Remember how we were called, in case we hand off to parallel workers */
+	cstate->attnamelist = copyObject(attnamelist);
+	cstate->options = copyObject(options);
+
 	/* Initialize state variables */
 	cstate->fe_eof = false;
 	cstate->eol_type = EOL_UNKNOWN;
@@ -3430,26 +4381,35 @@ NextCopyFromRawFields(CopyState cstate, char ***fields, int *nfields)
 	/* only available for text or csv input */
 	Assert(!cstate->binary);
 
-	/* on input just throw the header line away */
-	if (cstate->cur_lineno == 0 && cstate->header_line)
+	if (cstate->chunk)
 	{
-		cstate->cur_lineno++;
-		if (CopyReadLine(cstate))
-			return false;		/* done */
+		/* in parallel COPY, lines come from the current chunk */
+		if (!CopyReadChunkLine(cstate))
+			return false;
 	}
+	else
+	{
+		/* on input just throw the header line away */
+		if (cstate->cur_lineno == 0 && cstate->header_line)
+		{
+			cstate->cur_lineno++;
+			if (CopyReadLine(cstate))
+				return false;	/* done */
+		}
 
-	cstate->cur_lineno++;
+		cstate->cur_lineno++;
 
-	/* Actually read the line into memory here */
-	done = CopyReadLine(cstate);
+		/* Actually read the line into memory here */
+		done = CopyReadLine(cstate);
 
-	/*
-	 * EOF at start of line means we're done.  If we see EOF after some
-	 * characters, we act as though it was newline followed by EOF, ie,
-	 * process the line and then exit loop on next iteration.
-	 */
-	if (done && cstate->line_buf.len == 0)
-		return false;
+		/*
+		 * EOF at start of line means we're done.  If we see EOF after some
+		 * characters, we act as though it was newline followed by EOF, ie,
+		 * process the line and then exit loop on next iteration.
+		 */
+		if (done && cstate->line_buf.len == 0)
+			return false;
+	}
 
 	/* Parse the line into de-escaped field values */
 	if (cstate->csv_mode)
@@ -3816,6 +4776,37 @@ CopyReadLine(CopyState cstate)
 	return result;
 }
 
+/*
+ * Read the next line of the current parallel COPY chunk into line_buf.
+ *
+ * Result is false if there are no more lines in the chunk.  The leader has
+ * already converted the line to server encoding.
+ */
+static bool
+CopyReadChunkLine(CopyState cstate)
+{
+	ParallelCopyChunk *chunk = cstate->chunk;
+	uint32		linelen;
+
+	if (cstate->chunk_line >= chunk->nlines)
+		return false;
+
+	memcpy(&linelen, chunk->data + cstate->chunk_pos, sizeof(uint32));
+	cstate->chunk_pos += sizeof(uint32);
+
+	resetStringInfo(&cstate->line_buf);
+	appendBinaryStringInfo(&cstate->line_buf,
+						   chunk->data + cstate->chunk_pos, linelen);
+	cstate->chunk_pos += linelen;
+	cstate->line_buf_valid = true;
+	cstate->line_buf_converted = true;
+
+	cstate->cur_lineno = chunk->first_lineno + cstate->chunk_line;
+	cstate->chunk_line++;
+
+	return true;
+}
+
 /*
  * CopyReadLineText - inner loop of CopyReadLine for text mode
  */
@@ -3913,6 +4904,36 @@ CopyReadLineText(CopyState cstate)
 			need_data = false;
 		}
 
+		/*
+		 * Skip quickly over data that contains none of the characters we
+		 * need to look at: \r, \n, and \\ (which in CSV mode matters only
+		 * at the start of a line), the CSV quote and escape characters, and
+		 * the first bytes of multi-byte characters if they need special
+		 * handling.  Since the skipped data contains no escape character,
+		 * it also ends any escape sequence in progress.  We always leave at
+		 * least one byte for the code below to fetch.
+		 */
+		while (raw_buf_ptr + (int) sizeof(Vector8) < copy_buf_len)
+		{
+			Vector8		chunk;
+
+			vector8_load(&chunk, (const uint8 *) &copy_raw_buf[raw_buf_ptr]);
+			if (vector8_has(chunk, '\n') || vector8_has(chunk, '\r'))
+				break;
+			if ((!cstate->csv_mode || first_char_in_line) &&
+				vector8_has(chunk, '\\'))
+				break;
+			if (cstate->csv_mode &&
+				(vector8_has(chunk, quotec) ||
+				 (escapec != '\0' && vector8_has(chunk, escapec))))
+				break;
+			if (cstate->encoding_embeds_ascii && vector8_is_highbit_set(chunk))
+				break;
+			raw_buf_ptr += sizeof(Vector8);
+			first_char_in_line = false;
+			last_was_esc = false;
+		}
+
 		/* OK to fetch a character */
 		prev_raw_ptr = raw_buf_ptr;
 		c = copy_raw_buf[raw_buf_ptr++];
@@ -4277,7 +5298,22 @@ CopyReadAttributesText(CopyState cstate)
 		 * de-escaping is actually the right thing to do; therefore we *must
 		 * not* throw any syntax errors before we've done the null-marker
 		 * check.
+		 *
+		 * Leading data with neither delimiters nor backslashes in it is
+		 * copied a vector at a time first.
 		 */
+		while (cur_ptr + sizeof(Vector8) <= line_end_ptr)
+		{
+			Vector8		chunk;
+
+			vector8_load(&chunk, (const uint8 *) cur_ptr);
+			if (vector8_has(chunk, delimc) || vector8_has(chunk, '\\'))
+				break;
+			memcpy(output_ptr, cur_ptr, sizeof(Vector8));
+			output_ptr += sizeof(Vector8);
+			cur_ptr += sizeof(Vector8);
+		}
+
 		for (;;)
 		{
 			char		c;
@@ -4508,7 +5544,19 @@ CopyReadAttributesCSV(CopyState cstate)
 		{
 			char		c;
 
-			/* Not in quote */
+			/* Not in quote; first copy data up to a delimiter or quote */
+			while (cur_ptr + sizeof(Vector8) <= line_end_ptr)
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk, (const uint8 *) cur_ptr);
+				if (vector8_has(chunk, delimc) || vector8_has(chunk, quotec))
+					break;
+				memcpy(output_ptr, cur_ptr, sizeof(Vector8));
+				output_ptr += sizeof(Vector8);
+				cur_ptr += sizeof(Vector8);
+			}
+
 			for (;;)
 			{
 				end_ptr = cur_ptr;
@@ -4531,7 +5579,19 @@ CopyReadAttributesCSV(CopyState cstate)
 				*output_ptr++ = c;
 			}
 
-			/* In quote */
+			/* In quote; first copy data up to a quote or escape */
+			while (cur_ptr + sizeof(Vector8) <= line_end_ptr)
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk, (const uint8 *) cur_ptr);
+				if (vector8_has(chunk, quotec) || vector8_has(chunk, escapec))
+					break;
+				memcpy(output_ptr, cur_ptr, sizeof(Vector8));
+				output_ptr += sizeof(Vector8);
+				cur_ptr += sizeof(Vector8);
+			}
+
 			for (;;)
 			{
 				end_ptr = cur_ptr;
@@ -4687,7 +5747,8 @@ CopyAttributeOutText(CopyState cstate, char *string)
 	 * in valid backend encodings, extra bytes of a multibyte character never
 	 * look like ASCII.  This loop is sufficiently performance-critical that
 	 * it's worth making two copies of it to get the IS_HIGHBIT_SET() test out
-	 * of the normal safe-encoding path.
+	 * of the normal safe-encoding path, which also tests a whole vector of
+	 * characters at a time where it can.
 	 */
 	if (cstate->encoding_embeds_ascii)
 	{
@@ -4751,9 +5812,29 @@ CopyAttributeOutText(CopyState cstate, char *string)
 	}
 	else
 	{
+		char	   *end = ptr + strlen(ptr);
+
 		start = ptr;
 		while ((c = *ptr) != '\0')
 		{
+			/*
+			 * Skip over a whole vector's worth of characters at once if none
+			 * of them needs escaping.
+			 */
+			if (ptr + sizeof(Vector8) <= end)
+			{
+				Vector8		chunk;
+
+				vector8_load(&chunk, (const uint8 *) ptr);
+				if (!vector8_has_le(chunk, 0x1F) &&
+					!vector8_has(chunk, '\\') &&
+					!vector8_has(chunk, delimc))
+				{
+					ptr += sizeof(Vector8);
+					continue;
+				}
+			}
+
 			if ((unsigned char) c < (unsigned char) 0x20)
 			{
 				/*
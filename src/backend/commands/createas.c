@@ -106,6 +106,7 @@ create_ctas_internal(List *attrList, IntoClause *into)
 	create->options = into->options;
 	create->oncommit = into->onCommit;
 	create->tablespacename = into->tableSpaceName;
+	create->accessMethod = into->accessMethod;
 	create->if_not_exists = false;
 
 	/*
@@ -81,6 +81,8 @@ static void show_upper_qual(List *qual, const char *qlabel,
 				ExplainState *es);
 static void show_sort_keys(SortState *sortstate, List *ancestors,
 			   ExplainState *es);
+static void show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es);
 static void show_merge_append_keys(MergeAppendState *mstate, List *ancestors,
 					   ExplainState *es);
 static void show_agg_keys(AggState *astate, List *ancestors,
@@ -102,7 +104,11 @@ static void show_sortorder_options(StringInfo buf, Node *sortexpr,
 static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
 				 List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
+static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
+static void show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 					ExplainState *es);
 static void show_instrumentation_count(const char *qlabel, int which,
@@ -1061,9 +1067,15 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Material:
 			pname = sname = "Materialize";
 			break;
+		case T_ResultCache:
+			pname = sname = "Result Cache";
+			break;
 		case T_Sort:
 			pname = sname = "Sort";
 			break;
+		case T_IncrementalSort:
+			pname = sname = "Incremental Sort";
+			break;
 		case T_Group:
 			pname = sname = "Group";
 			break;
@@ -1671,6 +1683,12 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			show_sort_keys(castNode(SortState, planstate), ancestors, es);
 			show_sort_info(castNode(SortState, planstate), es);
 			break;
+		case T_IncrementalSort:
+			show_incremental_sort_keys(castNode(IncrementalSortState, planstate),
+									   ancestors, es);
+			show_incremental_sort_info(castNode(IncrementalSortState, planstate),
+									   es);
+			break;
 		case T_MergeAppend:
 			show_merge_append_keys(castNode(MergeAppendState, planstate),
 								   ancestors, es);
@@ -1690,6 +1708,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Hash:
 			show_hash_info(castNode(HashState, planstate), es);
 			break;
+		case T_ResultCache:
+			show_resultcache_info(castNode(ResultCacheState, planstate),
+								  ancestors, es);
+			break;
 		default:
 			break;
 	}
@@ -2011,6 +2033,27 @@ show_sort_keys(SortState *sortstate, List *ancestors, ExplainState *es)
 						 ancestors, es);
 }
 
+/*
+ * Show the sort keys for an IncrementalSort node, as well as the prefix of
+ * them by which the input is already sorted.
+ */
+static void
+show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es)
+{
+	IncrementalSort *plan = (IncrementalSort *) incrsortstate->ss.ps.plan;
+
+	show_sort_group_keys((PlanState *) incrsortstate, "Sort Key",
+						 plan->sort.numCols, plan->sort.sortColIdx,
+						 plan->sort.sortOperators, plan->sort.collations,
+						 plan->sort.nullsFirst,
+						 ancestors, es);
+	show_sort_group_keys((PlanState *) incrsortstate, "Presorted Key",
+						 plan->nPresortedCols, plan->sort.sortColIdx,
+						 NULL, NULL, NULL,
+						 ancestors, es);
+}
+
 /*
  * Likewise, for a MergeAppend node.
  */
@@ -2440,6 +2483,138 @@ show_sort_info(SortState *sortstate, ExplainState *es)
 	}
 }
 
+/*
+ * If it's EXPLAIN ANALYZE, show the number of sort batches and the tuplesort
+ * stats aggregated over them for an incremental sort node
+ */
+static void
+show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es)
+{
+	IncrementalSortInfo *info = &incrsortstate->incsort_info;
+	StringInfoData methods;
+	const char *spaceType;
+	int			m;
+
+	if (!es->analyze || info->groupCount == 0)
+		return;
+
+	initStringInfo(&methods);
+	for (m = SORT_TYPE_TOP_N_HEAPSORT; m <= SORT_TYPE_EXTERNAL_MERGE; m++)
+	{
+		if (info->sortMethods & (1 << m))
+		{
+			if (methods.len > 0)
+				appendStringInfoString(&methods, ", ");
+			appendStringInfoString(&methods,
+								   tuplesort_method_name((TuplesortMethod) m));
+		}
+	}
+	spaceType = tuplesort_space_type_name(info->maxSpaceType);
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Sort Batches: " INT64_FORMAT "  Sort Methods: %s  Peak %s: %ldkB\n",
+						 info->groupCount, methods.data, spaceType,
+						 info->maxSpaceUsed);
+	}
+	else
+	{
+		ExplainPropertyInteger("Sort Batches", NULL, info->groupCount, es);
+		ExplainPropertyText("Sort Methods", methods.data, es);
+		ExplainPropertyInteger("Peak Sort Space Used", "kB",
+							   info->maxSpaceUsed, es);
+		ExplainPropertyText("Peak Sort Space Type", spaceType, es);
+	}
+
+	pfree(methods.data);
+}
+
+/*
+ * Show information on result cache hits/misses/evictions and memory usage.
+ */
+static void
+show_resultcache_info(ResultCacheState *rcstate, List *ancestors,
+					  ExplainState *es)
+{
+	Plan	   *plan = ((PlanState *) rcstate)->plan;
+	ListCell   *lc;
+	List	   *context;
+	StringInfoData keystr;
+	bool		useprefix;
+	int64		memPeakKb;
+
+	initStringInfo(&keystr);
+
+	/*
+	 * It's hard to imagine having a result cache with fewer than 2 RTEs, but
+	 * let's just keep the same useprefix logic as elsewhere in this file.
+	 */
+	useprefix = list_length(es->rtable) > 1 || es->verbose;
+
+	/* Set up deparsing context */
+	context = set_deparse_context_planstate(es->deparse_cxt,
+											(Node *) rcstate,
+											ancestors);
+
+	foreach(lc, ((ResultCache *) plan)->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		if (keystr.len > 0)
+			appendStringInfoString(&keystr, ", ");
+
+		appendStringInfoString(&keystr, deparse_expression(expr, context,
+														   useprefix, false));
+	}
+
+	ExplainPropertyText("Cache Key", keystr.data, es);
+
+	pfree(keystr.data);
+
+	if (!es->analyze)
+		return;
+
+	/* Nothing to report if the node was never executed */
+	if (rcstate->stats.cache_hits == 0 && rcstate->stats.cache_misses == 0)
+		return;
+
+	/*
+	 * mem_peak is only maintained on evictions and at end of execution, so
+	 * make sure we report the memory in use right now if that's larger.
+	 */
+	memPeakKb = (Max(rcstate->stats.mem_peak, rcstate->mem_used) +
+				 1023) / 1024;
+
+	if (es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyInteger("Cache Hits", NULL,
+							   rcstate->stats.cache_hits, es);
+		ExplainPropertyInteger("Cache Misses", NULL,
+							   rcstate->stats.cache_misses, es);
+		ExplainPropertyInteger("Cache Evictions", NULL,
+							   rcstate->stats.cache_evictions, es);
+		ExplainPropertyInteger("Cache Overflows", NULL,
+							   rcstate->stats.cache_overflows, es);
+		ExplainPropertyInteger("Peak Memory Usage", "kB", memPeakKb, es);
+	}
+	else
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Hits: " UINT64_FORMAT "  Misses: " UINT64_FORMAT
+						 "  Evictions: " UINT64_FORMAT "  Overflows: "
+						 UINT64_FORMAT "  Memory Usage: " INT64_FORMAT "kB\n",
+						 rcstate->stats.cache_hits,
+						 rcstate->stats.cache_misses,
+						 rcstate->stats.cache_evictions,
+						 rcstate->stats.cache_overflows,
+						 memPeakKb);
+	}
+}
+
 /*
  * Show information on hash buckets/batches.
  */
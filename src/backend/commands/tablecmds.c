@@ -21,6 +21,7 @@
 #include "access/reloptions.h"
 #include "access/relscan.h"
 #include "access/sysattr.h"
+#include "access/tableam.h"
 #include "access/tupconvert.h"
 #include "access/xact.h"
 #include "access/xlog.h"
@@ -539,6 +540,7 @@ DefineRelation(CreateStmt *stmt, char relkind, Oid ownerId,
 	AttrNumber	attnum;
 	static char *validnsps[] = HEAP_RELOPT_NAMESPACES;
 	Oid			ofTypeId;
+	Oid			accessMethodId = InvalidOid;
 	ObjectAddress address;
 
 	/*
@@ -644,6 +646,22 @@ DefineRelation(CreateStmt *stmt, char relkind, Oid ownerId,
 	else
 		ofTypeId = InvalidOid;
 
+	/*
+	 * Select the table access method.  If not specified, relkinds that store
+	 * tuples use default_table_access_method; the others don't get one.
+	 */
+	if (stmt->accessMethod != NULL)
+	{
+		if (relkind == RELKIND_PARTITIONED_TABLE)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("specifying a table access method is not supported on a partitioned table")));
+
+		accessMethodId = get_table_am_oid(stmt->accessMethod, false);
+	}
+	else if (relkind == RELKIND_RELATION || relkind == RELKIND_MATVIEW)
+		accessMethodId = get_table_am_oid(default_table_access_method, false);
+
 	/*
 	 * Look up inheritance ancestors and generate relation schema, including
 	 * inherited attributes.  (Note that stmt->tableElts is destructively
@@ -756,6 +774,7 @@ DefineRelation(CreateStmt *stmt, char relkind, Oid ownerId,
 										  InvalidOid,
 										  ofTypeId,
 										  ownerId,
+										  accessMethodId,
 										  descriptor,
 										  list_concat(cookedDefaults,
 													  old_constraints),
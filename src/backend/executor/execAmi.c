@@ -32,6 +32,7 @@
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
 #include "executor/nodeIndexonlyscan.h"
+#include "executor/nodeIncrementalSort.h"
 #include "executor/nodeIndexscan.h"
 #include "executor/nodeLimit.h"
 #include "executor/nodeLockRows.h"
@@ -44,6 +45,7 @@
 #include "executor/nodeProjectSet.h"
 #include "executor/nodeRecursiveunion.h"
 #include "executor/nodeResult.h"
+#include "executor/nodeResultCache.h"
 #include "executor/nodeSamplescan.h"
 #include "executor/nodeSeqscan.h"
 #include "executor/nodeSetOp.h"
@@ -249,10 +251,18 @@ ExecReScan(PlanState *node)
 			ExecReScanMaterial((MaterialState *) node);
 			break;
 
+		case T_ResultCacheState:
+			ExecReScanResultCache((ResultCacheState *) node);
+			break;
+
 		case T_SortState:
 			ExecReScanSort((SortState *) node);
 			break;
 
+		case T_IncrementalSortState:
+			ExecReScanIncrementalSort((IncrementalSortState *) node);
+			break;
+
 		case T_GroupState:
 			ExecReScanGroup((GroupState *) node);
 			break;
@@ -394,6 +404,37 @@ ExecRestrPos(PlanState *node)
 	}
 }
 
+/*
+ * ExecSkipTo
+ *
+ * Ask a node whose output is sorted on some column to skip ahead, so that
+ * the next ExecProcNode returns the first tuple for which that column
+ * satisfies the scan key, as "column OP sk_argument"; how sk_attno
+ * identifies the column depends on the node type.  The caller must know
+ * that none of the tuples skipped over are of interest.
+ *
+ * Returns false if the node can't do that, in which case nothing happened
+ * and the caller must fall back to reading its way forward.
+ */
+bool
+ExecSkipTo(PlanState *node, ScanKey key)
+{
+	switch (nodeTag(node))
+	{
+		case T_IndexScanState:
+			return ExecIndexSkipTo((IndexScanState *) node, key);
+
+		case T_IndexOnlyScanState:
+			return ExecIndexOnlySkipTo((IndexOnlyScanState *) node, key);
+
+		case T_SortState:
+			return ExecSortSkipTo((SortState *) node, key);
+
+		default:
+			return false;
+	}
+}
+
 /*
  * ExecSupportsMarkRestore - does a Path support mark/restore?
  *
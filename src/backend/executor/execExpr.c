@@ -3345,3 +3345,124 @@ ExecBuildGroupingEqual(TupleDesc ldesc, TupleDesc rdesc,
 
 	return state;
 }
+
+/*
+ * Build an ExprState that computes the 32-bit hash value of a set of key
+ * expressions, as used by hash joins.  The expression returns the hash value
+ * as a uint32 Datum, combining the keys' hash values by rotating the value so
+ * far left by one bit and XORing in the next key's hash value.  A NULL key
+ * hashes as 0, unless its operator is strict and NULLs aren't to be kept, in
+ * which case the tuple can't match anything and the expression returns NULL.
+ *
+ * Building the whole computation as one expression allows it to be JIT
+ * compiled along with the key expressions, including inlining the hash
+ * functions.
+ *
+ * hash_exprs: list of Expr nodes to hash
+ * hashfunc_oids: array of the hash functions' oids, one for each expression
+ * opstrict: array of the strictness of each key's join operator
+ * keep_nulls: if true, don't reject tuples with NULL keys
+ * parent: parent executor node
+ */
+ExprState *
+ExecBuildHash32Expr(List *hash_exprs, const Oid *hashfunc_oids,
+					const bool *opstrict, bool keep_nulls,
+					PlanState *parent)
+{
+	ExprState  *state = makeNode(ExprState);
+	ExprEvalStep scratch = {0};
+	int			num_exprs = list_length(hash_exprs);
+	Datum	   *iresult_value = NULL;
+	bool	   *iresult_null = NULL;
+	List	   *adjust_jumps = NIL;
+	ListCell   *lc;
+	int			i;
+
+	Assert(num_exprs > 0);
+
+	state->expr = NULL;
+	state->parent = parent;
+
+	/* Insert EEOP_*_FETCHSOME steps as needed */
+	ExecInitExprSlots(state, (Node *) hash_exprs);
+
+	/*
+	 * The hash value computed so far is kept separately from the final
+	 * result, so that evaluating the next key can't clobber it.
+	 */
+	if (num_exprs > 1)
+	{
+		iresult_value = palloc(sizeof(Datum));
+		iresult_null = palloc(sizeof(bool));
+	}
+
+	i = 0;
+	foreach(lc, hash_exprs)
+	{
+		Expr	   *expr = (Expr *) lfirst(lc);
+		FmgrInfo   *finfo;
+		FunctionCallInfo fcinfo;
+		bool		strict = opstrict[i] && !keep_nulls;
+
+		/* Set up the hash function's lookup information */
+		finfo = palloc0(sizeof(FmgrInfo));
+		fcinfo = palloc0(sizeof(FunctionCallInfoData));
+		fmgr_info(hashfunc_oids[i], finfo);
+		InitFunctionCallInfoData(*fcinfo, finfo, 1,
+								 InvalidOid, NULL, NULL);
+
+		/* evaluate the key straight into the hash function's argument */
+		ExecInitExprRec(expr, state, &fcinfo->arg[0], &fcinfo->argnull[0]);
+
+		if (i == 0)
+			scratch.opcode = strict ? EEOP_HASHDATUM_FIRST_STRICT :
+				EEOP_HASHDATUM_FIRST;
+		else
+			scratch.opcode = strict ? EEOP_HASHDATUM_NEXT32_STRICT :
+				EEOP_HASHDATUM_NEXT32;
+
+		/* only the last key's step produces the final result */
+		if (i == num_exprs - 1)
+		{
+			scratch.resvalue = &state->resvalue;
+			scratch.resnull = &state->resnull;
+		}
+		else
+		{
+			scratch.resvalue = iresult_value;
+			scratch.resnull = iresult_null;
+		}
+
+		scratch.d.hashdatum.finfo = finfo;
+		scratch.d.hashdatum.fcinfo_data = fcinfo;
+		scratch.d.hashdatum.fn_addr = finfo->fn_addr;
+		scratch.d.hashdatum.jumpdone = -1;
+		scratch.d.hashdatum.iresult = iresult_value;
+		ExprEvalPushStep(state, &scratch);
+
+		if (strict)
+			adjust_jumps = lappend_int(adjust_jumps, state->steps_len - 1);
+
+		i++;
+	}
+
+	/* adjust jump targets */
+	foreach(lc, adjust_jumps)
+	{
+		ExprEvalStep *as = &state->steps[lfirst_int(lc)];
+
+		Assert(as->opcode == EEOP_HASHDATUM_FIRST_STRICT ||
+			   as->opcode == EEOP_HASHDATUM_NEXT32_STRICT);
+		Assert(as->d.hashdatum.jumpdone == -1);
+		as->d.hashdatum.jumpdone = state->steps_len;
+	}
+
+	scratch.resvalue = NULL;
+	scratch.resnull = NULL;
+	scratch.opcode = EEOP_DONE;
+	ExprEvalPushStep(state, &scratch);
+
+	ExecReadyExpr(state);
+
+	return state;
+}
@@ -328,6 +328,10 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 		&&CASE_EEOP_FUNCEXPR_STRICT,
 		&&CASE_EEOP_FUNCEXPR_FUSAGE,
 		&&CASE_EEOP_FUNCEXPR_STRICT_FUSAGE,
+		&&CASE_EEOP_HASHDATUM_FIRST,
+		&&CASE_EEOP_HASHDATUM_FIRST_STRICT,
+		&&CASE_EEOP_HASHDATUM_NEXT32,
+		&&CASE_EEOP_HASHDATUM_NEXT32_STRICT,
 		&&CASE_EEOP_BOOL_AND_STEP_FIRST,
 		&&CASE_EEOP_BOOL_AND_STEP,
 		&&CASE_EEOP_BOOL_AND_STEP_LAST,
@@ -699,6 +703,92 @@ ExecInterpExpr(ExprState *state, ExprContext *econtext, bool *isnull)
 			EEO_NEXT();
 		}
 
+		EEO_CASE(EEOP_HASHDATUM_FIRST)
+		{
+			FunctionCallInfo fcinfo = op->d.hashdatum.fcinfo_data;
+			uint32		hashvalue = 0;
+
+			/* a NULL input is treated as having hash value 0 */
+			if (!fcinfo->argnull[0])
+			{
+				fcinfo->isnull = false;
+				hashvalue = DatumGetUInt32(op->d.hashdatum.fn_addr(fcinfo));
+			}
+
+			*op->resvalue = UInt32GetDatum(hashvalue);
+			*op->resnull = false;
+
+			EEO_NEXT();
+		}
+
+		EEO_CASE(EEOP_HASHDATUM_FIRST_STRICT)
+		{
+			FunctionCallInfo fcinfo = op->d.hashdatum.fcinfo_data;
+
+			/* a NULL input can't match anything, so return NULL */
+			if (fcinfo->argnull[0])
+			{
+				state->resvalue = (Datum) 0;
+				state->resnull = true;
+				EEO_JUMP(op->d.hashdatum.jumpdone);
+			}
+
+			fcinfo->isnull = false;
+			*op->resvalue =
+				UInt32GetDatum(DatumGetUInt32(op->d.hashdatum.fn_addr(fcinfo)));
+			*op->resnull = false;
+
+			EEO_NEXT();
+		}
+
+		EEO_CASE(EEOP_HASHDATUM_NEXT32)
+		{
+			FunctionCallInfo fcinfo = op->d.hashdatum.fcinfo_data;
+			uint32		hashvalue = DatumGetUInt32(*op->d.hashdatum.iresult);
+
+			/* rotate hashvalue left 1 bit at each step */
+			hashvalue = (hashvalue << 1) | ((hashvalue & 0x80000000) ? 1 : 0);
+
+			/* a NULL input is treated as having hash value 0 */
+			if (!fcinfo->argnull[0])
+			{
+				fcinfo->isnull = false;
+				hashvalue ^= DatumGetUInt32(op->d.hashdatum.fn_addr(fcinfo));
+			}
+
+			*op->resvalue = UInt32GetDatum(hashvalue);
+			*op->resnull = false;
+
+			EEO_NEXT();
+		}
+
+		EEO_CASE(EEOP_HASHDATUM_NEXT32_STRICT)
+		{
+			FunctionCallInfo fcinfo = op->d.hashdatum.fcinfo_data;
+			uint32		hashvalue;
+
+			/* a NULL input can't match anything, so return NULL */
+			if (fcinfo->argnull[0])
+			{
+				state->resvalue = (Datum) 0;
+				state->resnull = true;
+				EEO_JUMP(op->d.hashdatum.jumpdone);
+			}
+
+			hashvalue = DatumGetUInt32(*op->d.hashdatum.iresult);
+
+			/* rotate hashvalue left 1 bit at each step */
+			hashvalue = (hashvalue << 1) | ((hashvalue & 0x80000000) ? 1 : 0);
+
+			fcinfo->isnull = false;
+			hashvalue ^= DatumGetUInt32(op->d.hashdatum.fn_addr(fcinfo));
+
+			*op->resvalue = UInt32GetDatum(hashvalue);
+			*op->resnull = false;
+
+			EEO_NEXT();
+		}
+
 		/*
 		 * If any of its clauses is FALSE, an AND's result is FALSE regardless
 		 * of the states of the rest of the clauses, so we can stop evaluating
@@ -19,8 +19,10 @@
 #include "postgres.h"
 
 #include "access/hash.h"
+#include "access/htup_details.h"
 #include "access/parallel.h"
 #include "executor/executor.h"
+#include "lib/dshash.h"
 #include "miscadmin.h"
 #include "utils/lsyscache.h"
 #include "utils/hashutils.h"
@@ -28,6 +30,34 @@
 
 static uint32 TupleHashTableHash(struct tuplehash_hash *tb, const MinimalTuple tuple);
 static int	TupleHashTableMatch(struct tuplehash_hash *tb, const MinimalTuple tuple1, const MinimalTuple tuple2);
+static uint32 SharedTupleHashTableHash(const void *key, size_t size, void *arg);
+static bool SharedTupleHashChainMatch(SharedTupleHashTable hashtable,
+						  TupleTableSlot *slot,
+						  dsa_pointer chain, dsa_pointer stop);
+
+/*
+ * An entry of a SharedTupleHashTable.  dshash only knows about the hash
+ * value: the entry heads a chain of the first tuples of all the groups
+ * whose key columns hash to it.  Members are only ever pushed onto the
+ * front of the chain, under the entry's lock, and never change once they
+ * are linked in, so that the chain can be read without holding the lock.
+ * That keeps the datatypes' equality functions, which might do anything,
+ * from running while we hold dshash's partition lock.
+ */
+typedef struct SharedTupleHashEntry
+{
+	uint32		hash;			/* hash value of the key columns */
+	dsa_pointer tuples;			/* chain of SharedTupleHashTuples */
+} SharedTupleHashEntry;
+
+typedef struct SharedTupleHashTuple
+{
+	dsa_pointer next;			/* next member of the chain */
+	/* the first tuple of the group follows, as a MinimalTuple */
+} SharedTupleHashTuple;
+
+#define STHTUPLE_MINTUPLE(sthtup) \
+	((MinimalTuple) ((char *) (sthtup) + MAXALIGN(sizeof(SharedTupleHashTuple))))
 
 /*
  * Define parameters for tuple hash table code generation. The interface is
@@ -138,7 +168,8 @@ execTuplesHashPrepare(int numCols,
  *	hashfunctions: datatype-specific hashing functions to use
  *	nbuckets: initial estimate of hashtable size
  *	additionalsize: size of data stored in ->additional
- *	tablecxt: memory context in which to store table and table entries
+ *	metacxt: memory context for long-lived allocation, but not per-entry data
+ *	tablecxt: memory context in which to store table entries
  *	tempcxt: short-lived context for evaluation hash and comparison functions
  *
  * The function arrays may be made with execTuplesHashPrepare().  Note they
@@ -149,14 +180,16 @@ execTuplesHashPrepare(int numCols,
  * storage that will live as long as the hashtable does.
  */
 TupleHashTable
-BuildTupleHashTable(PlanState *parent,
-					TupleDesc inputDesc,
-					int numCols, AttrNumber *keyColIdx,
-					Oid *eqfuncoids,
-					FmgrInfo *hashfunctions,
-					long nbuckets, Size additionalsize,
-					MemoryContext tablecxt, MemoryContext tempcxt,
-					bool use_variable_hash_iv)
+BuildTupleHashTableExt(PlanState *parent,
+					   TupleDesc inputDesc,
+					   int numCols, AttrNumber *keyColIdx,
+					   Oid *eqfuncoids,
+					   FmgrInfo *hashfunctions,
+					   long nbuckets, Size additionalsize,
+					   MemoryContext metacxt,
+					   MemoryContext tablecxt,
+					   MemoryContext tempcxt,
+					   bool use_variable_hash_iv)
 {
 	TupleHashTable hashtable;
 	Size		entrysize = sizeof(TupleHashEntryData) + additionalsize;
@@ -168,7 +201,7 @@ BuildTupleHashTable(PlanState *parent,
 	nbuckets = Min(nbuckets, (long) ((work_mem * 1024L) / entrysize));
 
 	hashtable = (TupleHashTable)
-		MemoryContextAlloc(tablecxt, sizeof(TupleHashTableData));
+		MemoryContextAlloc(metacxt, sizeof(TupleHashTableData));
 
 	hashtable->numCols = numCols;
 	hashtable->keyColIdx = keyColIdx;
@@ -194,9 +227,9 @@ BuildTupleHashTable(PlanState *parent,
 	else
 		hashtable->hash_iv = 0;
 
-	hashtable->hashtab = tuplehash_create(tablecxt, nbuckets, hashtable);
+	hashtable->hashtab = tuplehash_create(metacxt, nbuckets, hashtable);
 
-	oldcontext = MemoryContextSwitchTo(hashtable->tablecxt);
+	oldcontext = MemoryContextSwitchTo(metacxt);
 
 	/*
 	 * We copy the input tuple descriptor just for safety --- we assume all
@@ -217,6 +250,44 @@ BuildTupleHashTable(PlanState *parent,
 	return hashtable;
 }
 
+/*
+ * BuildTupleHashTable is a backwards-compatibility wrapper for
+ * BuildTupleHashTableExt(), that allocates the hashtable's metadata in
+ * tablecxt.
+ */
+TupleHashTable
+BuildTupleHashTable(PlanState *parent,
+					TupleDesc inputDesc,
+					int numCols, AttrNumber *keyColIdx,
+					Oid *eqfuncoids,
+					FmgrInfo *hashfunctions,
+					long nbuckets, Size additionalsize,
+					MemoryContext tablecxt, MemoryContext tempcxt,
+					bool use_variable_hash_iv)
+{
+	return BuildTupleHashTableExt(parent,
+								  inputDesc,
+								  numCols, keyColIdx,
+								  eqfuncoids,
+								  hashfunctions,
+								  nbuckets, additionalsize,
+								  tablecxt,
+								  tablecxt,
+								  tempcxt,
+								  use_variable_hash_iv);
+}
+
+/*
+ * Reset contents of the hashtable to be empty, preserving all the non-content
+ * state.  Note that the tablecxt passed to BuildTupleHashTableExt() should
+ * also be reset, otherwise there will be leaks.
+ */
+void
+ResetTupleHashTable(TupleHashTable hashtable)
+{
+	tuplehash_reset(hashtable->hashtab);
+}
+
 /*
  * Find or create a hashtable entry for the tuple group containing the
  * given tuple.  The tuple must be the same type as the hashtable entries.
@@ -415,3 +486,266 @@ TupleHashTableMatch(struct tuplehash_hash *tb, const MinimalTuple tuple1, const
 	econtext->ecxt_outertuple = slot1;
 	return !ExecQualAndReset(hashtable->cur_eq_func, econtext);
 }
+
+
+/*****************************************************************************
+ *		Utility routines for shared hash tables
+ *
+ * These are the counterpart of the above for hash tables that live in
+ * dynamic shared memory, which lets the participants of a parallel query
+ * eliminate duplicates across all of their input (eg, for a parallel-aware
+ * Unique).
+ *****************************************************************************/
+
+/*
+ * Create a SharedTupleHashTable in 'area', or attach to an existing one.
+ *
+ *	numCols, keyColIdx, eqfuncoids, hashfunctions: as for
+ *	BuildTupleHashTableExt
+ *	area: the DSA area to keep the table and its tuples in
+ *	handle: InvalidDsaPointer to create a new table, or the handle of an
+ *	existing one, as returned by SharedTupleHashTableGetHandle, to attach to
+ *	metacxt: memory context for the backend-local state
+ *	tempcxt: short-lived context for evaluation hash and comparison functions
+ *
+ * All the participants must use the same hash and equality functions.
+ * Unlike with BuildTupleHashTableExt there's no hash IV: the hash values
+ * must be the same in every backend.
+ */
+SharedTupleHashTable
+BuildSharedTupleHashTable(PlanState *parent,
+						  TupleDesc inputDesc,
+						  int numCols, AttrNumber *keyColIdx,
+						  Oid *eqfuncoids,
+						  FmgrInfo *hashfunctions,
+						  dsa_area *area,
+						  dsa_pointer handle,
+						  MemoryContext metacxt,
+						  MemoryContext tempcxt)
+{
+	SharedTupleHashTable hashtable;
+	dshash_parameters params;
+	MemoryContext oldcontext;
+
+	oldcontext = MemoryContextSwitchTo(metacxt);
+
+	hashtable = (SharedTupleHashTable) palloc(sizeof(SharedTupleHashTableData));
+	hashtable->area = area;
+	hashtable->numCols = numCols;
+	hashtable->keyColIdx = keyColIdx;
+	hashtable->tab_hash_funcs = hashfunctions;
+	hashtable->tempcxt = tempcxt;
+
+	/* see BuildTupleHashTableExt */
+	hashtable->tableslot = MakeSingleTupleTableSlot(CreateTupleDescCopy(inputDesc));
+	hashtable->tab_eq_func = ExecBuildGroupingEqual(inputDesc, inputDesc,
+													numCols,
+													keyColIdx, eqfuncoids,
+													parent);
+	hashtable->exprcontext = CreateExprContext(parent->state);
+
+	params.key_size = sizeof(uint32);
+	params.entry_size = sizeof(SharedTupleHashEntry);
+	params.compare_function = dshash_memcmp;
+	params.hash_function = SharedTupleHashTableHash;
+	params.tranche_id = LWTRANCHE_PARALLEL_TUPLE_HASH;
+
+	if (DsaPointerIsValid(handle))
+		hashtable->hashtab = dshash_attach(area, &params, handle, NULL);
+	else
+		hashtable->hashtab = dshash_create(area, &params, NULL);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return hashtable;
+}
+
+/*
+ * Get a handle that other backends can pass to BuildSharedTupleHashTable to
+ * attach to the table.
+ */
+dsa_pointer
+SharedTupleHashTableGetHandle(SharedTupleHashTable hashtable)
+{
+	return dshash_get_hash_table_handle(hashtable->hashtab);
+}
+
+/*
+ * Detach from a SharedTupleHashTable.  If 'destroy' is true, the shared
+ * table itself is freed too; the caller must make sure that no other backend
+ * is still using it.  The tuples stored in the table are not freed, they go
+ * away with the DSA area.
+ */
+void
+ReleaseSharedTupleHashTable(SharedTupleHashTable hashtable, bool destroy)
+{
+	if (destroy)
+		dshash_destroy(hashtable->hashtab);
+	else
+		dshash_detach(hashtable->hashtab);
+	ExecDropSingleTupleTableSlot(hashtable->tableslot);
+	pfree(hashtable);
+}
+
+/*
+ * Find or create an entry of a SharedTupleHashTable for the tuple group
+ * containing the given tuple.
+ *
+ * If isnew is NULL, we do not create new entries, and just return whether
+ * a matching entry exists.  Otherwise a new entry is created if no existing
+ * entry matches, *isnew tells which case applied, and we return true.
+ * Exactly one of several backends looking up the same group concurrently
+ * sees *isnew set.
+ */
+bool
+LookupSharedTupleHashEntry(SharedTupleHashTable hashtable,
+						   TupleTableSlot *slot, bool *isnew)
+{
+	SharedTupleHashEntry *entry;
+	MemoryContext oldContext;
+	dsa_pointer chain;
+	dsa_pointer compared = InvalidDsaPointer;
+	dsa_pointer newtuple = InvalidDsaPointer;
+	int			i;
+	uint32		hashkey = 0;
+
+	/* Need to run the hash functions in short-lived context */
+	oldContext = MemoryContextSwitchTo(hashtable->tempcxt);
+
+	/* hash the key columns the same way TupleHashTableHash does */
+	for (i = 0; i < hashtable->numCols; i++)
+	{
+		AttrNumber	att = hashtable->keyColIdx[i];
+		Datum		attr;
+		bool		isNull;
+
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, att, &isNull);
+
+		if (!isNull)
+		{
+			uint32		hkey;
+
+			hkey = DatumGetUInt32(FunctionCall1(&hashtable->tab_hash_funcs[i],
+												attr));
+			hashkey ^= hkey;
+		}
+	}
+
+	hashkey = murmurhash32(hashkey);
+
+	/*
+	 * Look at the chain of the groups with the same hash value, and compare
+	 * our tuple to the members we haven't seen yet once we have released
+	 * the lock.  If none of them matches, go back and link in our tuple,
+	 * unless somebody else has added a member in the meantime; then we have
+	 * to compare to that one first.
+	 */
+	for (;;)
+	{
+		if (isnew == NULL)
+		{
+			entry = dshash_find(hashtable->hashtab, &hashkey, false);
+			if (entry == NULL)
+				break;
+		}
+		else
+		{
+			bool		found;
+
+			entry = dshash_find_or_insert(hashtable->hashtab, &hashkey,
+										  &found);
+			if (!found)
+				entry->tuples = InvalidDsaPointer;
+		}
+
+		chain = entry->tuples;
+		if (chain == compared && DsaPointerIsValid(newtuple))
+		{
+			SharedTupleHashTuple *sthtup;
+
+			sthtup = dsa_get_address(hashtable->area, newtuple);
+			sthtup->next = chain;
+			entry->tuples = newtuple;
+			dshash_release_lock(hashtable->hashtab, entry);
+
+			MemoryContextSwitchTo(oldContext);
+			*isnew = true;
+			return true;
+		}
+		dshash_release_lock(hashtable->hashtab, entry);
+
+		if (SharedTupleHashChainMatch(hashtable, slot, chain, compared))
+		{
+			if (DsaPointerIsValid(newtuple))
+				dsa_free(hashtable->area, newtuple);
+
+			MemoryContextSwitchTo(oldContext);
+			if (isnew)
+				*isnew = false;
+			return true;
+		}
+
+		if (isnew == NULL)
+			break;
+		compared = chain;
+
+		/* Copy our tuple into the area, to be linked in on the next round */
+		if (!DsaPointerIsValid(newtuple))
+		{
+			MinimalTuple tuple = ExecCopySlotMinimalTuple(slot);
+			Size		headersize = MAXALIGN(sizeof(SharedTupleHashTuple));
+
+			newtuple = dsa_allocate(hashtable->area,
+									headersize + tuple->t_len);
+			memcpy(STHTUPLE_MINTUPLE(dsa_get_address(hashtable->area,
+													 newtuple)),
+				   tuple, tuple->t_len);
+		}
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return false;
+}
+
+/*
+ * Compare the tuple in 'slot' to the members of a chain of a
+ * SharedTupleHashTable, starting at 'chain' and ending before 'stop'.
+ */
+static bool
+SharedTupleHashChainMatch(SharedTupleHashTable hashtable,
+						  TupleTableSlot *slot,
+						  dsa_pointer chain, dsa_pointer stop)
+{
+	ExprContext *econtext = hashtable->exprcontext;
+
+	while (chain != stop)
+	{
+		SharedTupleHashTuple *sthtup;
+
+		sthtup = dsa_get_address(hashtable->area, chain);
+		ExecStoreMinimalTuple(STHTUPLE_MINTUPLE(sthtup),
+							  hashtable->tableslot, false);
+
+		econtext->ecxt_innertuple = slot;
+		econtext->ecxt_outertuple = hashtable->tableslot;
+		if (ExecQualAndReset(hashtable->tab_eq_func, econtext))
+			return true;
+
+		chain = sthtup->next;
+	}
+
+	return false;
+}
+
+/*
+ * Hash function for SharedTupleHashTable entries.  The key is the hash value
+ * that LookupSharedTupleHashEntry computed from the key columns.
+ */
+static uint32
+SharedTupleHashTableHash(const void *key, size_t size, void *arg)
+{
+	return *(const uint32 *) key;
+}
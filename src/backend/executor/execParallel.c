@@ -36,6 +36,9 @@
 #include "executor/nodeIndexonlyscan.h"
 #include "executor/nodeSeqscan.h"
 #include "executor/nodeSort.h"
+#include "executor/nodeUnique.h"
+#include "executor/nodeSubplan.h"
+#include "executor/nodeWindowAgg.h"
 #include "executor/tqueue.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/planmain.h"
@@ -53,6 +56,19 @@
  * Magic numbers for parallel executor communication.  We use constants
  * greater than any 32-bit integer here so that values < 2^32 can be used
  * by individual parallel nodes to store their own state.
+ *
+ * The keys of the DSM table of contents are laid out as follows:
+ *
+ *	plan_node_id					per-node state of parallel-aware nodes,
+ *									or their instrumentation
+ *	0xE000000000000001 ..			the constants below
+ *	0xE000000100000000 | node id	parallel-aware Sort (nodeSort.c), whose
+ *									plan_node_id holds its statistics
+ *	0xE000000200000000 | plan_id	shared rows of a hashed SubPlan
+ *									(nodeSubplan.c)
+ *
+ * Any other node needing more than one key should take the next free
+ * 0xE000000n00000000 prefix, and be listed here.
  */
 #define PARALLEL_KEY_EXECUTOR_FIXED		UINT64CONST(0xE000000000000001)
 #define PARALLEL_KEY_PLANNEDSTMT		UINT64CONST(0xE000000000000002)
@@ -225,6 +241,8 @@ ExecSerializePlan(Plan *plan, EState *estate)
 static bool
 ExecParallelEstimate(PlanState *planstate, ExecParallelEstimateContext *e)
 {
+	ListCell   *lc;
+
 	if (planstate == NULL)
 		return false;
 
@@ -281,11 +299,25 @@ ExecParallelEstimate(PlanState *planstate, ExecParallelEstimateContext *e)
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecSortEstimate((SortState *) planstate, e->pcxt);
 			break;
+		case T_WindowAggState:
+			if (planstate->plan->parallel_aware)
+				ExecWindowAggEstimate((WindowAggState *) planstate,
+									  e->pcxt);
+			break;
+		case T_UniqueState:
+			if (planstate->plan->parallel_aware)
+				ExecUniqueEstimate((UniqueState *) planstate,
+								   e->pcxt);
+			break;
 
 		default:
 			break;
 	}
 
+	/* Hashed subplans in this node's expressions may need shared state */
+	foreach(lc, planstate->subPlan)
+		ExecSubPlanEstimate((SubPlanState *) lfirst(lc), e->pcxt);
+
 	return planstate_tree_walker(planstate, ExecParallelEstimate, e);
 }
 
@@ -424,6 +456,8 @@ static bool
 ExecParallelInitializeDSM(PlanState *planstate,
 						  ExecParallelInitializeDSMContext *d)
 {
+	ListCell   *lc;
+
 	if (planstate == NULL)
 		return false;
 
@@ -494,11 +528,24 @@ ExecParallelInitializeDSM(PlanState *planstate,
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecSortInitializeDSM((SortState *) planstate, d->pcxt);
 			break;
+		case T_WindowAggState:
+			if (planstate->plan->parallel_aware)
+				ExecWindowAggInitializeDSM((WindowAggState *) planstate,
+										   d->pcxt);
+			break;
+		case T_UniqueState:
+			if (planstate->plan->parallel_aware)
+				ExecUniqueInitializeDSM((UniqueState *) planstate,
+										d->pcxt);
+			break;
 
 		default:
 			break;
 	}
 
+	foreach(lc, planstate->subPlan)
+		ExecSubPlanInitializeDSM((SubPlanState *) lfirst(lc), d->pcxt);
+
 	return planstate_tree_walker(planstate, ExecParallelInitializeDSM, d);
 }
 
@@ -916,9 +963,22 @@ ExecParallelReInitializeDSM(PlanState *planstate,
 				ExecHashJoinReInitializeDSM((HashJoinState *) planstate,
 											pcxt);
 			break;
-		case T_HashState:
 		case T_SortState:
-			/* these nodes have DSM state, but no reinitialization is required */
+			if (planstate->plan->parallel_aware)
+				ExecSortReInitializeDSM((SortState *) planstate, pcxt);
+			break;
+		case T_WindowAggState:
+			if (planstate->plan->parallel_aware)
+				ExecWindowAggReInitializeDSM((WindowAggState *) planstate,
+											 pcxt);
+			break;
+		case T_UniqueState:
+			if (planstate->plan->parallel_aware)
+				ExecUniqueReInitializeDSM((UniqueState *) planstate,
+										  pcxt);
+			break;
+		case T_HashState:
+			/* this node has DSM state, but no reinitialization is required */
 			break;
 
 		default:
@@ -1137,9 +1197,14 @@ ExecParallelReportInstrumentation(PlanState *planstate,
 								  SharedExecutorInstrumentation *instrumentation)
 {
 	int			i;
-	int			plan_node_id = planstate->plan->plan_node_id;
+	int			plan_node_id;
 	Instrumentation *instrument;
 
+	/* the plan of a subplan computed by the leader isn't initialized here */
+	if (planstate == NULL)
+		return false;
+	plan_node_id = planstate->plan->plan_node_id;
+
 	InstrEndLoop(planstate->instrument);
 
 	/*
@@ -1176,6 +1241,8 @@ ExecParallelReportInstrumentation(PlanState *planstate,
 static bool
 ExecParallelInitializeWorker(PlanState *planstate, ParallelWorkerContext *pwcxt)
 {
+	ListCell   *lc;
+
 	if (planstate == NULL)
 		return false;
 
@@ -1227,11 +1294,24 @@ ExecParallelInitializeWorker(PlanState *planstate, ParallelWorkerContext *pwcxt)
 			/* even when not parallel-aware, for EXPLAIN ANALYZE */
 			ExecSortInitializeWorker((SortState *) planstate, pwcxt);
 			break;
+		case T_WindowAggState:
+			if (planstate->plan->parallel_aware)
+				ExecWindowAggInitializeWorker((WindowAggState *) planstate,
+											  pwcxt);
+			break;
+		case T_UniqueState:
+			if (planstate->plan->parallel_aware)
+				ExecUniqueInitializeWorker((UniqueState *) planstate,
+										   pwcxt);
+			break;
 
 		default:
 			break;
 	}
 
+	foreach(lc, planstate->subPlan)
+		ExecSubPlanInitializeWorker((SubPlanState *) lfirst(lc), pwcxt);
+
 	return planstate_tree_walker(planstate, ExecParallelInitializeWorker,
 								 pwcxt);
 }
@@ -57,6 +57,8 @@
 
 #include "postgres.h"
 
+#include "access/relscan.h"
+#include "access/tableam.h"
 #include "executor/execdebug.h"
 #include "executor/execPartition.h"
 #include "executor/nodeAppend.h"
@@ -85,6 +87,8 @@ static bool choose_next_subplan_locally(AppendState *node);
 static bool choose_next_subplan_for_leader(AppendState *node);
 static bool choose_next_subplan_for_worker(AppendState *node);
 static void mark_invalid_subplans_as_finished(AppendState *node);
+static bool subplan_remaining_blocks(PlanState *subnode, BlockNumber *nblocks);
+static int	choose_partial_subplan_to_steal(AppendState *node, int whichplan);
 
 /* ----------------------------------------------------------------
  *		ExecInitAppend
@@ -594,6 +598,13 @@ choose_next_subplan_for_leader(AppendState *node)
  *		partial plan.  This assigns the non-partial plans first in
  *		order of descending cost and then spreads out the workers
  *		as evenly as possible across the remaining partial plans.
+ *
+ *		Once we are handing out partial plans, a worker that has run
+ *		out of work is sent to whichever partial plan has the most
+ *		blocks left to scan, so that it helps finish a large partition
+ *		rather than idling next to one worker grinding through it.
+ *		Partial scans hand out blocks one at a time, so any number of
+ *		workers can join such a plan late and still share its work.
  * ----------------------------------------------------------------
  */
 static bool
@@ -703,15 +714,83 @@ choose_next_subplan_for_worker(AppendState *node)
 		}
 	}
 
-	/* If non-partial, immediately mark as finished. */
+	/*
+	 * If non-partial, immediately mark as finished.  Otherwise, see whether
+	 * some other partial plan needs our help more.
+	 */
 	if (node->as_whichplan < node->as_first_partial_plan)
 		node->as_pstate->pa_finished[node->as_whichplan] = true;
+	else
+		node->as_whichplan = choose_partial_subplan_to_steal(node,
+															 node->as_whichplan);
 
 	LWLockRelease(&pstate->pa_lock);
 
 	return true;
 }
 
+/*
+ * subplan_remaining_blocks
+ *		Report how many blocks a partial subplan has yet to hand out.
+ *
+ * Returns false if we can't tell, which is the case for anything other than
+ * a parallel sequential scan on a table whose access method keeps track.
+ */
+static bool
+subplan_remaining_blocks(PlanState *subnode, BlockNumber *nblocks)
+{
+	if (IsA(subnode, SeqScanState))
+	{
+		HeapScanDesc scandesc = ((SeqScanState *) subnode)->ss.ss_currentScanDesc;
+
+		if (scandesc != NULL && scandesc->rs_parallel != NULL)
+			return table_parallelscan_remaining(scandesc->rs_rd,
+												scandesc->rs_parallel,
+												nblocks);
+	}
+
+	return false;
+}
+
+/*
+ * choose_partial_subplan_to_steal
+ *		Given the partial plan picked by round-robin, return the unfinished
+ *		partial plan with the most blocks left to scan.
+ *
+ * We only move away from whichplan when we know how much work it has left
+ * and some other plan has strictly more; plans whose remaining work is
+ * unknown are left to the round-robin order.  Caller must hold pa_lock.
+ */
+static int
+choose_partial_subplan_to_steal(AppendState *node, int whichplan)
+{
+	ParallelAppendState *pstate = node->as_pstate;
+	BlockNumber bestblocks;
+	int			bestplan = whichplan;
+	int			i;
+
+	if (!subplan_remaining_blocks(node->appendplans[whichplan], &bestblocks))
+		return whichplan;
+
+	i = node->as_first_partial_plan - 1;
+	while ((i = bms_next_member(node->as_valid_subplans, i)) >= 0)
+	{
+		BlockNumber nblocks;
+
+		if (i == whichplan || pstate->pa_finished[i])
+			continue;
+
+		if (subplan_remaining_blocks(node->appendplans[i], &nblocks) &&
+			nblocks > bestblocks)
+		{
+			bestplan = i;
+			bestblocks = nblocks;
+		}
+	}
+
+	return bestplan;
+}
+
 /*
  * mark_invalid_subplans_as_finished
  *		Marks the ParallelAppendState's pa_finished as true for each invalid
@@ -73,8 +73,16 @@ ExecInitGather(Gather *node, EState *estate, int eflags)
 	gatherstate->ps.ExecProcNode = ExecGather;
 
 	gatherstate->initialized = false;
-	gatherstate->need_to_scan_locally =
-		!node->single_copy && parallel_leader_participation;
+
+	/*
+	 * A parallel-aware Sort leaves it to the leader to merge the runs written
+	 * by the workers, so in that case the leader must run the plan whether or
+	 * not parallel_leader_participation is set.
+	 */
+	gatherstate->leader_merges = IsA(outerPlan(node), Sort) &&
+		outerPlan(node)->parallel_aware;
+	gatherstate->need_to_scan_locally = !node->single_copy &&
+		(parallel_leader_participation || gatherstate->leader_merges);
 	gatherstate->tuples_needed = -1;
 
 	/*
@@ -187,9 +195,13 @@ ExecGather(PlanState *pstate)
 			node->nextreader = 0;
 		}
 
-		/* Run plan locally if no workers or enabled and not single-copy. */
+		/*
+		 * Run plan locally if no workers, or if enabled or required and not
+		 * single-copy.
+		 */
 		node->need_to_scan_locally = (node->nreaders == 0)
-			|| (!gather->single_copy && parallel_leader_participation);
+			|| (!gather->single_copy &&
+				(parallel_leader_participation || node->leader_merges));
 		node->initialized = true;
 	}
 
@@ -138,7 +138,7 @@ static void
 MultiExecPrivateHash(HashState *node)
 {
 	PlanState  *outerNode;
-	List	   *hashkeys;
+	ExprState  *hash_expr;
 	HashJoinTable hashtable;
 	TupleTableSlot *slot;
 	ExprContext *econtext;
@@ -153,7 +153,7 @@ MultiExecPrivateHash(HashState *node)
 	/*
 	 * set expression context
 	 */
-	hashkeys = node->hashkeys;
+	hash_expr = node->hash_expr;
 	econtext = node->ps.ps_ExprContext;
 
 	/*
@@ -166,9 +166,7 @@ MultiExecPrivateHash(HashState *node)
 			break;
 		/* We have to compute the hash value */
 		econtext->ecxt_innertuple = slot;
-		if (ExecHashGetHashValue(hashtable, econtext, hashkeys,
-								 false, hashtable->keepNulls,
-								 &hashvalue))
+		if (ExecHashGetHashValue(hash_expr, econtext, &hashvalue))
 		{
 			int			bucketNumber;
 
@@ -214,7 +212,7 @@ MultiExecParallelHash(HashState *node)
 {
 	ParallelHashJoinState *pstate;
 	PlanState  *outerNode;
-	List	   *hashkeys;
+	ExprState  *hash_expr;
 	HashJoinTable hashtable;
 	TupleTableSlot *slot;
 	ExprContext *econtext;
@@ -231,7 +229,7 @@ MultiExecParallelHash(HashState *node)
 	/*
 	 * set expression context
 	 */
-	hashkeys = node->hashkeys;
+	hash_expr = node->hash_expr;
 	econtext = node->ps.ps_ExprContext;
 
 	/*
@@ -282,9 +280,7 @@ MultiExecParallelHash(HashState *node)
 				if (TupIsNull(slot))
 					break;
 				econtext->ecxt_innertuple = slot;
-				if (ExecHashGetHashValue(hashtable, econtext, hashkeys,
-										 false, hashtable->keepNulls,
-										 &hashvalue))
+				if (ExecHashGetHashValue(hash_expr, econtext, &hashvalue))
 					ExecParallelHashTableInsert(hashtable, slot, hashvalue);
 				hashtable->partialTuples++;
 			}
@@ -364,7 +360,7 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->ps.state = estate;
 	hashstate->ps.ExecProcNode = ExecHash;
 	hashstate->hashtable = NULL;
-	hashstate->hashkeys = NIL;	/* will be set by parent HashJoin */
+	hashstate->hash_expr = NULL;	/* will be set by parent HashJoin */
 
 	/*
 	 * Miscellaneous initialization
@@ -532,15 +528,12 @@ ExecHashTableCreate(HashState *state, List *hashOperators, bool keepNulls)
 	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
 
 	/*
-	 * Get info about the hash functions to be used for each hash key. Also
-	 * remember whether the join operators are strict.
+	 * Get info about the hash functions to be used for the outer side of each
+	 * hash key, for the skew optimization.
 	 */
 	nkeys = list_length(hashOperators);
 	hashtable->outer_hashfunctions =
 		(FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
-	hashtable->inner_hashfunctions =
-		(FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
-	hashtable->hashStrict = (bool *) palloc(nkeys * sizeof(bool));
 	i = 0;
 	foreach(ho, hashOperators)
 	{
@@ -552,8 +545,6 @@ ExecHashTableCreate(HashState *state, List *hashOperators, bool keepNulls)
 			elog(ERROR, "could not find hash function for hash operator %u",
 				 hashop);
 		fmgr_info(left_hashfn, &hashtable->outer_hashfunctions[i]);
-		fmgr_info(right_hashfn, &hashtable->inner_hashfunctions[i]);
-		hashtable->hashStrict[i] = op_strict(hashop);
 		i++;
 	}
 
@@ -1759,27 +1750,23 @@ ExecParallelHashTableInsertCurrentBatch(HashJoinTable hashtable,
  *		Compute the hash value for a tuple
  *
  * The tuple to be tested must be in either econtext->ecxt_outertuple or
- * econtext->ecxt_innertuple.  Vars in the hashkeys expressions should have
- * varno either OUTER_VAR or INNER_VAR.
+ * econtext->ecxt_innertuple.  hash_expr is the expression built by
+ * ExecBuildHash32Expr for the hash keys of that side of the join; Vars in it
+ * should have varno either OUTER_VAR or INNER_VAR.
  *
  * A true result means the tuple's hash value has been successfully computed
  * and stored at *hashvalue.  A false result means the tuple cannot match
  * because it contains a null attribute, and hence it should be discarded
- * immediately.  (If keep_nulls is true then false is never returned.)
+ * immediately.  (If hash_expr was built with keep_nulls then false is never
+ * returned.)
  */
 bool
-ExecHashGetHashValue(HashJoinTable hashtable,
+ExecHashGetHashValue(ExprState *hash_expr,
 					 ExprContext *econtext,
-					 List *hashkeys,
-					 bool outer_tuple,
-					 bool keep_nulls,
 					 uint32 *hashvalue)
 {
-	uint32		hashkey = 0;
-	FmgrInfo   *hashfunctions;
-	ListCell   *hk;
-	int			i = 0;
-	MemoryContext oldContext;
+	Datum		hashdatum;
+	bool		isnull;
 
 	/*
 	 * We reset the eval context each time to reclaim any memory leaked in the
@@ -1787,64 +1774,13 @@ ExecHashGetHashValue(HashJoinTable hashtable,
 	 */
 	ResetExprContext(econtext);
 
-	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
-
-	if (outer_tuple)
-		hashfunctions = hashtable->outer_hashfunctions;
-	else
-		hashfunctions = hashtable->inner_hashfunctions;
-
-	foreach(hk, hashkeys)
-	{
-		ExprState  *keyexpr = (ExprState *) lfirst(hk);
-		Datum		keyval;
-		bool		isNull;
-
-		/* rotate hashkey left 1 bit at each step */
-		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
-
-		/*
-		 * Get the join attribute value of the tuple
-		 */
-		keyval = ExecEvalExpr(keyexpr, econtext, &isNull);
-
-		/*
-		 * If the attribute is NULL, and the join operator is strict, then
-		 * this tuple cannot pass the join qual so we can reject it
-		 * immediately (unless we're scanning the outside of an outer join, in
-		 * which case we must not reject it).  Otherwise we act like the
-		 * hashcode of NULL is zero (this will support operators that act like
-		 * IS NOT DISTINCT, though not any more-random behavior).  We treat
-		 * the hash support function as strict even if the operator is not.
-		 *
-		 * Note: currently, all hashjoinable operators must be strict since
-		 * the hash index AM assumes that.  However, it takes so little extra
-		 * code here to allow non-strict that we may as well do it.
-		 */
-		if (isNull)
-		{
-			if (hashtable->hashStrict[i] && !keep_nulls)
-			{
-				MemoryContextSwitchTo(oldContext);
-				return false;	/* cannot match */
-			}
-			/* else, leave hashkey unmodified, equivalent to hashcode 0 */
-		}
-		else
-		{
-			/* Compute the hash function */
-			uint32		hkey;
-
-			hkey = DatumGetUInt32(FunctionCall1(&hashfunctions[i], keyval));
-			hashkey ^= hkey;
-		}
-
-		i++;
-	}
+	hashdatum = ExecEvalExprSwitchContext(hash_expr, econtext, &isnull);
 
-	MemoryContextSwitchTo(oldContext);
+	/* a NULL result means a NULL key with a strict operator; cannot match */
+	if (isnull)
+		return false;
 
-	*hashvalue = hashkey;
+	*hashvalue = DatumGetUInt32(hashdatum);
 	return true;
 }
 
@@ -114,6 +114,7 @@
 #include "executor/nodeHashjoin.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/sharedtuplestore.h"
 
@@ -596,9 +597,14 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	List	   *lclauses;
 	List	   *rclauses;
 	List	   *hoperators;
+	Oid		   *outer_hashfuncids;
+	Oid		   *inner_hashfuncids;
+	bool	   *hash_strict;
 	TupleDesc	outerDesc,
 				innerDesc;
 	ListCell   *l;
+	int			nkeys;
+	int			i;
 
 	/* check for unsupported flags */
 	Assert(!(eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)));
@@ -719,29 +725,50 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_CurTuple = NULL;
 
 	/*
-	 * Deconstruct the hash clauses into outer and inner argument values, so
-	 * that we can evaluate those subexpressions separately.  Also make a list
-	 * of the hash operator OIDs, in preparation for looking up the hash
-	 * functions to use.
+	 * Deconstruct the hash clauses into outer and inner argument values, and
+	 * look up the hash functions and strictness of their operators.  Also
+	 * make a list of the hash operator OIDs, for the hash table.
 	 */
+	nkeys = list_length(node->hashclauses);
+	outer_hashfuncids = (Oid *) palloc(nkeys * sizeof(Oid));
+	inner_hashfuncids = (Oid *) palloc(nkeys * sizeof(Oid));
+	hash_strict = (bool *) palloc(nkeys * sizeof(bool));
+
 	lclauses = NIL;
 	rclauses = NIL;
 	hoperators = NIL;
+	i = 0;
 	foreach(l, node->hashclauses)
 	{
 		OpExpr	   *hclause = lfirst_node(OpExpr, l);
 
-		lclauses = lappend(lclauses, ExecInitExpr(linitial(hclause->args),
-												  (PlanState *) hjstate));
-		rclauses = lappend(rclauses, ExecInitExpr(lsecond(hclause->args),
-												  (PlanState *) hjstate));
+		if (!get_op_hash_functions(hclause->opno,
+								   &outer_hashfuncids[i],
+								   &inner_hashfuncids[i]))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hclause->opno);
+		hash_strict[i] = op_strict(hclause->opno);
+
+		lclauses = lappend(lclauses, linitial(hclause->args));
+		rclauses = lappend(rclauses, lsecond(hclause->args));
 		hoperators = lappend_oid(hoperators, hclause->opno);
+		i++;
 	}
-	hjstate->hj_OuterHashKeys = lclauses;
-	hjstate->hj_InnerHashKeys = rclauses;
 	hjstate->hj_HashOperators = hoperators;
+
+	/*
+	 * Build the expressions computing the hash value of an outer and an inner
+	 * tuple.  Evaluating each of them as a single expression, rather than key
+	 * by key, lets the whole computation be JIT compiled.  NULL keys are kept
+	 * for the side of the join whose unmatched tuples must be emitted.
+	 */
+	hjstate->hj_OuterHash =
+		ExecBuildHash32Expr(lclauses, outer_hashfuncids, hash_strict,
+							HJ_FILL_OUTER(hjstate), (PlanState *) hjstate);
 	/* child Hash node needs to evaluate inner hash keys, too */
-	((HashState *) innerPlanState(hjstate))->hashkeys = rclauses;
+	((HashState *) innerPlanState(hjstate))->hash_expr =
+		ExecBuildHash32Expr(rclauses, inner_hashfuncids, hash_strict,
+							HJ_FILL_INNER(hjstate), (PlanState *) hjstate);
 
 	hjstate->hj_JoinState = HJ_BUILD_HASHTABLE;
 	hjstate->hj_MatchedOuter = false;
@@ -828,10 +855,7 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 			ExprContext *econtext = hjstate->js.ps.ps_ExprContext;
 
 			econtext->ecxt_outertuple = slot;
-			if (ExecHashGetHashValue(hashtable, econtext,
-									 hjstate->hj_OuterHashKeys,
-									 true,	/* outer tuple */
-									 HJ_FILL_OUTER(hjstate),
+			if (ExecHashGetHashValue(hjstate->hj_OuterHash, econtext,
 									 hashvalue))
 			{
 				/* remember outer relation is not empty for possible rescan */
@@ -896,10 +920,7 @@ ExecParallelHashJoinOuterGetTuple(PlanState *outerNode,
 			ExprContext *econtext = hjstate->js.ps.ps_ExprContext;
 
 			econtext->ecxt_outertuple = slot;
-			if (ExecHashGetHashValue(hashtable, econtext,
-									 hjstate->hj_OuterHashKeys,
-									 true,	/* outer tuple */
-									 HJ_FILL_OUTER(hjstate),
+			if (ExecHashGetHashValue(hjstate->hj_OuterHash, econtext,
 									 hashvalue))
 				return slot;
 
@@ -1392,10 +1413,7 @@ ExecParallelHashJoinPartitionOuter(HashJoinState *hjstate)
 		if (TupIsNull(slot))
 			break;
 		econtext->ecxt_outertuple = slot;
-		if (ExecHashGetHashValue(hashtable, econtext,
-								 hjstate->hj_OuterHashKeys,
-								 true,	/* outer tuple */
-								 false, /* outer join, currently unsupported */
+		if (ExecHashGetHashValue(hjstate->hj_OuterHash, econtext,
 								 &hashvalue))
 		{
 			int			batchno;
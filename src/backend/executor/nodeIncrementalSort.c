@@ -0,0 +1,457 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to handle incremental sorting of relations.
+ *
+ * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ * DESCRIPTION
+ *
+ *	Incremental sort is an optimized variant of multikey sort for cases
+ *	when the input is already sorted by a prefix of the sort keys.  For
+ *	example when a sort by (key1, key2 ... keyN) is requested, and the
+ *	input is already sorted by (key1, key2 ... keyM), M < N, we can
+ *	divide the input into groups where keys (key1, ... keyM) are equal,
+ *	and only sort on the remaining columns.
+ *
+ *	Consider the following example.  We have input tuples consisting of
+ *	two integers (X, Y) already presorted by X, while it's required to
+ *	sort them by both X and Y.  Let input tuples be following.
+ *
+ *	(1, 5)
+ *	(1, 2)
+ *	(2, 9)
+ *	(2, 1)
+ *	(2, 5)
+ *	(3, 3)
+ *	(3, 7)
+ *
+ *	An incremental sort algorithm would split the input into the following
+ *	groups, which have equal X, and then sort them by Y individually:
+ *
+ *		(1, 5) (1, 2)
+ *		(2, 9) (2, 1) (2, 5)
+ *		(3, 3) (3, 7)
+ *
+ *	After sorting these groups and putting them altogether, we would get
+ *	the following result which is sorted by X and Y, as requested:
+ *
+ *	(1, 2)
+ *	(1, 5)
+ *	(2, 1)
+ *	(2, 5)
+ *	(2, 9)
+ *	(3, 3)
+ *	(3, 7)
+ *
+ *	Incremental sort may be more efficient than plain sort, particularly
+ *	on large datasets, as it reduces the amount of data to sort at once,
+ *	making it more likely it fits into work_mem (eliminating the need to
+ *	spill to disk).  But the main advantage of incremental sort is that it
+ *	can start producing rows early, before sorting the whole dataset,
+ *	which is a significant benefit especially for queries with LIMIT.
+ *
+ *	Setting up a tuplesort for each group separately would be expensive
+ *	when the groups are tiny, so we collect at least MIN_BATCH_SIZE tuples
+ *	into each sort batch and then keep reading until the presorted columns
+ *	change.  Since each batch therefore consists of complete groups, sorting
+ *	it by all the sort keys gives the right answer.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/tuplesort.h"
+
+/*
+ * Minimum number of tuples collected into a single sort batch.  Once a
+ * batch holds this many tuples, it is closed at the next change of the
+ * presorted columns.
+ */
+#define MIN_BATCH_SIZE 32
+
+
+/*
+ * Prepare the comparators used to detect the boundaries between groups of
+ * tuples that are equal on the presorted columns.
+ */
+static void
+preparePresortedKeys(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	int			nPresortedCols = plannode->nPresortedCols;
+	int			i;
+
+	Assert(nPresortedCols > 0 && nPresortedCols < plannode->sort.numCols);
+
+	node->presorted_keys = (SortSupport)
+		palloc0(nPresortedCols * sizeof(SortSupportData));
+
+	for (i = 0; i < nPresortedCols; i++)
+	{
+		SortSupport ssup = node->presorted_keys + i;
+
+		ssup->ssup_cxt = CurrentMemoryContext;
+		ssup->ssup_collation = plannode->sort.collations[i];
+		ssup->ssup_nulls_first = plannode->sort.nullsFirst[i];
+		ssup->ssup_attno = plannode->sort.sortColIdx[i];
+
+		/* we only ever compare full datums here */
+		ssup->abbreviate = false;
+
+		PrepareSortSupportFromOrderingOp(plannode->sort.sortOperators[i],
+										 ssup);
+	}
+}
+
+/*
+ * Check whether a given tuple belongs to the same group as the pivot tuple,
+ * that is, whether both are equal on all the presorted columns.
+ */
+static bool
+isCurrentGroup(IncrementalSortState *node,
+			   TupleTableSlot *pivot, TupleTableSlot *tuple)
+{
+	int			nPresortedCols;
+	int			i;
+
+	nPresortedCols = ((IncrementalSort *) node->ss.ps.plan)->nPresortedCols;
+
+	/*
+	 * The input is sorted by the presorted columns, so the last of them is
+	 * the most likely to differ.  Compare in reverse order to detect a group
+	 * boundary as early as possible.
+	 */
+	for (i = nPresortedCols - 1; i >= 0; i--)
+	{
+		SortSupport ssup = node->presorted_keys + i;
+		Datum		datumA,
+					datumB;
+		bool		isnullA,
+					isnullB;
+
+		datumA = slot_getattr(pivot, ssup->ssup_attno, &isnullA);
+		datumB = slot_getattr(tuple, ssup->ssup_attno, &isnullB);
+
+		if (ApplySortComparator(datumA, isnullA, datumB, isnullB, ssup) != 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Read the next batch of tuples from the outer plan and sort it.
+ *
+ * A batch starts with the tuple that ended the previous one, if any, and
+ * extends to the end of the prefix group current when MIN_BATCH_SIZE
+ * tuples have been collected.  The first tuple of the following group is
+ * kept in transfer_tuple for the next batch.
+ */
+static void
+loadBatch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	TupleDesc	tupDesc = ExecGetResultType(outerNode);
+	Tuplesortstate *sortstate;
+	int64		nTuples = 0;
+
+	SO1_printf("ExecIncrementalSort: %s\n",
+			   "loading next batch");
+
+	sortstate = tuplesort_begin_heap(tupDesc,
+									 plannode->sort.numCols,
+									 plannode->sort.sortColIdx,
+									 plannode->sort.sortOperators,
+									 plannode->sort.collations,
+									 plannode->sort.nullsFirst,
+									 work_mem,
+									 NULL, false);
+
+	/* Only as many tuples as are still needed can come out of this batch */
+	if (node->bounded)
+		tuplesort_set_bound(sortstate, node->bound - node->n_outputted);
+
+	if (node->have_transfer)
+	{
+		tuplesort_puttupleslot(sortstate, node->transfer_tuple);
+		ExecClearTuple(node->transfer_tuple);
+		node->have_transfer = false;
+		nTuples++;
+	}
+
+	while (!node->outerNodeDone)
+	{
+		TupleTableSlot *slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->outerNodeDone = true;
+			break;
+		}
+
+		if (nTuples < MIN_BATCH_SIZE)
+		{
+			tuplesort_puttupleslot(sortstate, slot);
+			nTuples++;
+
+			/* remember a tuple of the group the batch will be closed on */
+			if (nTuples == MIN_BATCH_SIZE)
+				ExecCopySlot(node->group_pivot, slot);
+			continue;
+		}
+
+		if (!isCurrentGroup(node, node->group_pivot, slot))
+		{
+			/* first tuple of a new group; it starts the next batch */
+			ExecCopySlot(node->transfer_tuple, slot);
+			node->have_transfer = true;
+			break;
+		}
+
+		tuplesort_puttupleslot(sortstate, slot);
+		nTuples++;
+	}
+
+	tuplesort_performsort(sortstate);
+
+	if (node->ss.ps.instrument != NULL)
+	{
+		IncrementalSortInfo *info = &node->incsort_info;
+		TuplesortInstrumentation stats;
+
+		tuplesort_get_stats(sortstate, &stats);
+		info->groupCount++;
+		info->sortMethods |= (1 << stats.sortMethod);
+
+		/* disk usage is considered more interesting than memory usage */
+		if (info->groupCount == 1 ||
+			(stats.spaceType == info->maxSpaceType &&
+			 stats.spaceUsed > info->maxSpaceUsed) ||
+			(stats.spaceType == SORT_SPACE_TYPE_DISK &&
+			 info->maxSpaceType != SORT_SPACE_TYPE_DISK))
+		{
+			info->maxSpaceUsed = stats.spaceUsed;
+			info->maxSpaceType = stats.spaceType;
+		}
+	}
+
+	node->sortstate = (void *) sortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Returns the next tuple in sort order.  Tuples are read from the
+ *		outer plan and sorted one batch at a time; a new batch is only
+ *		loaded once all the tuples of the current one have been returned.
+ *
+ *		Conditions:
+ *		  -- the outer plan returns tuples sorted by the first
+ *			 nPresortedCols sort keys.
+ *
+ *		Initial States:
+ *		  -- the outer child is prepared to return the first tuple.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecIncrementalSort(PlanState *pstate)
+{
+	IncrementalSortState *node = castNode(IncrementalSortState, pstate);
+	EState	   *estate = node->ss.ps.state;
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+	ScanDirection dir;
+
+	CHECK_FOR_INTERRUPTS();
+
+	/* Backward scans are not supported, see ExecSupportsBackwardScan */
+	Assert(ScanDirectionIsForward(estate->es_direction));
+
+	for (;;)
+	{
+		/*
+		 * Return the next tuple of the current batch, if there is one.  Note
+		 * that we only rely on the slot tuple remaining valid until the next
+		 * fetch from the tuplesort.
+		 */
+		if (node->sortstate != NULL)
+		{
+			if (tuplesort_gettupleslot((Tuplesortstate *) node->sortstate,
+									   true, false, slot, NULL))
+			{
+				node->n_outputted++;
+				return slot;
+			}
+
+			/* Batch exhausted; the slot no longer points into it */
+			tuplesort_end((Tuplesortstate *) node->sortstate);
+			node->sortstate = NULL;
+		}
+
+		/* Stop if the input is used up or we produced all that's needed */
+		if ((node->outerNodeDone && !node->have_transfer) ||
+			(node->bounded && node->n_outputted >= node->bound))
+			return ExecClearTuple(slot);
+
+		/* Scan the subplan in the forward direction while loading */
+		dir = estate->es_direction;
+		estate->es_direction = ForwardScanDirection;
+		loadBatch(node);
+		estate->es_direction = dir;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental sort
+ *		node produced by the planner and initializes its outer subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *incrsortstate;
+	TupleDesc	outerTupDesc;
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "initializing sort node");
+
+	/*
+	 * Incremental sort can't be used with EXEC_FLAG_BACKWARD or
+	 * EXEC_FLAG_MARK, because the current batch is all it keeps.
+	 */
+	Assert((eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) == 0);
+
+	/*
+	 * create state structure
+	 */
+	incrsortstate = makeNode(IncrementalSortState);
+	incrsortstate->ss.ps.plan = (Plan *) node;
+	incrsortstate->ss.ps.state = estate;
+	incrsortstate->ss.ps.ExecProcNode = ExecIncrementalSort;
+
+	incrsortstate->bounded = false;
+	incrsortstate->outerNodeDone = false;
+	incrsortstate->have_transfer = false;
+	incrsortstate->n_outputted = 0;
+	incrsortstate->sortstate = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * Sort nodes don't initialize their ExprContexts because they never call
+	 * ExecQual or ExecProject.
+	 */
+
+	/*
+	 * initialize child nodes
+	 *
+	 * The child is re-executed on rescan, so it needn't support anything
+	 * beyond that.
+	 */
+	eflags &= ~(EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
+
+	outerPlanState(incrsortstate) = ExecInitNode(outerPlan(node), estate, eflags);
+
+	/*
+	 * Initialize scan slot and type.
+	 */
+	ExecCreateScanSlotFromOuterPlan(estate, &incrsortstate->ss);
+
+	/*
+	 * Initialize return slot and type. No need to initialize projection info
+	 * because this node doesn't do projections.
+	 */
+	ExecInitResultTupleSlotTL(estate, &incrsortstate->ss.ps);
+	incrsortstate->ss.ps.ps_ProjInfo = NULL;
+
+	/*
+	 * Slots holding copies of input tuples: one to compare against for group
+	 * boundary detection, and one to carry a tuple over to the next batch.
+	 */
+	outerTupDesc = ExecGetResultType(outerPlanState(incrsortstate));
+	incrsortstate->group_pivot = ExecInitExtraTupleSlot(estate, outerTupDesc);
+	incrsortstate->transfer_tuple = ExecInitExtraTupleSlot(estate,
+														   outerTupDesc);
+
+	preparePresortedKeys(incrsortstate);
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "sort node initialized");
+
+	return incrsortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "shutting down sort node");
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->sortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->sortstate);
+	node->sortstate = NULL;
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "sort node shutdown");
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/*
+	 * Incremental sort doesn't keep its whole output, so there is nothing to
+	 * rewind: forget the current batch and start over from the input.
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	if (node->sortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->sortstate);
+	node->sortstate = NULL;
+
+	node->outerNodeDone = false;
+	node->have_transfer = false;
+	node->n_outputted = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
@@ -354,6 +354,13 @@ ExecReScanIndexOnlyScan(IndexOnlyScanState *node)
 	}
 	node->ioss_RuntimeKeysReady = true;
 
+	/* go back to the regular scan, if ExecIndexOnlySkipTo switched away */
+	if (node->ioss_PlainScanDesc)
+	{
+		node->ioss_ScanDesc = node->ioss_PlainScanDesc;
+		node->ioss_PlainScanDesc = NULL;
+	}
+
 	/* reset index scan */
 	if (node->ioss_ScanDesc)
 		index_rescan(node->ioss_ScanDesc,
@@ -379,7 +386,8 @@ ExecEndIndexOnlyScan(IndexOnlyScanState *node)
 	 * extract information from the node
 	 */
 	indexRelationDesc = node->ioss_RelationDesc;
-	indexScanDesc = node->ioss_ScanDesc;
+	indexScanDesc = node->ioss_PlainScanDesc ?
+		node->ioss_PlainScanDesc : node->ioss_ScanDesc;
 	relation = node->ss.ss_currentRelation;
 
 	/* Release VM buffer pin, if any. */
@@ -409,6 +417,8 @@ ExecEndIndexOnlyScan(IndexOnlyScanState *node)
 	 */
 	if (indexScanDesc)
 		index_endscan(indexScanDesc);
+	if (node->ioss_SkipScanDesc)
+		index_endscan(node->ioss_SkipScanDesc);
 	if (indexRelationDesc)
 		index_close(indexRelationDesc, NoLock);
 
@@ -483,6 +493,59 @@ ExecIndexOnlyRestrPos(IndexOnlyScanState *node)
 	index_restrpos(node->ioss_ScanDesc);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecIndexOnlySkipTo
+ *
+ *		Reposition a forward scan so that the next tuple returned is the
+ *		first one that also satisfies 'key'.  See ExecIndexSkipTo.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecIndexOnlySkipTo(IndexOnlyScanState *node, ScanKey key)
+{
+	EState	   *estate = node->ss.ps.state;
+	int			nkeys = node->ioss_NumScanKeys;
+	MemoryContext oldcontext;
+
+	if (node->ioss_ScanDesc == NULL ||
+		node->ioss_ScanDesc->parallel_scan != NULL ||
+		node->ioss_NumOrderByKeys > 0 ||
+		estate->es_epqTuple != NULL)
+		return false;
+
+	oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	if (node->ioss_SkipScanDesc == NULL)
+	{
+		node->ioss_SkipScanKeys = (ScanKey)
+			palloc((nkeys + 1) * sizeof(ScanKeyData));
+		node->ioss_SkipScanDesc = index_beginscan(node->ss.ss_currentRelation,
+												  node->ioss_RelationDesc,
+												  estate->es_snapshot,
+												  nkeys + 1,
+												  0);
+		node->ioss_SkipScanDesc->xs_want_itup = true;
+	}
+
+	/* runtime keys may have changed since the last skip */
+	memcpy(node->ioss_SkipScanKeys, node->ioss_ScanKeys,
+		   nkeys * sizeof(ScanKeyData));
+	node->ioss_SkipScanKeys[nkeys] = *key;
+	index_rescan(node->ioss_SkipScanDesc,
+				 node->ioss_SkipScanKeys, nkeys + 1,
+				 NULL, 0);
+
+	if (node->ioss_PlainScanDesc == NULL)
+	{
+		node->ioss_PlainScanDesc = node->ioss_ScanDesc;
+		node->ioss_ScanDesc = node->ioss_SkipScanDesc;
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return true;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitIndexOnlyScan
  *
@@ -598,6 +598,13 @@ ExecReScanIndexScan(IndexScanState *node)
 			reorderqueue_pop(node);
 	}
 
+	/* go back to the regular scan, if ExecIndexSkipTo switched away */
+	if (node->iss_PlainScanDesc)
+	{
+		node->iss_ScanDesc = node->iss_PlainScanDesc;
+		node->iss_PlainScanDesc = NULL;
+	}
+
 	/* reset index scan */
 	if (node->iss_ScanDesc)
 		index_rescan(node->iss_ScanDesc,
@@ -810,7 +817,8 @@ ExecEndIndexScan(IndexScanState *node)
 	 * extract information from the node
 	 */
 	indexRelationDesc = node->iss_RelationDesc;
-	indexScanDesc = node->iss_ScanDesc;
+	indexScanDesc = node->iss_PlainScanDesc ?
+		node->iss_PlainScanDesc : node->iss_ScanDesc;
 	relation = node->ss.ss_currentRelation;
 
 	/*
@@ -833,6 +841,8 @@ ExecEndIndexScan(IndexScanState *node)
 	 */
 	if (indexScanDesc)
 		index_endscan(indexScanDesc);
+	if (node->iss_SkipScanDesc)
+		index_endscan(node->iss_SkipScanDesc);
 	if (indexRelationDesc)
 		index_close(indexRelationDesc, NoLock);
 
@@ -907,6 +917,75 @@ ExecIndexRestrPos(IndexScanState *node)
 	index_restrpos(node->iss_ScanDesc);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecIndexSkipTo
+ *
+ *		Reposition a forward scan so that the next tuple returned is the
+ *		first one that also satisfies 'key', whose sk_attno is an index
+ *		column number.  The caller must know that the tuples skipped that
+ *		way are of no interest, ie. that the scan returns them in order of
+ *		that column.  Unlike reading our way there one tuple at a time,
+ *		the index AM can descend directly to the new starting point.
+ *
+ *		We do that by restarting the scan with the regular scan keys plus
+ *		'key', using a second scan descriptor since the number of keys of
+ *		a scan can't change; ExecReScanIndexScan switches back to the
+ *		regular one.  A position marked before a skip can't be restored
+ *		after it.  Returns false if we can't skip, in which case nothing
+ *		was done.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecIndexSkipTo(IndexScanState *node, ScanKey key)
+{
+	EState	   *estate = node->ss.ps.state;
+	int			nkeys = node->iss_NumScanKeys;
+	MemoryContext oldcontext;
+
+	/*
+	 * We must have started a non-parallel scan, and not be inside an
+	 * EvalPlanQual recheck (see ExecIndexMarkPos).  There's no point in
+	 * skipping when reordering by ORDER BY operators, either.
+	 */
+	if (node->iss_ScanDesc == NULL ||
+		node->iss_ScanDesc->parallel_scan != NULL ||
+		node->iss_NumOrderByKeys > 0 ||
+		estate->es_epqTuple != NULL)
+		return false;
+
+	oldcontext = MemoryContextSwitchTo(estate->es_query_cxt);
+
+	if (node->iss_SkipScanDesc == NULL)
+	{
+		node->iss_SkipScanKeys = (ScanKey)
+			palloc((nkeys + 1) * sizeof(ScanKeyData));
+		node->iss_SkipScanDesc = index_beginscan(node->ss.ss_currentRelation,
+												 node->iss_RelationDesc,
+												 estate->es_snapshot,
+												 nkeys + 1,
+												 0);
+	}
+
+	/* runtime keys may have changed since the last skip */
+	memcpy(node->iss_SkipScanKeys, node->iss_ScanKeys,
+		   nkeys * sizeof(ScanKeyData));
+	node->iss_SkipScanKeys[nkeys] = *key;
+	index_rescan(node->iss_SkipScanDesc,
+				 node->iss_SkipScanKeys, nkeys + 1,
+				 NULL, 0);
+
+	if (node->iss_PlainScanDesc == NULL)
+	{
+		node->iss_PlainScanDesc = node->iss_ScanDesc;
+		node->iss_ScanDesc = node->iss_SkipScanDesc;
+	}
+	node->iss_ReachedEnd = false;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return true;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitIndexScan
  *
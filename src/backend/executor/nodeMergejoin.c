@@ -84,6 +84,14 @@
  *			}
  *		}
  *
+ *		If the inner plan can skip ahead (see ExecSkipTo), we don't advance
+ *		the inner side tuple by tuple for long: after a run of
+ *		MJ_SKIP_AHEAD_THRESHOLD advances, we ask the inner plan to move
+ *		directly to the first tuple whose leading merge key is >= the outer
+ *		tuple's.  For an index scan that's a fresh descent of the index,
+ *		and for a sort done in memory an exponential search.  That makes
+ *		joins whose inputs overlap only sparsely much cheaper.
+ *
  *		The merge join operation is coded in the fashion
  *		of a state machine.  At each state, we do something and then
  *		proceed to another state.  This state is stored in the node's
@@ -96,6 +104,7 @@
 #include "executor/execdebug.h"
 #include "executor/nodeMergejoin.h"
 #include "miscadmin.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 
@@ -115,6 +124,12 @@
 #define EXEC_MJ_ENDOUTER				10
 #define EXEC_MJ_ENDINNER				11
 
+/*
+ * Number of inner tuples we advance over one at a time before asking the
+ * inner plan to skip ahead.
+ */
+#define MJ_SKIP_AHEAD_THRESHOLD			16
+
 /*
  * Runtime data for each mergejoin clause
  */
@@ -445,6 +460,57 @@ MJCompare(MergeJoinState *mergestate)
 }
 
 
+/*
+ * MJSkipInner
+ *
+ * Called when advancing over an inner tuple that is known not to join.  If
+ * the inner side is behind the outer one on the leading merge key, ask the
+ * inner plan to skip ahead to the first tuple whose key is >= the outer
+ * tuple's.  All the tuples in between are of no interest: we're not
+ * filling the inner side, and the outer tuples to come have keys at least
+ * as large.  (If only the later keys put the inner side behind, skipping
+ * would take us back to the start of the current group instead.)
+ *
+ * Returns false if the inner plan can't skip ahead.
+ */
+static bool
+MJSkipInner(MergeJoinState *mergestate)
+{
+	MergeJoinClause clause = &mergestate->mj_Clauses[0];
+	ExprContext *econtext = mergestate->js.ps.ps_ExprContext;
+	MemoryContext oldContext;
+	bool		result = true;
+
+	if (TupIsNull(mergestate->mj_OuterTupleSlot) ||
+		clause->lisnull || clause->risnull)
+		return true;
+
+	/* As in MJCompare, call functions in short-lived context */
+	ResetExprContext(econtext);
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	if (ApplySortComparator(clause->ldatum, false,
+							clause->rdatum, false,
+							&clause->ssup) > 0)
+	{
+		/* The key's argument must survive until the next skip */
+		MemoryContextReset(mergestate->mj_SkipContext);
+		MemoryContextSwitchTo(mergestate->mj_SkipContext);
+		mergestate->mj_SkipKey.sk_argument =
+			datumCopy(clause->ldatum,
+					  mergestate->mj_SkipKeyByVal,
+					  mergestate->mj_SkipKeyLen);
+		MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+		result = ExecSkipTo(innerPlanState(mergestate),
+							&mergestate->mj_SkipKey);
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return result;
+}
+
 /*
  * Generate a fake join tuple with nulls for the inner tuple,
  * and return it if it passes the non-join quals.
@@ -1196,6 +1262,10 @@ ExecMergeJoin(PlanState *pstate)
 				else
 					/* compareResult > 0 */
 					node->mj_JoinState = EXEC_MJ_SKIPINNER_ADVANCE;
+
+				/* a run of inner advances ends unless we go on with it */
+				if (compareResult <= 0)
+					node->mj_InnerSkipCount = 0;
 				break;
 
 				/*
@@ -1289,6 +1359,18 @@ ExecMergeJoin(PlanState *pstate)
 				if (node->mj_ExtraMarks)
 					ExecMarkPos(innerPlan);
 
+				/*
+				 * If we've been advancing over inner tuples for a while, try
+				 * to have the inner plan skip ahead instead.
+				 */
+				if (node->mj_SkipAhead &&
+					++node->mj_InnerSkipCount >= MJ_SKIP_AHEAD_THRESHOLD)
+				{
+					if (!MJSkipInner(node))
+						node->mj_SkipAhead = false; /* don't try again */
+					node->mj_InnerSkipCount = 0;
+				}
+
 				/*
 				 * now we get the next inner tuple, if any
 				 */
@@ -1600,6 +1682,43 @@ ExecInitMergeJoin(MergeJoin *node, EState *estate, int eflags)
 											node->mergeNullsFirst,
 											(PlanState *) mergestate);
 
+	/*
+	 * If the planner found that the inner plan may be able to skip ahead,
+	 * prepare the scan key describing where to skip to, as "inner >= outer"
+	 * on the first merge key.  The planner doesn't allow that when the inner
+	 * side must be null-filled, since we would skip unmatched inner tuples.
+	 */
+	if (OidIsValid(node->mergeSkipOp))
+	{
+		int			strategy;
+		Oid			lefttype;
+		Oid			righttype;
+
+		Assert(!mergestate->mj_FillInner);
+		get_op_opfamily_properties(node->mergeSkipOp,
+								   node->mergeFamilies[0],
+								   false,
+								   &strategy,
+								   &lefttype,
+								   &righttype);
+		ScanKeyEntryInitialize(&mergestate->mj_SkipKey,
+							   0,
+							   node->mergeSkipAttno,
+							   strategy,
+							   righttype,
+							   node->mergeCollations[0],
+							   get_opcode(node->mergeSkipOp),
+							   (Datum) 0);
+		get_typlenbyval(righttype,
+						&mergestate->mj_SkipKeyLen,
+						&mergestate->mj_SkipKeyByVal);
+		mergestate->mj_SkipContext =
+			AllocSetContextCreate(CurrentMemoryContext,
+								  "MergeJoin skip key",
+								  ALLOCSET_SMALL_SIZES);
+		mergestate->mj_SkipAhead = true;
+	}
+
 	/*
 	 * initialize join state
 	 */
@@ -1662,6 +1781,7 @@ ExecReScanMergeJoin(MergeJoinState *node)
 	node->mj_MatchedInner = false;
 	node->mj_OuterTupleSlot = NULL;
 	node->mj_InnerTupleSlot = NULL;
+	node->mj_InnerSkipCount = 0;
 
 	/*
 	 * if chgParam of subnodes is not null then plans will be re-scanned by
@@ -19,9 +19,40 @@
 #include "executor/execdebug.h"
 #include "executor/nodeSort.h"
 #include "miscadmin.h"
+#include "pgstat.h"
+#include "storage/condition_variable.h"
+#include "storage/spin.h"
 #include "utils/tuplesort.h"
 
 
+/*
+ * Shared state for a parallel-aware Sort.  Every participant, the leader
+ * included, sorts the tuples it reads from its own copy of the outer plan
+ * into a single run on the tuplesort's shared fileset.  The leader then
+ * waits for all participants to finish and merges their runs; workers
+ * return no tuples at all.  The tuplesort's Sharedsort follows this struct.
+ */
+struct ParallelSortShared
+{
+	slock_t		mutex;			/* protects nfinished */
+	int			nfinished;		/* participants that have written a run */
+	ConditionVariable cv;		/* signaled when a participant finishes */
+};
+
+#define ParallelSortSharedsort(pshared) \
+	((Sharedsort *) ((char *) (pshared) + MAXALIGN(sizeof(ParallelSortShared))))
+
+/*
+ * The plain plan node ID is the key of the sort statistics, so the parallel
+ * state of a parallel-aware Sort is stored under a key of its own.
+ */
+#define PARALLEL_SORT_KEY(plan_node_id) \
+	(UINT64CONST(0xE000000100000000) | (uint64) (plan_node_id))
+
+static Tuplesortstate *ExecSortParallel(SortState *node);
+static Size ExecSortSharedSize(int nparticipants);
+
+
 /* ----------------------------------------------------------------
  *		ExecSort
  *
@@ -78,44 +109,69 @@ ExecSort(PlanState *pstate)
 		estate->es_direction = ForwardScanDirection;
 
 		/*
-		 * Initialize tuplesort module.
+		 * A parallel-aware sort is coordinated with the other participants,
+		 * unless no workers could be launched, in which case the leader just
+		 * sorts everything itself.  The bound, if any, is ignored.
 		 */
-		SO1_printf("ExecSort: %s\n",
-				   "calling tuplesort_begin");
-
-		outerNode = outerPlanState(node);
-		tupDesc = ExecGetResultType(outerNode);
-
-		tuplesortstate = tuplesort_begin_heap(tupDesc,
-											  plannode->numCols,
-											  plannode->sortColIdx,
-											  plannode->sortOperators,
-											  plannode->collations,
-											  plannode->nullsFirst,
-											  work_mem,
-											  NULL, node->randomAccess);
-		if (node->bounded)
-			tuplesort_set_bound(tuplesortstate, node->bound);
-		node->tuplesortstate = (void *) tuplesortstate;
-
-		/*
-		 * Scan the subplan and feed all the tuples to tuplesort.
-		 */
-
-		for (;;)
+		if (node->pshared != NULL &&
+			(node->am_worker || node->pcxt->nworkers_launched > 0))
 		{
-			slot = ExecProcNode(outerNode);
-
-			if (TupIsNull(slot))
-				break;
-
-			tuplesort_puttupleslot(tuplesortstate, slot);
+			tuplesortstate = ExecSortParallel(node);
+			node->tuplesortstate = (void *) tuplesortstate;
+			node->bounded = false;
+		}
+		else
+		{
+			/*
+			 * Initialize tuplesort module.
+			 */
+			SO1_printf("ExecSort: %s\n",
+					   "calling tuplesort_begin");
+
+			outerNode = outerPlanState(node);
+			tupDesc = ExecGetResultType(outerNode);
+
+			tuplesortstate = tuplesort_begin_heap(tupDesc,
+												  plannode->numCols,
+												  plannode->sortColIdx,
+												  plannode->sortOperators,
+												  plannode->collations,
+												  plannode->nullsFirst,
+												  work_mem,
+												  NULL, node->randomAccess);
+			if (node->bounded)
+				tuplesort_set_bound(tuplesortstate, node->bound);
+			node->tuplesortstate = (void *) tuplesortstate;
+
+			/*
+			 * Scan the subplan and feed all the tuples to tuplesort.
+			 */
+
+			for (;;)
+			{
+				slot = ExecProcNode(outerNode);
+
+				if (TupIsNull(slot))
+					break;
+
+				tuplesort_puttupleslot(tuplesortstate, slot);
+			}
+
+			/*
+			 * Complete the sort.
+			 */
+			tuplesort_performsort(tuplesortstate);
+
+			if (node->shared_info && node->am_worker)
+			{
+				TuplesortInstrumentation *si;
+
+				Assert(IsParallelWorker());
+				Assert(ParallelWorkerNumber <= node->shared_info->num_workers);
+				si = &node->shared_info->sinstrument[ParallelWorkerNumber];
+				tuplesort_get_stats(tuplesortstate, si);
+			}
 		}
-
-		/*
-		 * Complete the sort.
-		 */
-		tuplesort_performsort(tuplesortstate);
 
 		/*
 		 * restore to user specified direction
@@ -128,15 +184,6 @@ ExecSort(PlanState *pstate)
 		node->sort_Done = true;
 		node->bounded_Done = node->bounded;
 		node->bound_Done = node->bound;
-		if (node->shared_info && node->am_worker)
-		{
-			TuplesortInstrumentation *si;
-
-			Assert(IsParallelWorker());
-			Assert(ParallelWorkerNumber <= node->shared_info->num_workers);
-			si = &node->shared_info->sinstrument[ParallelWorkerNumber];
-			tuplesort_get_stats(tuplesortstate, si);
-		}
 		SO1_printf("ExecSort: %s\n", "sorting done");
 	}
 
@@ -149,12 +196,130 @@ ExecSort(PlanState *pstate)
 	 * next fetch from the tuplesort.
 	 */
 	slot = node->ss.ps.ps_ResultTupleSlot;
+
+	/*
+	 * Parallel workers hand their tuples over to the leader through the
+	 * shared fileset, so they have nothing to return here.
+	 */
+	if (tuplesortstate == NULL)
+		return ExecClearTuple(slot);
+
 	(void) tuplesort_gettupleslot(tuplesortstate,
 								  ScanDirectionIsForward(dir),
 								  false, slot, NULL);
 	return slot;
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSortParallel
+ *
+ *		Sorts this participant's share of the input into one run on the
+ *		shared fileset.  That is all a worker does, and NULL is returned.
+ *		The leader goes on to wait for every participant to finish, and
+ *		returns a tuplesort merging all of the runs.
+ * ----------------------------------------------------------------
+ */
+static Tuplesortstate *
+ExecSortParallel(SortState *node)
+{
+	Sort	   *plannode = (Sort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	TupleDesc	tupDesc = ExecGetResultType(outerNode);
+	ParallelSortShared *pshared = node->pshared;
+	SortCoordinate coordinate;
+	Tuplesortstate *tuplesortstate;
+	TupleTableSlot *slot;
+	int			nparticipants;
+
+	coordinate = (SortCoordinate) palloc0(sizeof(SortCoordinateData));
+	coordinate->isWorker = true;
+	coordinate->nParticipants = -1;
+	coordinate->sharedsort = ParallelSortSharedsort(pshared);
+
+	tuplesortstate = tuplesort_begin_heap(tupDesc,
+										  plannode->numCols,
+										  plannode->sortColIdx,
+										  plannode->sortOperators,
+										  plannode->collations,
+										  plannode->nullsFirst,
+										  work_mem,
+										  coordinate, false);
+
+	for (;;)
+	{
+		slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+			break;
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+	}
+
+	/* Write out our run, and let the leader know it is there. */
+	tuplesort_performsort(tuplesortstate);
+
+	if (node->shared_info && node->am_worker)
+	{
+		TuplesortInstrumentation *si;
+
+		Assert(IsParallelWorker());
+		Assert(ParallelWorkerNumber <= node->shared_info->num_workers);
+		si = &node->shared_info->sinstrument[ParallelWorkerNumber];
+		tuplesort_get_stats(tuplesortstate, si);
+	}
+	tuplesort_end(tuplesortstate);
+
+	SpinLockAcquire(&pshared->mutex);
+	pshared->nfinished++;
+	SpinLockRelease(&pshared->mutex);
+	ConditionVariableBroadcast(&pshared->cv);
+
+	if (node->am_worker)
+		return NULL;
+
+	/*
+	 * Wait for every launched worker to write its run.  Waiting for them to
+	 * attach first makes sure that we error out rather than wait forever if
+	 * some worker failed to start.
+	 */
+	WaitForParallelWorkersToAttach(node->pcxt);
+	nparticipants = node->pcxt->nworkers_launched + 1;
+
+	ConditionVariablePrepareToSleep(&pshared->cv);
+	for (;;)
+	{
+		int			nfinished;
+
+		SpinLockAcquire(&pshared->mutex);
+		nfinished = pshared->nfinished;
+		SpinLockRelease(&pshared->mutex);
+
+		if (nfinished >= nparticipants)
+			break;
+
+		ConditionVariableSleep(&pshared->cv, WAIT_EVENT_PARALLEL_SORT_RUNS);
+	}
+	ConditionVariableCancelSleep();
+
+	/* Merge all the runs. */
+	coordinate = (SortCoordinate) palloc0(sizeof(SortCoordinateData));
+	coordinate->isWorker = false;
+	coordinate->nParticipants = nparticipants;
+	coordinate->sharedsort = ParallelSortSharedsort(pshared);
+
+	tuplesortstate = tuplesort_begin_heap(tupDesc,
+										  plannode->numCols,
+										  plannode->sortColIdx,
+										  plannode->sortOperators,
+										  plannode->collations,
+										  plannode->nullsFirst,
+										  work_mem,
+										  coordinate, false);
+	tuplesort_performsort(tuplesortstate);
+
+	return tuplesortstate;
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitSort
  *
@@ -181,15 +346,20 @@ ExecInitSort(Sort *node, EState *estate, int eflags)
 	/*
 	 * We must have random access to the sort output to do backward scan or
 	 * mark/restore.  We also prefer to materialize the sort output if we
-	 * might be called on to rewind and replay it many times.
+	 * might be called on to rewind and replay it many times.  The merged
+	 * output of a parallel-aware sort can only be read forwards, once; a
+	 * rescan sorts again.
 	 */
-	sortstate->randomAccess = (eflags & (EXEC_FLAG_REWIND |
-										 EXEC_FLAG_BACKWARD |
-										 EXEC_FLAG_MARK)) != 0;
+	sortstate->randomAccess = !node->plan.parallel_aware &&
+		(eflags & (EXEC_FLAG_REWIND |
+				   EXEC_FLAG_BACKWARD |
+				   EXEC_FLAG_MARK)) != 0;
 
 	sortstate->bounded = false;
 	sortstate->sort_Done = false;
 	sortstate->tuplesortstate = NULL;
+	sortstate->pshared = NULL;
+	sortstate->pcxt = NULL;
 
 	/*
 	 * Miscellaneous initialization
@@ -298,6 +468,68 @@ ExecSortRestrPos(SortState *node)
 	tuplesort_restorepos((Tuplesortstate *) node->tuplesortstate);
 }
 
+/*
+ * State for ExecSortSkipPredicate.
+ */
+typedef struct SortSkipArg
+{
+	TupleTableSlot *slot;		/* slot to examine the tuples in */
+	ScanKey		key;			/* the condition to satisfy */
+} SortSkipArg;
+
+/*
+ * Predicate for ExecSortSkipTo: does the tuple satisfy the skip key?
+ */
+static bool
+ExecSortSkipPredicate(void *tuple, void *arg)
+{
+	SortSkipArg *skiparg = (SortSkipArg *) arg;
+	ScanKey		key = skiparg->key;
+	Datum		value;
+	bool		isnull;
+	bool		result;
+
+	ExecStoreMinimalTuple((MinimalTuple) tuple, skiparg->slot, false);
+	value = slot_getattr(skiparg->slot, key->sk_attno, &isnull);
+
+	/* nulls sort after everything else, so stop there */
+	if (isnull)
+		result = true;
+	else
+		result = DatumGetBool(FunctionCall2Coll(&key->sk_func,
+												key->sk_collation,
+												value,
+												key->sk_argument));
+	ExecClearTuple(skiparg->slot);
+
+	return result;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSortSkipTo
+ *
+ *		Skip ahead to the first sorted tuple whose sk_attno column
+ *		satisfies "column OP sk_argument".  The sort must be ascending,
+ *		nulls last, on that column.  Returns false if the sort was not
+ *		done in memory, in which case nothing was done.
+ * ----------------------------------------------------------------
+ */
+bool
+ExecSortSkipTo(SortState *node, ScanKey key)
+{
+	SortSkipArg skiparg;
+
+	if (!node->sort_Done)
+		return false;
+
+	/* the scan slot is otherwise unused once the input has been sorted */
+	skiparg.slot = node->ss.ss_ScanTupleSlot;
+	skiparg.key = key;
+
+	return tuplesort_skipto((Tuplesortstate *) node->tuplesortstate,
+							ExecSortSkipPredicate, &skiparg);
+}
+
 void
 ExecReScanSort(SortState *node)
 {
@@ -327,7 +559,8 @@ ExecReScanSort(SortState *node)
 		!node->randomAccess)
 	{
 		node->sort_Done = false;
-		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		if (node->tuplesortstate != NULL)
+			tuplesort_end((Tuplesortstate *) node->tuplesortstate);
 		node->tuplesortstate = NULL;
 
 		/*
@@ -341,15 +574,45 @@ ExecReScanSort(SortState *node)
 		tuplesort_rescan((Tuplesortstate *) node->tuplesortstate);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecShutdownSort
+ *
+ *		Release the merge of a parallel-aware sort, which reads from
+ *		the shared fileset, before the DSM segment goes away.
+ * ----------------------------------------------------------------
+ */
+void
+ExecShutdownSort(SortState *node)
+{
+	if (node->pshared != NULL && node->tuplesortstate != NULL)
+	{
+		ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+		node->tuplesortstate = NULL;
+	}
+}
+
 /* ----------------------------------------------------------------
  *						Parallel Query Support
  * ----------------------------------------------------------------
  */
 
+/*
+ * Space needed for the shared state of a parallel-aware sort with the given
+ * number of participants.
+ */
+static Size
+ExecSortSharedSize(int nparticipants)
+{
+	return add_size(MAXALIGN(sizeof(ParallelSortShared)),
+					tuplesort_estimate_shared(nparticipants));
+}
+
 /* ----------------------------------------------------------------
  *		ExecSortEstimate
  *
- *		Estimate space required to propagate sort statistics.
+ *		Estimate space required to coordinate a parallel-aware sort
+ *		and to propagate sort statistics.
  * ----------------------------------------------------------------
  */
 void
@@ -357,8 +620,19 @@ ExecSortEstimate(SortState *node, ParallelContext *pcxt)
 {
 	Size		size;
 
-	/* don't need this if not instrumenting or no workers */
-	if (!node->ss.ps.instrument || pcxt->nworkers == 0)
+	/* don't need anything if no workers */
+	if (pcxt->nworkers == 0)
+		return;
+
+	if (node->ss.ps.plan->parallel_aware)
+	{
+		shm_toc_estimate_chunk(&pcxt->estimator,
+							   ExecSortSharedSize(pcxt->nworkers + 1));
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
+
+	/* don't need statistics space if not instrumenting */
+	if (!node->ss.ps.instrument)
 		return;
 
 	size = mul_size(pcxt->nworkers, sizeof(TuplesortInstrumentation));
@@ -370,7 +644,8 @@ ExecSortEstimate(SortState *node, ParallelContext *pcxt)
 /* ----------------------------------------------------------------
  *		ExecSortInitializeDSM
  *
- *		Initialize DSM space for sort statistics.
+ *		Initialize DSM space for parallel coordination and sort
+ *		statistics.
  * ----------------------------------------------------------------
  */
 void
@@ -378,8 +653,30 @@ ExecSortInitializeDSM(SortState *node, ParallelContext *pcxt)
 {
 	Size		size;
 
-	/* don't need this if not instrumenting or no workers */
-	if (!node->ss.ps.instrument || pcxt->nworkers == 0)
+	/* don't need anything if no workers */
+	if (pcxt->nworkers == 0)
+		return;
+
+	if (node->ss.ps.plan->parallel_aware)
+	{
+		ParallelSortShared *pshared;
+
+		pshared = shm_toc_allocate(pcxt->toc,
+								   ExecSortSharedSize(pcxt->nworkers + 1));
+		SpinLockInit(&pshared->mutex);
+		pshared->nfinished = 0;
+		ConditionVariableInit(&pshared->cv);
+		tuplesort_initialize_shared(ParallelSortSharedsort(pshared),
+									pcxt->nworkers + 1, pcxt->seg);
+		shm_toc_insert(pcxt->toc,
+					   PARALLEL_SORT_KEY(node->ss.ps.plan->plan_node_id),
+					   pshared);
+		node->pshared = pshared;
+		node->pcxt = pcxt;
+	}
+
+	/* don't need statistics space if not instrumenting */
+	if (!node->ss.ps.instrument)
 		return;
 
 	size = offsetof(SharedSortInfo, sinstrument)
@@ -392,10 +689,32 @@ ExecSortInitializeDSM(SortState *node, ParallelContext *pcxt)
 				   node->shared_info);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSortReInitializeDSM
+ *
+ *		Reset shared state before beginning a fresh parallel sort.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSortReInitializeDSM(SortState *node, ParallelContext *pcxt)
+{
+	ParallelSortShared *pshared = node->pshared;
+
+	if (pshared == NULL)
+		return;
+
+	/* any merge left from the last scan must let go of its files first */
+	ExecShutdownSort(node);
+
+	pshared->nfinished = 0;
+	tuplesort_reset_shared(ParallelSortSharedsort(pshared));
+}
+
 /* ----------------------------------------------------------------
  *		ExecSortInitializeWorker
  *
- *		Attach worker to DSM space for sort statistics.
+ *		Attach worker to DSM space for parallel coordination and
+ *		sort statistics.
  * ----------------------------------------------------------------
  */
 void
@@ -404,6 +723,15 @@ ExecSortInitializeWorker(SortState *node, ParallelWorkerContext *pwcxt)
 	node->shared_info =
 		shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, true);
 	node->am_worker = true;
+
+	if (node->ss.ps.plan->parallel_aware)
+	{
+		node->pshared = shm_toc_lookup(pwcxt->toc,
+									   PARALLEL_SORT_KEY(node->ss.ps.plan->plan_node_id),
+									   false);
+		tuplesort_attach_shared(ParallelSortSharedsort(node->pshared),
+								pwcxt->seg);
+	}
 }
 
 /* ----------------------------------------------------------------
@@ -30,16 +30,35 @@
 #include <math.h>
 
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "executor/executor.h"
 #include "executor/nodeSubplan.h"
 #include "nodes/makefuncs.h"
 #include "miscadmin.h"
 #include "optimizer/clauses.h"
+#include "storage/buffile.h"
+#include "storage/sharedfileset.h"
 #include "utils/array.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 
 
+/*
+ * In a parallel query, a hashed subplan whose subselect can't be run in a
+ * worker has the subselect's rows computed once by the leader, and written
+ * to a shared temporary file from which each worker loads its own hash
+ * table.  This is the shared state for that, keyed by the subplan's plan_id.
+ */
+typedef struct SharedSubPlanHash
+{
+	SharedFileSet fileset;		/* space for the shared file of rows */
+} SharedSubPlanHash;
+
+/* see execParallel.c for the layout of the parallel keys */
+#define PARALLEL_KEY_SUBPLAN_HASH(plan_id) \
+	(UINT64CONST(0xE000000200000000) | (uint64) (plan_id))
+
+
 static Datum ExecHashSubPlan(SubPlanState *node,
 				ExprContext *econtext,
 				bool *isNull);
@@ -47,6 +66,19 @@ static Datum ExecScanSubPlan(SubPlanState *node,
 				ExprContext *econtext,
 				bool *isNull);
 static void buildSubPlanHash(SubPlanState *node, ExprContext *econtext);
+static void insertSubPlanHash(SubPlanState *node, TupleTableSlot *slot);
+static void spillSubPlanHash(SubPlanState *node);
+static void loadSubPlanHashBatch(SubPlanState *node, int batchno);
+static void closeSubPlanHashBatches(SubPlanState *node);
+static void ShutdownSubPlanHash(Datum arg);
+static uint32 subplanHashValue(SubPlanState *node, TupleTableSlot *slot,
+				 FmgrInfo *hashfunctions);
+static void saveSubPlanHashTuple(BufFile **fileptr, MinimalTuple tuple);
+static MinimalTuple readSubPlanHashTuple(BufFile *file, MemoryContext cxt);
+static bool subPlanHashUsesShared(SubPlanState *node);
+static void loadSharedSubPlanHash(SubPlanState *node);
+static void publishSubPlanHash(SubPlanState *node, BufFile *file);
+static bool findPartialMatchMain(SubPlanState *node, TupleTableSlot *slot);
 static bool findPartialMatch(TupleHashTable hashtable, TupleTableSlot *slot,
 				 FmgrInfo *eqfunctions);
 static bool slotAllNulls(TupleTableSlot *slot);
@@ -104,7 +136,8 @@ ExecHashSubPlan(SubPlanState *node,
 	 * If first time through or we need to rescan the subplan, build the hash
 	 * table.
 	 */
-	if (node->hashtable == NULL || planstate->chgParam != NULL)
+	if (node->hashtable == NULL ||
+		(planstate != NULL && planstate->chgParam != NULL))
 		buildSubPlanHash(node, econtext);
 
 	/*
@@ -143,9 +176,19 @@ ExecHashSubPlan(SubPlanState *node,
 	 * UNKNOWN instead of FALSE because of an UNKNOWN result in comparing the
 	 * LHS to some main-table entry --- which is a comparison we will not even
 	 * make, unless there's a chance match of hash keys.
+	 *
+	 * If the main table has spilled, only the LHS's batch can hold a match,
+	 * so load that first.
 	 */
 	if (slotNoNulls(slot))
 	{
+		if (node->havehashrows && node->nbatch > 0)
+		{
+			uint32		hashvalue;
+
+			hashvalue = subplanHashValue(node, slot, node->lhs_hash_funcs);
+			loadSubPlanHashBatch(node, hashvalue & (node->nbatch - 1));
+		}
 		if (node->havehashrows &&
 			FindTupleHashEntry(node->hashtable,
 							   slot,
@@ -196,7 +239,7 @@ ExecHashSubPlan(SubPlanState *node,
 		return BoolGetDatum(false);
 	}
 	if (node->havehashrows &&
-		findPartialMatch(node->hashtable, slot, node->cur_eq_funcs))
+		findPartialMatchMain(node, slot))
 	{
 		ExecClearTuple(slot);
 		*isNull = true;
@@ -484,27 +527,38 @@ buildSubPlanHash(SubPlanState *node, ExprContext *econtext)
 	 * If it's not necessary to distinguish FALSE and UNKNOWN, then we don't
 	 * need to store subplan output rows that contain NULL.
 	 */
+	closeSubPlanHashBatches(node);
 	MemoryContextReset(node->hashtablecxt);
+	MemoryContextReset(node->hashbatchcxt);
 	node->hashtable = NULL;
 	node->hashnulls = NULL;
 	node->havehashrows = false;
 	node->havenullrows = false;
+	node->hashspace = 0;
 
-	nbuckets = (long) Min(planstate->plan->plan_rows, (double) LONG_MAX);
+	if (planstate)
+		nbuckets = (long) Min(planstate->plan->plan_rows, (double) LONG_MAX);
+	else
+		nbuckets = 1024;		/* leader didn't tell us; just guess */
 	if (nbuckets < 1)
 		nbuckets = 1;
 
-	node->hashtable = BuildTupleHashTable(node->parent,
-										  node->descRight,
-										  ncols,
-										  node->keyColIdx,
-										  node->tab_eq_funcoids,
-										  node->tab_hash_funcs,
-										  nbuckets,
-										  0,
-										  node->hashtablecxt,
-										  node->hashtempcxt,
-										  false);
+	/*
+	 * The main table keeps its entries in a separate context, so that they
+	 * can be thrown away if we have to switch to loading one batch at a time.
+	 */
+	node->hashtable = BuildTupleHashTableExt(node->parent,
+											 node->descRight,
+											 ncols,
+											 node->keyColIdx,
+											 node->tab_eq_funcoids,
+											 node->tab_hash_funcs,
+											 nbuckets,
+											 0,
+											 node->hashtablecxt,
+											 node->hashbatchcxt,
+											 node->hashtempcxt,
+											 false);
 
 	if (!subplan->unknownEqFalse)
 	{
@@ -535,6 +589,17 @@ buildSubPlanHash(SubPlanState *node, ExprContext *econtext)
 	 */
 	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_query_memory);
 
+	/*
+	 * In a parallel worker, the subselect may have been run by the leader
+	 * instead, in which case we just load the rows it computed.
+	 */
+	if (planstate == NULL)
+	{
+		loadSharedSubPlanHash(node);
+		MemoryContextSwitchTo(oldcontext);
+		return;
+	}
+
 	/*
 	 * Reset subplan to start.
 	 */
@@ -550,7 +615,6 @@ buildSubPlanHash(SubPlanState *node, ExprContext *econtext)
 	{
 		int			col = 1;
 		ListCell   *plst;
-		bool		isnew;
 
 		/*
 		 * Load up the Params representing the raw sub-select outputs, then
@@ -569,19 +633,7 @@ buildSubPlanHash(SubPlanState *node, ExprContext *econtext)
 		}
 		slot = ExecProject(node->projRight);
 
-		/*
-		 * If result contains any nulls, store separately or not at all.
-		 */
-		if (slotNoNulls(slot))
-		{
-			(void) LookupTupleHashEntry(node->hashtable, slot, &isnew);
-			node->havehashrows = true;
-		}
-		else if (node->hashnulls)
-		{
-			(void) LookupTupleHashEntry(node->hashnulls, slot, &isnew);
-			node->havenullrows = true;
-		}
+		insertSubPlanHash(node, slot);
 
 		/*
 		 * Reset innerecontext after each inner tuple to free any memory used
@@ -602,6 +654,263 @@ buildSubPlanHash(SubPlanState *node, ExprContext *econtext)
 	MemoryContextSwitchTo(oldcontext);
 }
 
+/*
+ * insertSubPlanHash: add one projected subplan output row to the hash
+ * table(s), or to the batch files once the main table has spilled.
+ */
+static void
+insertSubPlanHash(SubPlanState *node, TupleTableSlot *slot)
+{
+	TupleHashEntry entry;
+	bool		isnew;
+
+	/*
+	 * If result contains any nulls, store separately or not at all.
+	 */
+	if (slotNoNulls(slot))
+	{
+		node->havehashrows = true;
+		if (node->nbatch > 0)
+		{
+			uint32		hashvalue;
+			int			batchno;
+
+			hashvalue = subplanHashValue(node, slot, node->tab_hash_funcs);
+			batchno = hashvalue & (node->nbatch - 1);
+			saveSubPlanHashTuple(&node->batchfiles[batchno],
+								 ExecFetchSlotMinimalTuple(slot));
+			return;
+		}
+
+		entry = LookupTupleHashEntry(node->hashtable, slot, &isnew);
+		if (isnew)
+		{
+			node->hashspace += node->hashtable->entrysize +
+				MAXALIGN(entry->firstTuple->t_len);
+			if (node->hashspace > work_mem * 1024L)
+				spillSubPlanHash(node);
+		}
+	}
+	else if (node->hashnulls)
+	{
+		(void) LookupTupleHashEntry(node->hashnulls, slot, &isnew);
+		node->havenullrows = true;
+	}
+}
+
+/*
+ * spillSubPlanHash: the main hash table has outgrown work_mem, so divide
+ * its rows, and all the ones still to come, into batches held in temp
+ * files.  From then on the hash table holds one batch at a time; see
+ * loadSubPlanHashBatch.  The partly-null table is expected to stay small
+ * and is kept in memory regardless.
+ */
+static void
+spillSubPlanHash(SubPlanState *node)
+{
+	TupleHashTable hashtable = node->hashtable;
+	TupleHashIterator hashiter;
+	TupleHashEntry entry;
+	double		totalspace;
+	int			nbatch;
+
+	/*
+	 * Choose the number of batches so that each should use about half of
+	 * work_mem, trusting the planner's row estimate only where it's larger
+	 * than what we have already seen.  Batches are not split any further
+	 * later on, so if the estimate is badly off, they will exceed work_mem.
+	 */
+	totalspace = (double) node->hashspace;
+	if (node->planstate &&
+		node->planstate->plan->plan_rows > hashtable->hashtab->members)
+		totalspace *= node->planstate->plan->plan_rows /
+			hashtable->hashtab->members;
+	nbatch = 2;
+	while (nbatch < (1 << 20) &&
+		   (double) nbatch * work_mem * 1024L < 2.0 * totalspace)
+		nbatch <<= 1;
+
+	node->nbatch = nbatch;
+	node->curbatch = -1;
+	node->batchfiles = (BufFile **)
+		MemoryContextAllocZero(node->hashtablecxt, nbatch * sizeof(BufFile *));
+
+	/* Dump the rows collected so far into their batches */
+	InitTupleHashIterator(hashtable, &hashiter);
+	while ((entry = ScanTupleHashTable(hashtable, &hashiter)) != NULL)
+	{
+		uint32		hashvalue;
+
+		ExecStoreMinimalTuple(entry->firstTuple, hashtable->tableslot, false);
+		hashvalue = subplanHashValue(node, hashtable->tableslot,
+									 node->tab_hash_funcs);
+		saveSubPlanHashTuple(&node->batchfiles[hashvalue & (nbatch - 1)],
+							 entry->firstTuple);
+	}
+	ExecClearTuple(hashtable->tableslot);
+
+	ResetTupleHashTable(hashtable);
+	MemoryContextReset(node->hashbatchcxt);
+	node->hashspace = 0;
+}
+
+/*
+ * loadSubPlanHashBatch: make the main hash table hold the given batch.
+ */
+static void
+loadSubPlanHashBatch(SubPlanState *node, int batchno)
+{
+	BufFile    *file = node->batchfiles[batchno];
+	TupleTableSlot *slot = node->projRight->pi_state.resultslot;
+	ExprContext *innerecontext = node->innerecontext;
+	MinimalTuple tuple;
+	bool		isnew;
+
+	if (node->curbatch == batchno)
+		return;
+
+	ResetTupleHashTable(node->hashtable);
+	MemoryContextReset(node->hashbatchcxt);
+	node->curbatch = batchno;
+
+	if (file == NULL)
+		return;					/* empty batch */
+
+	if (BufFileSeek(file, 0, 0L, SEEK_SET))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not rewind hashed subplan temporary file: %m")));
+
+	while ((tuple = readSubPlanHashTuple(file,
+										 innerecontext->ecxt_per_tuple_memory)) != NULL)
+	{
+		ExecStoreMinimalTuple(tuple, slot, false);
+		(void) LookupTupleHashEntry(node->hashtable, slot, &isnew);
+		ExecClearTuple(slot);
+		ResetExprContext(innerecontext);
+	}
+}
+
+/*
+ * closeSubPlanHashBatches: release the temp files of a spilled hash table.
+ */
+static void
+closeSubPlanHashBatches(SubPlanState *node)
+{
+	int			i;
+
+	for (i = 0; i < node->nbatch; i++)
+	{
+		if (node->batchfiles[i])
+			BufFileClose(node->batchfiles[i]);
+	}
+	node->nbatch = 0;
+	node->curbatch = -1;
+	node->batchfiles = NULL;	/* was in hashtablecxt */
+}
+
+/*
+ * ShutdownSubPlanHash: expression context callback to close any temp files
+ * at executor shutdown.
+ */
+static void
+ShutdownSubPlanHash(Datum arg)
+{
+	closeSubPlanHashBatches((SubPlanState *) DatumGetPointer(arg));
+}
+
+/*
+ * subplanHashValue: hash the columns of a projected row, for assigning it
+ * to a batch.
+ *
+ * The lefthand and righthand hash functions of each combining operator are
+ * compatible, so either side's rows may be passed with its own functions.
+ * The row must not contain nulls.
+ */
+static uint32
+subplanHashValue(SubPlanState *node, TupleTableSlot *slot,
+				 FmgrInfo *hashfunctions)
+{
+	int			ncols = slot->tts_tupleDescriptor->natts;
+	uint32		hashkey = 0;
+	MemoryContext oldcontext;
+	int			i;
+
+	oldcontext = MemoryContextSwitchTo(node->hashtempcxt);
+
+	for (i = 0; i < ncols; i++)
+	{
+		Datum		attr;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, i + 1, &isNull);
+		Assert(!isNull);
+		hashkey ^= DatumGetUInt32(FunctionCall1(&hashfunctions[i], attr));
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+	MemoryContextReset(node->hashtempcxt);
+
+	return hashkey;
+}
+
+/*
+ * saveSubPlanHashTuple: append a tuple to a temp file, creating the file
+ * first if necessary.
+ */
+static void
+saveSubPlanHashTuple(BufFile **fileptr, MinimalTuple tuple)
+{
+	BufFile    *file = *fileptr;
+
+	if (file == NULL)
+	{
+		/* First write to this batch file, so open it. */
+		file = BufFileCreateTemp(false);
+		*fileptr = file;
+	}
+
+	if (BufFileWrite(file, (void *) tuple, tuple->t_len) != tuple->t_len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to hashed subplan temporary file: %m")));
+}
+
+/*
+ * readSubPlanHashTuple: read the next tuple from a temp file into the given
+ * memory context, returning NULL at end of file.
+ */
+static MinimalTuple
+readSubPlanHashTuple(BufFile *file, MemoryContext cxt)
+{
+	uint32		t_len;
+	size_t		nread;
+	MinimalTuple tuple;
+
+	CHECK_FOR_INTERRUPTS();
+
+	nread = BufFileRead(file, (void *) &t_len, sizeof(t_len));
+	if (nread == 0)				/* end of file */
+		return NULL;
+	if (nread != sizeof(t_len))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from hashed subplan temporary file: %m")));
+	tuple = (MinimalTuple) MemoryContextAlloc(cxt, t_len);
+	tuple->t_len = t_len;
+	nread = BufFileRead(file,
+						(void *) ((char *) tuple + sizeof(uint32)),
+						t_len - sizeof(uint32));
+	if (nread != t_len - sizeof(uint32))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read from hashed subplan temporary file: %m")));
+	return tuple;
+}
+
 /*
  * execTuplesUnequal
  *		Return true if two tuples are definitely unequal in the indicated
@@ -712,6 +1021,27 @@ findPartialMatch(TupleHashTable hashtable, TupleTableSlot *slot,
 	return false;
 }
 
+/*
+ * findPartialMatchMain: findPartialMatch for the main hash table, which has
+ * to look through every batch if the table has spilled.
+ */
+static bool
+findPartialMatchMain(SubPlanState *node, TupleTableSlot *slot)
+{
+	int			batchno;
+
+	if (node->nbatch == 0)
+		return findPartialMatch(node->hashtable, slot, node->cur_eq_funcs);
+
+	for (batchno = 0; batchno < node->nbatch; batchno++)
+	{
+		loadSubPlanHashBatch(node, batchno);
+		if (findPartialMatch(node->hashtable, slot, node->cur_eq_funcs))
+			return true;
+	}
+	return false;
+}
+
 /*
  * slotAllNulls: is the slot completely NULL?
  *
@@ -799,6 +1129,12 @@ ExecInitSubPlan(SubPlan *subplan, PlanState *parent)
 	sstate->tab_eq_funcs = NULL;
 	sstate->lhs_hash_funcs = NULL;
 	sstate->cur_eq_funcs = NULL;
+	sstate->hashbatchcxt = NULL;
+	sstate->hashspace = 0;
+	sstate->nbatch = 0;
+	sstate->curbatch = -1;
+	sstate->batchfiles = NULL;
+	sstate->shared_hash = NULL;
 
 	/*
 	 * If this is an initplan or MULTIEXPR subplan, it has output parameters
@@ -846,6 +1182,11 @@ ExecInitSubPlan(SubPlan *subplan, PlanState *parent)
 			AllocSetContextCreate(CurrentMemoryContext,
 								  "Subplan HashTable Context",
 								  ALLOCSET_DEFAULT_SIZES);
+		/* and one for the main table's entries, so they can be reset alone */
+		sstate->hashbatchcxt =
+			AllocSetContextCreate(CurrentMemoryContext,
+								  "Subplan HashTable Batch Context",
+								  ALLOCSET_DEFAULT_SIZES);
 		/* and a small one for the hash tables to use as temp storage */
 		sstate->hashtempcxt =
 			AllocSetContextCreate(CurrentMemoryContext,
@@ -853,6 +1194,10 @@ ExecInitSubPlan(SubPlan *subplan, PlanState *parent)
 								  ALLOCSET_SMALL_SIZES);
 		/* and a short-lived exprcontext for function evaluation */
 		sstate->innerecontext = CreateExprContext(estate);
+		/* make sure any temp files get closed at executor shutdown */
+		RegisterExprContextCallback(sstate->innerecontext,
+									ShutdownSubPlanHash,
+									PointerGetDatum(sstate));
 		/* Silly little array of column numbers 1..n */
 		ncols = list_length(subplan->paramIds);
 		sstate->keyColIdx = (AttrNumber *) palloc(ncols * sizeof(AttrNumber));
@@ -1295,3 +1640,166 @@ ExecAlternativeSubPlan(AlternativeSubPlanState *node,
 
 	return ExecSubPlan(activesp, econtext, isNull);
 }
+
+/* ----------------------------------------------------------------
+ *						Parallel Query Support
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * subPlanHashUsesShared
+ *
+ * Does the leader need to compute this hashed subplan's rows for the
+ * workers?  The planner allows a hashed subplan whose subselect isn't
+ * parallel-safe below a Gather only on that understanding.
+ */
+static bool
+subPlanHashUsesShared(SubPlanState *node)
+{
+	return node->subplan->useHashTable &&
+		node->subplan->parallel_safe &&
+		node->planstate != NULL &&
+		!node->planstate->plan->parallel_safe;
+}
+
+/*
+ * loadSharedSubPlanHash
+ *
+ * Load the hash table(s) of a parallel worker from the rows the leader
+ * computed.
+ */
+static void
+loadSharedSubPlanHash(SubPlanState *node)
+{
+	TupleTableSlot *slot = node->projRight->pi_state.resultslot;
+	ExprContext *innerecontext = node->innerecontext;
+	char		name[MAXPGPATH];
+	BufFile    *file;
+	MinimalTuple tuple;
+
+	if (node->shared_hash == NULL)
+		elog(ERROR, "rows of hashed subplan %d were not provided by the leader",
+			 node->subplan->plan_id);
+
+	snprintf(name, MAXPGPATH, "subplan%d", node->subplan->plan_id);
+	file = BufFileOpenShared(&node->shared_hash->fileset, name);
+
+	while ((tuple = readSubPlanHashTuple(file,
+										 innerecontext->ecxt_per_tuple_memory)) != NULL)
+	{
+		ExecStoreMinimalTuple(tuple, slot, false);
+		insertSubPlanHash(node, slot);
+		ExecClearTuple(slot);
+		ResetExprContext(innerecontext);
+	}
+
+	BufFileClose(file);
+}
+
+/*
+ * publishSubPlanHash
+ *
+ * Write the distinct rows of the leader's hash table(s) to a shared file.
+ */
+static void
+publishSubPlanHash(SubPlanState *node, BufFile *file)
+{
+	TupleHashIterator hashiter;
+	TupleHashEntry entry;
+	int			batchno;
+
+	for (batchno = 0; batchno < Max(node->nbatch, 1); batchno++)
+	{
+		if (!node->havehashrows)
+			break;
+		if (node->nbatch > 0)
+			loadSubPlanHashBatch(node, batchno);
+
+		InitTupleHashIterator(node->hashtable, &hashiter);
+		while ((entry = ScanTupleHashTable(node->hashtable, &hashiter)) != NULL)
+			saveSubPlanHashTuple(&file, entry->firstTuple);
+	}
+
+	if (node->havenullrows)
+	{
+		InitTupleHashIterator(node->hashnulls, &hashiter);
+		while ((entry = ScanTupleHashTable(node->hashnulls, &hashiter)) != NULL)
+			saveSubPlanHashTuple(&file, entry->firstTuple);
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSubPlanEstimate
+ *
+ *		Estimate space required to share a hashed subplan's rows.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSubPlanEstimate(SubPlanState *node, ParallelContext *pcxt)
+{
+	/* The shared file needs a DSM segment, which we won't have sans workers */
+	if (!subPlanHashUsesShared(node) || pcxt->nworkers == 0)
+		return;
+
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(SharedSubPlanHash));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSubPlanInitializeDSM
+ *
+ *		Compute a hashed subplan's rows in the leader, and share them
+ *		with the workers.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSubPlanInitializeDSM(SubPlanState *node, ParallelContext *pcxt)
+{
+	SharedSubPlanHash *shared;
+	char		name[MAXPGPATH];
+	BufFile    *file;
+
+	if (!subPlanHashUsesShared(node) || pcxt->nworkers == 0)
+		return;
+
+	shared = shm_toc_allocate(pcxt->toc, sizeof(SharedSubPlanHash));
+	SharedFileSetInit(&shared->fileset, pcxt->seg);
+	shm_toc_insert(pcxt->toc,
+				   PARALLEL_KEY_SUBPLAN_HASH(node->subplan->plan_id),
+				   shared);
+
+	/*
+	 * The subselect can't depend on anything that changes during the query
+	 * (see build_subplan), so the leader's own hash table serves as well.
+	 */
+	if (node->hashtable == NULL)
+		buildSubPlanHash(node, node->innerecontext);
+
+	snprintf(name, MAXPGPATH, "subplan%d", node->subplan->plan_id);
+	file = BufFileCreateShared(&shared->fileset, name);
+	publishSubPlanHash(node, file);
+	BufFileExportShared(file);
+	BufFileClose(file);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSubPlanInitializeWorker
+ *
+ *		Find the rows of a hashed subplan that the leader computed.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSubPlanInitializeWorker(SubPlanState *node, ParallelWorkerContext *pwcxt)
+{
+	SharedSubPlanHash *shared;
+
+	/* Only subplans whose plan wasn't sent to us were computed for us */
+	if (!node->subplan->useHashTable || node->planstate != NULL)
+		return;
+
+	shared = shm_toc_lookup(pwcxt->toc,
+							PARALLEL_KEY_SUBPLAN_HASH(node->subplan->plan_id),
+							false);
+	SharedFileSetAttach(&shared->fileset, pwcxt->seg);
+	node->shared_hash = shared;
+}
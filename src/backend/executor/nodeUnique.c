@@ -28,7 +28,7 @@
  *
  * NOTES
  *		Assumes tuples returned from subplan arrive in
- *		sorted order.
+ *		sorted order, unless the node is parallel-aware.
  */
 
 #include "postgres.h"
@@ -39,6 +39,17 @@
 #include "utils/memutils.h"
 
 
+/*
+ * Shared state of a parallel-aware Unique.
+ */
+struct ParallelUniqueState
+{
+	dsa_pointer hashtable;		/* handle of the shared hash table */
+};
+
+static TupleTableSlot *ExecParallelUnique(PlanState *pstate);
+
+
 /* ----------------------------------------------------------------
  *		ExecUnique
  * ----------------------------------------------------------------
@@ -104,6 +115,75 @@ ExecUnique(PlanState *pstate)
 	return ExecCopySlot(resultTupleSlot, slot);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecParallelUnique
+ *
+ *		A parallel-aware Unique reads its share of the unsorted input,
+ *		and returns the tuples that no participant has returned yet.
+ *		The participants record the tuples they return in a shared
+ *		hash table, whose insertions are atomic, so that every distinct
+ *		tuple is returned by exactly one of them.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecParallelUnique(PlanState *pstate)
+{
+	UniqueState *node = castNode(UniqueState, pstate);
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	PlanState  *outerPlan = outerPlanState(node);
+	TupleTableSlot *slot;
+	bool		isnew;
+
+	/*
+	 * If we're not running in parallel after all, e.g. because no workers
+	 * could be launched, remember the tuples in a local hash table instead.
+	 */
+	if (node->shared_hashtable == NULL && node->hashtable == NULL)
+	{
+		Unique	   *plannode = (Unique *) node->ps.plan;
+
+		node->hashtable =
+			BuildTupleHashTableExt(&node->ps,
+								   ExecGetResultType(outerPlan),
+								   plannode->numCols,
+								   plannode->uniqColIdx,
+								   node->eqfuncoids,
+								   node->hashfunctions,
+								   Max((long) plannode->plan.plan_rows, 1),
+								   0,
+								   node->ps.state->es_query_cxt,
+								   node->tablecxt,
+								   econtext->ecxt_per_tuple_memory,
+								   false);
+	}
+
+	for (;;)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		/*
+		 * fetch a tuple from the outer subplan
+		 */
+		slot = ExecProcNode(outerPlan);
+		if (TupIsNull(slot))
+			return NULL;
+
+		ResetExprContext(econtext);
+
+		if (node->shared_hashtable != NULL)
+			LookupSharedTupleHashEntry(node->shared_hashtable, slot, &isnew);
+		else
+			LookupTupleHashEntry(node->hashtable, slot, &isnew);
+
+		/*
+		 * The first tuple of each group is returned.  It's been copied into
+		 * the hash table, but the source slot is good enough to return.
+		 */
+		if (isnew)
+			return slot;
+	}
+}
+
 /* ----------------------------------------------------------------
  *		ExecInitUnique
  *
@@ -125,7 +205,8 @@ ExecInitUnique(Unique *node, EState *estate, int eflags)
 	uniquestate = makeNode(UniqueState);
 	uniquestate->ps.plan = (Plan *) node;
 	uniquestate->ps.state = estate;
-	uniquestate->ps.ExecProcNode = ExecUnique;
+	uniquestate->ps.ExecProcNode = node->plan.parallel_aware ?
+		ExecParallelUnique : ExecUnique;
 
 	/*
 	 * create expression context
@@ -154,6 +235,21 @@ ExecInitUnique(Unique *node, EState *estate, int eflags)
 							   node->uniqOperators,
 							   &uniquestate->ps);
 
+	/*
+	 * A parallel-aware Unique eliminates duplicates by hashing instead.
+	 */
+	if (node->plan.parallel_aware)
+	{
+		execTuplesHashPrepare(node->numCols,
+							  node->uniqOperators,
+							  &uniquestate->eqfuncoids,
+							  &uniquestate->hashfunctions);
+		uniquestate->tablecxt =
+			AllocSetContextCreate(CurrentMemoryContext,
+								  "Unique hash table",
+								  ALLOCSET_DEFAULT_SIZES);
+	}
+
 	return uniquestate;
 }
 
@@ -172,6 +268,9 @@ ExecEndUnique(UniqueState *node)
 
 	ExecFreeExprContext(&node->ps);
 
+	if (node->tablecxt)
+		MemoryContextDelete(node->tablecxt);
+
 	ExecEndNode(outerPlanState(node));
 }
 
@@ -182,6 +281,16 @@ ExecReScanUnique(UniqueState *node)
 	/* must clear result tuple so first input tuple is returned */
 	ExecClearTuple(node->ps.ps_ResultTupleSlot);
 
+	/*
+	 * Forget the tuples returned so far.  A shared hash table is reset by
+	 * ExecUniqueReInitializeDSM instead.
+	 */
+	if (node->hashtable != NULL)
+	{
+		ResetTupleHashTable(node->hashtable);
+		MemoryContextReset(node->tablecxt);
+	}
+
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
 	 * first ExecProcNode.
@@ -189,3 +298,118 @@ ExecReScanUnique(UniqueState *node)
 	if (node->ps.lefttree->chgParam == NULL)
 		ExecReScan(node->ps.lefttree);
 }
+
+/* ----------------------------------------------------------------
+ *						Parallel Query Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecUniqueEstimate
+ *
+ *		Estimate space required to propagate the shared hash table
+ *		of a parallel-aware Unique.
+ * ----------------------------------------------------------------
+ */
+void
+ExecUniqueEstimate(UniqueState *node, ParallelContext *pcxt)
+{
+	/* don't need anything if no workers; we'll use a local hash table */
+	if (pcxt->nworkers == 0)
+		return;
+
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(ParallelUniqueState));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/*
+ * Create the shared hash table in the query's DSA area, and advertise it.
+ */
+static void
+ExecUniqueCreateSharedHashTable(UniqueState *node)
+{
+	Unique	   *plannode = (Unique *) node->ps.plan;
+	EState	   *estate = node->ps.state;
+
+	Assert(estate->es_query_dsa != NULL);
+	node->shared_hashtable =
+		BuildSharedTupleHashTable(&node->ps,
+								  ExecGetResultType(outerPlanState(node)),
+								  plannode->numCols,
+								  plannode->uniqColIdx,
+								  node->eqfuncoids,
+								  node->hashfunctions,
+								  estate->es_query_dsa,
+								  InvalidDsaPointer,
+								  estate->es_query_cxt,
+								  node->ps.ps_ExprContext->ecxt_per_tuple_memory);
+	node->pstate->hashtable =
+		SharedTupleHashTableGetHandle(node->shared_hashtable);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecUniqueInitializeDSM
+ *
+ *		Set up the shared hash table of a parallel-aware Unique.
+ * ----------------------------------------------------------------
+ */
+void
+ExecUniqueInitializeDSM(UniqueState *node, ParallelContext *pcxt)
+{
+	/* don't need anything if no workers; we'll use a local hash table */
+	if (pcxt->nworkers == 0)
+		return;
+
+	node->pstate = shm_toc_allocate(pcxt->toc, sizeof(ParallelUniqueState));
+	shm_toc_insert(pcxt->toc, node->ps.plan->plan_node_id, node->pstate);
+
+	ExecUniqueCreateSharedHashTable(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecUniqueReInitializeDSM
+ *
+ *		Reset shared state before beginning a fresh scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecUniqueReInitializeDSM(UniqueState *node, ParallelContext *pcxt)
+{
+	if (node->pstate == NULL)
+		return;
+
+	/*
+	 * The workers of the last scan are gone, so we can just throw the old
+	 * table away and start over with a fresh one.
+	 */
+	ReleaseSharedTupleHashTable(node->shared_hashtable, true);
+	ExecUniqueCreateSharedHashTable(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecUniqueInitializeWorker
+ *
+ *		Attach worker to the shared hash table of a parallel-aware
+ *		Unique.
+ * ----------------------------------------------------------------
+ */
+void
+ExecUniqueInitializeWorker(UniqueState *node, ParallelWorkerContext *pwcxt)
+{
+	Unique	   *plannode = (Unique *) node->ps.plan;
+	EState	   *estate = node->ps.state;
+
+	node->pstate = shm_toc_lookup(pwcxt->toc, plannode->plan.plan_node_id,
+								  false);
+	node->shared_hashtable =
+		BuildSharedTupleHashTable(&node->ps,
+								  ExecGetResultType(outerPlanState(node)),
+								  plannode->numCols,
+								  plannode->uniqColIdx,
+								  node->eqfuncoids,
+								  node->hashfunctions,
+								  estate->es_query_dsa,
+								  node->pstate->hashtable,
+								  estate->es_query_cxt,
+								  node->ps.ps_ExprContext->ecxt_per_tuple_memory);
+}
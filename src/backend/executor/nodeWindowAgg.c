@@ -22,6 +22,13 @@
  * As required by the SQL spec, the output represents the value of the
  * aggregate function over all rows in the current row's window frame.
  *
+ * A parallel-aware WindowAgg runs beneath a Gather, on top of a partial plan,
+ * and sorts its input by itself.  All participants first redistribute the
+ * tuples they read among a number of buckets by hashing the PARTITION BY
+ * columns, so that each window partition ends up entirely in one bucket.
+ * Then each participant claims buckets one at a time, sorts the bucket and
+ * processes the partitions in it exactly as usual.
+ *
  *
  * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -34,9 +41,11 @@
 #include "postgres.h"
 
 #include "access/htup_details.h"
+#include "access/parallel.h"
 #include "catalog/objectaccess.h"
 #include "catalog/pg_aggregate.h"
 #include "catalog/pg_proc.h"
+#include "catalog/pg_type.h"
 #include "executor/executor.h"
 #include "executor/nodeWindowAgg.h"
 #include "miscadmin.h"
@@ -44,13 +53,18 @@
 #include "optimizer/clauses.h"
 #include "parser/parse_agg.h"
 #include "parser/parse_coerce.h"
+#include "pgstat.h"
+#include "storage/barrier.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
+#include "utils/hashutils.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/regproc.h"
+#include "utils/sharedtuplestore.h"
 #include "utils/syscache.h"
+#include "utils/tuplesort.h"
 #include "windowapi.h"
 
 /*
@@ -116,6 +130,7 @@ typedef struct WindowStatePerAggData
 	FmgrInfo	transfn;
 	FmgrInfo	invtransfn;
 	FmgrInfo	finalfn;
+	FmgrInfo	combinefn;		/* only valid if segtree_ok */
 
 	int			numFinalArgs;	/* number of arguments to pass to finalfn */
 
@@ -153,10 +168,52 @@ typedef struct WindowStatePerAggData
 
 	int64		transValueCount;	/* number of currently-aggregated rows */
 
+	/*
+	 * Segment tree over the transition states of the partition's rows, used
+	 * for aggregates that have a combine function but no inverse transition
+	 * function when the frame head can move.  Node i combines nodes 2i and
+	 * 2i+1; the leaves are nodes segtreeSize .. 2*segtreeSize-1.  The arrays
+	 * live in partcontext, and are NULL until built for the current
+	 * partition.  If the trees of a partition wouldn't fit in work_mem, its
+	 * aggregates restart whenever the frame head moves instead.
+	 */
+	bool		segtree_ok;		/* can this agg use a segment tree at all? */
+	bool		use_segtree;	/* ... and does it in the current partition? */
+	Size		segtreeNodeSize;	/* estimated space per tree node */
+	Datum	   *segtreeValues;
+	bool	   *segtreeNulls;
+	int64		segtreeSize;	/* number of leaves, ie rows in partition */
+
 	/* Data local to eval_windowaggregates() */
 	bool		restart;		/* need to restart this agg in this cycle? */
 } WindowStatePerAggData;
 
+/*
+ * Shared state for a parallel-aware WindowAgg.  Each bucket is a shared
+ * tuplestore that every participant may write to while redistributing, and
+ * that a single participant reads back once all of them are done.  The
+ * SharedTuplestores of the buckets follow this struct.
+ */
+struct ParallelWindowAggShared
+{
+	Barrier		barrier;		/* phase is one of PWA_PHASE_* */
+	pg_atomic_uint32 nextbucket;	/* next bucket to be claimed */
+	int			nparticipants;	/* number of possible writers */
+	int			nbuckets;		/* number of buckets */
+	SharedFileSet fileset;		/* space for the buckets' files */
+};
+
+#define PWA_PHASE_REDISTRIBUTING	0
+#define PWA_PHASE_PROCESSING		1
+
+/* more buckets than participants, so that the work evens out */
+#define PWA_BUCKETS_PER_PARTICIPANT 4
+
+#define ParallelWindowAggBucket(pshared, i) \
+	((SharedTuplestore *) ((char *) (pshared) + \
+						   MAXALIGN(sizeof(ParallelWindowAggShared)) + \
+						   (i) * MAXALIGN(sts_estimate((pshared)->nparticipants))))
+
 static void initialize_windowaggregate(WindowAggState *winstate,
 						   WindowStatePerFunc perfuncstate,
 						   WindowStatePerAgg peraggstate);
@@ -172,10 +229,21 @@ static void finalize_windowaggregate(WindowAggState *winstate,
 						 Datum *result, bool *isnull);
 
 static void eval_windowaggregates(WindowAggState *winstate);
+static void combine_windowaggregate(WindowAggState *winstate,
+						WindowStatePerFunc perfuncstate,
+						WindowStatePerAgg peraggstate,
+						MemoryContext context,
+						Datum *transValue, bool *transValueIsNull,
+						Datum input, bool inputIsNull);
+static void build_windowaggregate_segtrees(WindowAggState *winstate);
+static void eval_windowaggregate_segtree(WindowAggState *winstate,
+							 WindowStatePerFunc perfuncstate,
+							 WindowStatePerAgg peraggstate);
 static void eval_windowfunction(WindowAggState *winstate,
 					WindowStatePerFunc perfuncstate,
 					Datum *result, bool *isnull);
 
+static TupleTableSlot *fetch_input_tuple(WindowAggState *winstate);
 static void begin_partition(WindowAggState *winstate);
 static void spool_tuples(WindowAggState *winstate, int64 pos);
 static void release_partition(WindowAggState *winstate);
@@ -196,6 +264,15 @@ static bool are_peers(WindowAggState *winstate, TupleTableSlot *slot1,
 static bool window_gettupleslot(WindowObject winobj, int64 pos,
 					TupleTableSlot *slot);
 
+static TupleTableSlot *parallel_window_next_tuple(WindowAggState *winstate);
+static void parallel_window_redistribute(WindowAggState *winstate);
+static void parallel_window_sort_bucket(WindowAggState *winstate, int bucket);
+static Tuplesortstate *parallel_window_begin_sort(WindowAggState *winstate);
+static uint32 parallel_window_hash(WindowAggState *winstate,
+					 TupleTableSlot *slot);
+static Size parallel_window_shared_size(int nparticipants, int nbuckets);
+static void parallel_window_init_buckets(WindowAggState *winstate);
+
 
 /*
  * initialize_windowaggregate
@@ -647,6 +724,307 @@ finalize_windowaggregate(WindowAggState *winstate,
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * combine_windowaggregate
+ * merge the transition state 'input' into *transValue using the aggregate's
+ * combine function, parallel to the combine phase of nodeAgg.c
+ *
+ * The new state is stored in 'context', which is also what
+ * AggCheckCallContext reports to the combine function, so that it may
+ * modify *transValue in place.
+ */
+static void
+combine_windowaggregate(WindowAggState *winstate,
+						WindowStatePerFunc perfuncstate,
+						WindowStatePerAgg peraggstate,
+						MemoryContext context,
+						Datum *transValue, bool *transValueIsNull,
+						Datum input, bool inputIsNull)
+{
+	FunctionCallInfoData fcinfo;
+	Datum		newVal;
+	MemoryContext oldContext;
+
+	if (peraggstate->combinefn.fn_strict)
+	{
+		/* For a strict combinefn, a NULL input changes nothing */
+		if (inputIsNull)
+			return;
+
+		/*
+		 * If the state is still NULL, adopt a copy of the input as the
+		 * state, just as for the first non-NULL input of a strict transfn.
+		 */
+		if (*transValueIsNull)
+		{
+			oldContext = MemoryContextSwitchTo(context);
+			*transValue = datumCopy(input,
+									peraggstate->transtypeByVal,
+									peraggstate->transtypeLen);
+			*transValueIsNull = false;
+			MemoryContextSwitchTo(oldContext);
+			return;
+		}
+	}
+
+	oldContext = MemoryContextSwitchTo(winstate->tmpcontext->ecxt_per_tuple_memory);
+
+	InitFunctionCallInfoData(fcinfo, &(peraggstate->combinefn),
+							 2,
+							 perfuncstate->winCollation,
+							 (void *) winstate, NULL);
+	fcinfo.arg[0] = *transValue;
+	fcinfo.argnull[0] = *transValueIsNull;
+	fcinfo.arg[1] = input;
+	fcinfo.argnull[1] = inputIsNull;
+	winstate->curaggcontext = context;
+	newVal = FunctionCallInvoke(&fcinfo);
+	winstate->curaggcontext = NULL;
+
+	/*
+	 * If pass-by-ref datatype, must copy the new value into context and free
+	 * the prior state, as in advance_windowaggregate().  We always copy a
+	 * value the combinefn returned, even if it is the input, so that the
+	 * state never shares storage with a tree node.
+	 */
+	if (!peraggstate->transtypeByVal &&
+		DatumGetPointer(newVal) != DatumGetPointer(*transValue))
+	{
+		if (!fcinfo.isnull)
+		{
+			MemoryContextSwitchTo(context);
+			newVal = datumCopy(newVal,
+							   peraggstate->transtypeByVal,
+							   peraggstate->transtypeLen);
+		}
+		if (!*transValueIsNull)
+		{
+			if (DatumIsReadWriteExpandedObject(*transValue,
+											   false,
+											   peraggstate->transtypeLen))
+				DeleteExpandedObject(*transValue);
+			else
+				pfree(DatumGetPointer(*transValue));
+		}
+	}
+
+	MemoryContextSwitchTo(oldContext);
+	*transValue = newVal;
+	*transValueIsNull = fcinfo.isnull;
+}
+
+/*
+ * build_windowaggregate_segtrees
+ * build the segment trees of all the aggregates that use one, for the
+ * current partition
+ *
+ * Each leaf is the transition state of a single row, computed with the
+ * ordinary transfn (so that FILTER and strictness are handled as usual), and
+ * each inner node combines its two children.  This needs the whole partition
+ * to be spooled, but afterwards the aggregate over any contiguous frame can
+ * be had by combining O(log n) nodes, however far the frame head moves.
+ *
+ * The trees take 2 * nrows nodes each, so if they would exceed work_mem we
+ * don't build them at all; the aggregates then fall back to restarting for
+ * the rest of the partition, like any aggregate without an inverse
+ * transition function.
+ */
+static void
+build_windowaggregate_segtrees(WindowAggState *winstate)
+{
+	WindowObject agg_winobj = winstate->agg_winobj;
+	TupleTableSlot *temp_slot = winstate->temp_slot_1;
+	MemoryContext oldContext;
+	int64		nrows;
+	int64		pos;
+	double		treespace = 0;
+	int			i;
+
+	spool_tuples(winstate, -1);
+	nrows = winstate->spooled_rows;
+
+	for (i = 0; i < winstate->numaggs; i++)
+	{
+		WindowStatePerAgg peraggstate = &winstate->peragg[i];
+
+		if (peraggstate->use_segtree)
+			treespace += 2.0 * nrows * peraggstate->segtreeNodeSize;
+	}
+	if (treespace > work_mem * 1024.0)
+	{
+		for (i = 0; i < winstate->numaggs; i++)
+			winstate->peragg[i].use_segtree = false;
+		return;
+	}
+
+	for (i = 0; i < winstate->numaggs; i++)
+	{
+		WindowStatePerAgg peraggstate = &winstate->peragg[i];
+
+		if (!peraggstate->use_segtree)
+			continue;
+		peraggstate->segtreeSize = nrows;
+		peraggstate->segtreeValues = (Datum *)
+			MemoryContextAllocHuge(winstate->partcontext,
+								   2 * nrows * sizeof(Datum));
+		peraggstate->segtreeNulls = (bool *)
+			MemoryContextAllocHuge(winstate->partcontext,
+								   2 * nrows * sizeof(bool));
+	}
+
+	/* Compute the leaves, reading each row of the partition once */
+	for (pos = 0; pos < nrows; pos++)
+	{
+		if (!window_gettupleslot(agg_winobj, pos, temp_slot))
+			elog(ERROR, "could not fetch partition row " INT64_FORMAT, pos);
+
+		/* Set tuple context for evaluation of aggregate arguments */
+		winstate->tmpcontext->ecxt_outertuple = temp_slot;
+
+		for (i = 0; i < winstate->numaggs; i++)
+		{
+			WindowStatePerAgg peraggstate = &winstate->peragg[i];
+			WindowStatePerFunc perfuncstate;
+			int64		leaf = nrows + pos;
+
+			if (!peraggstate->use_segtree)
+				continue;
+			perfuncstate = &winstate->perfunc[peraggstate->wfuncno];
+
+			/* transition from the initial value over just this row */
+			initialize_windowaggregate(winstate, perfuncstate, peraggstate);
+			advance_windowaggregate(winstate, perfuncstate, peraggstate);
+
+			peraggstate->segtreeNulls[leaf] = peraggstate->transValueIsNull;
+			if (peraggstate->transValueIsNull)
+				peraggstate->segtreeValues[leaf] = (Datum) 0;
+			else
+			{
+				oldContext = MemoryContextSwitchTo(winstate->partcontext);
+				peraggstate->segtreeValues[leaf] =
+					datumCopy(peraggstate->transValue,
+							  peraggstate->transtypeByVal,
+							  peraggstate->transtypeLen);
+				MemoryContextSwitchTo(oldContext);
+			}
+		}
+
+		/* Reset per-input-tuple context after each tuple */
+		ResetExprContext(winstate->tmpcontext);
+	}
+	ExecClearTuple(temp_slot);
+
+	/*
+	 * Now the inner nodes.  When nrows isn't a power of 2, some of them
+	 * combine leaves that aren't adjacent, but no query ever uses those.
+	 */
+	for (i = 0; i < winstate->numaggs; i++)
+	{
+		WindowStatePerAgg peraggstate = &winstate->peragg[i];
+		WindowStatePerFunc perfuncstate;
+
+		if (!peraggstate->use_segtree)
+			continue;
+		perfuncstate = &winstate->perfunc[peraggstate->wfuncno];
+
+		/* leave the private aggcontext clean for the first query */
+		initialize_windowaggregate(winstate, perfuncstate, peraggstate);
+
+		for (pos = nrows - 1; pos >= 1; pos--)
+		{
+			Datum		value = peraggstate->initValue;
+			bool		isnull = peraggstate->initValueIsNull;
+
+			if (!isnull)
+			{
+				oldContext = MemoryContextSwitchTo(winstate->partcontext);
+				value = datumCopy(value,
+								  peraggstate->transtypeByVal,
+								  peraggstate->transtypeLen);
+				MemoryContextSwitchTo(oldContext);
+			}
+			combine_windowaggregate(winstate, perfuncstate, peraggstate,
+									winstate->partcontext,
+									&value, &isnull,
+									peraggstate->segtreeValues[2 * pos],
+									peraggstate->segtreeNulls[2 * pos]);
+			combine_windowaggregate(winstate, perfuncstate, peraggstate,
+									winstate->partcontext,
+									&value, &isnull,
+									peraggstate->segtreeValues[2 * pos + 1],
+									peraggstate->segtreeNulls[2 * pos + 1]);
+			peraggstate->segtreeValues[pos] = value;
+			peraggstate->segtreeNulls[pos] = isnull;
+
+			ResetExprContext(winstate->tmpcontext);
+		}
+	}
+}
+
+/*
+ * eval_windowaggregate_segtree
+ * compute the transition value of a segment-tree aggregate over the current
+ * frame into peraggstate->transValue, ready for finalize_windowaggregate
+ *
+ * There must be no exclusion clause, so the frame is the contiguous range
+ * [frameheadpos, frametailpos).
+ */
+static void
+eval_windowaggregate_segtree(WindowAggState *winstate,
+							 WindowStatePerFunc perfuncstate,
+							 WindowStatePerAgg peraggstate)
+{
+	int64		nrows = peraggstate->segtreeSize;
+	int64		lo,
+				hi;
+	int64		leftnodes[64];
+	int64		rightnodes[64];
+	int			nleft = 0,
+				nright = 0;
+	int			i;
+
+	update_frametailpos(winstate);
+	lo = Min(winstate->frameheadpos, nrows);
+	hi = Min(winstate->frametailpos, nrows);
+
+	/* start over from the initial value, in a freshly reset aggcontext */
+	initialize_windowaggregate(winstate, perfuncstate, peraggstate);
+
+	/*
+	 * Collect the nodes covering [lo, hi), bottom-up.  Nodes found from the
+	 * left edge are in frame order; those from the right edge come out in
+	 * reverse.
+	 */
+	for (lo += nrows, hi += nrows; lo < hi; lo >>= 1, hi >>= 1)
+	{
+		if (lo & 1)
+			leftnodes[nleft++] = lo++;
+		if (hi & 1)
+			rightnodes[nright++] = --hi;
+	}
+
+	for (i = 0; i < nleft; i++)
+	{
+		combine_windowaggregate(winstate, perfuncstate, peraggstate,
+								peraggstate->aggcontext,
+								&peraggstate->transValue,
+								&peraggstate->transValueIsNull,
+								peraggstate->segtreeValues[leftnodes[i]],
+								peraggstate->segtreeNulls[leftnodes[i]]);
+		ResetExprContext(winstate->tmpcontext);
+	}
+	for (i = nright - 1; i >= 0; i--)
+	{
+		combine_windowaggregate(winstate, perfuncstate, peraggstate,
+								peraggstate->aggcontext,
+								&peraggstate->transValue,
+								&peraggstate->transValueIsNull,
+								peraggstate->segtreeValues[rightnodes[i]],
+								peraggstate->segtreeNulls[rightnodes[i]]);
+		ResetExprContext(winstate->tmpcontext);
+	}
+}
+
 /*
  * eval_windowaggregates
  * evaluate plain aggregates being used as window functions
@@ -665,6 +1043,7 @@ eval_windowaggregates(WindowAggState *winstate)
 	int			wfuncno,
 				numaggs,
 				numaggs_restart,
+				numaggs_segtree,
 				i;
 	int64		aggregatedupto_nonrestarted;
 	MemoryContext oldContext;
@@ -724,7 +1103,33 @@ eval_windowaggregates(WindowAggState *winstate)
 	 * 'aggregatedupto' keeps track of the first row that has not yet been
 	 * accumulated into the aggregate transition values.  Whenever we start a
 	 * new peer group, we accumulate forward to the end of the peer group.
+	 *
+	 * Aggregates that would have to restart whenever the frame head moves,
+	 * but that have a combine function, are instead evaluated from a segment
+	 * tree built over the whole partition (see initialize_peragg for the
+	 * exact conditions).  Those take no part in the incremental strategy
+	 * above; we just combine the tree nodes covering the frame for each row.
+	 */
+
+	/*
+	 * Build the segment trees on the first call for each partition.  This
+	 * can also decide not to use them for this partition after all.
 	 */
+	for (i = 0; i < numaggs; i++)
+	{
+		peraggstate = &winstate->peragg[i];
+		if (peraggstate->use_segtree && peraggstate->segtreeValues == NULL)
+		{
+			build_windowaggregate_segtrees(winstate);
+			break;
+		}
+	}
+	numaggs_segtree = 0;
+	for (i = 0; i < numaggs; i++)
+	{
+		if (winstate->peragg[i].use_segtree)
+			numaggs_segtree++;
+	}
 
 	/*
 	 * First, update the frame head position.
@@ -783,7 +1188,9 @@ eval_windowaggregates(WindowAggState *winstate)
 	for (i = 0; i < numaggs; i++)
 	{
 		peraggstate = &winstate->peragg[i];
-		if (winstate->currentpos == 0 ||
+		if (peraggstate->use_segtree)
+			peraggstate->restart = false;
+		else if (winstate->currentpos == 0 ||
 			(winstate->aggregatedbase != winstate->frameheadpos &&
 			 !OidIsValid(peraggstate->invtransfn_oid)) ||
 			(winstate->frameOptions & FRAMEOPTION_EXCLUSION) ||
@@ -803,7 +1210,7 @@ eval_windowaggregates(WindowAggState *winstate)
 	 * i.e. advance_windowaggregate_base() can return false, in which case
 	 * we'll restart that aggregate below.
 	 */
-	while (numaggs_restart < numaggs &&
+	while (numaggs_restart + numaggs_segtree < numaggs &&
 		   winstate->aggregatedbase < winstate->frameheadpos)
 	{
 		/*
@@ -826,7 +1233,7 @@ eval_windowaggregates(WindowAggState *winstate)
 			bool		ok;
 
 			peraggstate = &winstate->peragg[i];
-			if (peraggstate->restart)
+			if (peraggstate->restart || peraggstate->use_segtree)
 				continue;
 
 			wfuncno = peraggstate->wfuncno;
@@ -871,13 +1278,16 @@ eval_windowaggregates(WindowAggState *winstate)
 	 * aggcontext if that is the case.  Private aggcontexts are reset by
 	 * initialize_windowaggregate() if their owning aggregate restarts. If we
 	 * aren't restarting an aggregate, we need to free any previously saved
-	 * result for it, else we'll leak memory.
+	 * result for it, else we'll leak memory.  Segment-tree aggregates reset
+	 * their private aggcontext in eval_windowaggregate_segtree() instead.
 	 */
 	if (numaggs_restart > 0)
 		MemoryContextResetAndDeleteChildren(winstate->aggcontext);
 	for (i = 0; i < numaggs; i++)
 	{
 		peraggstate = &winstate->peragg[i];
+		if (peraggstate->use_segtree)
+			continue;
 
 		/* Aggregates using the shared ctx must restart if *any* agg does */
 		Assert(peraggstate->aggcontext != winstate->aggcontext ||
@@ -923,9 +1333,10 @@ eval_windowaggregates(WindowAggState *winstate)
 	 *
 	 * Note the loop invariant: agg_row_slot is either empty or holds the row
 	 * at position aggregatedupto.  We advance aggregatedupto after processing
-	 * a row.
+	 * a row.  If all the aggregates use segment trees, there is nothing to
+	 * accumulate, and the rows before the frame head may be gone already.
 	 */
-	for (;;)
+	while (numaggs_segtree < numaggs)
 	{
 		int			ret;
 
@@ -954,6 +1365,8 @@ eval_windowaggregates(WindowAggState *winstate)
 		for (i = 0; i < numaggs; i++)
 		{
 			peraggstate = &winstate->peragg[i];
+			if (peraggstate->use_segtree)
+				continue;
 
 			/* Non-restarted aggs skip until aggregatedupto_nonrestarted */
 			if (!peraggstate->restart &&
@@ -990,6 +1403,10 @@ next_tuple:
 		wfuncno = peraggstate->wfuncno;
 		result = &econtext->ecxt_aggvalues[wfuncno];
 		isnull = &econtext->ecxt_aggnulls[wfuncno];
+		if (peraggstate->use_segtree)
+			eval_windowaggregate_segtree(winstate,
+										 &winstate->perfunc[wfuncno],
+										 peraggstate);
 		finalize_windowaggregate(winstate,
 								 &winstate->perfunc[wfuncno],
 								 peraggstate,
@@ -1070,6 +1487,22 @@ eval_windowfunction(WindowAggState *winstate, WindowStatePerFunc perfuncstate,
 	MemoryContextSwitchTo(oldContext);
 }
 
+/*
+ * fetch_input_tuple
+ * Fetch the next input row, or return an empty slot at the end of input.
+ *
+ * Normally the outer plan delivers the rows in the required order, but a
+ * parallel-aware WindowAgg gets its rows from the buckets it sorts itself.
+ */
+static TupleTableSlot *
+fetch_input_tuple(WindowAggState *winstate)
+{
+	if (winstate->ss.ps.plan->parallel_aware)
+		return parallel_window_next_tuple(winstate);
+
+	return ExecProcNode(outerPlanState(winstate));
+}
+
 /*
  * begin_partition
  * Start buffering rows of the next partition.
@@ -1078,7 +1511,6 @@ static void
 begin_partition(WindowAggState *winstate)
 {
 	WindowAgg  *node = (WindowAgg *) winstate->ss.ps.plan;
-	PlanState  *outerPlan = outerPlanState(winstate);
 	int			frameOptions = winstate->frameOptions;
 	int			numfuncs = winstate->numfuncs;
 	int			i;
@@ -1108,7 +1540,7 @@ begin_partition(WindowAggState *winstate)
 	 */
 	if (TupIsNull(winstate->first_part_slot))
 	{
-		TupleTableSlot *outerslot = ExecProcNode(outerPlan);
+		TupleTableSlot *outerslot = fetch_input_tuple(winstate);
 
 		if (!TupIsNull(outerslot))
 			ExecCopySlot(winstate->first_part_slot, outerslot);
@@ -1238,7 +1670,6 @@ static void
 spool_tuples(WindowAggState *winstate, int64 pos)
 {
 	WindowAgg  *node = (WindowAgg *) winstate->ss.ps.plan;
-	PlanState  *outerPlan;
 	TupleTableSlot *outerslot;
 	MemoryContext oldcontext;
 
@@ -1258,14 +1689,12 @@ spool_tuples(WindowAggState *winstate, int64 pos)
 	if (!tuplestore_in_memory(winstate->buffer))
 		pos = -1;
 
-	outerPlan = outerPlanState(winstate);
-
 	/* Must be in query context to call outerplan */
 	oldcontext = MemoryContextSwitchTo(winstate->ss.ps.ps_ExprContext->ecxt_per_query_memory);
 
 	while (winstate->spooled_rows <= pos || pos == -1)
 	{
-		outerslot = ExecProcNode(outerPlan);
+		outerslot = fetch_input_tuple(winstate);
 		if (TupIsNull(outerslot))
 		{
 			/* reached the end of the last partition */
@@ -1333,6 +1762,10 @@ release_partition(WindowAggState *winstate)
 	{
 		if (winstate->peragg[i].aggcontext != winstate->aggcontext)
 			MemoryContextResetAndDeleteChildren(winstate->peragg[i].aggcontext);
+		/* any segment tree was in partcontext */
+		winstate->peragg[i].segtreeValues = NULL;
+		winstate->peragg[i].segtreeNulls = NULL;
+		winstate->peragg[i].use_segtree = winstate->peragg[i].segtree_ok;
 	}
 
 	if (winstate->buffer)
@@ -2369,6 +2802,12 @@ ExecInitWindowAgg(WindowAgg *node, EState *estate, int eflags)
 								   node->ordOperators,
 								   &winstate->ss.ps);
 
+	/*
+	 * Copy frame options to state node for easy access.  Do this before
+	 * setting up the per-agg state, since initialize_peragg looks at them.
+	 */
+	winstate->frameOptions = frameOptions;
+
 	/*
 	 * WindowAgg nodes use aggvalues and aggnulls as well as Agg nodes.
 	 */
@@ -2486,9 +2925,6 @@ ExecInitWindowAgg(WindowAgg *node, EState *estate, int eflags)
 		winstate->agg_winobj = agg_winobj;
 	}
 
-	/* copy frame options to state node for easy access */
-	winstate->frameOptions = frameOptions;
-
 	/* initialize frame bound offset expressions */
 	winstate->startOffset = ExecInitExpr((Expr *) node->startOffset,
 										 (PlanState *) winstate);
@@ -2508,6 +2944,20 @@ ExecInitWindowAgg(WindowAgg *node, EState *estate, int eflags)
 	winstate->partition_spooled = false;
 	winstate->more_partitions = false;
 
+	/*
+	 * A parallel-aware WindowAgg needs to hash the partitioning columns to
+	 * redistribute its input, and a slot for the tuples it sorts.  Its
+	 * shared state is set up later, if we get to run in parallel at all.
+	 */
+	if (node->plan.parallel_aware)
+	{
+		Oid		   *eqfuncoids;
+
+		execTuplesHashPrepare(node->partNumCols, node->partOperators,
+							  &eqfuncoids, &winstate->pwa_hashfunctions);
+		winstate->pwa_slot = ExecInitExtraTupleSlot(estate, scanDesc);
+	}
+
 	return winstate;
 }
 
@@ -2532,6 +2982,12 @@ ExecEndWindowAgg(WindowAggState *node)
 		ExecClearTuple(node->framehead_slot);
 	if (node->frametail_slot)
 		ExecClearTuple(node->frametail_slot);
+	if (node->pwa_slot)
+		ExecClearTuple(node->pwa_slot);
+
+	if (node->pwa_sort)
+		tuplesort_end((Tuplesortstate *) node->pwa_sort);
+	node->pwa_sort = NULL;
 
 	/*
 	 * Free both the expr contexts.
@@ -2581,6 +3037,14 @@ ExecReScanWindowAgg(WindowAggState *node)
 		ExecClearTuple(node->framehead_slot);
 	if (node->frametail_slot)
 		ExecClearTuple(node->frametail_slot);
+	if (node->pwa_slot)
+		ExecClearTuple(node->pwa_slot);
+
+	/* a parallel-aware WindowAgg will have to start over, too */
+	if (node->pwa_sort)
+		tuplesort_end((Tuplesortstate *) node->pwa_sort);
+	node->pwa_sort = NULL;
+	node->pwa_started = false;
 
 	/* Forget current wfunc values */
 	MemSet(econtext->ecxt_aggvalues, 0, sizeof(Datum) * node->numfuncs);
@@ -2594,6 +3058,364 @@ ExecReScanWindowAgg(WindowAggState *node)
 		ExecReScan(outerPlan);
 }
 
+/* ----------------------------------------------------------------
+ *						Parallel Query Support
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * parallel_window_next_tuple
+ * Fetch the next input row of a parallel-aware WindowAgg.
+ *
+ * The first call redistributes the input; after that we return the rows of
+ * the bucket we sorted last, claiming and sorting another one whenever it
+ * runs out.  Since all rows of a window partition are in the same bucket,
+ * moving on to another bucket always starts a new partition.  Without
+ * shared state, as when no workers could be launched, all of our input is
+ * treated as one bucket.
+ */
+static TupleTableSlot *
+parallel_window_next_tuple(WindowAggState *winstate)
+{
+	ParallelWindowAggShared *pshared = winstate->pwa_shared;
+	MemoryContext oldcontext;
+
+	/* Sorting and reading the buckets must be done in query context */
+	oldcontext = MemoryContextSwitchTo(winstate->ss.ps.ps_ExprContext->ecxt_per_query_memory);
+
+	if (!winstate->pwa_started)
+	{
+		winstate->pwa_started = true;
+
+		if (pshared != NULL)
+			parallel_window_redistribute(winstate);
+		else
+		{
+			PlanState  *outerPlan = outerPlanState(winstate);
+			Tuplesortstate *sortstate = parallel_window_begin_sort(winstate);
+
+			for (;;)
+			{
+				TupleTableSlot *outerslot = ExecProcNode(outerPlan);
+
+				if (TupIsNull(outerslot))
+					break;
+				tuplesort_puttupleslot(sortstate, outerslot);
+			}
+			tuplesort_performsort(sortstate);
+			winstate->pwa_sort = sortstate;
+		}
+	}
+
+	for (;;)
+	{
+		uint32		bucket;
+
+		if (winstate->pwa_sort != NULL)
+		{
+			if (tuplesort_gettupleslot((Tuplesortstate *) winstate->pwa_sort,
+									   true, false, winstate->pwa_slot, NULL))
+				break;
+
+			tuplesort_end((Tuplesortstate *) winstate->pwa_sort);
+			winstate->pwa_sort = NULL;
+		}
+
+		/* Claim the next bucket, if any are left */
+		if (pshared == NULL)
+			break;
+		bucket = pg_atomic_fetch_add_u32(&pshared->nextbucket, 1);
+		if (bucket >= pshared->nbuckets)
+			break;
+
+		parallel_window_sort_bucket(winstate, bucket);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	/* the slot is empty if we ran out of buckets */
+	return winstate->pwa_slot;
+}
+
+/*
+ * parallel_window_redistribute
+ * Write the rows we read from the outer plan to the buckets.
+ *
+ * Participants that show up after redistribution has finished have nothing
+ * to add: the partial plan beneath us has been run to completion by then.
+ */
+static void
+parallel_window_redistribute(WindowAggState *winstate)
+{
+	ParallelWindowAggShared *pshared = winstate->pwa_shared;
+	PlanState  *outerPlan = outerPlanState(winstate);
+	int			i;
+
+	if (BarrierAttach(&pshared->barrier) == PWA_PHASE_REDISTRIBUTING)
+	{
+		for (;;)
+		{
+			TupleTableSlot *outerslot = ExecProcNode(outerPlan);
+			uint32		hashvalue;
+
+			if (TupIsNull(outerslot))
+				break;
+
+			hashvalue = parallel_window_hash(winstate, outerslot);
+			sts_puttuple(winstate->pwa_buckets[hashvalue % pshared->nbuckets],
+						 NULL, ExecFetchSlotMinimalTuple(outerslot));
+		}
+
+		for (i = 0; i < pshared->nbuckets; i++)
+			sts_end_write(winstate->pwa_buckets[i]);
+
+		/* Wait for everybody else to finish writing */
+		BarrierArriveAndWait(&pshared->barrier,
+							 WAIT_EVENT_PARALLEL_WINDOW_REDISTRIBUTE);
+	}
+	BarrierDetach(&pshared->barrier);
+}
+
+/*
+ * parallel_window_sort_bucket
+ * Read back all the rows of a bucket we claimed, and sort them.
+ */
+static void
+parallel_window_sort_bucket(WindowAggState *winstate, int bucket)
+{
+	SharedTuplestoreAccessor *accessor = winstate->pwa_buckets[bucket];
+	Tuplesortstate *sortstate = parallel_window_begin_sort(winstate);
+	MinimalTuple tuple;
+
+	sts_begin_parallel_scan(accessor);
+	while ((tuple = sts_parallel_scan_next(accessor, NULL)) != NULL)
+	{
+		ExecStoreMinimalTuple(tuple, winstate->pwa_slot, false);
+		tuplesort_puttupleslot(sortstate, winstate->pwa_slot);
+	}
+	sts_end_parallel_scan(accessor);
+	ExecClearTuple(winstate->pwa_slot);
+
+	tuplesort_performsort(sortstate);
+	winstate->pwa_sort = sortstate;
+}
+
+/*
+ * parallel_window_begin_sort
+ * Set up a sort on the partitioning columns, then the ordering columns.
+ */
+static Tuplesortstate *
+parallel_window_begin_sort(WindowAggState *winstate)
+{
+	WindowAgg  *node = (WindowAgg *) winstate->ss.ps.plan;
+
+	return tuplesort_begin_heap(winstate->ss.ss_ScanTupleSlot->tts_tupleDescriptor,
+								node->numSortCols,
+								node->sortColIdx,
+								node->sortOperators,
+								node->collations,
+								node->nullsFirst,
+								work_mem,
+								NULL,
+								false);
+}
+
+/*
+ * parallel_window_hash
+ * Compute the hash value of the partitioning columns of a row.
+ *
+ * This combines the column hashes the same way as execGrouping.c does.
+ */
+static uint32
+parallel_window_hash(WindowAggState *winstate, TupleTableSlot *slot)
+{
+	WindowAgg  *node = (WindowAgg *) winstate->ss.ps.plan;
+	ExprContext *econtext = winstate->tmpcontext;
+	MemoryContext oldcontext;
+	uint32		hashkey = 0;
+	int			i;
+
+	/* hash functions might leak memory, so use the per-tuple context */
+	ResetExprContext(econtext);
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	for (i = 0; i < node->partNumCols; i++)
+	{
+		Datum		attr;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		attr = slot_getattr(slot, node->partColIdx[i], &isNull);
+
+		if (!isNull)			/* treat nulls as having hash key 0 */
+			hashkey ^= DatumGetUInt32(FunctionCall1(&winstate->pwa_hashfunctions[i],
+													attr));
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	return murmurhash32(hashkey);
+}
+
+/*
+ * Space needed for the shared state of a parallel-aware WindowAgg.
+ */
+static Size
+parallel_window_shared_size(int nparticipants, int nbuckets)
+{
+	return add_size(MAXALIGN(sizeof(ParallelWindowAggShared)),
+					mul_size(nbuckets, MAXALIGN(sts_estimate(nparticipants))));
+}
+
+/*
+ * parallel_window_init_buckets
+ * Initialize the buckets' shared tuplestores, and attach to them.
+ *
+ * The accessors, and the buffers they allocate later, live in
+ * pwa_bucketcxt, so that a rescan can get rid of them all at once.
+ */
+static void
+parallel_window_init_buckets(WindowAggState *winstate)
+{
+	ParallelWindowAggShared *pshared = winstate->pwa_shared;
+	MemoryContext oldcontext;
+	int			i;
+
+	oldcontext = MemoryContextSwitchTo(winstate->pwa_bucketcxt);
+
+	for (i = 0; i < pshared->nbuckets; i++)
+	{
+		char		name[MAXPGPATH];
+
+		snprintf(name, MAXPGPATH, "windowagg.%d", i);
+		winstate->pwa_buckets[i] =
+			sts_initialize(ParallelWindowAggBucket(pshared, i),
+						   pshared->nparticipants,
+						   0,
+						   0,
+						   SHARED_TUPLESTORE_SINGLE_PASS,
+						   &pshared->fileset,
+						   name);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecWindowAggEstimate
+ *
+ *		Estimate space required to redistribute the input of a
+ *		parallel-aware WindowAgg.
+ * ----------------------------------------------------------------
+ */
+void
+ExecWindowAggEstimate(WindowAggState *node, ParallelContext *pcxt)
+{
+	int			nparticipants = pcxt->nworkers + 1;
+
+	/* don't need anything if no workers; we'll run as a single bucket */
+	if (pcxt->nworkers == 0)
+		return;
+
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   parallel_window_shared_size(nparticipants,
+													   nparticipants * PWA_BUCKETS_PER_PARTICIPANT));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecWindowAggInitializeDSM
+ *
+ *		Set up the shared state of a parallel-aware WindowAgg.
+ * ----------------------------------------------------------------
+ */
+void
+ExecWindowAggInitializeDSM(WindowAggState *node, ParallelContext *pcxt)
+{
+	ParallelWindowAggShared *pshared;
+	int			nparticipants = pcxt->nworkers + 1;
+	int			nbuckets = nparticipants * PWA_BUCKETS_PER_PARTICIPANT;
+
+	/* don't need anything if no workers; we'll run as a single bucket */
+	if (pcxt->nworkers == 0)
+		return;
+
+	pshared = shm_toc_allocate(pcxt->toc,
+							   parallel_window_shared_size(nparticipants,
+														   nbuckets));
+	BarrierInit(&pshared->barrier, 0);
+	pg_atomic_init_u32(&pshared->nextbucket, 0);
+	pshared->nparticipants = nparticipants;
+	pshared->nbuckets = nbuckets;
+	SharedFileSetInit(&pshared->fileset, pcxt->seg);
+	shm_toc_insert(pcxt->toc, node->ss.ps.plan->plan_node_id, pshared);
+
+	/* The leader is participant 0 */
+	node->pwa_shared = pshared;
+	node->pwa_buckets = palloc(sizeof(SharedTuplestoreAccessor *) * nbuckets);
+	node->pwa_bucketcxt = AllocSetContextCreate(CurrentMemoryContext,
+												"WindowAgg buckets",
+												ALLOCSET_DEFAULT_SIZES);
+	parallel_window_init_buckets(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecWindowAggReInitializeDSM
+ *
+ *		Reset shared state before beginning a fresh scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecWindowAggReInitializeDSM(WindowAggState *node, ParallelContext *pcxt)
+{
+	ParallelWindowAggShared *pshared = node->pwa_shared;
+	int			i;
+
+	if (pshared == NULL)
+		return;
+
+	/* Close our files of the last scan, and free the old accessors */
+	for (i = 0; i < pshared->nbuckets; i++)
+	{
+		sts_end_write(node->pwa_buckets[i]);
+		sts_end_parallel_scan(node->pwa_buckets[i]);
+	}
+	MemoryContextReset(node->pwa_bucketcxt);
+
+	/* Get rid of the files of the last scan and start over */
+	SharedFileSetDeleteAll(&pshared->fileset);
+	BarrierInit(&pshared->barrier, 0);
+	pg_atomic_write_u32(&pshared->nextbucket, 0);
+	parallel_window_init_buckets(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecWindowAggInitializeWorker
+ *
+ *		Attach worker to the shared state of a parallel-aware WindowAgg.
+ * ----------------------------------------------------------------
+ */
+void
+ExecWindowAggInitializeWorker(WindowAggState *node,
+							  ParallelWorkerContext *pwcxt)
+{
+	ParallelWindowAggShared *pshared;
+	int			i;
+
+	pshared = shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, false);
+	SharedFileSetAttach(&pshared->fileset, pwcxt->seg);
+
+	node->pwa_shared = pshared;
+	node->pwa_buckets = palloc(sizeof(SharedTuplestoreAccessor *) *
+							   pshared->nbuckets);
+	for (i = 0; i < pshared->nbuckets; i++)
+		node->pwa_buckets[i] = sts_attach(ParallelWindowAggBucket(pshared, i),
+										  ParallelWorkerNumber + 1,
+										  &pshared->fileset);
+}
+
 /*
  * initialize_peragg
  *
@@ -2613,12 +3435,14 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 	bool		use_ma_code;
 	Oid			transfn_oid,
 				invtransfn_oid,
-				finalfn_oid;
+				finalfn_oid,
+				combinefn_oid;
 	bool		finalextra;
 	char		finalmodify;
 	Expr	   *transfnexpr,
 			   *invtransfnexpr,
-			   *finalfnexpr;
+			   *finalfnexpr,
+			   *combinefnexpr;
 	Datum		textInitVal;
 	int			i;
 	ListCell   *lc;
@@ -2681,6 +3505,25 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 		initvalAttNo = Anum_pg_aggregate_agginitval;
 	}
 
+	/*
+	 * If we can't use moving-aggregate code but the frame head can move, the
+	 * aggregation would have to restart for nearly every row.  Use a segment
+	 * tree instead if the aggregate has a combine function.  That requires a
+	 * contiguous frame, so not with an exclusion clause, and the same caveat
+	 * as above about volatile functions applies, since each row's arguments
+	 * are evaluated only once.  Transition states of type internal are
+	 * excluded too, since we need to be able to copy them with datumCopy.
+	 */
+	combinefn_oid = aggform->aggcombinefn;
+	peraggstate->segtree_ok =
+		!use_ma_code &&
+		OidIsValid(combinefn_oid) &&
+		aggtranstype != INTERNALOID &&
+		!(winstate->frameOptions & (FRAMEOPTION_START_UNBOUNDED_PRECEDING |
+									FRAMEOPTION_EXCLUSION)) &&
+		!contain_volatile_functions((Node *) wfunc);
+	peraggstate->use_segtree = peraggstate->segtree_ok;
+
 	/*
 	 * ExecInitWindowAgg already checked permission to call aggregate function
 	 * ... but we still need to check the component functions
@@ -2725,6 +3568,16 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 							   get_func_name(finalfn_oid));
 			InvokeFunctionExecuteHook(finalfn_oid);
 		}
+
+		if (peraggstate->segtree_ok)
+		{
+			aclresult = pg_proc_aclcheck(combinefn_oid, aggOwner,
+										 ACL_EXECUTE);
+			if (aclresult != ACLCHECK_OK)
+				aclcheck_error(aclresult, OBJECT_FUNCTION,
+							   get_func_name(combinefn_oid));
+			InvokeFunctionExecuteHook(combinefn_oid);
+		}
 	}
 
 	/*
@@ -2772,6 +3625,16 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 		fmgr_info_set_expr((Node *) invtransfnexpr, &peraggstate->invtransfn);
 	}
 
+	if (peraggstate->segtree_ok)
+	{
+		build_aggregate_combinefn_expr(aggtranstype,
+									   wfunc->inputcollid,
+									   combinefn_oid,
+									   &combinefnexpr);
+		fmgr_info(combinefn_oid, &peraggstate->combinefn);
+		fmgr_info_set_expr((Node *) combinefnexpr, &peraggstate->combinefn);
+	}
+
 	if (OidIsValid(finalfn_oid))
 	{
 		build_aggregate_finalfn_expr(inputTypes,
@@ -2793,6 +3656,12 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 					&peraggstate->transtypeLen,
 					&peraggstate->transtypeByVal);
 
+	/* a tree node is a Datum and a null flag, plus any by-ref value */
+	peraggstate->segtreeNodeSize = sizeof(Datum) + sizeof(bool);
+	if (!peraggstate->transtypeByVal)
+		peraggstate->segtreeNodeSize +=
+			MAXALIGN(get_typavgwidth(aggtranstype, -1));
+
 	/*
 	 * initval is potentially null, so don't try to access it as a struct
 	 * field. Must do it the hard way with SysCacheGetAttr.
@@ -2850,8 +3719,11 @@ initialize_peragg(WindowAggState *winstate, WindowFunc *wfunc,
 	 * make the memory allocation rules for moving aggregates different than
 	 * they have historically been for plain aggregates, but that seems grotty
 	 * and likely to lead to memory leaks.
+	 *
+	 * Segment-tree aggregates also use their own aggcontext, since they never
+	 * restart together with the others.
 	 */
-	if (OidIsValid(invtransfn_oid))
+	if (OidIsValid(invtransfn_oid) || peraggstate->segtree_ok)
 		peraggstate->aggcontext =
 			AllocSetContextCreate(CurrentMemoryContext,
 								  "WindowAgg Per Aggregate",
@@ -45,6 +45,11 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc, int natts)
 	LLVMBasicBlockRef b_adjust_unavail_cols;
 	LLVMBasicBlockRef b_find_start;
 
+	LLVMBasicBlockRef b_prefix_checkattno = NULL;
+	LLVMBasicBlockRef b_prefix_checknulls = NULL;
+	LLVMBasicBlockRef b_prefix_checkbitmap = NULL;
+	LLVMBasicBlockRef b_prefix = NULL;
+
 	LLVMBasicBlockRef b_out;
 	LLVMBasicBlockRef b_dead;
 	LLVMBasicBlockRef *attcheckattnoblocks;
@@ -86,6 +91,9 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc, int natts)
 	/* if true, known_alignment describes definite offset of column */
 	bool		attguaranteedalign = true;
 
+	/* number of leading fixed-width columns deformed at once, if any */
+	int			nfixed = 0;
+
 	int			attnum;
 
 	mod = llvm_mutable_module(context);
@@ -117,6 +125,23 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc, int natts)
 			guaranteed_column_number = attnum;
 	}
 
+	/*
+	 * If the tuple starts with fixed-width columns, some of which are
+	 * nullable, emit a path that deforms all of them at their precomputed
+	 * offsets, for tuples that have no NULLs among them.  Otherwise every
+	 * nullable column has to be checked separately, and the offsets of the
+	 * columns following it have to be computed at runtime.  If all of them
+	 * are NOT NULL, the code below already uses constant offsets.
+	 */
+	nfixed = Min(natts, TupleDescFixedPrefix(desc));
+	for (attnum = 0; attnum < nfixed; attnum++)
+	{
+		if (!TupleDescAttr(desc, attnum)->attnotnull)
+			break;
+	}
+	if (attnum == nfixed || nfixed < 2)
+		nfixed = 0;
+
 	/* Create the signature and function */
 	{
 		LLVMTypeRef param_types[1];
@@ -137,6 +162,17 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc, int natts)
 		LLVMAppendBasicBlock(v_deform_fn, "adjust_unavail_cols");
 	b_find_start =
 		LLVMAppendBasicBlock(v_deform_fn, "find_startblock");
+	if (nfixed > 0)
+	{
+		b_prefix_checkattno =
+			LLVMAppendBasicBlock(v_deform_fn, "block.prefix.checkattno");
+		b_prefix_checknulls =
+			LLVMAppendBasicBlock(v_deform_fn, "block.prefix.checknulls");
+		b_prefix_checkbitmap =
+			LLVMAppendBasicBlock(v_deform_fn, "block.prefix.checkbitmap");
+		b_prefix =
+			LLVMAppendBasicBlock(v_deform_fn, "block.prefix.deform");
+	}
 	b_out =
 		LLVMAppendBasicBlock(v_deform_fn, "outblock");
 	b_dead =
@@ -306,7 +342,10 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc, int natts)
 		{
 			LLVMValueRef v_attno = l_int32_const(attnum);
 
-			LLVMAddCase(v_switch, v_attno, attcheckattnoblocks[attnum]);
+			if (attnum == 0 && nfixed > 0)
+				LLVMAddCase(v_switch, v_attno, b_prefix_checkattno);
+			else
+				LLVMAddCase(v_switch, v_attno, attcheckattnoblocks[attnum]);
 		}
 
 	}
@@ -319,6 +358,101 @@ slot_compile_deform(LLVMJitContext *context, TupleDesc desc, int natts)
 	LLVMPositionBuilderAtEnd(b, b_dead);
 	LLVMBuildUnreachable(b);
 
+	/*
+	 * Build the fixed-width prefix path.  It's taken if the tuple stores all
+	 * of the prefix columns and none of them is NULL; otherwise we fall back
+	 * to deforming column by column.
+	 */
+	if (nfixed > 0)
+	{
+		LLVMValueRef v_allset = NULL;
+		Form_pg_attribute att;
+
+		/* check that all prefix columns are stored in the tuple */
+		LLVMPositionBuilderAtEnd(b, b_prefix_checkattno);
+		if ((nfixed - 1) <= guaranteed_column_number)
+			LLVMBuildBr(b, b_prefix_checknulls);
+		else
+			LLVMBuildCondBr(b,
+							LLVMBuildICmp(b, LLVMIntUGE,
+										  v_maxatt,
+										  l_int16_const(nfixed),
+										  ""),
+							b_prefix_checknulls,
+							attcheckattnoblocks[0]);
+
+		/* only need to look at the null bitmap if there is one */
+		LLVMPositionBuilderAtEnd(b, b_prefix_checknulls);
+		LLVMBuildCondBr(b, v_hasnulls, b_prefix_checkbitmap, b_prefix);
+
+		/* check that the bitmap has the bits of all prefix columns set */
+		LLVMPositionBuilderAtEnd(b, b_prefix_checkbitmap);
+		for (attnum = 0; attnum < nfixed; attnum += 8)
+		{
+			int			nbits = Min(nfixed - attnum, 8);
+			int			mask = (1 << nbits) - 1;
+			LLVMValueRef v_nullbyte;
+			LLVMValueRef v_isset;
+
+			v_nullbyte = l_load_gep1(b, v_bits, l_int32_const(attnum >> 3),
+									 "prefixnullbyte");
+			v_isset = LLVMBuildICmp(b, LLVMIntEQ,
+									LLVMBuildAnd(b, v_nullbyte,
+												 l_int8_const(mask), ""),
+									l_int8_const(mask),
+									"");
+			if (v_allset == NULL)
+				v_allset = v_isset;
+			else
+				v_allset = LLVMBuildAnd(b, v_allset, v_isset, "");
+		}
+		LLVMBuildCondBr(b, v_allset, b_prefix, attcheckattnoblocks[0]);
+
+		/* deform the prefix columns at their precomputed offsets */
+		LLVMPositionBuilderAtEnd(b, b_prefix);
+		for (attnum = 0; attnum < nfixed; attnum++)
+		{
+			LLVMValueRef l_attno = l_int16_const(attnum);
+			LLVMValueRef v_attoff;
+			LLVMValueRef v_attdatap;
+			LLVMValueRef v_tmp_loaddata;
+
+			att = TupleDescAttr(desc, attnum);
+			Assert(att->attlen > 0 && att->attcacheoff >= 0);
+
+			v_attoff = l_sizet_const(att->attcacheoff);
+			v_attdatap = LLVMBuildGEP(b, v_tupdata_base, &v_attoff, 1, "");
+
+			if (att->attbyval)
+			{
+				LLVMTypeRef vartypep =
+				LLVMPointerType(LLVMIntType(att->attlen * 8), 0);
+
+				v_tmp_loaddata =
+					LLVMBuildPointerCast(b, v_attdatap, vartypep, "");
+				v_tmp_loaddata = LLVMBuildLoad(b, v_tmp_loaddata, "attr_byval");
+				v_tmp_loaddata = LLVMBuildZExt(b, v_tmp_loaddata, TypeSizeT, "");
+			}
+			else
+				v_tmp_loaddata =
+					LLVMBuildPtrToInt(b, v_attdatap, TypeSizeT, "attr_ptr");
+
+			LLVMBuildStore(b, v_tmp_loaddata,
+						   LLVMBuildGEP(b, v_tts_values, &l_attno, 1, ""));
+			LLVMBuildStore(b, l_int8_const(0),
+						   LLVMBuildGEP(b, v_tts_nulls, &l_attno, 1, ""));
+		}
+
+		att = TupleDescAttr(desc, nfixed - 1);
+		LLVMBuildStore(b, l_sizet_const(att->attcacheoff + att->attlen),
+					   v_offp);
+
+		if (nfixed == natts)
+			LLVMBuildBr(b, b_out);
+		else
+			LLVMBuildBr(b, attcheckattnoblocks[nfixed]);
+	}
+
 	/*
 	 * Iterate over each attribute that needs to be deformed, build code to
 	 * deform it.
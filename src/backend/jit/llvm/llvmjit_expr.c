@@ -702,6 +702,111 @@ llvm_compile_expr(ExprState *state)
 				LLVMBuildBr(b, opblocks[i + 1]);
 				break;
 
+			case EEOP_HASHDATUM_FIRST:
+			case EEOP_HASHDATUM_FIRST_STRICT:
+			case EEOP_HASHDATUM_NEXT32:
+			case EEOP_HASHDATUM_NEXT32_STRICT:
+				{
+					FunctionCallInfo fcinfo = op->d.hashdatum.fcinfo_data;
+					bool		is_first;
+					bool		is_strict;
+					LLVMValueRef v_fcinfo;
+					LLVMValueRef v_argnullp;
+					LLVMValueRef v_argisnull;
+					LLVMValueRef v_prevhash = NULL;
+					LLVMValueRef v_fcinfo_isnull;
+					LLVMValueRef v_retval;
+					LLVMValueRef v_hash;
+					LLVMBasicBlockRef b_ifnotnull;
+					LLVMBasicBlockRef b_ifnull;
+
+					is_first = (opcode == EEOP_HASHDATUM_FIRST ||
+								opcode == EEOP_HASHDATUM_FIRST_STRICT);
+					is_strict = (opcode == EEOP_HASHDATUM_FIRST_STRICT ||
+								 opcode == EEOP_HASHDATUM_NEXT32_STRICT);
+
+					b_ifnotnull = l_bb_before_v(opblocks[i + 1],
+												"b.%d.ifnotnull", i);
+					b_ifnull = l_bb_before_v(opblocks[i + 1],
+											 "b.%d.ifnull", i);
+
+					/*
+					 * Unless this is the first key, load the hash value
+					 * computed so far and rotate it left by one bit.
+					 */
+					if (!is_first)
+					{
+						LLVMValueRef v_iresultp;
+						LLVMValueRef v_tmp1;
+						LLVMValueRef v_tmp2;
+
+						v_iresultp = l_ptr_const(op->d.hashdatum.iresult,
+												 l_ptr(TypeSizeT));
+						v_prevhash = LLVMBuildLoad(b, v_iresultp, "prevhash");
+						v_prevhash = LLVMBuildTrunc(b, v_prevhash,
+													LLVMInt32Type(), "");
+						v_tmp1 = LLVMBuildShl(b, v_prevhash,
+											  l_int32_const(1), "");
+						v_tmp2 = LLVMBuildLShr(b, v_prevhash,
+											   l_int32_const(31), "");
+						v_prevhash = LLVMBuildOr(b, v_tmp1, v_tmp2,
+												 "rotatedhash");
+					}
+
+					/* check whether the key is NULL */
+					v_fcinfo =
+						l_ptr_const(fcinfo, l_ptr(StructFunctionCallInfoData));
+					v_argnullp =
+						LLVMBuildStructGEP(b,
+										   v_fcinfo,
+										   FIELDNO_FUNCTIONCALLINFODATA_ARGNULL,
+										   "v_argnullp");
+					v_argisnull = l_load_struct_gep(b, v_argnullp, 0, "");
+					LLVMBuildCondBr(b,
+									LLVMBuildICmp(b, LLVMIntEQ, v_argisnull,
+												  l_sbool_const(1), ""),
+									b_ifnull,
+									b_ifnotnull);
+
+					/* NULL key */
+					LLVMPositionBuilderAtEnd(b, b_ifnull);
+					if (is_strict)
+					{
+						/* the tuple can't match, so the result is NULL */
+						LLVMBuildStore(b, l_sizet_const(0), v_tmpvaluep);
+						LLVMBuildStore(b, l_sbool_const(1), v_tmpisnullp);
+						LLVMBuildBr(b, opblocks[op->d.hashdatum.jumpdone]);
+					}
+					else
+					{
+						/* a NULL key hashes as 0 */
+						if (is_first)
+							v_hash = l_sizet_const(0);
+						else
+							v_hash = LLVMBuildZExt(b, v_prevhash, TypeSizeT,
+												   "");
+						LLVMBuildStore(b, v_hash, v_resvaluep);
+						LLVMBuildStore(b, l_sbool_const(0), v_resnullp);
+						LLVMBuildBr(b, opblocks[i + 1]);
+					}
+
+					/*
+					 * Call the hash function.  Calling it directly, rather
+					 * than through the interpreter, allows it to be inlined.
+					 */
+					LLVMPositionBuilderAtEnd(b, b_ifnotnull);
+					v_retval = BuildV1Call(context, b, mod, fcinfo,
+										   &v_fcinfo_isnull);
+					v_hash = LLVMBuildTrunc(b, v_retval, LLVMInt32Type(), "");
+					if (!is_first)
+						v_hash = LLVMBuildXor(b, v_prevhash, v_hash, "");
+					v_hash = LLVMBuildZExt(b, v_hash, TypeSizeT, "");
+					LLVMBuildStore(b, v_hash, v_resvaluep);
+					LLVMBuildStore(b, l_sbool_const(0), v_resnullp);
+					LLVMBuildBr(b, opblocks[i + 1]);
+					break;
+				}
+
 			case EEOP_BOOL_AND_STEP_FIRST:
 				{
 					LLVMValueRef v_boolanynullp;
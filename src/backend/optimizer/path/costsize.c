@@ -78,6 +78,7 @@
 #include "access/tsmapi.h"
 #include "executor/executor.h"
 #include "executor/nodeHash.h"
+#include "executor/nodeResultCache.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
@@ -88,6 +89,7 @@
 #include "optimizer/plancat.h"
 #include "optimizer/planmain.h"
 #include "optimizer/restrictinfo.h"
+#include "optimizer/var.h"
 #include "parser/parsetree.h"
 #include "utils/lsyscache.h"
 #include "utils/selfuncs.h"
@@ -125,6 +127,7 @@ bool		enable_indexonlyscan = true;
 bool		enable_bitmapscan = true;
 bool		enable_tidscan = true;
 bool		enable_sort = true;
+bool		enable_incrementalsort = true;
 bool		enable_hashagg = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
@@ -134,7 +137,11 @@ bool		enable_gathermerge = true;
 bool		enable_partitionwise_join = false;
 bool		enable_partitionwise_aggregate = false;
 bool		enable_parallel_append = true;
+bool		enable_parallel_distinct = true;
 bool		enable_parallel_hash = true;
+bool		enable_parallel_sort = true;
+bool		enable_parallel_windowagg = true;
+bool		enable_resultcache = true;
 bool		enable_partition_pruning = true;
 
 typedef struct
@@ -377,9 +384,14 @@ cost_gather(GatherPath *path, PlannerInfo *root,
 
 	run_cost = path->subpath->total_cost - path->subpath->startup_cost;
 
-	/* Parallel setup and communication cost. */
+	/*
+	 * Parallel setup and communication cost.  The output of a parallel-aware
+	 * sort is all produced by the leader, so nothing goes through the tuple
+	 * queues in that case.
+	 */
 	startup_cost += parallel_setup_cost;
-	run_cost += parallel_tuple_cost * path->path.rows;
+	if (!(IsA(path->subpath, SortPath) && path->subpath->parallel_aware))
+		run_cost += parallel_tuple_cost * path->path.rows;
 
 	path->path.startup_cost = startup_cost;
 	path->path.total_cost = (startup_cost + run_cost);
@@ -1610,9 +1622,9 @@ cost_recursive_union(Path *runion, Path *nrterm, Path *rterm)
 }
 
 /*
- * cost_sort
- *	  Determines and returns the cost of sorting a relation, including
- *	  the cost of reading the input data.
+ * cost_tuplesort
+ *	  Determines and returns the cost of sorting a relation using tuplesort,
+ *	  not including the cost of reading the input data.
  *
  * If the total volume of data to sort is less than sort_mem, we will do
  * an in-memory sort, which requires no I/O and about t*log2(t) tuple
@@ -1639,39 +1651,23 @@ cost_recursive_union(Path *runion, Path *nrterm, Path *rterm)
  * specifying nonzero comparison_cost; typically that's used for any extra
  * work that has to be done to prepare the inputs to the comparison operators.
  *
- * 'pathkeys' is a list of sort keys
- * 'input_cost' is the total cost for reading the input data
  * 'tuples' is the number of tuples in the relation
  * 'width' is the average tuple width in bytes
  * 'comparison_cost' is the extra cost per comparison, if any
  * 'sort_mem' is the number of kilobytes of work memory allowed for the sort
  * 'limit_tuples' is the bound on the number of output tuples; -1 if no bound
- *
- * NOTE: some callers currently pass NIL for pathkeys because they
- * can't conveniently supply the sort keys.  Since this routine doesn't
- * currently do anything with pathkeys anyway, that doesn't matter...
- * but if it ever does, it should react gracefully to lack of key data.
- * (Actually, the thing we'd most likely be interested in is just the number
- * of sort keys, which all callers *could* supply.)
  */
-void
-cost_sort(Path *path, PlannerInfo *root,
-		  List *pathkeys, Cost input_cost, double tuples, int width,
-		  Cost comparison_cost, int sort_mem,
-		  double limit_tuples)
+static void
+cost_tuplesort(Cost *startup_cost, Cost *run_cost,
+			   double tuples, int width,
+			   Cost comparison_cost, int sort_mem,
+			   double limit_tuples)
 {
-	Cost		startup_cost = input_cost;
-	Cost		run_cost = 0;
 	double		input_bytes = relation_byte_size(tuples, width);
 	double		output_bytes;
 	double		output_tuples;
 	long		sort_mem_bytes = sort_mem * 1024L;
 
-	if (!enable_sort)
-		startup_cost += disable_cost;
-
-	path->rows = tuples;
-
 	/*
 	 * We want to be sure the cost of a sort is never estimated as zero, even
 	 * if passed-in tuple count is zero.  Besides, mustn't do log(0)...
@@ -1710,7 +1706,7 @@ cost_sort(Path *path, PlannerInfo *root,
 		 *
 		 * Assume about N log2 N comparisons
 		 */
-		startup_cost += comparison_cost * tuples * LOG2(tuples);
+		*startup_cost = comparison_cost * tuples * LOG2(tuples);
 
 		/* Disk costs */
 
@@ -1721,7 +1717,7 @@ cost_sort(Path *path, PlannerInfo *root,
 			log_runs = 1.0;
 		npageaccesses = 2.0 * npages * log_runs;
 		/* Assume 3/4ths of accesses are sequential, 1/4th are not */
-		startup_cost += npageaccesses *
+		*startup_cost += npageaccesses *
 			(seq_page_cost * 0.75 + random_page_cost * 0.25);
 	}
 	else if (tuples > 2 * output_tuples || input_bytes > sort_mem_bytes)
@@ -1732,12 +1728,12 @@ cost_sort(Path *path, PlannerInfo *root,
 		 * factor is a bit higher than for quicksort.  Tweak it so that the
 		 * cost curve is continuous at the crossover point.
 		 */
-		startup_cost += comparison_cost * tuples * LOG2(2.0 * output_tuples);
+		*startup_cost = comparison_cost * tuples * LOG2(2.0 * output_tuples);
 	}
 	else
 	{
 		/* We'll use plain quicksort on all the input tuples */
-		startup_cost += comparison_cost * tuples * LOG2(tuples);
+		*startup_cost = comparison_cost * tuples * LOG2(tuples);
 	}
 
 	/*
@@ -1748,7 +1744,225 @@ cost_sort(Path *path, PlannerInfo *root,
 	 * here --- the upper LIMIT will pro-rate the run cost so we'd be double
 	 * counting the LIMIT otherwise.
 	 */
-	run_cost += cpu_operator_cost * tuples;
+	*run_cost = cpu_operator_cost * tuples;
+}
+
+/*
+ * cost_sort
+ *	  Determines and returns the cost of sorting a relation, including
+ *	  the cost of reading the input data.  See cost_tuplesort for the
+ *	  details of the model.
+ *
+ * 'pathkeys' is a list of sort keys
+ * 'input_cost' is the total cost for reading the input data
+ * 'tuples' is the number of tuples in the relation
+ * 'width' is the average tuple width in bytes
+ * 'comparison_cost' is the extra cost per comparison, if any
+ * 'sort_mem' is the number of kilobytes of work memory allowed for the sort
+ * 'limit_tuples' is the bound on the number of output tuples; -1 if no bound
+ *
+ * NOTE: some callers currently pass NIL for pathkeys because they
+ * can't conveniently supply the sort keys.  Since this routine doesn't
+ * currently do anything with pathkeys anyway, that doesn't matter...
+ * but if it ever does, it should react gracefully to lack of key data.
+ * (Actually, the thing we'd most likely be interested in is just the number
+ * of sort keys, which all callers *could* supply.)
+ */
+void
+cost_sort(Path *path, PlannerInfo *root,
+		  List *pathkeys, Cost input_cost, double tuples, int width,
+		  Cost comparison_cost, int sort_mem,
+		  double limit_tuples)
+{
+	Cost		startup_cost;
+	Cost		run_cost;
+
+	cost_tuplesort(&startup_cost, &run_cost,
+				   tuples, width,
+				   comparison_cost, sort_mem,
+				   limit_tuples);
+
+	if (!enable_sort)
+		startup_cost += disable_cost;
+
+	startup_cost += input_cost;
+
+	path->rows = tuples;
+	path->startup_cost = startup_cost;
+	path->total_cost = startup_cost + run_cost;
+}
+
+/*
+ * cost_parallel_sort
+ *	  Determines and returns the cost of a parallel-aware sort.
+ *
+ * Each participant sorts the tuples it reads into a single run on disk, and
+ * the leader then merges all the runs.  The participants work concurrently,
+ * so the per-participant sort is charged just once; on top of that we charge
+ * for writing a run, and for the leader reading back and merging the runs of
+ * all participants.  As in cost_sort, the merge can only start once all the
+ * input has been sorted, so all but the per-tuple merge work is startup cost.
+ *
+ * 'input_cost' is the total cost for reading one participant's input
+ * 'tuples' is the number of tuples each participant sorts
+ * 'total_tuples' is the number of tuples coming out of the merge
+ * 'width' is the average tuple width in bytes
+ * 'nparticipants' is the number of runs the leader merges
+ */
+void
+cost_parallel_sort(Path *path, PlannerInfo *root,
+				   List *pathkeys, Cost input_cost, double tuples,
+				   double total_tuples, int width, int nparticipants)
+{
+	Cost		startup_cost;
+	Cost		run_cost;
+	Cost		comparison_cost = 2.0 * cpu_operator_cost;
+	double		logN = LOG2(Max(nparticipants, 2));
+
+	/* Sort one participant's share, as a serial sort would */
+	cost_tuplesort(&startup_cost, &run_cost,
+				   tuples, width,
+				   0.0, work_mem, -1.0);
+
+	if (!enable_parallel_sort)
+		startup_cost += disable_cost;
+
+	startup_cost += input_cost;
+
+	/* Write out the run */
+	startup_cost += seq_page_cost * page_size(tuples, width);
+
+	/* Build the merge heap, then read back and merge all the runs */
+	startup_cost += comparison_cost * nparticipants * logN;
+	run_cost = page_size(total_tuples, width) *
+		(seq_page_cost * 0.75 + random_page_cost * 0.25);
+	run_cost += comparison_cost * total_tuples * logN;
+	run_cost += cpu_operator_cost * total_tuples;
+
+	path->rows = total_tuples;
+	path->startup_cost = startup_cost;
+	path->total_cost = startup_cost + run_cost;
+}
+
+/*
+ * cost_incremental_sort
+ *	  Determines and returns the cost of sorting a relation incrementally,
+ *	  when the input path is already sorted by some of the pathkeys.
+ *
+ * 'presorted_keys' is the number of leading pathkeys by which the input path
+ * is sorted.
+ *
+ * We estimate the number of groups into which the relation is divided by the
+ * leading pathkeys, and then calculate the cost of sorting a single group
+ * with tuplesort using cost_tuplesort().  The startup cost is that of reading
+ * and sorting the first group only, which is what makes incremental sort
+ * attractive below a LIMIT.
+ */
+void
+cost_incremental_sort(Path *path,
+					  PlannerInfo *root, List *pathkeys, int presorted_keys,
+					  Cost input_startup_cost, Cost input_total_cost,
+					  double input_tuples, int width, Cost comparison_cost,
+					  int sort_mem, double limit_tuples)
+{
+	Cost		startup_cost = 0,
+				run_cost = 0,
+				input_run_cost = input_total_cost - input_startup_cost;
+	double		group_tuples,
+				input_groups;
+	Cost		group_startup_cost,
+				group_run_cost,
+				group_input_run_cost;
+	List	   *presortedExprs = NIL;
+	ListCell   *l;
+	int			i = 0;
+	bool		unknown_varno = false;
+
+	Assert(presorted_keys > 0 && presorted_keys < list_length(pathkeys));
+
+	path->rows = input_tuples;
+
+	/*
+	 * We want to be sure the cost of a sort is never estimated as zero, even
+	 * if passed-in tuple count is zero.  Besides, mustn't do log(0)...
+	 */
+	if (input_tuples < 2.0)
+		input_tuples = 2.0;
+
+	/* Default estimate of number of groups, capped to one group per row. */
+	input_groups = Min(input_tuples, DEFAULT_NUM_DISTINCT);
+
+	/*
+	 * Extract presorted keys as list of expressions.
+	 *
+	 * We need to be careful about Vars containing "varno 0" which might have
+	 * been introduced by generate_append_tlist, which would confuse
+	 * estimate_num_groups (in fact it'd fail for such expressions).  In that
+	 * case we just fall back to the default estimate above.
+	 */
+	foreach(l, pathkeys)
+	{
+		PathKey    *key = (PathKey *) lfirst(l);
+		EquivalenceMember *member = (EquivalenceMember *)
+		linitial(key->pk_eclass->ec_members);
+
+		if (bms_is_member(0, pull_varnos((Node *) member->em_expr)))
+		{
+			unknown_varno = true;
+			break;
+		}
+
+		presortedExprs = lappend(presortedExprs, member->em_expr);
+
+		i++;
+		if (i >= presorted_keys)
+			break;
+	}
+
+	/* Estimate number of groups with equal presorted keys. */
+	if (!unknown_varno)
+		input_groups = estimate_num_groups(root, presortedExprs, input_tuples,
+										   NULL);
+
+	group_tuples = input_tuples / input_groups;
+	group_input_run_cost = input_run_cost / input_groups;
+
+	/*
+	 * Estimate the average cost of sorting one group.  The distribution of
+	 * tuples into groups is only roughly known, so be pessimistic and assume
+	 * groups half again as large as the average.
+	 */
+	cost_tuplesort(&group_startup_cost, &group_run_cost,
+				   1.5 * group_tuples, width, comparison_cost, sort_mem,
+				   limit_tuples);
+
+	/*
+	 * Startup cost of incremental sort is the startup cost of its first group
+	 * plus the cost of its input.
+	 */
+	startup_cost += group_startup_cost
+		+ input_startup_cost + group_input_run_cost;
+
+	/*
+	 * After we started producing tuples from the first group, the cost of
+	 * producing all the tuples is given by the cost to finish processing this
+	 * group, plus the total cost to process the remaining groups, plus the
+	 * remaining cost of input.
+	 */
+	run_cost += group_run_cost
+		+ (group_run_cost + group_startup_cost) * (input_groups - 1)
+		+ group_input_run_cost * (input_groups - 1);
+
+	/*
+	 * Incremental sort adds some overhead by itself.  It has to detect the
+	 * group boundaries, which costs roughly one extra copy and comparison per
+	 * tuple, and it has to set up a fresh sort for every group.
+	 */
+	run_cost += (cpu_tuple_cost + comparison_cost) * input_tuples;
+	run_cost += 2.0 * cpu_tuple_cost * input_groups;
+
+	if (!enable_incrementalsort)
+		startup_cost += disable_cost;
 
 	path->startup_cost = startup_cost;
 	path->total_cost = startup_cost + run_cost;
@@ -2233,6 +2447,83 @@ cost_windowagg(Path *path, PlannerInfo *root,
 	path->total_cost = total_cost;
 }
 
+/*
+ * cost_parallel_windowagg
+ *		Determines and returns the cost of performing a parallel-aware
+ *		WindowAgg plan node, including the cost of its input.
+ *
+ * Each participant hashes the partitioning columns of the tuples it reads,
+ * writes them out to the participant owning their bucket and reads back the
+ * tuples of its own buckets, which it then sorts and processes just like a
+ * regular WindowAgg.  The participants work concurrently, so everything is
+ * charged per participant; 'input_tuples' is the number of tuples each one
+ * reads and, assuming the partitions spread evenly, ends up processing.
+ * Nothing can be returned until all the input has been redistributed and
+ * the first bucket sorted, so that is all startup cost.
+ */
+void
+cost_parallel_windowagg(Path *path, PlannerInfo *root,
+						List *windowFuncs, int numPartCols, int numOrderCols,
+						Cost input_total_cost, double input_tuples, int width)
+{
+	Cost		startup_cost;
+	Cost		sort_startup_cost;
+	Cost		sort_run_cost;
+
+	startup_cost = input_total_cost;
+
+	/* Hash the partitioning columns, then write out and read back */
+	startup_cost += cpu_operator_cost * numPartCols * input_tuples;
+	startup_cost += 2.0 * seq_page_cost * page_size(input_tuples, width);
+
+	/* Sort the redistributed tuples */
+	cost_tuplesort(&sort_startup_cost, &sort_run_cost,
+				   input_tuples, width,
+				   0.0, work_mem, -1.0);
+
+	cost_windowagg(path, root, windowFuncs, numPartCols, numOrderCols,
+				   startup_cost + sort_startup_cost,
+				   startup_cost + sort_startup_cost + sort_run_cost,
+				   input_tuples);
+
+	if (!enable_parallel_windowagg)
+	{
+		path->startup_cost += disable_cost;
+		path->total_cost += disable_cost;
+	}
+}
+
+/*
+ * cost_parallel_unique
+ *		Determines and returns the cost of performing a parallel-aware
+ *		Unique plan node, including the cost of its input.
+ *
+ * Each participant hashes the grouping columns of the tuples it reads and
+ * looks them up in a hash table shared by all of them, inserting those not
+ * found yet.  Like for hashed aggregation, we charge one cpu_operator_cost
+ * per column for the hashing, and another for the comparisons, ignoring
+ * the contention on the shared table.  All of that is charged per
+ * participant; 'input_tuples' is the number of tuples each one reads, and
+ * 'numGroups' the number it returns.
+ */
+void
+cost_parallel_unique(Path *path, int numCols, double numGroups,
+					 Cost input_startup_cost, Cost input_total_cost,
+					 double input_tuples)
+{
+	path->rows = numGroups;
+	path->startup_cost = input_startup_cost;
+	path->total_cost = input_total_cost +
+		2.0 * cpu_operator_cost * numCols * input_tuples +
+		cpu_tuple_cost * numGroups;
+
+	if (!enable_parallel_distinct)
+	{
+		path->startup_cost += disable_cost;
+		path->total_cost += disable_cost;
+	}
+}
+
 /*
  * cost_group
  *		Determines and returns the cost of performing a Group plan node,
@@ -3588,6 +3879,153 @@ cost_subplan(PlannerInfo *root, SubPlan *subplan, Plan *plan)
 }
 
 
+/*
+ * resultcache_keys_have_default_stats
+ *		Returns true if we lack real statistics for any of the given cache
+ *		key expressions, in which case the number of distinct values that
+ *		estimate_num_groups() comes up with is just a guess.
+ */
+static bool
+resultcache_keys_have_default_stats(PlannerInfo *root, List *param_exprs)
+{
+	ListCell   *lc;
+
+	foreach(lc, param_exprs)
+	{
+		VariableStatData vardata;
+		bool		isdefault;
+
+		examine_variable(root, (Node *) lfirst(lc), 0, &vardata);
+		(void) get_variable_numdistinct(&vardata, &isdefault);
+		ReleaseVariableStats(vardata);
+
+		if (isdefault)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * cost_resultcache_rescan
+ *	  Determines the estimated cost of rescanning a ResultCache node.
+ *
+ * In order to estimate this, we must gain knowledge of how often we expect to
+ * be called and how many distinct sets of parameters we are likely to be
+ * called with.  If we expect a good cache hit ratio, then we can set our
+ * costs to account for that hit ratio, plus a little bit of cost for the
+ * caching itself.  Caching will not work out well if we expect to be called
+ * with too many distinct parameter values.  The worst-case here is that we
+ * never see any parameter value twice, in which case we'd never get a cache
+ * hit and caching would be a complete waste of effort.
+ */
+static void
+cost_resultcache_rescan(PlannerInfo *root, ResultCachePath *rcpath,
+						Cost *rescan_startup_cost, Cost *rescan_total_cost)
+{
+	Cost		input_startup_cost = rcpath->subpath->startup_cost;
+	Cost		input_total_cost = rcpath->subpath->total_cost;
+	double		tuples = rcpath->subpath->rows;
+	double		calls = rcpath->calls;
+	int			width = rcpath->subpath->pathtarget->width;
+	double		cache_mem_bytes = work_mem * 1024.0;
+	double		est_entry_bytes;
+	double		est_cache_entries;
+	double		ndistinct;
+	double		evict_ratio;
+	double		hit_ratio;
+	Cost		startup_cost;
+	Cost		total_cost;
+
+	/*
+	 * Estimate how many cache entries fit in the cache.  The overhead of an
+	 * entry is whatever the executor needs to track the entry and its
+	 * tuples, on top of the tuples themselves.
+	 */
+	est_entry_bytes = relation_byte_size(tuples, width) +
+		ExecEstimateCacheEntryOverheadBytes(tuples);
+	est_cache_entries = floor(cache_mem_bytes / est_entry_bytes);
+
+	/*
+	 * Estimate the number of distinct parameter values we'll be called with.
+	 * Without statistics on the keys, assume every call uses new values;
+	 * that avoids choosing a result cache on the strength of a guess.
+	 */
+	ndistinct = estimate_num_groups(root, rcpath->param_exprs, calls, NULL);
+	if (resultcache_keys_have_default_stats(root, rcpath->param_exprs))
+		ndistinct = calls;
+
+	/*
+	 * Size the executor's hash table for the number of entries we expect to
+	 * keep, so it need not be grown in the common case.
+	 */
+	rcpath->est_entries = Min(Min(ndistinct, est_cache_entries),
+							  PG_UINT32_MAX);
+
+	/*
+	 * When the number of distinct parameter values is above the amount we
+	 * can store in the cache, then we'll have to evict some entries from the
+	 * cache.  This is not free.  Here we estimate how big this ratio is.
+	 */
+	evict_ratio = 1.0 - Min(est_cache_entries, ndistinct) / ndistinct;
+
+	/*
+	 * In order to estimate how costly a single scan will be, we need to
+	 * attempt to estimate what the cache hit ratio will be.  To do that we
+	 * must look at how many scans are estimated in total for this node and
+	 * how many of those scans we expect to get a cache hit.  The first scan
+	 * for each set of parameter values is always a miss, and only the
+	 * fraction of distinct values that fit in the cache can hit at all.
+	 */
+	hit_ratio = ((calls - ndistinct) / calls) *
+		(est_cache_entries / Max(ndistinct, est_cache_entries));
+
+	Assert(hit_ratio >= 0 && hit_ratio <= 1.0);
+
+	/*
+	 * Set the total_cost accounting for the expected cache hit ratio.  We
+	 * also add on a cpu_operator_cost to account for a cache lookup.  This
+	 * will happen regardless of whether it's a cache hit or not.
+	 */
+	total_cost = input_total_cost * (1.0 - hit_ratio) + cpu_operator_cost;
+
+	/* Now adjust the total cost to account for cache evictions */
+
+	/* Charge a cpu_tuple_cost for evicting the actual cache entry */
+	total_cost += cpu_tuple_cost * evict_ratio;
+
+	/*
+	 * Charge a 10th of cpu_operator_cost to evict every tuple in that entry.
+	 * The per-tuple eviction is really just a pfree, so charging a whole
+	 * cpu_operator_cost seems a little excessive.
+	 */
+	total_cost += cpu_operator_cost / 10.0 * evict_ratio * tuples;
+
+	/*
+	 * Now adjust for storing things in the cache, since that's not free
+	 * either.  Everything must go in the cache.  We don't proportion this
+	 * over any ratio, just apply it once for the scan.  We charge a
+	 * cpu_tuple_cost for the creation of the cache entry and also a
+	 * cpu_operator_cost for each tuple we expect to cache.
+	 */
+	total_cost += cpu_tuple_cost + cpu_operator_cost * tuples;
+
+	/*
+	 * Getting the first row must also be proportioned according to the
+	 * expected cache hit ratio.
+	 */
+	startup_cost = input_startup_cost * (1.0 - hit_ratio);
+
+	/*
+	 * Additionally we charge a cpu_tuple_cost to account for cache lookups,
+	 * which we'll do regardless of whether it was a cache hit or not.
+	 */
+	startup_cost += cpu_tuple_cost;
+
+	*rescan_startup_cost = startup_cost;
+	*rescan_total_cost = total_cost;
+}
+
 /*
  * cost_rescan
  *		Given a finished Path, estimate the costs of rescanning it after
@@ -3692,6 +4130,11 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_ResultCache:
+			/* All the hard work is done by cost_resultcache_rescan */
+			cost_resultcache_rescan(root, (ResultCachePath *) path,
+									rescan_startup_cost, rescan_total_cost);
+			break;
 		default:
 			*rescan_startup_cost = path->startup_cost;
 			*rescan_total_cost = path->total_cost;
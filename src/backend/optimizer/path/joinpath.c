@@ -18,10 +18,12 @@
 
 #include "executor/executor.h"
 #include "foreign/fdwapi.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/planmain.h"
+#include "utils/lsyscache.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -866,6 +868,167 @@ clause_sides_match_join(RestrictInfo *rinfo, RelOptInfo *outerrel,
 	return false;				/* no good for these input relations */
 }
 
+/*
+ * paraminfo_get_equal_hashops
+ *		Determine if the clauses of param_info are suitable for use as cache
+ *		keys of a ResultCache.  On success, the
+ *		outer-side expressions of the parameterizing join clauses are
+ *		returned in *param_exprs, along with the clauses' own hashable
+ *		equality operators in *operators, and true is returned.
+ */
+static bool
+paraminfo_get_equal_hashops(ParamPathInfo *param_info, RelOptInfo *outerrel,
+							RelOptInfo *innerrel, List **param_exprs,
+							List **operators)
+{
+	ListCell   *lc;
+
+	*param_exprs = NIL;
+	*operators = NIL;
+
+	foreach(lc, param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		OpExpr	   *opexpr;
+		Node	   *expr;
+		Oid			lefttype;
+		Oid			righttype;
+
+		/*
+		 * We only know how to cache on the outer side of a binary opclause,
+		 * and only if the clause's operator is hashable.  The cache compares
+		 * and hashes outer-side values against each other, so the operator
+		 * must also take the same type on both sides.
+		 */
+		if (!IsA(rinfo->clause, OpExpr) ||
+			list_length(((OpExpr *) rinfo->clause)->args) != 2 ||
+			!OidIsValid(rinfo->hashjoinoperator) ||
+			!clause_sides_match_join(rinfo, outerrel, innerrel))
+		{
+			list_free(*operators);
+			list_free(*param_exprs);
+			return false;
+		}
+
+		op_input_types(rinfo->hashjoinoperator, &lefttype, &righttype);
+		if (lefttype != righttype)
+		{
+			list_free(*operators);
+			list_free(*param_exprs);
+			return false;
+		}
+
+		opexpr = (OpExpr *) rinfo->clause;
+		if (rinfo->outer_is_left)
+			expr = (Node *) linitial(opexpr->args);
+		else
+			expr = (Node *) lsecond(opexpr->args);
+
+		*operators = lappend_oid(*operators, rinfo->hashjoinoperator);
+		*param_exprs = lappend(*param_exprs, expr);
+	}
+
+	/* We can't cache anything if there are no parameters to key on */
+	return *param_exprs != NIL;
+}
+
+/*
+ * get_resultcache_path
+ *		If possible, make and return a ResultCache path atop of 'inner_path'.
+ *		Otherwise return NULL.
+ */
+static Path *
+get_resultcache_path(PlannerInfo *root, RelOptInfo *innerrel,
+					 RelOptInfo *outerrel, Path *inner_path,
+					 Path *outer_path, JoinType jointype,
+					 JoinPathExtraData *extra)
+{
+	List	   *param_exprs;
+	List	   *hash_operators;
+	ListCell   *lc;
+
+	/* Obviously not if it's disabled */
+	if (!enable_resultcache)
+		return NULL;
+
+	/*
+	 * We can safely not bother with all this unless we expect to perform
+	 * more than one inner scan.  The first scan is always going to be a cache
+	 * miss.  This would likely fail later anyway based on costs, so this is
+	 * really just to save some wasted effort.
+	 */
+	if (outer_path->parent->rows < 2)
+		return NULL;
+
+	/*
+	 * We can only have a result cache when there's some kind of cache key,
+	 * which means parameterized path clauses.  No cache key sounds more like
+	 * something a Materialize node might be more useful for.
+	 */
+	if (inner_path->param_info == NULL ||
+		inner_path->param_info->ppi_clauses == NIL)
+		return NULL;
+
+	/*
+	 * We don't attempt to cache the results of laterally-referencing rels;
+	 * their output depends on more than the join clauses.
+	 */
+	if (!bms_is_empty(innerrel->lateral_relids))
+		return NULL;
+
+	/*
+	 * Currently we don't do this for SEMI and ANTI joins unless they're
+	 * marked as inner_unique.  This is because nested loop SEMI/ANTI joins
+	 * don't scan the inner node to completion, which will mean result cache
+	 * cannot mark the cache entry as complete.
+	 */
+	if (!extra->inner_unique && (jointype == JOIN_SEMI ||
+								 jointype == JOIN_ANTI))
+		return NULL;
+
+	/*
+	 * We can't use a result cache if there are volatile functions in the
+	 * inner rel's target list or restrict list.  A cache hit could reduce
+	 * the number of calls to these functions.
+	 */
+	if (contain_volatile_functions((Node *) innerrel->reltarget->exprs))
+		return NULL;
+
+	foreach(lc, innerrel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+	}
+
+	/* Check if we have hash ops for each parameter to the path */
+	if (paraminfo_get_equal_hashops(inner_path->param_info, outerrel,
+									innerrel, &param_exprs, &hash_operators))
+	{
+		/*
+		 * A unique join stops after the first inner row that passes the join
+		 * quals, so the entry is complete after one row only if all of the
+		 * join quals were pushed down into the inner scan.
+		 */
+		bool		singlerow;
+
+		singlerow = extra->inner_unique &&
+			list_length(inner_path->param_info->ppi_clauses) ==
+			list_length(extra->restrictlist);
+
+		return (Path *) create_resultcache_path(root,
+												innerrel,
+												inner_path,
+												param_exprs,
+												hash_operators,
+												singlerow,
+												outer_path->parent->rows);
+	}
+
+	return NULL;
+}
+
 /*
  * sort_inner_and_outer
  *	  Create mergejoin join paths by explicitly sorting both the outer and
@@ -1471,6 +1634,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *rcpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -1479,6 +1643,22 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/*
+				 * Try generating a result cache path and see if that makes
+				 * the nested loop any cheaper.
+				 */
+				rcpath = get_resultcache_path(root, innerrel, outerrel,
+											  innerpath, outerpath, jointype,
+											  extra);
+				if (rcpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  rcpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
@@ -22,6 +22,7 @@
 #include "nodes/nodeFuncs.h"
 #include "nodes/plannodes.h"
 #include "optimizer/clauses.h"
+#include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/tlist.h"
@@ -327,6 +328,57 @@ pathkeys_contained_in(List *keys1, List *keys2)
 	return false;
 }
 
+/*
+ * pathkeys_count_contained_in
+ *	  Same as pathkeys_contained_in, but also sets *n_common to the length
+ *	  of the longest common prefix of keys1 and keys2.
+ *
+ * This is what incremental sort needs: a path whose pathkeys share a leading
+ * prefix with the required ordering only has to be sorted within groups of
+ * tuples that are equal on that prefix.
+ */
+bool
+pathkeys_count_contained_in(List *keys1, List *keys2, int *n_common)
+{
+	int			n = 0;
+	ListCell   *key1,
+			   *key2;
+
+	/* Quick exits for the common trivial cases */
+	if (keys1 == keys2)
+	{
+		*n_common = list_length(keys1);
+		return true;
+	}
+	else if (keys1 == NIL)
+	{
+		*n_common = 0;
+		return true;
+	}
+	else if (keys2 == NIL)
+	{
+		*n_common = 0;
+		return false;
+	}
+
+	forboth(key1, keys1, key2, keys2)
+	{
+		PathKey    *pathkey1 = (PathKey *) lfirst(key1);
+		PathKey    *pathkey2 = (PathKey *) lfirst(key2);
+
+		if (pathkey1 != pathkey2)
+		{
+			*n_common = n;
+			return false;
+		}
+		n++;
+	}
+
+	/* If we ran off the end of keys1, keys2 is at least as well sorted */
+	*n_common = n;
+	return (key1 == NULL);
+}
+
 /*
  * get_cheapest_path_for_pathkeys
  *	  Find the cheapest path (according to the specified criterion) that
@@ -1608,6 +1660,20 @@ pathkeys_useful_for_ordering(PlannerInfo *root, List *pathkeys)
 		return list_length(root->query_pathkeys);
 	}
 
+	/*
+	 * If incremental sort is enabled, a path sorted by a leading prefix of
+	 * the requested ordering is useful too, since only the remaining keys
+	 * have to be sorted within each group of equal prefix values.
+	 */
+	if (enable_incrementalsort)
+	{
+		int			n_common;
+
+		(void) pathkeys_count_contained_in(root->query_pathkeys, pathkeys,
+										   &n_common);
+		return n_common;
+	}
+
 	return 0;					/* path ordering not useful */
 }
 
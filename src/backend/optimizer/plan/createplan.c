@@ -21,6 +21,7 @@
 
 #include "access/stratnum.h"
 #include "access/sysattr.h"
+#include "catalog/pg_am.h"
 #include "catalog/pg_class.h"
 #include "foreign/fdwapi.h"
 #include "miscadmin.h"
@@ -89,6 +90,9 @@ static Result *create_result_plan(PlannerInfo *root, ResultPath *best_path);
 static ProjectSet *create_project_set_plan(PlannerInfo *root, ProjectSetPath *best_path);
 static Material *create_material_plan(PlannerInfo *root, MaterialPath *best_path,
 					 int flags);
+static ResultCache *create_resultcache_plan(PlannerInfo *root,
+						ResultCachePath *best_path,
+						int flags);
 static Plan *create_unique_plan(PlannerInfo *root, UniquePath *best_path,
 				   int flags);
 static Gather *create_gather_plan(PlannerInfo *root, GatherPath *best_path);
@@ -97,6 +101,8 @@ static Plan *create_projection_plan(PlannerInfo *root,
 					   int flags);
 static Plan *inject_projection_plan(Plan *subplan, List *tlist, bool parallel_safe);
 static Sort *create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags);
+static IncrementalSort *create_incrementalsort_plan(PlannerInfo *root,
+							IncrementalSortPath *best_path, int flags);
 static Group *create_group_plan(PlannerInfo *root, GroupPath *best_path);
 static Unique *create_upper_unique_plan(PlannerInfo *root, UpperUniquePath *best_path,
 						 int flags);
@@ -226,6 +232,8 @@ static Hash *make_hash(Plan *lefttree,
 		  Oid skewTable,
 		  AttrNumber skewColumn,
 		  bool skewInherit);
+static void set_mergejoin_skip_ahead(MergeJoin *join_plan, Path *inner_path,
+						 Plan *inner_plan);
 static MergeJoin *make_mergejoin(List *tlist,
 			   List *joinclauses, List *otherclauses,
 			   List *mergeclauses,
@@ -239,6 +247,10 @@ static MergeJoin *make_mergejoin(List *tlist,
 static Sort *make_sort(Plan *lefttree, int numCols,
 		  AttrNumber *sortColIdx, Oid *sortOperators,
 		  Oid *collations, bool *nullsFirst);
+static IncrementalSort *make_incrementalsort(Plan *lefttree,
+					 int numCols, int nPresortedCols,
+					 AttrNumber *sortColIdx, Oid *sortOperators,
+					 Oid *collations, bool *nullsFirst);
 static Plan *prepare_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
 						   Relids relids,
 						   const AttrNumber *reqColIdx,
@@ -253,10 +265,16 @@ static EquivalenceMember *find_ec_member_for_tle(EquivalenceClass *ec,
 					   Relids relids);
 static Sort *make_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
 						Relids relids);
+static IncrementalSort *make_incrementalsort_from_pathkeys(Plan *lefttree,
+								   List *pathkeys, Relids relids,
+								   int nPresortedCols);
 static Sort *make_sort_from_groupcols(List *groupcls,
 						 AttrNumber *grpColIdx,
 						 Plan *lefttree);
 static Material *make_material(Plan *lefttree);
+static ResultCache *make_resultcache(Plan *lefttree, Oid *hashoperators,
+				 List *param_exprs, bool singlerow,
+				 uint32 est_entries);
 static WindowAgg *make_windowagg(List *tlist, Index winref,
 			   int partNumCols, AttrNumber *partColIdx, Oid *partOperators,
 			   int ordNumCols, AttrNumber *ordColIdx, Oid *ordOperators,
@@ -285,6 +303,7 @@ static ModifyTable *make_modifytable(PlannerInfo *root,
 				 List *resultRelations, List *subplans, List *subroots,
 				 List *withCheckOptionLists, List *returningLists,
 				 List *rowMarks, OnConflictExpr *onconflict, int epqParam);
+static bool insert_source_is_multirow(Plan *subplan);
 static GatherMerge *create_gather_merge_plan(PlannerInfo *root,
 						 GatherMergePath *best_path);
 
@@ -424,6 +443,11 @@ create_plan_recurse(PlannerInfo *root, Path *best_path, int flags)
 												 (MaterialPath *) best_path,
 												 flags);
 			break;
+		case T_ResultCache:
+			plan = (Plan *) create_resultcache_plan(root,
+													(ResultCachePath *) best_path,
+													flags);
+			break;
 		case T_Unique:
 			if (IsA(best_path, UpperUniquePath))
 			{
@@ -448,6 +472,11 @@ create_plan_recurse(PlannerInfo *root, Path *best_path, int flags)
 											 (SortPath *) best_path,
 											 flags);
 			break;
+		case T_IncrementalSort:
+			plan = (Plan *) create_incrementalsort_plan(root,
+														(IncrementalSortPath *) best_path,
+														flags);
+			break;
 		case T_Group:
 			plan = (Plan *) create_group_plan(root,
 											  (GroupPath *) best_path);
@@ -1341,6 +1370,61 @@ create_material_plan(PlannerInfo *root, MaterialPath *best_path, int flags)
 	return plan;
 }
 
+/*
+ * create_resultcache_plan
+ *	  Create a ResultCache plan for 'best_path' and (recursively) plans
+ *	  for its subpaths.
+ *
+ *	  Returns a Plan node.
+ */
+static ResultCache *
+create_resultcache_plan(PlannerInfo *root, ResultCachePath *best_path,
+						int flags)
+{
+	ResultCache *plan;
+	Plan	   *subplan;
+	Oid		   *operators;
+	List	   *param_exprs = NIL;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			nkeys;
+	int			i;
+
+	/*
+	 * Like Material, ResultCache stores its input tuples and doesn't
+	 * project, so request a small tlist.
+	 */
+	subplan = create_plan_recurse(root, best_path->subpath,
+								  flags | CP_SMALL_TLIST);
+
+	/*
+	 * The cache keys are evaluated in the context of the inner side of the
+	 * nestloop, so replace the outer Vars with nestloop Params, as the
+	 * parameterized subplan does.
+	 */
+	nkeys = list_length(best_path->param_exprs);
+	Assert(nkeys > 0);
+	operators = (Oid *) palloc(nkeys * sizeof(Oid));
+
+	i = 0;
+	forboth(lc, best_path->param_exprs, lc2, best_path->hash_operators)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		param_exprs = lappend(param_exprs,
+							  replace_nestloop_params(root, expr));
+		operators[i] = lfirst_oid(lc2);
+		i++;
+	}
+
+	plan = make_resultcache(subplan, operators, param_exprs,
+							best_path->singlerow, best_path->est_entries);
+
+	copy_generic_path_info(&plan->plan, (Path *) best_path);
+
+	return plan;
+}
+
 /*
  * create_unique_plan
  *	  Create a Unique plan for 'best_path' and (recursively) plans
@@ -1802,6 +1886,32 @@ create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags)
 	return plan;
 }
 
+/*
+ * create_incrementalsort_plan
+ *
+ *	  Do the same as create_sort_plan, but create IncrementalSort plan.
+ */
+static IncrementalSort *
+create_incrementalsort_plan(PlannerInfo *root, IncrementalSortPath *best_path,
+							int flags)
+{
+	IncrementalSort *plan;
+	Plan	   *subplan;
+
+	/* See comments in create_sort_plan() above */
+	subplan = create_plan_recurse(root, best_path->spath.subpath,
+								  flags | CP_SMALL_TLIST);
+	plan = make_incrementalsort_from_pathkeys(subplan,
+											  best_path->spath.path.pathkeys,
+											  IS_OTHER_REL(best_path->spath.subpath->parent) ?
+											  best_path->spath.path.parent->relids : NULL,
+											  best_path->nPresortedCols);
+
+	copy_generic_path_info(&plan->sort.plan, (Path *) best_path);
+
+	return plan;
+}
+
 /*
  * create_group_plan
  *
@@ -1858,9 +1968,17 @@ create_upper_unique_plan(PlannerInfo *root, UpperUniquePath *best_path, int flag
 	subplan = create_plan_recurse(root, best_path->subpath,
 								  flags | CP_LABEL_TLIST);
 
-	plan = make_unique_from_pathkeys(subplan,
-									 best_path->path.pathkeys,
-									 best_path->numkeys);
+	/*
+	 * A parallel-aware Unique hashes its unsorted input on the columns of the
+	 * DISTINCT clause.
+	 */
+	if (best_path->path.parallel_aware)
+		plan = make_unique_from_sortclauses(subplan,
+											root->parse->distinctClause);
+	else
+		plan = make_unique_from_pathkeys(subplan,
+										 best_path->path.pathkeys,
+										 best_path->numkeys);
 
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
@@ -2266,6 +2384,36 @@ create_windowagg_plan(PlannerInfo *root, WindowAggPath *best_path)
 						  wc->inRangeNullsFirst,
 						  subplan);
 
+	/*
+	 * A parallel-aware WindowAgg sorts the tuples it is handed by itself,
+	 * on the partitioning columns followed by the ordering columns.
+	 */
+	if (best_path->path.parallel_aware)
+	{
+		List	   *sortClauses = list_concat(list_copy(wc->partitionClause),
+											  wc->orderClause);
+		int			numSort = list_length(sortClauses);
+
+		plan->sortColIdx = (AttrNumber *) palloc(sizeof(AttrNumber) * numSort);
+		plan->sortOperators = (Oid *) palloc(sizeof(Oid) * numSort);
+		plan->collations = (Oid *) palloc(sizeof(Oid) * numSort);
+		plan->nullsFirst = (bool *) palloc(sizeof(bool) * numSort);
+
+		plan->numSortCols = 0;
+		foreach(lc, sortClauses)
+		{
+			SortGroupClause *sgc = (SortGroupClause *) lfirst(lc);
+			TargetEntry *tle = get_sortgroupclause_tle(sgc, subplan->targetlist);
+
+			Assert(OidIsValid(sgc->sortop));
+			plan->sortColIdx[plan->numSortCols] = tle->resno;
+			plan->sortOperators[plan->numSortCols] = sgc->sortop;
+			plan->collations[plan->numSortCols] = exprCollation((Node *) tle->expr);
+			plan->nullsFirst[plan->numSortCols] = sgc->nulls_first;
+			plan->numSortCols++;
+		}
+	}
+
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
 	return plan;
@@ -4104,12 +4252,104 @@ create_mergejoin_plan(PlannerInfo *root,
 							   best_path->jpath.inner_unique,
 							   best_path->skip_mark_restore);
 
+	/* See whether the inner plan can be asked to skip ahead */
+	set_mergejoin_skip_ahead(join_plan, inner_path, inner_plan);
+
 	/* Costs of sort and material steps are included in path cost already */
 	copy_generic_path_info(&join_plan->join.plan, &best_path->jpath.path);
 
 	return join_plan;
 }
 
+/*
+ * set_mergejoin_skip_ahead
+ *	  Decide whether the executor may ask the inner plan of a mergejoin to
+ *	  skip directly to the first tuple not less than the current outer key.
+ *
+ * This is possible when the leading merge key is sorted ascending with nulls
+ * last and the inner plan is either a Sort on that key or a forward btree
+ * index scan whose first column is that key.  Joins that must emit unmatched
+ * inner tuples cannot skip any of them.  On success we fill in the ">="
+ * operator the executor uses to build its scan key, and the attribute number
+ * (in the Sort's tuples, or the index's columns) it applies to.
+ */
+static void
+set_mergejoin_skip_ahead(MergeJoin *join_plan, Path *inner_path,
+						 Plan *inner_plan)
+{
+	OpExpr	   *clause;
+	Expr	   *outerexpr;
+	Expr	   *innerexpr;
+	Oid			lefttype;
+	AttrNumber	attno;
+	Oid			skipop;
+
+	switch (join_plan->join.jointype)
+	{
+		case JOIN_INNER:
+		case JOIN_LEFT:
+		case JOIN_SEMI:
+		case JOIN_ANTI:
+			break;
+		default:
+			return;
+	}
+
+	if (join_plan->mergeclauses == NIL ||
+		join_plan->mergeStrategies[0] != BTLessStrategyNumber ||
+		join_plan->mergeNullsFirst[0])
+		return;
+
+	clause = (OpExpr *) linitial(join_plan->mergeclauses);
+	if (!IsA(clause, OpExpr) || list_length(clause->args) != 2)
+		return;
+	outerexpr = (Expr *) linitial(clause->args);
+	innerexpr = (Expr *) lsecond(clause->args);
+
+	if (IsA(inner_plan, Sort))
+	{
+		Sort	   *sort = (Sort *) inner_plan;
+		TargetEntry *tle;
+
+		if (sort->numCols < 1)
+			return;
+		tle = get_tle_by_resno(sort->plan.targetlist, sort->sortColIdx[0]);
+		if (tle == NULL || !equal(tle->expr, innerexpr))
+			return;
+		attno = sort->sortColIdx[0];
+		lefttype = exprType((Node *) innerexpr);
+	}
+	else if ((IsA(inner_plan, IndexScan) || IsA(inner_plan, IndexOnlyScan)) &&
+			 IsA(inner_path, IndexPath) &&
+			 !inner_plan->parallel_aware)
+	{
+		IndexPath  *ipath = (IndexPath *) inner_path;
+		IndexOptInfo *index = ipath->indexinfo;
+
+		if (index->relam != BTREE_AM_OID ||
+			ipath->indexscandir != ForwardScanDirection ||
+			ipath->indexorderbys != NIL ||
+			!match_index_to_operand((Node *) innerexpr, 0, index) ||
+			index->opfamily[0] != join_plan->mergeFamilies[0] ||
+			index->indexcollations[0] != join_plan->mergeCollations[0])
+			return;
+		attno = 1;
+		lefttype = index->opcintype[0];
+	}
+	else
+		return;
+
+	skipop = get_opfamily_member(join_plan->mergeFamilies[0],
+								 lefttype,
+								 exprType((Node *) outerexpr),
+								 BTGreaterEqualStrategyNumber);
+	if (!OidIsValid(skipop))
+		return;
+
+	join_plan->mergeSkipOp = skipop;
+	join_plan->mergeSkipAttno = attno;
+}
+
 static HashJoin *
 create_hashjoin_plan(PlannerInfo *root,
 					 HashPath *best_path)
@@ -5600,6 +5840,34 @@ make_sort(Plan *lefttree, int numCols,
 	return node;
 }
 
+/*
+ * make_incrementalsort --- basic routine to build an IncrementalSort plan node
+ *
+ * Caller must have built the sortColIdx, sortOperators, collations, and
+ * nullsFirst arrays already.
+ */
+static IncrementalSort *
+make_incrementalsort(Plan *lefttree, int numCols, int nPresortedCols,
+					 AttrNumber *sortColIdx, Oid *sortOperators,
+					 Oid *collations, bool *nullsFirst)
+{
+	IncrementalSort *node = makeNode(IncrementalSort);
+	Plan	   *plan = &node->sort.plan;
+
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+	node->nPresortedCols = nPresortedCols;
+	node->sort.numCols = numCols;
+	node->sort.sortColIdx = sortColIdx;
+	node->sort.sortOperators = sortOperators;
+	node->sort.collations = collations;
+	node->sort.nullsFirst = nullsFirst;
+
+	return node;
+}
+
 /*
  * prepare_sort_from_pathkeys
  *	  Prepare to sort according to given pathkeys
@@ -5946,6 +6214,42 @@ make_sort_from_pathkeys(Plan *lefttree, List *pathkeys, Relids relids)
 					 collations, nullsFirst);
 }
 
+/*
+ * make_incrementalsort_from_pathkeys
+ *	  Create sort plan to sort according to given pathkeys
+ *
+ *	  'lefttree' is the node which yields input tuples
+ *	  'pathkeys' is the list of pathkeys by which the result is to be sorted
+ *	  'relids' is the set of relations required by prepare_sort_from_pathkeys()
+ *	  'nPresortedCols' is the number of presorted columns in input tuples
+ */
+static IncrementalSort *
+make_incrementalsort_from_pathkeys(Plan *lefttree, List *pathkeys,
+								   Relids relids, int nPresortedCols)
+{
+	int			numsortkeys;
+	AttrNumber *sortColIdx;
+	Oid		   *sortOperators;
+	Oid		   *collations;
+	bool	   *nullsFirst;
+
+	/* Compute sort column info, and adjust lefttree as needed */
+	lefttree = prepare_sort_from_pathkeys(lefttree, pathkeys,
+										  relids,
+										  NULL,
+										  false,
+										  &numsortkeys,
+										  &sortColIdx,
+										  &sortOperators,
+										  &collations,
+										  &nullsFirst);
+
+	/* Now build the IncrementalSort node */
+	return make_incrementalsort(lefttree, numsortkeys, nPresortedCols,
+								sortColIdx, sortOperators,
+								collations, nullsFirst);
+}
+
 /*
  * make_sort_from_sortclauses
  *	  Create sort plan to sort according to given sortclauses
@@ -6057,6 +6361,27 @@ make_material(Plan *lefttree)
 	return node;
 }
 
+static ResultCache *
+make_resultcache(Plan *lefttree, Oid *hashoperators, List *param_exprs,
+				 bool singlerow, uint32 est_entries)
+{
+	ResultCache *node = makeNode(ResultCache);
+	Plan	   *plan = &node->plan;
+
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+
+	node->numKeys = list_length(param_exprs);
+	node->hashOperators = hashoperators;
+	node->param_exprs = param_exprs;
+	node->singlerow = singlerow;
+	node->est_entries = est_entries;
+
+	return node;
+}
+
 /*
  * materialize_finished_plan: stick a Material node atop a completed plan
  *
@@ -6194,7 +6519,7 @@ make_group(List *tlist,
 /*
  * distinctList is a list of SortGroupClauses, identifying the targetlist items
  * that should be considered by the Unique filter.  The input path must
- * already be sorted accordingly.
+ * already be sorted accordingly, unless the Unique is parallel-aware.
  */
 static Unique *
 make_unique_from_sortclauses(Plan *lefttree, List *distinctList)
@@ -6575,6 +6900,24 @@ make_modifytable(PlannerInfo *root,
 	node->rowMarks = rowMarks;
 	node->epqParam = epqParam;
 
+	/*
+	 * A plain INSERT may buffer its rows and write them out in batches, as
+	 * COPY does, provided no RETURNING list needs each row as it's inserted
+	 * and nothing else in the statement could look at the target table while
+	 * rows are still buffered.  Like COPY, we trust nextval() not to do so.
+	 * The executor checks the rest, such as triggers, per result relation.
+	 *
+	 * Setting up the buffer costs more than it saves for a single row, so
+	 * only do it if the source can produce several: not for the single-row
+	 * Result of INSERT ... VALUES, nor if we expect just one row anyway.
+	 */
+	node->multiInsert = (operation == CMD_INSERT &&
+						 onconflict == NULL &&
+						 returningLists == NIL &&
+						 list_length(subplans) == 1 &&
+						 insert_source_is_multirow((Plan *) linitial(subplans)) &&
+						 !contain_volatile_functions_not_nextval((Node *) root->parse));
+
 	/*
 	 * For each result relation that is a foreign table, allow the FDW to
 	 * construct private plan data, and accumulate it all into a list.
@@ -6648,6 +6991,22 @@ make_modifytable(PlannerInfo *root,
 	return node;
 }
 
+/*
+ * insert_source_is_multirow
+ *		Might this INSERT source plan produce more than one row?
+ *
+ * A Result without an input, as made for INSERT ... VALUES with a single
+ * row, produces exactly one.
+ */
+static bool
+insert_source_is_multirow(Plan *subplan)
+{
+	if (IsA(subplan, Result) && subplan->lefttree == NULL)
+		return false;
+
+	return subplan->plan_rows > 1;
+}
+
 /*
  * is_projection_capable_path
  *		Check whether a given Path node is able to do projection.
@@ -6660,7 +7019,9 @@ is_projection_capable_path(Path *path)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_ResultCache:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_LockRows:
@@ -6705,7 +7066,9 @@ is_projection_capable_plan(Plan *plan)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_ResultCache:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_LockRows:
@@ -4499,6 +4499,43 @@ create_window_paths(PlannerInfo *root,
 								   activeWindows);
 	}
 
+	/*
+	 * If there's a single window clause with hashable partitioning columns,
+	 * also consider evaluating it in parallel.  Each participant hashes the
+	 * partitioning columns of its share of the cheapest partial path to send
+	 * the tuples of any one partition to the same participant, which sorts
+	 * and processes them on its own; the results are then gathered.
+	 */
+	if (window_rel->consider_parallel && input_rel->partial_pathlist != NIL &&
+		list_length(activeWindows) == 1)
+	{
+		WindowClause *wc = linitial_node(WindowClause, activeWindows);
+
+		if (wc->partitionClause != NIL &&
+			grouping_is_hashable(wc->partitionClause))
+		{
+			Path	   *cheapest_partial_path;
+			Path	   *path;
+			double		total_rows;
+
+			cheapest_partial_path = linitial(input_rel->partial_pathlist);
+			total_rows = cheapest_partial_path->rows *
+				cheapest_partial_path->parallel_workers;
+
+			path = (Path *)
+				create_parallel_windowagg_path(root, window_rel,
+											   cheapest_partial_path,
+											   output_target,
+											   wflists->windowFuncs[wc->winref],
+											   wc);
+			path = (Path *)
+				create_gather_path(root, window_rel, path, output_target,
+								   NULL, &total_rows);
+
+			add_path(window_rel, path);
+		}
+	}
+
 	/*
 	 * If there is an FDW that's responsible for all baserels of the query,
 	 * let it consider adding ForeignPaths.
@@ -4794,6 +4831,39 @@ create_distinct_paths(PlannerInfo *root,
 								 NIL,
 								 NULL,
 								 numDistinctRows));
+
+		/*
+		 * Also consider removing the duplicates in parallel.  Each
+		 * participant looks up the rows of its share of the cheapest partial
+		 * path in a hash table in shared memory, and only returns those it
+		 * was the first to insert; the results are then gathered.
+		 */
+		if (distinct_rel->consider_parallel &&
+			input_rel->partial_pathlist != NIL &&
+			!parse->hasDistinctOn)
+		{
+			Path	   *cheapest_partial_path;
+			double		numPartialRows;
+
+			cheapest_partial_path = linitial(input_rel->partial_pathlist);
+
+			/* Assume the distinct rows are spread evenly over participants */
+			numPartialRows = clamp_row_est(cheapest_partial_path->rows *
+										   numDistinctRows /
+										   cheapest_input_path->rows);
+
+			path = (Path *)
+				create_parallel_unique_path(root, distinct_rel,
+											cheapest_partial_path,
+											list_length(parse->distinctClause),
+											numPartialRows);
+			path = (Path *)
+				create_gather_path(root, distinct_rel, path,
+								   path->pathtarget, NULL,
+								   &numDistinctRows);
+
+			add_path(distinct_rel, path);
+		}
 	}
 
 	/* Give a helpful error if we failed to find any implementation */
@@ -4870,11 +4940,14 @@ create_ordered_paths(PlannerInfo *root,
 
 	foreach(lc, input_rel->pathlist)
 	{
-		Path	   *path = (Path *) lfirst(lc);
+		Path	   *input_path = (Path *) lfirst(lc);
+		Path	   *path = input_path;
 		bool		is_sorted;
+		int			presorted_keys;
 
-		is_sorted = pathkeys_contained_in(root->sort_pathkeys,
-										  path->pathkeys);
+		is_sorted = pathkeys_count_contained_in(root->sort_pathkeys,
+												input_path->pathkeys,
+												&presorted_keys);
 		if (path == cheapest_input_path || is_sorted)
 		{
 			if (!is_sorted)
@@ -4894,6 +4967,30 @@ create_ordered_paths(PlannerInfo *root,
 
 			add_path(ordered_rel, path);
 		}
+
+		/*
+		 * If the path is sorted by a leading prefix of the required ordering,
+		 * also consider an incremental sort on top of it.  This is the case
+		 * where the ORDER BY extends the ordering provided by an index, and
+		 * it can be much cheaper than a full sort, particularly when only the
+		 * first few rows are needed.
+		 */
+		if (!is_sorted && enable_incrementalsort && presorted_keys > 0)
+		{
+			path = (Path *) create_incremental_sort_path(root,
+														 ordered_rel,
+														 input_path,
+														 root->sort_pathkeys,
+														 presorted_keys,
+														 limit_tuples);
+
+			/* Add projection step if needed */
+			if (path->pathtarget != target)
+				path = apply_projection_to_path(root, ordered_rel,
+												path, target);
+
+			add_path(ordered_rel, path);
+		}
 	}
 
 	/*
@@ -4944,6 +5041,85 @@ create_ordered_paths(PlannerInfo *root,
 												path, target);
 
 			add_path(ordered_rel, path);
+
+			/*
+			 * When each participant's share is too big to sort in memory
+			 * anyway, also consider a parallel-aware sort: the participants
+			 * write their sorted runs to shared temporary files and the
+			 * leader merges them, so no tuple needs to pass through the
+			 * tuple queues.  Bounded sorts are better left to per-worker
+			 * top-N sorts, and the leader must take part in the sort.
+			 */
+			if (limit_tuples < 0 && parallel_leader_participation &&
+				cheapest_partial_path->rows *
+				cheapest_partial_path->pathtarget->width > work_mem * 1024.0)
+			{
+				path = (Path *) create_parallel_sort_path(root,
+														  ordered_rel,
+														  cheapest_partial_path,
+														  root->sort_pathkeys,
+														  total_groups);
+				path = (Path *)
+					create_gather_path(root, ordered_rel,
+									   path,
+									   path->pathtarget,
+									   NULL,
+									   &total_groups);
+
+				/* Add projection step if needed */
+				if (path->pathtarget != target)
+					path = apply_projection_to_path(root, ordered_rel,
+													path, target);
+
+				add_path(ordered_rel, path);
+			}
+		}
+
+		/*
+		 * Likewise, consider incrementally sorting any partial path that is
+		 * already sorted by a prefix of the required ordering, and gathering
+		 * the result with Gather Merge.
+		 */
+		if (enable_incrementalsort)
+		{
+			foreach(lc, input_rel->partial_pathlist)
+			{
+				Path	   *input_path = (Path *) lfirst(lc);
+				Path	   *path;
+				bool		is_sorted;
+				int			presorted_keys;
+				double		total_groups;
+
+				is_sorted = pathkeys_count_contained_in(root->sort_pathkeys,
+														input_path->pathkeys,
+														&presorted_keys);
+
+				/* fully sorted paths were handled by generate_gather_paths */
+				if (is_sorted || presorted_keys == 0)
+					continue;
+
+				path = (Path *) create_incremental_sort_path(root,
+															 ordered_rel,
+															 input_path,
+															 root->sort_pathkeys,
+															 presorted_keys,
+															 limit_tuples);
+				total_groups = input_path->rows *
+					input_path->parallel_workers;
+				path = (Path *)
+					create_gather_merge_path(root, ordered_rel,
+											 path,
+											 path->pathtarget,
+											 root->sort_pathkeys, NULL,
+											 &total_groups);
+
+				/* Add projection step if needed */
+				if (path->pathtarget != target)
+					path = apply_projection_to_path(root, ordered_rel,
+													path, target);
+
+				add_path(ordered_rel, path);
+			}
 		}
 	}
 
@@ -14,6 +14,8 @@
 #include "postgres.h"
 
 #include "access/htup_details.h"
+#include "catalog/pg_class.h"
+#include "catalog/pg_inherits.h"
 #include "catalog/pg_operator.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
@@ -29,6 +31,7 @@
 #include "optimizer/subselect.h"
 #include "optimizer/var.h"
 #include "parser/parse_relation.h"
+#include "parser/parsetree.h"
 #include "rewrite/rewriteManip.h"
 #include "utils/builtins.h"
 #include "utils/lsyscache.h"
@@ -71,6 +74,8 @@ static Node *convert_testexpr_mutator(Node *node,
 static bool subplan_is_hashable(Plan *plan);
 static bool testexpr_is_hashable(Node *testexpr);
 static bool hash_ok_operator(OpExpr *expr);
+static Node *make_not_in_null_quals(PlannerInfo *root, SubLink *sublink);
+static bool subquery_output_is_nonnullable(Query *subselect, Node *rightarg);
 static bool simplify_EXISTS_query(PlannerInfo *root, Query *query);
 static Query *convert_EXISTS_to_ANY(PlannerInfo *root, Query *subselect,
 					  Node **testexpr, List **paramIds);
@@ -838,13 +843,32 @@ build_subplan(PlannerInfo *root, Plan *plan, PlannerInfo *subroot,
 		 * because we need to scan the output of the subplan for each outer
 		 * tuple.  But if it's a not-direct-correlated IN (= ANY) test, we
 		 * might be able to use a hashtable to avoid comparing all the tuples.
+		 *
+		 * The executor can spill the hashtable to disk if the estimate turns
+		 * out to be too low, but a probe may then have to load another batch
+		 * from disk, so we still hash only if the result is expected to fit
+		 * in work_mem.
 		 */
 		if (subLinkType == ANY_SUBLINK &&
 			splan->parParam == NIL &&
 			subplan_is_hashable(plan) &&
 			testexpr_is_hashable(splan->testexpr))
+		{
 			splan->useHashTable = true;
 
+			/*
+			 * If the subquery can't be run in a parallel worker, the leader
+			 * can still compute its result once and share that with the
+			 * workers (see ExecSubPlanInitializeDSM), so the hashed subplan
+			 * needn't make the enclosing plan parallel-restricted.  That's
+			 * only correct if the result can't change during the query, so
+			 * we do it only at the top query level, where there are no outer
+			 * variables the subquery could reference.
+			 */
+			if (!splan->parallel_safe && root->query_level == 1)
+				splan->parallel_safe = true;
+		}
+
 		/*
 		 * Otherwise, we have the option to tack a Material node onto the top
 		 * of the subplan, to reduce the cost of reading it repeatedly.  This
@@ -1312,10 +1336,18 @@ SS_process_ctes(PlannerInfo *root)
  * Side effects of a successful conversion include adding the SubLink's
  * subselect to the query's rangetable, so that it can be referenced in
  * the JoinExpr's rarg.
+ *
+ * If under_not is true, the caller has found NOT ANY, that is NOT IN, and
+ * we try to build an anti join instead.  That only gives the right answer
+ * for rows where neither side of the comparison is NULL, so in that case we
+ * also return, in *null_quals, a qual that the caller must put in place of
+ * the NOT clause to reject the other rows where required.  It is NULL if no
+ * such qual is needed.
  */
 JoinExpr *
 convert_ANY_sublink_to_join(PlannerInfo *root, SubLink *sublink,
-							Relids available_rels)
+							bool under_not, Relids available_rels,
+							Node **null_quals)
 {
 	JoinExpr   *result;
 	Query	   *parse = root->parse;
@@ -1358,6 +1390,24 @@ convert_ANY_sublink_to_join(PlannerInfo *root, SubLink *sublink,
 	if (contain_volatile_functions(sublink->testexpr))
 		return NULL;
 
+	/*
+	 * For NOT IN, we only handle a single hashable comparison, as the point
+	 * is to let large sub-selects be hashed in a hash anti join rather than
+	 * in a hashed SubPlan.  The operator must be strict, so that comparisons
+	 * involving NULLs yield NULL and no anti join match.
+	 */
+	if (under_not)
+	{
+		OpExpr	   *opexpr = (OpExpr *) sublink->testexpr;
+
+		if (!IsA(opexpr, OpExpr) ||
+			list_length(opexpr->args) != 2 ||
+			!op_strict(opexpr->opno) ||
+			!op_hashjoinable(opexpr->opno,
+							 exprType((Node *) linitial(opexpr->args))))
+			return NULL;
+	}
+
 	/* Create a dummy ParseState for addRangeTableEntryForSubquery */
 	pstate = make_parsestate(NULL);
 
@@ -1395,11 +1445,14 @@ convert_ANY_sublink_to_join(PlannerInfo *root, SubLink *sublink,
 	 */
 	quals = convert_testexpr(root, sublink->testexpr, subquery_vars);
 
+	if (under_not)
+		*null_quals = make_not_in_null_quals(root, sublink);
+
 	/*
 	 * And finally, build the JoinExpr node.
 	 */
 	result = makeNode(JoinExpr);
-	result->jointype = JOIN_SEMI;
+	result->jointype = under_not ? JOIN_ANTI : JOIN_SEMI;
 	result->isNatural = false;
 	result->larg = NULL;		/* caller must fill this in */
 	result->rarg = (Node *) rtr;
@@ -1411,12 +1464,153 @@ convert_ANY_sublink_to_join(PlannerInfo *root, SubLink *sublink,
 	return result;
 }
 
+/*
+ * make_not_in_null_quals: build the quals that must accompany the anti join
+ * that replaces "x NOT IN (sub-select)"
+ *
+ * At the top level of WHERE, NOT IN passes a row only if no sub-select row
+ * compares equal or NULL to it.  The anti join on "x = y" lets through rows
+ * for which x is NULL, and rows for which some y is NULL, so unless the
+ * sub-select returns no rows at all, we must reject both.  That gives
+ *
+ *		NOT EXISTS (SELECT FROM (sub-select) s WHERE s.y IS NULL) AND
+ *		(x IS NOT NULL OR NOT EXISTS (sub-select))
+ *
+ * The EXISTS sub-selects are uncorrelated, so they become initplans, and are
+ * run at most once each.  We leave out the first test if the sub-select's
+ * output column can be seen not to contain NULLs.
+ */
+static Node *
+make_not_in_null_quals(PlannerInfo *root, SubLink *sublink)
+{
+	OpExpr	   *opexpr = castNode(OpExpr, sublink->testexpr);
+	Query	   *subselect = (Query *) sublink->subselect;
+	SubLink    *empty_link;
+	NullTest   *ntest;
+	List	   *result = NIL;
+
+	if (!subquery_output_is_nonnullable(subselect, lsecond(opexpr->args)))
+	{
+		Query	   *nullquery;
+		RangeTblEntry *rte;
+		RangeTblRef *rtr;
+		SubLink    *null_link;
+		List	   *vars;
+		ParseState *pstate = make_parsestate(NULL);
+
+		/* SELECT FROM (sub-select) s WHERE s.y IS NULL */
+		rte = addRangeTableEntryForSubquery(pstate,
+											copyObject(subselect),
+											makeAlias("NOT_IN_subquery", NIL),
+											false,
+											true);
+		rtr = makeNode(RangeTblRef);
+		rtr->rtindex = 1;
+		vars = generate_subquery_vars(root, subselect->targetList, 1);
+
+		ntest = makeNode(NullTest);
+		ntest->arg = (Expr *) convert_testexpr(root,
+											   lsecond(opexpr->args),
+											   vars);
+		ntest->nulltesttype = IS_NULL;
+		ntest->argisrow = false;
+		ntest->location = -1;
+
+		nullquery = makeNode(Query);
+		nullquery->commandType = CMD_SELECT;
+		nullquery->querySource = QSRC_ORIGINAL;
+		nullquery->canSetTag = true;
+		nullquery->rtable = list_make1(rte);
+		nullquery->jointree = makeFromExpr(list_make1(rtr), (Node *) ntest);
+
+		null_link = makeNode(SubLink);
+		null_link->subLinkType = EXISTS_SUBLINK;
+		null_link->subselect = (Node *) nullquery;
+		null_link->location = -1;
+		result = lappend(result, make_notclause((Expr *) null_link));
+	}
+
+	/* x IS NOT NULL OR NOT EXISTS (sub-select) */
+	ntest = makeNode(NullTest);
+	ntest->arg = copyObject(linitial(opexpr->args));
+	ntest->nulltesttype = IS_NOT_NULL;
+	ntest->argisrow = false;
+	ntest->location = -1;
+
+	empty_link = makeNode(SubLink);
+	empty_link->subLinkType = EXISTS_SUBLINK;
+	empty_link->subselect = copyObject(sublink->subselect);
+	empty_link->location = -1;
+
+	result = lappend(result,
+					 make_orclause(list_make2(ntest,
+											  make_notclause((Expr *) empty_link))));
+
+	return (Node *) make_ands_explicit(result);
+}
+
+/*
+ * subquery_output_is_nonnullable: can the sub-select's single output column,
+ * as seen through the comparison's right-hand argument rightarg, be shown
+ * never to be NULL?
+ *
+ * We only recognize a NOT NULL column read from the one table of a simple
+ * query, possibly relabeled.  Grouping sets could null the column, as could
+ * an inheritance child that was allowed to drop the constraint.  A dropped
+ * constraint invalidates the plan, since the table is in its range table.
+ */
+static bool
+subquery_output_is_nonnullable(Query *subselect, Node *rightarg)
+{
+	TargetEntry *tle;
+	Var		   *var;
+	RangeTblEntry *rte;
+	HeapTuple	tp;
+	bool		result;
+
+	while (IsA(rightarg, RelabelType))
+		rightarg = (Node *) ((RelabelType *) rightarg)->arg;
+	if (!IsA(rightarg, Param))
+		return false;
+
+	if (subselect->setOperations != NULL ||
+		subselect->groupingSets != NIL ||
+		list_length(subselect->jointree->fromlist) != 1 ||
+		!IsA(linitial(subselect->jointree->fromlist), RangeTblRef))
+		return false;
+
+	tle = linitial_node(TargetEntry, subselect->targetList);
+	if (!IsA(tle->expr, Var))
+		return false;
+	var = (Var *) tle->expr;
+	if (var->varlevelsup != 0 || var->varattno <= 0 ||
+		var->varno !=
+		((RangeTblRef *) linitial(subselect->jointree->fromlist))->rtindex)
+		return false;
+
+	rte = rt_fetch(var->varno, subselect->rtable);
+	if (rte->rtekind != RTE_RELATION)
+		return false;
+	if (rte->inh && rte->relkind != RELKIND_PARTITIONED_TABLE &&
+		has_subclass(rte->relid))
+		return false;
+
+	tp = SearchSysCache2(ATTNUM,
+						 ObjectIdGetDatum(rte->relid),
+						 Int16GetDatum(var->varattno));
+	if (!HeapTupleIsValid(tp))
+		return false;
+	result = ((Form_pg_attribute) GETSTRUCT(tp))->attnotnull;
+	ReleaseSysCache(tp);
+
+	return result;
+}
+
 /*
  * convert_EXISTS_sublink_to_join: try to convert an EXISTS SubLink to a join
  *
  * The API of this function is identical to convert_ANY_sublink_to_join's,
- * except that we also support the case where the caller has found NOT EXISTS,
- * so we need an additional input parameter "under_not".
+ * except that we don't need to return any null_quals.
  */
 JoinExpr *
 convert_EXISTS_sublink_to_join(PlannerInfo *root, SubLink *sublink,
@@ -2791,10 +2985,16 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			/* rescan_param does *not* get added to scan_params */
 			break;
 
+		case T_ResultCache:
+			finalize_primnode((Node *) ((ResultCache *) plan)->param_exprs,
+							  &context);
+			break;
+
 		case T_ProjectSet:
 		case T_Hash:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_Group:
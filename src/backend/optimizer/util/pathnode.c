@@ -1507,6 +1507,61 @@ create_material_path(RelOptInfo *rel, Path *subpath)
 	return pathnode;
 }
 
+/*
+ * create_resultcache_path
+ *	  Creates a path corresponding to a ResultCache plan, returning the
+ *	  pathnode.
+ *
+ * 'calls' is the number of times we expect the node to be rescanned, which
+ * is what determines the expected cache hit ratio.  The costs stored here
+ * are for the first scan only; cost_rescan() accounts for the caching.
+ */
+ResultCachePath *
+create_resultcache_path(PlannerInfo *root, RelOptInfo *rel, Path *subpath,
+						List *param_exprs, List *hash_operators,
+						bool singlerow, double calls)
+{
+	ResultCachePath *pathnode = makeNode(ResultCachePath);
+
+	Assert(subpath->parent == rel);
+
+	pathnode->path.pathtype = T_ResultCache;
+	pathnode->path.parent = rel;
+	pathnode->path.pathtarget = rel->reltarget;
+	pathnode->path.param_info = subpath->param_info;
+	pathnode->path.parallel_aware = false;
+	pathnode->path.parallel_safe = rel->consider_parallel &&
+		subpath->parallel_safe;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = subpath->pathkeys;
+
+	pathnode->subpath = subpath;
+	pathnode->hash_operators = hash_operators;
+	pathnode->param_exprs = param_exprs;
+	pathnode->singlerow = singlerow;
+	pathnode->calls = calls;
+
+	/*
+	 * For now we set est_entries to 0.  cost_resultcache_rescan() does all
+	 * the hard work to determine how many cache entries there are likely to
+	 * be, so it seems best to leave it up to that function to fill this
+	 * field in.  If left at 0, the executor will make a guess at a good
+	 * value.
+	 */
+	pathnode->est_entries = 0;
+
+	/*
+	 * Add a small additional charge for caching the first entry.  All the
+	 * harder calculations for rescans are performed in
+	 * cost_resultcache_rescan().
+	 */
+	pathnode->path.startup_cost = subpath->startup_cost + cpu_tuple_cost;
+	pathnode->path.total_cost = subpath->total_cost + cpu_tuple_cost;
+	pathnode->path.rows = subpath->rows;
+
+	return pathnode;
+}
+
 /*
  * create_unique_path
  *	  Creates a path representing elimination of distinct rows from the
@@ -1857,6 +1912,10 @@ create_gather_path(PlannerInfo *root, RelOptInfo *rel, Path *subpath,
 		pathnode->single_copy = true;
 	}
 
+	/* The leader returns the merged output of a parallel-aware sort */
+	if (IsA(subpath, SortPath) && subpath->parallel_aware)
+		pathnode->path.pathkeys = subpath->pathkeys;
+
 	cost_gather(pathnode, root, rel, pathnode->path.param_info, rows);
 
 	return pathnode;
@@ -2501,9 +2560,14 @@ apply_projection_to_path(PlannerInfo *root,
 	 * If the path happens to be a Gather or GatherMerge path, we'd like to
 	 * arrange for the subpath to return the required target list so that
 	 * workers can help project.  But if there is something that is not
-	 * parallel-safe in the target expressions, then we can't.
+	 * parallel-safe in the target expressions, then we can't.  Nor can we
+	 * put anything between a Gather and a parallel-aware sort, whose output
+	 * comes from the leader anyway.
 	 */
 	if ((IsA(path, GatherPath) ||IsA(path, GatherMergePath)) &&
+		!(IsA(path, GatherPath) &&
+		  IsA(((GatherPath *) path)->subpath, SortPath) &&
+		  ((GatherPath *) path)->subpath->parallel_aware) &&
 		is_parallel_safe(root, (Node *) target->exprs))
 	{
 		/*
@@ -2660,6 +2724,101 @@ create_sort_path(PlannerInfo *root,
 	return pathnode;
 }
 
+/*
+ * create_parallel_sort_path
+ *	  Creates a pathnode that represents a parallel-aware sort, in which
+ *	  each participant sorts its share of a partial path and the leader
+ *	  merges the results.  It must be placed directly under a Gather.
+ *
+ * 'rel' is the parent relation associated with the result
+ * 'subpath' is the partial path representing the source of data
+ * 'pathkeys' represents the desired sort order
+ * 'rows' is the total number of rows the merge returns
+ */
+SortPath *
+create_parallel_sort_path(PlannerInfo *root,
+						  RelOptInfo *rel,
+						  Path *subpath,
+						  List *pathkeys,
+						  double rows)
+{
+	SortPath   *pathnode = makeNode(SortPath);
+
+	Assert(subpath->parallel_safe && subpath->parallel_workers > 0);
+
+	pathnode->path.pathtype = T_Sort;
+	pathnode->path.parent = rel;
+	/* Sort doesn't project, so use source path's pathtarget */
+	pathnode->path.pathtarget = subpath->pathtarget;
+	/* For now, assume we are above any joins, so no parameterization */
+	pathnode->path.param_info = NULL;
+	pathnode->path.parallel_aware = true;
+	pathnode->path.parallel_safe = true;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = pathkeys;
+
+	pathnode->subpath = subpath;
+
+	cost_parallel_sort(&pathnode->path, root, pathkeys,
+					   subpath->total_cost,
+					   subpath->rows,
+					   rows,
+					   subpath->pathtarget->width,
+					   subpath->parallel_workers + 1);
+
+	return pathnode;
+}
+
+/*
+ * create_incremental_sort_path
+ *	  Creates a pathnode that represents performing an incremental sort.
+ *
+ * 'rel' is the parent relation associated with the result
+ * 'subpath' is the path representing the source of data
+ * 'pathkeys' represents the desired sort order
+ * 'presorted_keys' is the number of leading pathkeys by which the subpath
+ *		is already sorted
+ * 'limit_tuples' is the estimated bound on the number of output tuples,
+ *		or -1 if no LIMIT or couldn't estimate
+ */
+IncrementalSortPath *
+create_incremental_sort_path(PlannerInfo *root,
+							 RelOptInfo *rel,
+							 Path *subpath,
+							 List *pathkeys,
+							 int presorted_keys,
+							 double limit_tuples)
+{
+	IncrementalSortPath *sort = makeNode(IncrementalSortPath);
+	SortPath   *pathnode = &sort->spath;
+
+	pathnode->path.pathtype = T_IncrementalSort;
+	pathnode->path.parent = rel;
+	/* Sort doesn't project, so use source path's pathtarget */
+	pathnode->path.pathtarget = subpath->pathtarget;
+	/* For now, assume we are above any joins, so no parameterization */
+	pathnode->path.param_info = NULL;
+	pathnode->path.parallel_aware = false;
+	pathnode->path.parallel_safe = rel->consider_parallel &&
+		subpath->parallel_safe;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	pathnode->path.pathkeys = pathkeys;
+
+	pathnode->subpath = subpath;
+	sort->nPresortedCols = presorted_keys;
+
+	cost_incremental_sort(&pathnode->path,
+						  root, pathkeys, presorted_keys,
+						  subpath->startup_cost,
+						  subpath->total_cost,
+						  subpath->rows,
+						  subpath->pathtarget->width,
+						  0.0,	/* XXX comparison_cost shouldn't be 0? */
+						  work_mem, limit_tuples);
+
+	return sort;
+}
+
 /*
  * create_group_path
  *	  Creates a pathnode that represents performing grouping of presorted input
@@ -2768,6 +2927,54 @@ create_upper_unique_path(PlannerInfo *root,
 	return pathnode;
 }
 
+/*
+ * create_parallel_unique_path
+ *	  Creates a pathnode that represents removing duplicate rows of a
+ *	  partial path in parallel.  The participants hash the rows they read
+ *	  into a table in shared memory and only return the ones they were the
+ *	  first to insert.  It must be placed under a Gather.
+ *
+ * 'rel' is the parent relation associated with the result
+ * 'subpath' is the partial path representing the source of data
+ * 'numCols' is the number of grouping columns
+ * 'numGroups' is the estimated number of groups each participant returns
+ *
+ * The grouping columns are those of the query's DISTINCT clause, which must
+ * be hashable.
+ */
+UpperUniquePath *
+create_parallel_unique_path(PlannerInfo *root,
+							RelOptInfo *rel,
+							Path *subpath,
+							int numCols,
+							double numGroups)
+{
+	UpperUniquePath *pathnode = makeNode(UpperUniquePath);
+
+	Assert(subpath->parallel_safe && subpath->parallel_workers > 0);
+
+	pathnode->path.pathtype = T_Unique;
+	pathnode->path.parent = rel;
+	/* Unique doesn't project, so use source path's pathtarget */
+	pathnode->path.pathtarget = subpath->pathtarget;
+	/* For now, assume we are above any joins, so no parameterization */
+	pathnode->path.param_info = NULL;
+	pathnode->path.parallel_aware = true;
+	pathnode->path.parallel_safe = true;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	/* Hashing keeps the input order, but no participant sees all of it */
+	pathnode->path.pathkeys = NIL;
+
+	pathnode->subpath = subpath;
+	pathnode->numkeys = numCols;
+
+	cost_parallel_unique(&pathnode->path, numCols, numGroups,
+						 subpath->startup_cost, subpath->total_cost,
+						 subpath->rows);
+
+	return pathnode;
+}
+
 /*
  * create_agg_path
  *	  Creates a pathnode that represents performing aggregation/grouping
@@ -3123,6 +3330,63 @@ create_windowagg_path(PlannerInfo *root,
 	return pathnode;
 }
 
+/*
+ * create_parallel_windowagg_path
+ *	  Creates a pathnode that represents computation of window functions
+ *	  in parallel.  Each participant redistributes its share of a partial
+ *	  path by hashing the partitioning columns, then sorts and processes
+ *	  the window partitions it is handed.  It must be placed under a Gather.
+ *
+ * 'rel' is the parent relation associated with the result
+ * 'subpath' is the partial path representing the source of data
+ * 'target' is the PathTarget to be computed
+ * 'windowFuncs' is a list of WindowFunc structs
+ * 'winclause' is a WindowClause that is common to all the WindowFuncs; it
+ *		must have hashable partitioning columns
+ */
+WindowAggPath *
+create_parallel_windowagg_path(PlannerInfo *root,
+							   RelOptInfo *rel,
+							   Path *subpath,
+							   PathTarget *target,
+							   List *windowFuncs,
+							   WindowClause *winclause)
+{
+	WindowAggPath *pathnode = makeNode(WindowAggPath);
+
+	Assert(subpath->parallel_safe && subpath->parallel_workers > 0);
+	Assert(winclause->partitionClause != NIL);
+
+	pathnode->path.pathtype = T_WindowAgg;
+	pathnode->path.parent = rel;
+	pathnode->path.pathtarget = target;
+	/* For now, assume we are above any joins, so no parameterization */
+	pathnode->path.param_info = NULL;
+	pathnode->path.parallel_aware = true;
+	pathnode->path.parallel_safe = true;
+	pathnode->path.parallel_workers = subpath->parallel_workers;
+	/* Output is sorted only within each participant, so no pathkeys */
+	pathnode->path.pathkeys = NIL;
+
+	pathnode->subpath = subpath;
+	pathnode->winclause = winclause;
+
+	cost_parallel_windowagg(&pathnode->path, root,
+							windowFuncs,
+							list_length(winclause->partitionClause),
+							list_length(winclause->orderClause),
+							subpath->total_cost,
+							subpath->rows,
+							subpath->pathtarget->width);
+
+	/* add tlist eval cost for each output row */
+	pathnode->path.startup_cost += target->cost.startup;
+	pathnode->path.total_cost += target->cost.startup +
+		target->cost.per_tuple * pathnode->path.rows;
+
+	return pathnode;
+}
+
 /*
  * create_setop_path
  *	  Creates a pathnode that represents computation of INTERSECT or EXCEPT
@@ -3837,6 +4101,17 @@ do { \
 			}
 			break;
 
+		case T_ResultCachePath:
+			{
+				ResultCachePath *rcpath;
+
+				FLAT_COPY_PATH(rcpath, path, ResultCachePath);
+				REPARAMETERIZE_CHILD_PATH(rcpath->subpath);
+				ADJUST_CHILD_ATTRS(rcpath->param_exprs);
+				new_path = (Path *) rcpath;
+			}
+			break;
+
 		case T_UniquePath:
 			{
 				UniquePath *upath;
@@ -24,6 +24,9 @@
 #include <sys/file.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 #ifdef HAVE_SYS_IPC_H
 #include <sys/ipc.h>
 #endif
@@ -67,6 +70,37 @@
 #define USE_ANONYMOUS_SHMEM
 #endif
 
+/*
+ * On Linux, the anonymous segment can be interleaved across NUMA nodes (see
+ * the numa_interleave GUC), and parts of it placed on particular nodes.  The
+ * constants are those of <linux/mempolicy.h>, which is not always installed.
+ */
+#if defined(USE_ANONYMOUS_SHMEM) && defined(SYS_mbind) && \
+	defined(SYS_get_mempolicy) && defined(SYS_getcpu)
+#define USE_NUMA_INTERLEAVE
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED		1
+#endif
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE		3
+#endif
+#ifndef MPOL_F_MEMS_ALLOWED
+#define MPOL_F_MEMS_ALLOWED	(1 << 2)
+#endif
+/* size of the node masks we pass; must be at least the kernel's node count */
+#define NUMA_MAX_NODES		1024
+#endif
+
+/*
+ * Likewise, PGSharedMemoryNumaUsage can ask the kernel where the pages of the
+ * anonymous segment reside.
+ */
+#if defined(USE_ANONYMOUS_SHMEM) && defined(SYS_move_pages)
+#define USE_NUMA_QUERY
+/* number of pages we ask about per system call */
+#define NUMA_QUERY_BATCH	1024
+#endif
+
 
 typedef key_t IpcMemoryKey;		/* shared memory key passed to shmget(2) */
 typedef int IpcMemoryId;		/* shared memory ID returned by shmget(2) */
@@ -77,6 +111,7 @@ void	   *UsedShmemSegAddr = NULL;
 
 #ifdef USE_ANONYMOUS_SHMEM
 static Size AnonymousShmemSize;
+static Size AnonymousShmemPageSize;
 static void *AnonymousShmem = NULL;
 #endif
 
@@ -85,6 +120,10 @@ static void IpcMemoryDetach(int status, Datum shmaddr);
 static void IpcMemoryDelete(int status, Datum shmId);
 static PGShmemHeader *PGSharedMemoryAttach(IpcMemoryKey key,
 					 IpcMemoryId *shmid);
+#ifdef USE_NUMA_INTERLEAVE
+static int	GetNumaNodeMask(unsigned long *nodemask);
+static void InterleaveSharedMemory(void *ptr, Size size);
+#endif
 
 
 /*
@@ -480,6 +519,7 @@ CreateAnonymousSegment(Size *size)
 		ptr = mmap(NULL, allocsize, PROT_READ | PROT_WRITE,
 				   PG_MMAP_FLAGS | mmap_flags, -1, 0);
 		mmap_errno = errno;
+		AnonymousShmemPageSize = hugepagesize;
 		if (huge_pages == HUGE_PAGES_TRY && ptr == MAP_FAILED)
 			elog(DEBUG1, "mmap(%zu) with MAP_HUGETLB failed, huge pages disabled: %m",
 				 allocsize);
@@ -496,6 +536,7 @@ CreateAnonymousSegment(Size *size)
 		ptr = mmap(NULL, allocsize, PROT_READ | PROT_WRITE,
 				   PG_MMAP_FLAGS, -1, 0);
 		mmap_errno = errno;
+		AnonymousShmemPageSize = (Size) sysconf(_SC_PAGESIZE);
 	}
 
 	if (ptr == MAP_FAILED)
@@ -513,10 +554,79 @@ CreateAnonymousSegment(Size *size)
 						 *size) : 0));
 	}
 
+#ifdef USE_NUMA_INTERLEAVE
+	if (numa_interleave)
+		InterleaveSharedMemory(ptr, allocsize);
+#endif
+
 	*size = allocsize;
 	return ptr;
 }
 
+#ifdef USE_NUMA_INTERLEAVE
+/*
+ * Fill nodemask, an array of NUMA_MAX_NODES bits, with the NUMA nodes we may
+ * allocate memory on, and return how many there are; or log a message and
+ * return 0 if the kernel won't tell.
+ *
+ * We issue get_mempolicy(2), mbind(2) and getcpu(2) directly rather than
+ * depending on libnuma for three calls.
+ */
+static int
+GetNumaNodeMask(unsigned long *nodemask)
+{
+	int			nnodes = 0;
+	int			i;
+
+	memset(nodemask, 0, NUMA_MAX_NODES / 8);
+	if (syscall(SYS_get_mempolicy, NULL, nodemask, NUMA_MAX_NODES + 1,
+				NULL, MPOL_F_MEMS_ALLOWED) != 0)
+	{
+		ereport(LOG,
+				(errmsg("could not determine NUMA nodes for shared memory: %m")));
+		return 0;
+	}
+
+	for (i = 0; i < NUMA_MAX_NODES; i++)
+	{
+		if (nodemask[i / (8 * sizeof(unsigned long))] &
+			(1UL << (i % (8 * sizeof(unsigned long)))))
+			nnodes++;
+	}
+
+	return nnodes;
+}
+
+/*
+ * Ask the kernel to interleave the pages of the given range over all the
+ * NUMA nodes we may allocate memory on.  This must be done before the pages
+ * are first touched, since that is when they get placed.
+ */
+static void
+InterleaveSharedMemory(void *ptr, Size size)
+{
+	unsigned long nodemask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	int			nnodes;
+
+	nnodes = GetNumaNodeMask(nodemask);
+
+	/* nothing to do on a machine with a single node */
+	if (nnodes <= 1)
+		return;
+
+	if (syscall(SYS_mbind, ptr, size, MPOL_INTERLEAVE, nodemask,
+				NUMA_MAX_NODES + 1, 0) != 0)
+	{
+		ereport(LOG,
+				(errmsg("could not interleave shared memory across NUMA nodes: %m")));
+		return;
+	}
+
+	elog(DEBUG1, "interleaving %zu bytes of shared memory across %d NUMA nodes",
+		 size, nnodes);
+}
+#endif							/* USE_NUMA_INTERLEAVE */
+
 /*
  * AnonymousShmemDetach --- detach from an anonymous mmap'd block
  * (called as an on_shmem_exit callback, hence funny argument list)
@@ -573,6 +683,14 @@ PGSharedMemoryCreate(Size size, bool makePrivate, int port,
 				 errmsg("huge pages not supported on this platform")));
 #endif
 
+	/* Likewise for NUMA interleaving */
+#ifndef USE_NUMA_INTERLEAVE
+	if (numa_interleave)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("NUMA interleaving of shared memory is not supported on this platform")));
+#endif
+
 	/* Room for a header? */
 	Assert(size > MAXALIGN(sizeof(PGShmemHeader)));
 
@@ -839,3 +957,151 @@ PGSharedMemoryAttach(IpcMemoryKey key, IpcMemoryId *shmid)
 
 	return hdr;
 }
+
+
+/*
+ * PGSharedMemoryNumaUsage
+ *
+ * Report how much of the main shared memory segment resides on each NUMA
+ * node.  On success, sizes[n] is set to the number of bytes on node n, for
+ * n < maxnodes, and *unallocated to the number of bytes not yet backed by
+ * memory at all, and true is returned.  Returns false if the platform
+ * cannot tell.
+ *
+ * The kernel is asked about the pages as mapped in this process, using the
+ * query mode of move_pages(2), which moves nothing.
+ */
+bool
+PGSharedMemoryNumaUsage(Size *sizes, int maxnodes, Size *unallocated)
+{
+#ifdef USE_NUMA_QUERY
+	void	   *pages[NUMA_QUERY_BATCH];
+	int			status[NUMA_QUERY_BATCH];
+	Size		pagesize = (Size) sysconf(_SC_PAGESIZE);
+	Size		npages;
+	Size		done;
+
+	if (AnonymousShmem == NULL)
+		return false;
+
+	memset(sizes, 0, maxnodes * sizeof(Size));
+	*unallocated = 0;
+
+	npages = AnonymousShmemSize / pagesize;
+	for (done = 0; done < npages; done += NUMA_QUERY_BATCH)
+	{
+		int			count = (int) Min(npages - done, NUMA_QUERY_BATCH);
+		int			i;
+
+		for (i = 0; i < count; i++)
+			pages[i] = (char *) AnonymousShmem + (done + i) * pagesize;
+
+		/* fails on kernels without NUMA support, or if seccomp forbids it */
+		if (syscall(SYS_move_pages, 0, (unsigned long) count, pages, NULL,
+					status, 0) != 0)
+			return false;
+
+		for (i = 0; i < count; i++)
+		{
+			if (status[i] >= 0 && status[i] < maxnodes)
+				sizes[status[i]] += pagesize;
+			else
+				*unallocated += pagesize;
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * PGSharedMemoryNumaNodes
+ *
+ * If numa_interleave is in effect, store the numbers of the NUMA nodes the
+ * main shared memory segment is spread over in nodes[], up to maxnodes of
+ * them, and return how many there are.  Otherwise, or on a machine with a
+ * single node, return 0.
+ */
+int
+PGSharedMemoryNumaNodes(int *nodes, int maxnodes)
+{
+#ifdef USE_NUMA_INTERLEAVE
+	unsigned long nodemask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	int			nnodes = 0;
+	int			i;
+
+	if (!numa_interleave || AnonymousShmem == NULL ||
+		GetNumaNodeMask(nodemask) <= 1)
+		return 0;
+
+	for (i = 0; i < NUMA_MAX_NODES && nnodes < maxnodes; i++)
+	{
+		if (nodemask[i / (8 * sizeof(unsigned long))] &
+			(1UL << (i % (8 * sizeof(unsigned long)))))
+			nodes[nnodes++] = i;
+	}
+
+	return nnodes;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * PGSharedMemoryNumaBind
+ *
+ * Ask for the given range of the main shared memory segment to be placed on
+ * NUMA node "node", rather than interleaved.  Only the pages lying entirely
+ * within the range are affected.  Like the interleaving, this must be done
+ * before the pages are first touched; if the kernel refuses, a message is
+ * logged and the pages stay interleaved.
+ */
+void
+PGSharedMemoryNumaBind(void *ptr, Size size, int node)
+{
+#ifdef USE_NUMA_INTERLEAVE
+	unsigned long nodemask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	char	   *start;
+	char	   *end;
+
+	Assert(node >= 0 && node < NUMA_MAX_NODES);
+
+	start = (char *) TYPEALIGN(AnonymousShmemPageSize, ptr);
+	end = (char *) TYPEALIGN_DOWN(AnonymousShmemPageSize, (char *) ptr + size);
+	if (start >= end)
+		return;
+
+	memset(nodemask, 0, sizeof(nodemask));
+	nodemask[node / (8 * sizeof(unsigned long))] =
+		1UL << (node % (8 * sizeof(unsigned long)));
+
+	if (syscall(SYS_mbind, start, (Size) (end - start), MPOL_PREFERRED,
+				nodemask, NUMA_MAX_NODES + 1, 0) != 0)
+		ereport(LOG,
+				(errmsg("could not place shared memory on NUMA node %d: %m",
+						node)));
+#endif
+}
+
+/*
+ * PGSharedMemoryLocalNumaNode
+ *
+ * Return the NUMA node of the CPU we are running on, or -1 if unknown.  The
+ * answer can change whenever the scheduler moves us to another CPU.
+ */
+int
+PGSharedMemoryLocalNumaNode(void)
+{
+#ifdef USE_NUMA_INTERLEAVE
+	unsigned int cpu;
+	unsigned int node;
+
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0)
+		return -1;
+	return (int) node;
+#else
+	return -1;
+#endif
+}
@@ -199,6 +199,11 @@ PGSharedMemoryCreate(Size size, bool makePrivate, int port,
 
 	UsedShmemSegAddr = NULL;
 
+	if (numa_interleave)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("NUMA interleaving of shared memory is not supported on this platform")));
+
 	if (huge_pages == HUGE_PAGES_ON || huge_pages == HUGE_PAGES_TRY)
 	{
 		/* Does the processor support large pages? */
@@ -475,6 +480,51 @@ PGSharedMemoryDetach(void)
 }
 
 
+/*
+ * PGSharedMemoryNumaUsage
+ *
+ * The NUMA placement of shared memory cannot be queried on Windows.
+ */
+bool
+PGSharedMemoryNumaUsage(Size *sizes, int maxnodes, Size *unallocated)
+{
+	return false;
+}
+
+/*
+ * PGSharedMemoryNumaNodes
+ *
+ * numa_interleave is not supported on Windows, so shared memory is never
+ * spread over NUMA nodes.
+ */
+int
+PGSharedMemoryNumaNodes(int *nodes, int maxnodes)
+{
+	return 0;
+}
+
+/*
+ * PGSharedMemoryNumaBind
+ *
+ * Not supported on Windows; see PGSharedMemoryNumaNodes.
+ */
+void
+PGSharedMemoryNumaBind(void *ptr, Size size, int node)
+{
+}
+
+/*
+ * PGSharedMemoryLocalNumaNode
+ *
+ * Not supported on Windows; see PGSharedMemoryNumaNodes.
+ */
+int
+PGSharedMemoryLocalNumaNode(void)
+{
+	return -1;
+}
+
+
 /*
  * pgwin32_SharedMemoryDelete
  *
@@ -3501,6 +3501,9 @@ pgstat_get_wait_activity(WaitEventActivity w)
 		case WAIT_EVENT_PGSTAT_MAIN:
 			event_name = "PgStatMain";
 			break;
+		case WAIT_EVENT_READAHEAD_WORKER_MAIN:
+			event_name = "ReadAheadWorkerMain";
+			break;
 		case WAIT_EVENT_RECOVERY_WAL_ALL:
 			event_name = "RecoveryWalAll";
 			break;
@@ -3662,15 +3665,30 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 		case WAIT_EVENT_PARALLEL_BITMAP_SCAN:
 			event_name = "ParallelBitmapScan";
 			break;
+		case WAIT_EVENT_PARALLEL_COPY_INPUT:
+			event_name = "ParallelCopyInput";
+			break;
 		case WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN:
 			event_name = "ParallelCreateIndexScan";
 			break;
+		case WAIT_EVENT_PARALLEL_SORT_RUNS:
+			event_name = "ParallelSortRuns";
+			break;
+		case WAIT_EVENT_PARALLEL_WINDOW_REDISTRIBUTE:
+			event_name = "ParallelWindowRedistribute";
+			break;
 		case WAIT_EVENT_PROCARRAY_GROUP_UPDATE:
 			event_name = "ProcArrayGroupUpdate";
 			break;
 		case WAIT_EVENT_CLOG_GROUP_UPDATE:
 			event_name = "ClogGroupUpdate";
 			break;
+		case WAIT_EVENT_REDO_DISPATCH:
+			event_name = "RedoDispatch";
+			break;
+		case WAIT_EVENT_REDO_DRAIN:
+			event_name = "RedoDrain";
+			break;
 		case WAIT_EVENT_REPLICATION_ORIGIN_DROP:
 			event_name = "ReplicationOriginDrop";
 			break;
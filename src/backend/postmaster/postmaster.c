@@ -121,6 +121,7 @@
 #include "storage/pg_shmem.h"
 #include "storage/pmsignal.h"
 #include "storage/proc.h"
+#include "storage/readahead.h"
 #include "tcop/tcopprot.h"
 #include "utils/builtins.h"
 #include "utils/datetime.h"
@@ -987,6 +988,9 @@ PostmasterMain(int argc, char *argv[])
 	 */
 	ApplyLauncherRegister();
 
+	/* Likewise for the read-ahead workers, if any. */
+	ReadAheadWorkersRegister();
+
 	/*
 	 * process any libraries that should be preloaded at postmaster start
 	 */
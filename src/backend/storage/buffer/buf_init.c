@@ -16,6 +16,7 @@
 
 #include "storage/bufmgr.h"
 #include "storage/buf_internals.h"
+#include "storage/pg_shmem.h"
 
 
 BufferDescPadded *BufferDescriptors;
@@ -71,6 +72,8 @@ InitBufferPool(void)
 				foundDescs,
 				foundIOLocks,
 				foundBufCkpt;
+	int			nodes[MAX_BUFFER_NUMA_PARTITIONS];
+	int			npartitions = 1;
 
 	/* Align descriptors to a cacheline boundary. */
 	BufferDescriptors = (BufferDescPadded *)
@@ -78,9 +81,12 @@ InitBufferPool(void)
 						NBuffers * sizeof(BufferDescPadded),
 						&foundDescs);
 
+	/* Align buffer pool on an I/O boundary, so io_direct can use it */
 	BufferBlocks = (char *)
-		ShmemInitStruct("Buffer Blocks",
-						NBuffers * (Size) BLCKSZ, &foundBufs);
+		TYPEALIGN(PG_IO_ALIGN_SIZE,
+				  ShmemInitStruct("Buffer Blocks",
+								  NBuffers * (Size) BLCKSZ + PG_IO_ALIGN_SIZE,
+								  &foundBufs));
 
 	/* Align lwlocks to cacheline boundary */
 	BufferIOLWLockArray = (LWLockMinimallyPadded *)
@@ -110,8 +116,41 @@ InitBufferPool(void)
 	}
 	else
 	{
+		int			partsize;
 		int			i;
 
+		/*
+		 * If shared memory is spread over several NUMA nodes, give each node
+		 * a partition of consecutive buffers, with their descriptors, rather
+		 * than interleaving them page by page.  A backend can then prefer
+		 * free buffers on its own node.  This must happen before we touch
+		 * the descriptors below.
+		 */
+		npartitions = PGSharedMemoryNumaNodes(nodes,
+											  MAX_BUFFER_NUMA_PARTITIONS);
+		if (npartitions > 1)
+		{
+			partsize = BufferNumaPartitionSize(npartitions);
+			/* with a tiny buffer pool, some nodes might get nothing */
+			npartitions = (NBuffers + partsize - 1) / partsize;
+		}
+		else
+			npartitions = 1;
+		partsize = BufferNumaPartitionSize(npartitions);
+
+		for (i = 0; npartitions > 1 && i < npartitions; i++)
+		{
+			int			first = i * partsize;
+			int			nbuffers = Min(partsize, NBuffers - first);
+
+			PGSharedMemoryNumaBind(GetBufferDescriptor(first),
+								   nbuffers * sizeof(BufferDescPadded),
+								   nodes[i]);
+			PGSharedMemoryNumaBind(BufferBlocks + (Size) first * BLCKSZ,
+								   nbuffers * (Size) BLCKSZ,
+								   nodes[i]);
+		}
+
 		/*
 		 * Initialize all the buffer headers.
 		 */
@@ -127,10 +166,14 @@ InitBufferPool(void)
 			buf->buf_id = i;
 
 			/*
-			 * Initially link all the buffers together as unused. Subsequent
-			 * management of this list is done by freelist.c.
+			 * Initially link all the buffers of each partition together as
+			 * unused. Subsequent management of these lists is done by
+			 * freelist.c.
 			 */
-			buf->freeNext = i + 1;
+			if ((i + 1) % partsize == 0)
+				buf->freeNext = FREENEXT_END_OF_LIST;
+			else
+				buf->freeNext = i + 1;
 
 			LWLockInitialize(BufferDescriptorGetContentLock(buf),
 							 LWTRANCHE_BUFFER_CONTENT);
@@ -144,7 +187,7 @@ InitBufferPool(void)
 	}
 
 	/* Init other shared buffer-management stuff */
-	StrategyInitialize(!foundDescs);
+	StrategyInitialize(!foundDescs, npartitions, nodes);
 
 	/* Initialize per-backend file flush context */
 	WritebackContextInit(&BackendWritebackContext,
@@ -169,6 +212,8 @@ BufferShmemSize(void)
 
 	/* size of data pages */
 	size = add_size(size, mul_size(NBuffers, BLCKSZ));
+	/* to allow aligning the data pages */
+	size = add_size(size, PG_IO_ALIGN_SIZE);
 
 	/* size of stuff controlled by freelist.c */
 	size = add_size(size, StrategyShmemSize());
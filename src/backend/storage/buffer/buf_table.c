@@ -3,11 +3,24 @@
  * buf_table.c
  *	  routines for mapping BufferTags to buffer indexes.
  *
- * Note: the routines in this file do no locking of their own.  The caller
- * must hold a suitable lock on the appropriate BufMappingLock, as specified
- * in the comments.  We can't do the locking inside these functions because
- * in most cases the caller needs to adjust the buffer header contents
- * before the lock is released (see notes in README).
+ * The mapping is kept in an open-addressing hash table that is split into
+ * NUM_BUFFER_PARTITIONS independent sub-tables, one per BufMappingLock
+ * partition.  Each sub-table uses linear probing, and deletions shift later
+ * entries back into the hole rather than leaving tombstones, so a probe
+ * never has to look past the first empty slot.
+ *
+ * Note: the insert and delete routines in this file do no locking of their
+ * own.  The caller must hold exclusive lock on the appropriate
+ * BufMappingLock, as specified in the comments.  We can't do the locking
+ * inside these functions because in most cases the caller needs to adjust
+ * the buffer header contents before the lock is released (see notes in
+ * README).
+ *
+ * Lookups can be done either under the BufMappingLock, or optimistically
+ * without it.  For the latter, every partition has a change counter that
+ * writers advance to an odd value before touching the sub-table and to the
+ * next even value afterwards; a reader that sees the same even value before
+ * and after its probe knows that the result it read was consistent.
  *
  *
  * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
@@ -21,50 +34,165 @@
  */
 #include "postgres.h"
 
+#include "access/hash.h"
+#include "port/atomics.h"
 #include "storage/bufmgr.h"
 #include "storage/buf_internals.h"
+#include "storage/shmem.h"
 
 
+/*
+ * Number of times BufTableLookupOptimistic retries before giving up and
+ * letting the caller take the partition lock.
+ */
+#define BUFTABLE_OPTIMISTIC_RETRIES		4
+
 /* entry for buffer lookup hashtable */
 typedef struct
 {
 	BufferTag	key;			/* Tag of a disk page */
-	int			id;				/* Associated buffer ID */
+	uint32		hashcode;		/* hash code of key */
+	int			id;				/* Associated buffer ID, or -1 if unused */
 } BufferLookupEnt;
 
-static HTAB *SharedBufHash;
+/* per-partition bookkeeping, padded to avoid false sharing */
+typedef struct
+{
+	pg_atomic_uint32 changecount;	/* odd while the sub-table is changing */
+	int			nentries;		/* number of slots in use */
+} BufTablePartitionData;
+
+typedef union BufTablePartition
+{
+	BufTablePartitionData data;
+	char		pad[PG_CACHE_LINE_SIZE];
+} BufTablePartition;
+
+static BufTablePartition *BufTablePartitions;
+static BufferLookupEnt *BufTableSlots;
+static uint32 BufTablePartitionSlots;	/* slots per partition */
+
+
+/*
+ * Number of slots to give each partition's sub-table.
+ *
+ * Tags are spread over partitions by their hash code, so some partitions
+ * will hold more than their share of the entries.  Allowing three times the
+ * average keeps the load factor of the fullest sub-table low enough for
+ * linear probing to stay cheap, with a floor for small buffer pools where
+ * the spread is proportionally larger.
+ */
+static uint32
+BufTableSlotsPerPartition(int size)
+{
+	return Max(64, 3 * (size / NUM_BUFFER_PARTITIONS + 1));
+}
+
+/*
+ * Home slot of a hash code within its partition's sub-table.  The low-order
+ * bits select the partition, so use the remaining ones here.
+ */
+static inline uint32
+BufTableHomeSlot(uint32 hashcode)
+{
+	return (hashcode / NUM_BUFFER_PARTITIONS) % BufTablePartitionSlots;
+}
+
+/*
+ * Probe a partition's sub-table for the given tag.
+ *
+ * The loop is bounded by the size of the sub-table, so that it terminates
+ * even when an optimistic reader sees a sub-table in the middle of a change.
+ */
+static inline int
+BufTableProbe(BufferLookupEnt *slots, BufferTag *tagPtr, uint32 hashcode)
+{
+	uint32		i = BufTableHomeSlot(hashcode);
+	uint32		n;
+
+	for (n = 0; n < BufTablePartitionSlots; n++)
+	{
+		BufferLookupEnt *ent = &slots[i];
+
+		if (ent->id < 0)
+			break;
+		if (ent->hashcode == hashcode && BUFFERTAGS_EQUAL(ent->key, *tagPtr))
+			return ent->id;
+		if (++i == BufTablePartitionSlots)
+			i = 0;
+	}
+
+	return -1;
+}
 
+/*
+ * Mark the start and end of a change to a partition's sub-table.  Only one
+ * backend can be changing a given partition, since that requires exclusive
+ * lock on its BufMappingLock, so plain writes of the counter suffice.
+ */
+static inline void
+BufTableBeginChange(BufTablePartition *partition)
+{
+	pg_atomic_write_u32(&partition->data.changecount,
+						pg_atomic_read_u32(&partition->data.changecount) + 1);
+	pg_write_barrier();
+}
+
+static inline void
+BufTableEndChange(BufTablePartition *partition)
+{
+	pg_write_barrier();
+	pg_atomic_write_u32(&partition->data.changecount,
+						pg_atomic_read_u32(&partition->data.changecount) + 1);
+}
 
 /*
  * Estimate space needed for mapping hashtable
- *		size is the desired hash table size (possibly more than NBuffers)
+ *		size is the maximum number of entries (possibly more than NBuffers)
  */
 Size
 BufTableShmemSize(int size)
 {
-	return hash_estimate_size(size, sizeof(BufferLookupEnt));
+	Size		nslots;
+
+	nslots = mul_size(NUM_BUFFER_PARTITIONS, BufTableSlotsPerPartition(size));
+
+	return add_size(mul_size(NUM_BUFFER_PARTITIONS, sizeof(BufTablePartition)),
+					mul_size(nslots, sizeof(BufferLookupEnt)));
 }
 
 /*
  * Initialize shmem hash table for mapping buffers
- *		size is the desired hash table size (possibly more than NBuffers)
+ *		size is the maximum number of entries (possibly more than NBuffers)
  */
 void
 InitBufTable(int size)
 {
-	HASHCTL		info;
+	bool		found;
+	Size		nslots;
+	int			i;
 
 	/* assume no locking is needed yet */
 
-	/* BufferTag maps to Buffer */
-	info.keysize = sizeof(BufferTag);
-	info.entrysize = sizeof(BufferLookupEnt);
-	info.num_partitions = NUM_BUFFER_PARTITIONS;
+	BufTablePartitionSlots = BufTableSlotsPerPartition(size);
+	nslots = mul_size(NUM_BUFFER_PARTITIONS, BufTablePartitionSlots);
 
-	SharedBufHash = ShmemInitHash("Shared Buffer Lookup Table",
-								  size, size,
-								  &info,
-								  HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+	BufTablePartitions = (BufTablePartition *)
+		ShmemInitStruct("Shared Buffer Lookup Table",
+						BufTableShmemSize(size), &found);
+	BufTableSlots = (BufferLookupEnt *)
+		(BufTablePartitions + NUM_BUFFER_PARTITIONS);
+
+	if (!found)
+	{
+		for (i = 0; i < NUM_BUFFER_PARTITIONS; i++)
+		{
+			pg_atomic_init_u32(&BufTablePartitions[i].data.changecount, 0);
+			BufTablePartitions[i].data.nentries = 0;
+		}
+		for (i = 0; i < nslots; i++)
+			BufTableSlots[i].id = -1;
+	}
 }
 
 /*
@@ -79,7 +207,8 @@ InitBufTable(int size)
 uint32
 BufTableHashCode(BufferTag *tagPtr)
 {
-	return get_hash_value(SharedBufHash, (void *) tagPtr);
+	return DatumGetUInt32(hash_any((unsigned char *) tagPtr,
+								   sizeof(BufferTag)));
 }
 
 /*
@@ -91,19 +220,61 @@ BufTableHashCode(BufferTag *tagPtr)
 int
 BufTableLookup(BufferTag *tagPtr, uint32 hashcode)
 {
-	BufferLookupEnt *result;
+	uint32		partition = BufTableHashPartition(hashcode);
+
+	return BufTableProbe(&BufTableSlots[partition * BufTablePartitionSlots],
+						 tagPtr, hashcode);
+}
+
+/*
+ * BufTableLookupOptimistic
+ *		Lookup the given BufferTag without holding the BufMappingLock
+ *
+ * On success, sets *buf_id to the buffer ID, or -1 if not found, and returns
+ * true.  Returns false if the partition kept changing under us; the caller
+ * should then fall back to BufTableLookup under the partition lock.
+ *
+ * The result only describes the mapping at some instant during the call.
+ * Before relying on a buffer ID, the caller must pin the buffer and check
+ * that its tag still matches, since nothing prevents the buffer from being
+ * reassigned in the meantime.
+ */
+bool
+BufTableLookupOptimistic(BufferTag *tagPtr, uint32 hashcode, int *buf_id)
+{
+	uint32		partition = BufTableHashPartition(hashcode);
+	BufTablePartition *part = &BufTablePartitions[partition];
+	BufferLookupEnt *slots = &BufTableSlots[partition * BufTablePartitionSlots];
+	int			attempt;
+
+	for (attempt = 0; attempt < BUFTABLE_OPTIMISTIC_RETRIES; attempt++)
+	{
+		uint32		before;
+		uint32		after;
+		int			result;
+
+		before = pg_atomic_read_u32(&part->data.changecount);
+		if (before & 1)
+		{
+			/* a change is in progress; give the writer a moment */
+			pg_spin_delay();
+			continue;
+		}
+		pg_read_barrier();
 
-	result = (BufferLookupEnt *)
-		hash_search_with_hash_value(SharedBufHash,
-									(void *) tagPtr,
-									hashcode,
-									HASH_FIND,
-									NULL);
+		result = BufTableProbe(slots, tagPtr, hashcode);
 
-	if (!result)
-		return -1;
+		pg_read_barrier();
+		after = pg_atomic_read_u32(&part->data.changecount);
 
-	return result->id;
+		if (before == after)
+		{
+			*buf_id = result;
+			return true;
+		}
+	}
+
+	return false;
 }
 
 /*
@@ -119,23 +290,36 @@ BufTableLookup(BufferTag *tagPtr, uint32 hashcode)
 int
 BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 {
-	BufferLookupEnt *result;
-	bool		found;
+	uint32		partition = BufTableHashPartition(hashcode);
+	BufTablePartition *part = &BufTablePartitions[partition];
+	BufferLookupEnt *slots = &BufTableSlots[partition * BufTablePartitionSlots];
+	uint32		i;
 
 	Assert(buf_id >= 0);		/* -1 is reserved for not-in-table */
 	Assert(tagPtr->blockNum != P_NEW);	/* invalid tag */
 
-	result = (BufferLookupEnt *)
-		hash_search_with_hash_value(SharedBufHash,
-									(void *) tagPtr,
-									hashcode,
-									HASH_ENTER,
-									&found);
+	/* find either an existing entry or the first free slot */
+	i = BufTableHomeSlot(hashcode);
+	while (slots[i].id >= 0)
+	{
+		if (slots[i].hashcode == hashcode &&
+			BUFFERTAGS_EQUAL(slots[i].key, *tagPtr))
+			return slots[i].id;
+		if (++i == BufTablePartitionSlots)
+			i = 0;
+	}
 
-	if (found)					/* found something already in the table */
-		return result->id;
+	/* always leave one slot free, so that probes are sure to terminate */
+	if (part->data.nentries >= BufTablePartitionSlots - 1)
+		elog(ERROR, "shared buffer hash table partition %u is full",
+			 partition);
 
-	result->id = buf_id;
+	BufTableBeginChange(part);
+	slots[i].key = *tagPtr;
+	slots[i].hashcode = hashcode;
+	slots[i].id = buf_id;
+	part->data.nentries++;
+	BufTableEndChange(part);
 
 	return -1;
 }
@@ -149,15 +333,56 @@ BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 void
 BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 {
-	BufferLookupEnt *result;
+	uint32		partition = BufTableHashPartition(hashcode);
+	BufTablePartition *part = &BufTablePartitions[partition];
+	BufferLookupEnt *slots = &BufTableSlots[partition * BufTablePartitionSlots];
+	uint32		hole;
+	uint32		j;
+
+	hole = BufTableHomeSlot(hashcode);
+	for (;;)
+	{
+		if (slots[hole].id < 0)	/* shouldn't happen */
+			elog(ERROR, "shared buffer hash table corrupted");
+		if (slots[hole].hashcode == hashcode &&
+			BUFFERTAGS_EQUAL(slots[hole].key, *tagPtr))
+			break;
+		if (++hole == BufTablePartitionSlots)
+			hole = 0;
+	}
+
+	BufTableBeginChange(part);
+
+	/*
+	 * Shift back any later entries in the same run that would become
+	 * unreachable once the hole is emptied, that is, those whose home slot
+	 * does not lie cyclically within (hole, j].
+	 */
+	j = hole;
+	for (;;)
+	{
+		uint32		home;
+		bool		reachable;
+
+		if (++j == BufTablePartitionSlots)
+			j = 0;
+		if (slots[j].id < 0)
+			break;
+
+		home = BufTableHomeSlot(slots[j].hashcode);
+		if (hole <= j)
+			reachable = (hole < home && home <= j);
+		else
+			reachable = (hole < home || home <= j);
 
-	result = (BufferLookupEnt *)
-		hash_search_with_hash_value(SharedBufHash,
-									(void *) tagPtr,
-									hashcode,
-									HASH_REMOVE,
-									NULL);
+		if (!reachable)
+		{
+			slots[hole] = slots[j];
+			hole = j;
+		}
+	}
+	slots[hole].id = -1;
+	part->data.nentries--;
 
-	if (!result)				/* shouldn't happen */
-		elog(ERROR, "shared buffer hash table corrupted");
+	BufTableEndChange(part);
 }
@@ -46,6 +46,7 @@
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
 #include "storage/proc.h"
+#include "storage/readahead.h"
 #include "storage/smgr.h"
 #include "storage/standby.h"
 #include "utils/rel.h"
@@ -444,6 +445,9 @@ static void TerminateBufferIO(BufferDesc *buf, bool clear_dirty,
 				  uint32 set_flag_bits);
 static void shared_buffer_write_error_callback(void *arg);
 static void local_buffer_write_error_callback(void *arg);
+static BufferDesc *LookupAndPinBuffer(BufferTag *tag, uint32 hashcode,
+				   LWLock *partitionLock,
+				   BufferAccessStrategy strategy, bool *valid);
 static BufferDesc *BufferAlloc(SMgrRelation smgr,
 			char relpersistence,
 			ForkNumber forkNum,
@@ -524,6 +528,10 @@ ComputeIoConcurrency(int io_concurrency, double *target)
  * buffer.  Instead it tries to ensure that a future ReadBuffer for the given
  * block will not be delayed by the I/O.  Prefetching is optional.
  * No-op if prefetching isn't compiled in.
+ *
+ * If there are read-ahead workers, we ask one of them to read the block into
+ * shared buffers; otherwise we can only tell the kernel that we'll need it.
+ * See readahead.c.
  */
 void
 PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
@@ -562,13 +570,21 @@ PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 		newPartitionLock = BufMappingPartitionLock(newHash);
 
 		/* see if the block is in the buffer pool already */
-		LWLockAcquire(newPartitionLock, LW_SHARED);
-		buf_id = BufTableLookup(&newTag, newHash);
-		LWLockRelease(newPartitionLock);
+		if (!BufTableLookupOptimistic(&newTag, newHash, &buf_id))
+		{
+			LWLockAcquire(newPartitionLock, LW_SHARED);
+			buf_id = BufTableLookup(&newTag, newHash);
+			LWLockRelease(newPartitionLock);
+		}
 
 		/* If not in buffers, initiate prefetch */
 		if (buf_id < 0)
-			smgrprefetch(reln->rd_smgr, forkNum, blockNum);
+		{
+			if (readahead_workers > 0)
+				(void) ReadAheadEnqueue(reln, &newTag);
+			else
+				smgrprefetch(reln->rd_smgr, forkNum, blockNum);
+		}
 
 		/*
 		 * If the block *is* in buffers, we do nothing.  This is not really
@@ -693,6 +709,26 @@ ReadBufferWithoutRelcache(RelFileNode rnode, ForkNumber forkNum,
 							 mode, strategy, &hit);
 }
 
+/*
+ * ReadBufferForReadAhead -- read a block into shared buffers on behalf of
+ *		another backend; see readahead.c
+ *
+ * Like ReadBufferWithoutRelcache, but for any relation that uses shared
+ * buffers, and *hit tells whether the block was there already.  The caller
+ * must hold a lock on the relation.
+ */
+Buffer
+ReadBufferForReadAhead(RelFileNode rnode, char relpersistence,
+					   ForkNumber forkNum, BlockNumber blockNum, bool *hit)
+{
+	SMgrRelation smgr = smgropen(rnode, InvalidBackendId);
+
+	Assert(relpersistence != RELPERSISTENCE_TEMP);
+
+	return ReadBuffer_common(smgr, relpersistence, forkNum, blockNum,
+							 RBM_NORMAL, NULL, hit);
+}
+
 
 /*
  * ReadBuffer_common -- common logic for all ReadBuffer variants
@@ -964,6 +1000,63 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	return BufferDescriptorGetBuffer(bufHdr);
 }
 
+/*
+ * LookupAndPinBuffer -- find the shared buffer holding a page, and pin it
+ *
+ * Returns NULL if the page is not in the buffer pool.  Otherwise returns the
+ * buffer, pinned, and sets *valid to whether its contents are valid (see
+ * PinBuffer).
+ *
+ * The mapping table is first searched without taking the partition lock.  A
+ * buffer found that way may have been reassigned to another page before we
+ * managed to pin it, so we check its tag again once the pin is held; from
+ * then on the tag can't change, because renaming or invalidating a buffer
+ * requires that no one else has it pinned.  If the optimistic lookup can't
+ * get a stable view of the partition, or finds a buffer that has moved on,
+ * we fall back to searching under the partition lock as before.  (Pinning
+ * the wrong buffer briefly bumps its usage count; that's harmless.)
+ */
+static BufferDesc *
+LookupAndPinBuffer(BufferTag *tag, uint32 hashcode, LWLock *partitionLock,
+				   BufferAccessStrategy strategy, bool *valid)
+{
+	BufferDesc *buf;
+	int			buf_id;
+
+	if (BufTableLookupOptimistic(tag, hashcode, &buf_id))
+	{
+		uint32		buf_state;
+
+		if (buf_id < 0)
+			return NULL;
+
+		buf = GetBufferDescriptor(buf_id);
+		*valid = PinBuffer(buf, strategy);
+
+		buf_state = pg_atomic_read_u32(&buf->state);
+		if ((buf_state & BM_TAG_VALID) && BUFFERTAGS_EQUAL(buf->tag, *tag))
+			return buf;
+
+		UnpinBuffer(buf, true);
+	}
+
+	LWLockAcquire(partitionLock, LW_SHARED);
+	buf_id = BufTableLookup(tag, hashcode);
+	if (buf_id < 0)
+	{
+		LWLockRelease(partitionLock);
+		return NULL;
+	}
+
+	buf = GetBufferDescriptor(buf_id);
+	*valid = PinBuffer(buf, strategy);
+
+	/* Can release the mapping lock as soon as we've pinned it */
+	LWLockRelease(partitionLock);
+
+	return buf;
+}
+
 /*
  * BufferAlloc -- subroutine for ReadBuffer.  Handles lookup of a shared
  *		buffer.  If no buffer exists already, selects a replacement
@@ -1008,23 +1101,15 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
-	/* see if the block is in the buffer pool already */
-	LWLockAcquire(newPartitionLock, LW_SHARED);
-	buf_id = BufTableLookup(&newTag, newHash);
-	if (buf_id >= 0)
+	/*
+	 * See if the block is in the buffer pool already.  If so, it comes back
+	 * pinned, so no one can steal it from the buffer pool; check to see if
+	 * the correct data has been loaded into the buffer.
+	 */
+	buf = LookupAndPinBuffer(&newTag, newHash, newPartitionLock, strategy,
+							 &valid);
+	if (buf != NULL)
 	{
-		/*
-		 * Found it.  Now, pin the buffer so no one can steal it from the
-		 * buffer pool, and check to see if the correct data has been loaded
-		 * into the buffer.
-		 */
-		buf = GetBufferDescriptor(buf_id);
-
-		valid = PinBuffer(buf, strategy);
-
-		/* Can release the mapping lock as soon as we've pinned it */
-		LWLockRelease(newPartitionLock);
-
 		*foundPtr = true;
 
 		if (!valid)
@@ -1046,14 +1131,14 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 			}
 		}
 
+		StrategyCountAccess(buf);
 		return buf;
 	}
 
 	/*
 	 * Didn't find it in the buffer pool.  We'll have to initialize a new
-	 * buffer.  Remember to unlock the mapping lock while doing the work.
+	 * buffer.
 	 */
-	LWLockRelease(newPartitionLock);
 
 	/* Loop here in case we have to try another victim buffer */
 	for (;;)
@@ -1258,6 +1343,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				}
 			}
 
+			StrategyCountAccess(buf);
 			return buf;
 		}
 
@@ -1298,6 +1384,9 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	 * checkpoints, except for their "init" forks, which need to be treated
 	 * just like permanent relations.
 	 */
+	StrategyAdmitBuffer(buf, strategy, oldPartitionLock != NULL, oldHash,
+						newHash);
+
 	buf->tag = newTag;
 	buf_state &= ~(BM_VALID | BM_DIRTY | BM_JUST_DIRTIED |
 				   BM_CHECKPOINT_NEEDED | BM_IO_ERROR | BM_PERMANENT |
@@ -1328,6 +1417,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	else
 		*foundPtr = true;
 
+	StrategyCountAccess(buf);
 	return buf;
 }
 
@@ -1418,6 +1508,7 @@ retry:
 	oldFlags = buf_state & BUF_FLAG_MASK;
 	CLEAR_BUFFERTAG(buf->tag);
 	buf_state &= ~(BUF_FLAG_MASK | BUF_USAGECOUNT_MASK);
+	StrategyForgetBuffer(buf);
 	UnlockBufHdr(buf, buf_state);
 
 	/*
@@ -2336,8 +2427,8 @@ BgBufferSync(WritebackContext *wb_context)
  *
  * Returns a bitmask containing the following flag bits:
  *	BUF_WRITTEN: we wrote the buffer.
- *	BUF_REUSABLE: buffer is available for replacement, ie, it has
- *		pin count 0 and usage count 0.
+ *	BUF_REUSABLE: buffer is available for replacement, ie, the clock
+ *		sweep would evict it if it came across it now.
  *
  * (BUF_WRITTEN could be set in error if FlushBuffers finds the buffer clean
  * after locking it, but we don't care all that much.)
@@ -2365,8 +2456,7 @@ SyncOneBuffer(int buf_id, bool skip_recently_used, WritebackContext *wb_context)
 	 */
 	buf_state = LockBufHdr(bufHdr);
 
-	if (BUF_STATE_GET_REFCOUNT(buf_state) == 0 &&
-		BUF_STATE_GET_USAGECOUNT(buf_state) == 0)
+	if (StrategyBufferIsReusable(bufHdr, buf_state))
 	{
 		result |= BUF_REUSABLE;
 	}
@@ -2465,7 +2555,8 @@ InitBufferPoolBackend(void)
 
 /*
  * During backend exit, ensure that we released all shared-buffer locks and
- * assert that we have no remaining pins.
+ * assert that we have no remaining pins.  Also publish our share of the
+ * replacement strategy's statistics, which would be lost otherwise.
  */
 static void
 AtProcExit_Buffers(int code, Datum arg)
@@ -2475,6 +2566,8 @@ AtProcExit_Buffers(int code, Datum arg)
 
 	CheckForBufferLeaks();
 
+	StrategyFlushStats();
+
 	/* localbuf.c needs a chance too */
 	AtProcExit_LocalBuffers();
 }
@@ -3687,23 +3780,31 @@ LockBufferForCleanup(Buffer buffer)
 /*
  * Check called from RecoveryConflictInterrupt handler when Startup
  * process requests cancellation of all pin holders that are blocking it.
+ * Parallel redo workers can be blocked the same way, so check their
+ * buffers as well.
  */
 bool
 HoldingBufferPinThatDelaysRecovery(void)
 {
-	int			bufid = GetStartupBufferPinWaitBufId();
+	int			slot;
 
-	/*
-	 * If we get woken slowly then it's possible that the Startup process was
-	 * already woken by other backends before we got here. Also possible that
-	 * we get here by multiple interrupts or interrupts at inappropriate
-	 * times, so make sure we do nothing if the bufid is not set.
-	 */
-	if (bufid < 0)
-		return false;
+	for (slot = 0; slot < NUM_STARTUP_PIN_WAITERS; slot++)
+	{
+		int			bufid = GetStartupBufferPinWaitBufId(slot);
 
-	if (GetPrivateRefCount(bufid + 1) > 0)
-		return true;
+		/*
+		 * If we get woken slowly then it's possible that the Startup process
+		 * was already woken by other backends before we got here. Also
+		 * possible that we get here by multiple interrupts or interrupts at
+		 * inappropriate times, so make sure we do nothing if the bufid is not
+		 * set.
+		 */
+		if (bufid < 0)
+			continue;
+
+		if (GetPrivateRefCount(bufid + 1) > 0)
+			return true;
+	}
 
 	return false;
 }
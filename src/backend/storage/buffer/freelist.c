@@ -18,10 +18,73 @@
 #include "port/atomics.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/pg_shmem.h"
 #include "storage/proc.h"
 
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 
+/*
+ * Replacement states of a buffer, kept in BufferReplacementState[] rather than
+ * in BufferDesc, which has no room left within its cache line.
+ *
+ * A block starts out on probation when it is read in, and the clock sweep
+ * evicts it the first time it finds it unused, unless it has been used again
+ * in the meantime; then it is promoted to protected.  Protected buffers age as
+ * in a plain clock sweep, except that the sweep leaves their usage counts
+ * alone while they make up no more than PROTECTED_BUFFERS_TARGET of the pool.
+ * Blocks read through a buffer ring are on bulk probation: they must survive
+ * one pass of the sweep, as the ring expects, but are never ghosts (see
+ * StrategyAdmitBuffer).  This is a clock approximation of 2Q, which keeps
+ * blocks touched only once, as by large scans, from flushing out the ones in
+ * repeated use.
+ */
+#define BUF_PROBATION		0
+#define BUF_PROTECTED		1
+#define BUF_BULK_PROBATION	2
+
+#define PROTECTED_BUFFERS_TARGET(nbuffers)	((nbuffers) - (nbuffers) / 4)
+
+/*
+ * Entries of BufferGhosts[].  0 marks an empty slot, so we reserve it by
+ * setting the low bit of every buffer-mapping hash code we store.
+ */
+#define GHOST_TAG(hashcode)		((hashcode) | 1)
+
+/*
+ * Backends publish their statistics after this many buffer allocations, and
+ * at exit.
+ */
+#define STRATEGY_STATS_FLUSH_INTERVAL	128
+
+/*
+ * With a NUMA-partitioned buffer pool, backends publish their counts of local
+ * and remote buffer accesses, and check which node they are running on,
+ * after this many buffer lookups.
+ */
+#define STRATEGY_NODE_CHECK_INTERVAL	1024
+
+/*
+ * A NUMA partition of the buffer pool; see InitBufferPool.  Without NUMA
+ * placement there is just one, holding all the buffers.
+ */
+typedef struct BufferNumaPartition
+{
+	int			node;			/* NUMA node, or -1 if not partitioned */
+
+	/* Protected by buffer_strategy_lock */
+	int			firstFreeBuffer;	/* Head of list of unused buffers */
+	int			lastFreeBuffer; /* Tail of list of unused buffers */
+
+	/*
+	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
+	 * when the list is empty)
+	 */
+
+	/* Buffer lookups by backends running on this node */
+	pg_atomic_uint64 localAccesses;
+	pg_atomic_uint64 remoteAccesses;
+} BufferNumaPartition;
+
 
 /*
  * The shared freelist control information.
@@ -38,13 +101,12 @@ typedef struct
 	 */
 	pg_atomic_uint32 nextVictimBuffer;
 
-	int			firstFreeBuffer;	/* Head of list of unused buffers */
-	int			lastFreeBuffer; /* Tail of list of unused buffers */
-
 	/*
-	 * NOTE: lastFreeBuffer is undefined when firstFreeBuffer is -1 (that is,
-	 * when the list is empty)
+	 * Partitions of the buffer pool, each with its own list of unused
+	 * buffers.  These two don't change after initialization.
 	 */
+	int			numPartitions;
+	int			partitionSize;	/* see BufferNumaPartitionSize */
 
 	/*
 	 * Statistics.  These counters should be wide enough that they can't
@@ -58,11 +120,59 @@ typedef struct
 	 * StrategyNotifyBgWriter.
 	 */
 	int			bgwprocno;
+
+	/* Number of buffers in state BUF_PROTECTED */
+	pg_atomic_uint32 numProtected;
+
+	/*
+	 * Cumulative statistics for StrategyGetStats.  Backends accumulate these
+	 * locally and add them in every STRATEGY_STATS_FLUSH_INTERVAL allocations
+	 * and when they exit, so they lag a little behind reality.
+	 */
+	pg_atomic_uint64 statAllocs;
+	pg_atomic_uint64 statFreelistHits;
+	pg_atomic_uint64 statRingReuses;
+	pg_atomic_uint64 statClockTicks;
+	pg_atomic_uint64 statClockPinned;
+	pg_atomic_uint64 statClockDecrements;
+	pg_atomic_uint64 statClockProtected;
+	pg_atomic_uint64 statPromotions;
+	pg_atomic_uint64 statGhostHits;
+	pg_atomic_uint64 statProbationVictims;
+	pg_atomic_uint64 statProtectedVictims;
+
+	BufferNumaPartition partitions[MAX_BUFFER_NUMA_PARTITIONS];
 } BufferStrategyControl;
 
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
 
+/*
+ * Replacement state of each buffer, indexed by buf_id.  An entry may only be
+ * changed while holding the buffer's header spinlock.
+ */
+static uint8 *BufferReplacementState = NULL;
+
+/*
+ * Hash codes of blocks recently evicted from probation, indexed by hash code
+ * modulo NBuffers.  This is the "ghost" queue of 2Q, made lossy: a newer
+ * ghost simply overwrites an older one in the same slot.  It is read and
+ * written without locking; a torn or lost update merely misjudges one block.
+ */
+static uint32 *BufferGhosts = NULL;
+
+/* Statistics not yet added to StrategyControl's counters */
+static BufferStrategyStats pendingStats;
+
+/*
+ * The partition on the NUMA node this backend runs on, as of the last check,
+ * or -1 if unknown; and our buffer lookups not yet added to its counters.
+ */
+static int	myPartition = -1;
+static int	accessesSinceNodeCheck = STRATEGY_NODE_CHECK_INTERVAL;
+static uint64 pendingLocalAccesses = 0;
+static uint64 pendingRemoteAccesses = 0;
+
 /*
  * Private (non-shared) state for managing a ring of shared buffers to re-use.
  * This is currently the only kind of BufferAccessStrategy object, but someday
@@ -102,6 +212,7 @@ static BufferDesc *GetBufferFromRing(BufferAccessStrategy strategy,
 				  uint32 *buf_state);
 static void AddBufferToRing(BufferAccessStrategy strategy,
 				BufferDesc *buf);
+static void FlushAccessStats(void);
 
 /*
  * ClockSweepTick - Helper routine for StrategyGetBuffer()
@@ -179,10 +290,14 @@ ClockSweepTick(void)
 bool
 have_free_buffer()
 {
-	if (StrategyControl->firstFreeBuffer >= 0)
-		return true;
-	else
-		return false;
+	int			i;
+
+	for (i = 0; i < StrategyControl->numPartitions; i++)
+	{
+		if (StrategyControl->partitions[i].firstFreeBuffer >= 0)
+			return true;
+	}
+	return false;
 }
 
 /*
@@ -203,8 +318,16 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 	BufferDesc *buf;
 	int			bgwprocno;
 	int			trycounter;
+	int			i;
+	bool		passed_protected;
+	bool		age_protected;
 	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
 
+	/* publish our statistics every so often */
+	if (pendingStats.buffers_alloc + pendingStats.ring_reuses >=
+		STRATEGY_STATS_FLUSH_INTERVAL)
+		StrategyFlushStats();
+
 	/*
 	 * If given a strategy object, see whether it can select a buffer. We
 	 * assume strategy objects don't need buffer_strategy_lock.
@@ -213,7 +336,10 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 	{
 		buf = GetBufferFromRing(strategy, buf_state);
 		if (buf != NULL)
+		{
+			pendingStats.ring_reuses++;
 			return buf;
+		}
 	}
 
 	/*
@@ -248,6 +374,7 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 	 * strategy object are intentionally not counted here.
 	 */
 	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+	pendingStats.buffers_alloc++;
 
 	/*
 	 * First check, without acquiring the lock, whether there's buffers in the
@@ -261,28 +388,36 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 	 * buffer of the freelist. Then check whether that buffer is usable and
 	 * repeat if not.
 	 *
+	 * If the buffer pool is split across NUMA nodes, there's one freelist per
+	 * node, and we try our own node's first.
+	 *
 	 * Note that the freeNext fields are considered to be protected by the
 	 * buffer_strategy_lock not the individual buffer spinlocks, so it's OK to
 	 * manipulate them without holding the spinlock.
 	 */
-	if (StrategyControl->firstFreeBuffer >= 0)
+	for (i = 0; i < StrategyControl->numPartitions; i++)
 	{
-		while (true)
+		BufferNumaPartition *part;
+
+		part = &StrategyControl->partitions[(Max(myPartition, 0) + i) %
+											StrategyControl->numPartitions];
+
+		while (part->firstFreeBuffer >= 0)
 		{
 			/* Acquire the spinlock to remove element from the freelist */
 			SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 
-			if (StrategyControl->firstFreeBuffer < 0)
+			if (part->firstFreeBuffer < 0)
 			{
 				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 				break;
 			}
 
-			buf = GetBufferDescriptor(StrategyControl->firstFreeBuffer);
+			buf = GetBufferDescriptor(part->firstFreeBuffer);
 			Assert(buf->freeNext != FREENEXT_NOT_IN_LIST);
 
 			/* Unconditionally remove buffer from freelist */
-			StrategyControl->firstFreeBuffer = buf->freeNext;
+			part->firstFreeBuffer = buf->freeNext;
 			buf->freeNext = FREENEXT_NOT_IN_LIST;
 
 			/*
@@ -304,65 +439,197 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 			{
 				if (strategy != NULL)
 					AddBufferToRing(strategy, buf);
+				pendingStats.freelist_hits++;
 				*buf_state = local_buf_state;
 				return buf;
 			}
 			UnlockBufHdr(buf, local_buf_state);
-
 		}
 	}
 
-	/* Nothing on the freelist, so run the "clock sweep" algorithm */
+	/*
+	 * Nothing on the freelist, so run the "clock sweep" algorithm.  Protected
+	 * buffers are passed over without aging them while there are few enough
+	 * of them; but if we find nothing else we can evict in a whole pass, we
+	 * age them after all.
+	 */
 	trycounter = NBuffers;
+	passed_protected = false;
+	age_protected = false;
 	for (;;)
 	{
+		uint8	   *state;
+		uint32		usage_count;
+
 		buf = GetBufferDescriptor(ClockSweepTick());
+		state = &BufferReplacementState[buf->buf_id];
+		pendingStats.clock_ticks++;
 
 		/*
 		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
 		 * it; decrement the usage_count (unless pinned) and keep scanning.
+		 * Buffers on probation are fair game with a usage_count of one, that
+		 * is, if they haven't been used again since they were read in.
 		 */
 		local_buf_state = LockBufHdr(buf);
+		usage_count = BUF_STATE_GET_USAGECOUNT(local_buf_state);
 
 		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
 		{
-			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
-			{
-				local_buf_state -= BUF_USAGECOUNT_ONE;
-
-				trycounter = NBuffers;
-			}
-			else
+			if (usage_count == 0 ||
+				(usage_count == 1 && *state == BUF_PROBATION))
 			{
 				/* Found a usable buffer */
+				if (*state == BUF_PROTECTED)
+					pendingStats.protected_victims++;
+				else
+					pendingStats.probation_victims++;
 				if (strategy != NULL)
 					AddBufferToRing(strategy, buf);
 				*buf_state = local_buf_state;
 				return buf;
 			}
+
+			if (*state == BUF_PROTECTED && !age_protected &&
+				pg_atomic_read_u32(&StrategyControl->numProtected) <=
+				PROTECTED_BUFFERS_TARGET(NBuffers))
+			{
+				/* leave it be */
+				pendingStats.clock_protected++;
+				passed_protected = true;
+			}
+			else
+			{
+				if (*state != BUF_PROTECTED && usage_count > 1)
+				{
+					/* used again since it was read in, so promote it */
+					*state = BUF_PROTECTED;
+					pg_atomic_fetch_add_u32(&StrategyControl->numProtected, 1);
+					pendingStats.promotions++;
+				}
+
+				local_buf_state -= BUF_USAGECOUNT_ONE;
+				pendingStats.clock_decrements++;
+
+				trycounter = NBuffers;
+				UnlockBufHdr(buf, local_buf_state);
+				continue;
+			}
 		}
-		else if (--trycounter == 0)
+		else
+			pendingStats.clock_pinned++;
+
+		if (--trycounter == 0)
 		{
-			/*
-			 * We've scanned all the buffers without making any state changes,
-			 * so all the buffers are pinned (or were when we looked at them).
-			 * We could hope that someone will free one eventually, but it's
-			 * probably better to fail than to risk getting stuck in an
-			 * infinite loop.
-			 */
-			UnlockBufHdr(buf, local_buf_state);
-			elog(ERROR, "no unpinned buffers available");
+			if (passed_protected)
+			{
+				/* we must make room among the protected buffers */
+				age_protected = true;
+				passed_protected = false;
+				trycounter = NBuffers;
+			}
+			else
+			{
+				/*
+				 * We've scanned all the buffers without making any state
+				 * changes, so all the buffers are pinned (or were when we
+				 * looked at them).  We could hope that someone will free one
+				 * eventually, but it's probably better to fail than to risk
+				 * getting stuck in an infinite loop.
+				 */
+				UnlockBufHdr(buf, local_buf_state);
+				elog(ERROR, "no unpinned buffers available");
+			}
 		}
 		UnlockBufHdr(buf, local_buf_state);
 	}
 }
 
+/*
+ * StrategyAdmitBuffer -- choose the replacement state of a buffer being
+ *		reassigned to a new block
+ *
+ * Called by BufferAlloc with the buffer header spinlock held, just before
+ * the buffer gets its new tag.  newHash is the buffer-mapping hash code of
+ * the new block; if the buffer held a valid block, had_old is true and
+ * oldHash is that block's hash code.
+ *
+ * A block leaving probation becomes a ghost, and a block read in again
+ * while its ghost is still around is admitted directly as protected: it was
+ * needed again soon after being judged a one-time use.  Blocks read through
+ * a buffer ring are bulk operations' pages, so they neither leave ghosts nor
+ * are matched against them.
+ */
+void
+StrategyAdmitBuffer(BufferDesc *buf, BufferAccessStrategy strategy,
+					bool had_old, uint32 oldHash, uint32 newHash)
+{
+	uint8	   *state = &BufferReplacementState[buf->buf_id];
+
+	if (*state == BUF_PROTECTED)
+		pg_atomic_fetch_sub_u32(&StrategyControl->numProtected, 1);
+	else if (*state == BUF_PROBATION && had_old)
+		BufferGhosts[oldHash % NBuffers] = GHOST_TAG(oldHash);
+
+	if (strategy != NULL)
+		*state = BUF_BULK_PROBATION;
+	else if (BufferGhosts[newHash % NBuffers] == GHOST_TAG(newHash))
+	{
+		BufferGhosts[newHash % NBuffers] = 0;
+		*state = BUF_PROTECTED;
+		pg_atomic_fetch_add_u32(&StrategyControl->numProtected, 1);
+		pendingStats.ghost_hits++;
+	}
+	else
+		*state = BUF_PROBATION;
+}
+
+/*
+ * StrategyForgetBuffer -- reset the replacement state of a buffer whose
+ *		block is being dropped
+ *
+ * Caller must hold the buffer header spinlock.
+ */
+void
+StrategyForgetBuffer(BufferDesc *buf)
+{
+	uint8	   *state = &BufferReplacementState[buf->buf_id];
+
+	if (*state == BUF_PROTECTED)
+		pg_atomic_fetch_sub_u32(&StrategyControl->numProtected, 1);
+	*state = BUF_PROBATION;
+}
+
+/*
+ * StrategyBufferIsReusable -- would the clock sweep evict this buffer now?
+ *
+ * buf_state is the buffer's state, read with the header spinlock held.  The
+ * bgwriter uses this to find the buffers it should clean ahead of the sweep.
+ */
+bool
+StrategyBufferIsReusable(BufferDesc *buf, uint32 buf_state)
+{
+	uint32		usage_count = BUF_STATE_GET_USAGECOUNT(buf_state);
+
+	if (BUF_STATE_GET_REFCOUNT(buf_state) != 0)
+		return false;
+	return usage_count == 0 ||
+		(usage_count == 1 &&
+		 BufferReplacementState[buf->buf_id] == BUF_PROBATION);
+}
+
 /*
  * StrategyFreeBuffer: put a buffer on the freelist
  */
 void
 StrategyFreeBuffer(BufferDesc *buf)
 {
+	BufferNumaPartition *part;
+
+	/* the buffer goes back to the freelist of its partition */
+	part = &StrategyControl->partitions[buf->buf_id /
+										StrategyControl->partitionSize];
+
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 
 	/*
@@ -371,10 +638,10 @@ StrategyFreeBuffer(BufferDesc *buf)
 	 */
 	if (buf->freeNext == FREENEXT_NOT_IN_LIST)
 	{
-		buf->freeNext = StrategyControl->firstFreeBuffer;
+		buf->freeNext = part->firstFreeBuffer;
 		if (buf->freeNext < 0)
-			StrategyControl->lastFreeBuffer = buf->buf_id;
-		StrategyControl->firstFreeBuffer = buf->buf_id;
+			part->lastFreeBuffer = buf->buf_id;
+		part->firstFreeBuffer = buf->buf_id;
 	}
 
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
@@ -441,6 +708,171 @@ StrategyNotifyBgWriter(int bgwprocno)
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 }
 
+/*
+ * StrategyFlushStats -- add this backend's pending statistics to the shared
+ * counters
+ */
+void
+StrategyFlushStats(void)
+{
+#define FLUSH_STAT(field, counter) \
+	do { \
+		if (pendingStats.field != 0) \
+		{ \
+			pg_atomic_fetch_add_u64(&StrategyControl->counter, \
+									pendingStats.field); \
+			pendingStats.field = 0; \
+		} \
+	} while (0)
+
+	FLUSH_STAT(buffers_alloc, statAllocs);
+	FLUSH_STAT(freelist_hits, statFreelistHits);
+	FLUSH_STAT(ring_reuses, statRingReuses);
+	FLUSH_STAT(clock_ticks, statClockTicks);
+	FLUSH_STAT(clock_pinned, statClockPinned);
+	FLUSH_STAT(clock_decrements, statClockDecrements);
+	FLUSH_STAT(clock_protected, statClockProtected);
+	FLUSH_STAT(promotions, statPromotions);
+	FLUSH_STAT(ghost_hits, statGhostHits);
+	FLUSH_STAT(probation_victims, statProbationVictims);
+	FLUSH_STAT(protected_victims, statProtectedVictims);
+
+#undef FLUSH_STAT
+
+	FlushAccessStats();
+}
+
+/*
+ * StrategyCountAccess -- count a lookup of a buffer as a local or a remote
+ *		NUMA access
+ *
+ * Called by the bufmgr for every buffer it looks up, whether found in the
+ * pool or newly allocated.  Does nothing unless the buffer pool is split
+ * across NUMA nodes.
+ */
+void
+StrategyCountAccess(BufferDesc *buf)
+{
+	if (StrategyControl->numPartitions <= 1)
+		return;
+
+	/* every so often, publish our counts and see where we run now */
+	if (++accessesSinceNodeCheck >= STRATEGY_NODE_CHECK_INTERVAL)
+	{
+		int			node = PGSharedMemoryLocalNumaNode();
+		int			i;
+
+		FlushAccessStats();
+
+		myPartition = -1;
+		for (i = 0; i < StrategyControl->numPartitions; i++)
+		{
+			if (StrategyControl->partitions[i].node == node)
+				myPartition = i;
+		}
+		accessesSinceNodeCheck = 0;
+	}
+
+	/* accesses from nodes without memory of their own aren't counted */
+	if (myPartition < 0)
+		return;
+
+	if (buf->buf_id / StrategyControl->partitionSize == myPartition)
+		pendingLocalAccesses++;
+	else
+		pendingRemoteAccesses++;
+}
+
+/*
+ * FlushAccessStats -- add this backend's pending counts of local and remote
+ *		buffer accesses to its partition's counters
+ */
+static void
+FlushAccessStats(void)
+{
+	BufferNumaPartition *part;
+
+	if (myPartition < 0)
+		return;
+
+	part = &StrategyControl->partitions[myPartition];
+	if (pendingLocalAccesses != 0)
+		pg_atomic_fetch_add_u64(&part->localAccesses, pendingLocalAccesses);
+	if (pendingRemoteAccesses != 0)
+		pg_atomic_fetch_add_u64(&part->remoteAccesses, pendingRemoteAccesses);
+	pendingLocalAccesses = 0;
+	pendingRemoteAccesses = 0;
+}
+
+/*
+ * StrategyGetStats -- report cumulative replacement statistics
+ *
+ * Other backends publish their counts in batches, so up to
+ * STRATEGY_STATS_FLUSH_INTERVAL recent allocations per backend may be
+ * missing.
+ */
+void
+StrategyGetStats(BufferStrategyStats *stats)
+{
+	uint32		complete_passes;
+
+	/* include our own activity, at least */
+	StrategyFlushStats();
+
+	stats->buffers_alloc = pg_atomic_read_u64(&StrategyControl->statAllocs);
+	stats->freelist_hits = pg_atomic_read_u64(&StrategyControl->statFreelistHits);
+	stats->ring_reuses = pg_atomic_read_u64(&StrategyControl->statRingReuses);
+	stats->clock_ticks = pg_atomic_read_u64(&StrategyControl->statClockTicks);
+	stats->clock_pinned = pg_atomic_read_u64(&StrategyControl->statClockPinned);
+	stats->clock_decrements =
+		pg_atomic_read_u64(&StrategyControl->statClockDecrements);
+	stats->clock_protected =
+		pg_atomic_read_u64(&StrategyControl->statClockProtected);
+	stats->promotions = pg_atomic_read_u64(&StrategyControl->statPromotions);
+	stats->ghost_hits = pg_atomic_read_u64(&StrategyControl->statGhostHits);
+	stats->probation_victims =
+		pg_atomic_read_u64(&StrategyControl->statProbationVictims);
+	stats->protected_victims =
+		pg_atomic_read_u64(&StrategyControl->statProtectedVictims);
+	stats->protected_buffers =
+		pg_atomic_read_u32(&StrategyControl->numProtected);
+
+	(void) StrategySyncStart(&complete_passes, NULL);
+	stats->complete_passes = complete_passes;
+}
+
+/*
+ * StrategyGetNumaStats -- report the partitions of the buffer pool
+ *
+ * Fills stats[] with one entry per partition, up to
+ * MAX_BUFFER_NUMA_PARTITIONS of them, and returns the number of partitions.
+ * If the buffer pool isn't split across NUMA nodes, that is a single entry
+ * with node -1 and no accesses counted.  Other backends publish their counts
+ * in batches, so recent accesses may be missing.
+ */
+int
+StrategyGetNumaStats(BufferNumaStats *stats)
+{
+	int			i;
+
+	/* include our own activity, at least */
+	FlushAccessStats();
+
+	for (i = 0; i < StrategyControl->numPartitions; i++)
+	{
+		BufferNumaPartition *part = &StrategyControl->partitions[i];
+		int			first = i * StrategyControl->partitionSize;
+
+		stats[i].node = part->node;
+		stats[i].buffers = Min(StrategyControl->partitionSize,
+							   NBuffers - first);
+		stats[i].local_accesses = pg_atomic_read_u64(&part->localAccesses);
+		stats[i].remote_accesses = pg_atomic_read_u64(&part->remoteAccesses);
+	}
+
+	return StrategyControl->numPartitions;
+}
+
 
 /*
  * StrategyShmemSize
@@ -461,6 +893,10 @@ StrategyShmemSize(void)
 	/* size of the shared replacement strategy control block */
 	size = add_size(size, MAXALIGN(sizeof(BufferStrategyControl)));
 
+	/* size of the per-buffer replacement states and of the ghost table */
+	size = add_size(size, MAXALIGN(mul_size(NBuffers, sizeof(uint8))));
+	size = add_size(size, MAXALIGN(mul_size(NBuffers, sizeof(uint32))));
+
 	return size;
 }
 
@@ -468,13 +904,19 @@ StrategyShmemSize(void)
  * StrategyInitialize -- initialize the buffer cache replacement
  *		strategy.
  *
- * Assumes: All of the buffers are already built into a linked list.
- *		Only called by postmaster and only during initialization.
+ * npartitions is the number of NUMA partitions the buffer pool is split
+ * into, and nodes[] their nodes; see InitBufferPool.  These are only looked
+ * at if init is true.
+ *
+ * Assumes: The buffers of each partition are already built into a linked
+ *		list.  Only called by postmaster and only during initialization.
  */
 void
-StrategyInitialize(bool init)
+StrategyInitialize(bool init, int npartitions, const int *nodes)
 {
 	bool		found;
+	bool		foundStates;
+	bool		foundGhosts;
 
 	/*
 	 * Initialize the shared buffer lookup hashtable.
@@ -496,8 +938,17 @@ StrategyInitialize(bool init)
 						sizeof(BufferStrategyControl),
 						&found);
 
+	BufferReplacementState = (uint8 *)
+		ShmemInitStruct("Buffer Replacement States",
+						NBuffers * sizeof(uint8), &foundStates);
+	BufferGhosts = (uint32 *)
+		ShmemInitStruct("Buffer Ghosts",
+						NBuffers * sizeof(uint32), &foundGhosts);
+
 	if (!found)
 	{
+		int			i;
+
 		/*
 		 * Only done once, usually in postmaster
 		 */
@@ -506,11 +957,25 @@ StrategyInitialize(bool init)
 		SpinLockInit(&StrategyControl->buffer_strategy_lock);
 
 		/*
-		 * Grab the whole linked list of free buffers for our strategy. We
-		 * assume it was previously set up by InitBufferPool().
+		 * Grab the linked lists of free buffers of all partitions for our
+		 * strategy. We assume they were previously set up by
+		 * InitBufferPool().
 		 */
-		StrategyControl->firstFreeBuffer = 0;
-		StrategyControl->lastFreeBuffer = NBuffers - 1;
+		Assert(npartitions >= 1 && npartitions <= MAX_BUFFER_NUMA_PARTITIONS);
+		StrategyControl->numPartitions = npartitions;
+		StrategyControl->partitionSize = BufferNumaPartitionSize(npartitions);
+		for (i = 0; i < npartitions; i++)
+		{
+			BufferNumaPartition *part = &StrategyControl->partitions[i];
+			int			first = i * StrategyControl->partitionSize;
+
+			part->node = (npartitions > 1) ? nodes[i] : -1;
+			part->firstFreeBuffer = first;
+			part->lastFreeBuffer =
+				Min(first + StrategyControl->partitionSize, NBuffers) - 1;
+			pg_atomic_init_u64(&part->localAccesses, 0);
+			pg_atomic_init_u64(&part->remoteAccesses, 0);
+		}
 
 		/* Initialize the clock sweep pointer */
 		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
@@ -521,6 +986,26 @@ StrategyInitialize(bool init)
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
+
+		/* Every buffer starts out empty, on probation, with no ghosts */
+		Assert(!foundStates && !foundGhosts);
+		memset(BufferReplacementState, BUF_PROBATION,
+			   NBuffers * sizeof(uint8));
+		memset(BufferGhosts, 0, NBuffers * sizeof(uint32));
+		pg_atomic_init_u32(&StrategyControl->numProtected, 0);
+
+		/* Clear cumulative statistics */
+		pg_atomic_init_u64(&StrategyControl->statAllocs, 0);
+		pg_atomic_init_u64(&StrategyControl->statFreelistHits, 0);
+		pg_atomic_init_u64(&StrategyControl->statRingReuses, 0);
+		pg_atomic_init_u64(&StrategyControl->statClockTicks, 0);
+		pg_atomic_init_u64(&StrategyControl->statClockPinned, 0);
+		pg_atomic_init_u64(&StrategyControl->statClockDecrements, 0);
+		pg_atomic_init_u64(&StrategyControl->statClockProtected, 0);
+		pg_atomic_init_u64(&StrategyControl->statPromotions, 0);
+		pg_atomic_init_u64(&StrategyControl->statGhostHits, 0);
+		pg_atomic_init_u64(&StrategyControl->statProbationVictims, 0);
+		pg_atomic_init_u64(&StrategyControl->statProtectedVictims, 0);
 	}
 	else
 		Assert(!init);
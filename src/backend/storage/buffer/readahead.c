@@ -0,0 +1,451 @@
+/*-------------------------------------------------------------------------
+ *
+ * readahead.c
+ *	  Read-ahead workers, reading pages into shared buffers ahead of scans
+ *
+ * PrefetchBuffer normally just hints to the kernel, with posix_fadvise, that
+ * a page will be read soon.  That does nothing for relations opened with
+ * io_direct, and a hint per page can do worse than the kernel's own
+ * readahead.  With readahead_workers set, PrefetchBuffer instead puts the
+ * page in a shared queue, and one of a pool of background workers reads it
+ * into shared buffers.  The backend that asked for it carries on with the
+ * pages it already has, and finds the page in the buffer pool when it gets
+ * there.  Each worker has one read in flight at a time, so up to
+ * readahead_workers reads are in flight at once; how far ahead each scan
+ * asks for pages is governed by effective_io_concurrency, as before.
+ *
+ * Requests carry only the page's buffer tag, and the lock identity and
+ * persistence of its relation.  Before reading, a worker takes
+ * AccessShareLock on the relation, and on its database, so that it can't
+ * read a page back into the buffer pool after the relation or database has
+ * been dropped or truncated and its buffers discarded.  It never waits for those locks: if they can't be had
+ * right away, the request is just dropped.  Pages that no longer exist by
+ * the time the worker holds the lock are skipped.  Temporary relations live
+ * in backend-local buffers, so they are still prefetched with hints.
+ *
+ * The workers aren't connected to a database and don't process shared
+ * invalidation messages, so they close the relation files they have opened
+ * whenever they have been idle for a while.
+ *
+ * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/buffer/readahead.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "catalog/pg_database.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "storage/bufmgr.h"
+#include "storage/buf_internals.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/lmgr.h"
+#include "storage/proc.h"
+#include "storage/readahead.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "storage/spin.h"
+#include "tcop/tcopprot.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+
+/* Number of requests the queue can hold; more are dropped */
+#define READAHEAD_QUEUE_SIZE	1024
+
+/* Most requests a worker takes from the queue at a time */
+#define READAHEAD_BATCH_SIZE	16
+
+/* Idle time after which a worker closes its relation files, in ms */
+#define READAHEAD_IDLE_CLOSE_TIMEOUT	1000
+
+typedef struct ReadAheadRequest
+{
+	LockRelId	lockRelId;		/* relation to lock while reading */
+	char		relpersistence; /* the relation's relpersistence */
+	BufferTag	tag;			/* page to read */
+} ReadAheadRequest;
+
+/*
+ * The queue is a ring buffer of requests, protected by the spinlock.  Idle
+ * workers put their latches on the sleepers stack, and each new request
+ * wakes one of them.
+ */
+typedef struct ReadAheadCtlData
+{
+	slock_t		mutex;
+	int			head;			/* index of the oldest request */
+	int			count;			/* number of requests queued */
+	int			nsleeping;		/* number of entries in sleepers[] */
+	Latch	   *sleepers[MAX_READAHEAD_WORKERS];
+	ReadAheadRequest requests[READAHEAD_QUEUE_SIZE];
+} ReadAheadCtlData;
+
+static ReadAheadCtlData *ReadAheadCtl = NULL;
+
+/* GUC variable */
+int			readahead_workers = 0;
+
+static int	ReadAheadDequeue(ReadAheadRequest *reqs, int maxreqs);
+static void ReadAheadWake(void);
+static void ReadAheadWorkerDetach(int code, Datum arg);
+static void ReadAheadRelation(ReadAheadRequest *reqs, int nreqs);
+
+
+/*
+ * Report shared-memory space needed by ReadAheadShmemInit
+ */
+Size
+ReadAheadShmemSize(void)
+{
+	if (readahead_workers == 0)
+		return 0;
+	return sizeof(ReadAheadCtlData);
+}
+
+/*
+ * Allocate and initialize the shared request queue
+ */
+void
+ReadAheadShmemInit(void)
+{
+	bool		found;
+
+	if (readahead_workers == 0)
+		return;
+
+	ReadAheadCtl = (ReadAheadCtlData *)
+		ShmemInitStruct("Read-Ahead Queue", ReadAheadShmemSize(), &found);
+
+	if (!found)
+	{
+		SpinLockInit(&ReadAheadCtl->mutex);
+		ReadAheadCtl->head = 0;
+		ReadAheadCtl->count = 0;
+		ReadAheadCtl->nsleeping = 0;
+	}
+}
+
+/*
+ * Register the read-ahead workers, at postmaster start
+ */
+void
+ReadAheadWorkersRegister(void)
+{
+	BackgroundWorker bgw;
+	int			i;
+
+	for (i = 0; i < readahead_workers; i++)
+	{
+		memset(&bgw, 0, sizeof(bgw));
+		bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		bgw.bgw_start_time = BgWorkerStart_ConsistentState;
+		snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(bgw.bgw_function_name, BGW_MAXLEN, "ReadAheadWorkerMain");
+		snprintf(bgw.bgw_name, BGW_MAXLEN, "read-ahead worker %d", i);
+		snprintf(bgw.bgw_type, BGW_MAXLEN, "read-ahead worker");
+		bgw.bgw_restart_time = 5;
+		bgw.bgw_notify_pid = 0;
+		bgw.bgw_main_arg = Int32GetDatum(i);
+
+		RegisterBackgroundWorker(&bgw);
+	}
+}
+
+/*
+ * ReadAheadEnqueue -- ask a worker to read a page into shared buffers
+ *
+ * Returns false if the queue is full, in which case the request is dropped.
+ * Only for relations in shared buffers.
+ */
+bool
+ReadAheadEnqueue(Relation reln, const BufferTag *tag)
+{
+	ReadAheadRequest *req;
+	Latch	   *sleeper = NULL;
+
+	Assert(readahead_workers > 0);
+	Assert(!RelationUsesLocalBuffers(reln));
+
+	SpinLockAcquire(&ReadAheadCtl->mutex);
+	if (ReadAheadCtl->count >= READAHEAD_QUEUE_SIZE)
+	{
+		SpinLockRelease(&ReadAheadCtl->mutex);
+		return false;
+	}
+	req = &ReadAheadCtl->requests[(ReadAheadCtl->head + ReadAheadCtl->count) %
+								  READAHEAD_QUEUE_SIZE];
+	req->lockRelId = reln->rd_lockInfo.lockRelId;
+	req->relpersistence = reln->rd_rel->relpersistence;
+	req->tag = *tag;
+	ReadAheadCtl->count++;
+	if (ReadAheadCtl->nsleeping > 0)
+		sleeper = ReadAheadCtl->sleepers[--ReadAheadCtl->nsleeping];
+	SpinLockRelease(&ReadAheadCtl->mutex);
+
+	if (sleeper != NULL)
+		SetLatch(sleeper);
+
+	return true;
+}
+
+/*
+ * Take up to maxreqs requests from the queue.  So that the other workers get
+ * a share, we take no more than our part of what's queued.  If there is
+ * nothing, we add ourselves to the sleepers instead, in the same critical
+ * section, so that no request can be queued without waking us.
+ */
+static int
+ReadAheadDequeue(ReadAheadRequest *reqs, int maxreqs)
+{
+	int			nreqs;
+	int			i;
+
+	SpinLockAcquire(&ReadAheadCtl->mutex);
+	nreqs = (ReadAheadCtl->count + readahead_workers - 1) / readahead_workers;
+	nreqs = Min(nreqs, maxreqs);
+	for (i = 0; i < nreqs; i++)
+	{
+		reqs[i] = ReadAheadCtl->requests[ReadAheadCtl->head];
+		ReadAheadCtl->head = (ReadAheadCtl->head + 1) % READAHEAD_QUEUE_SIZE;
+	}
+	ReadAheadCtl->count -= nreqs;
+	if (nreqs == 0)
+		ReadAheadCtl->sleepers[ReadAheadCtl->nsleeping++] = MyLatch;
+	SpinLockRelease(&ReadAheadCtl->mutex);
+
+	return nreqs;
+}
+
+/*
+ * Take ourselves off the sleepers stack, if no request did that already.
+ */
+static void
+ReadAheadWake(void)
+{
+	int			i;
+
+	SpinLockAcquire(&ReadAheadCtl->mutex);
+	for (i = 0; i < ReadAheadCtl->nsleeping; i++)
+	{
+		if (ReadAheadCtl->sleepers[i] == MyLatch)
+		{
+			ReadAheadCtl->sleepers[i] =
+				ReadAheadCtl->sleepers[--ReadAheadCtl->nsleeping];
+			break;
+		}
+	}
+	SpinLockRelease(&ReadAheadCtl->mutex);
+}
+
+/*
+ * before_shmem_exit callback, so that requests don't wake an exited worker
+ * while others sleep.
+ */
+static void
+ReadAheadWorkerDetach(int code, Datum arg)
+{
+	ReadAheadWake();
+}
+
+/*
+ * Read the pages of a batch of requests that all belong to the same relation
+ * fork.
+ */
+static void
+ReadAheadRelation(ReadAheadRequest *reqs, int nreqs)
+{
+	LockRelId  *relid = &reqs[0].lockRelId;
+	ForkNumber	forknum = reqs[0].tag.forkNum;
+	LOCKTAG		dbtag;
+	LOCKTAG		reltag;
+	SMgrRelation smgr;
+	int			i;
+
+	/* Give up rather than wait if the relation is being dropped or so */
+	SET_LOCKTAG_OBJECT(dbtag, InvalidOid, DatabaseRelationId, relid->dbId, 0);
+	SET_LOCKTAG_RELATION(reltag, relid->dbId, relid->relId);
+	if (OidIsValid(relid->dbId) &&
+		LockAcquire(&dbtag, AccessShareLock, true, true) == LOCKACQUIRE_NOT_AVAIL)
+		return;
+	if (LockAcquire(&reltag, AccessShareLock, true, true) == LOCKACQUIRE_NOT_AVAIL)
+	{
+		if (OidIsValid(relid->dbId))
+			LockRelease(&dbtag, AccessShareLock, true);
+		return;
+	}
+
+	/*
+	 * The relation can't be truncated while we hold the lock, but it may
+	 * have been since the requests were made.
+	 */
+	smgr = smgropen(reqs[0].tag.rnode, InvalidBackendId);
+	if (smgrexists(smgr, forknum))
+	{
+		BlockNumber nblocks = smgrnblocks(smgr, forknum);
+
+		for (i = 0; i < nreqs; i++)
+		{
+			Buffer		buffer;
+			bool		hit;
+
+			if (reqs[i].tag.blockNum >= nblocks)
+				continue;
+
+			buffer = ReadBufferForReadAhead(reqs[i].tag.rnode,
+											reqs[i].relpersistence, forknum,
+											reqs[i].tag.blockNum, &hit);
+
+			/*
+			 * If we did read the page, rather than find it already there,
+			 * reset its usage count so that the access by the backend that
+			 * asked for it counts as the first.  Otherwise the buffer
+			 * replacement strategy would see every page read ahead as used
+			 * twice.
+			 */
+			if (!hit)
+			{
+				BufferDesc *bufHdr = GetBufferDescriptor(buffer - 1);
+				uint32		buf_state;
+
+				buf_state = LockBufHdr(bufHdr);
+				buf_state &= ~BUF_USAGECOUNT_MASK;
+				UnlockBufHdr(bufHdr, buf_state);
+			}
+
+			ReleaseBuffer(buffer);
+		}
+	}
+
+	LockRelease(&reltag, AccessShareLock, true);
+	if (OidIsValid(relid->dbId))
+		LockRelease(&dbtag, AccessShareLock, true);
+}
+
+/*
+ * Main entry point for a read-ahead worker.
+ */
+void
+ReadAheadWorkerMain(Datum main_arg)
+{
+	sigjmp_buf	local_sigjmp_buf;
+	MemoryContext readahead_context;
+	bool		files_open = false;
+
+	pqsignal(SIGTERM, die);
+	BackgroundWorkerUnblockSignals();
+
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "read-ahead worker");
+
+	readahead_context = AllocSetContextCreate(TopMemoryContext,
+											  "read-ahead worker",
+											  ALLOCSET_DEFAULT_SIZES);
+	MemoryContextSwitchTo(readahead_context);
+
+	before_shmem_exit(ReadAheadWorkerDetach, (Datum) 0);
+
+	/*
+	 * If an exception is encountered, processing resumes here.  A failed
+	 * read only costs the requests being processed.
+	 */
+	if (sigsetjmp(local_sigjmp_buf, 1) != 0)
+	{
+		/* Since not using PG_TRY, must reset error stack by hand */
+		error_context_stack = NULL;
+
+		/* Prevent interrupts while cleaning up */
+		HOLD_INTERRUPTS();
+
+		/* Report the error to the server log */
+		EmitErrorReport();
+
+		/* Release the buffers and locks of the batch we were working on */
+		LWLockReleaseAll();
+		AbortBufferIO();
+		UnlockBuffers();
+		ResourceOwnerRelease(CurrentResourceOwner,
+							 RESOURCE_RELEASE_BEFORE_LOCKS,
+							 false, true);
+		LockReleaseAll(DEFAULT_LOCKMETHOD, true);
+		AtEOXact_Buffers(false);
+		AtEOXact_SMgr();
+		AtEOXact_Files(false);
+
+		/*
+		 * Now return to normal top-level context and clear ErrorContext for
+		 * next time.
+		 */
+		MemoryContextSwitchTo(readahead_context);
+		FlushErrorState();
+		MemoryContextResetAndDeleteChildren(readahead_context);
+
+		/* Now we can allow interrupts again */
+		RESUME_INTERRUPTS();
+
+		smgrcloseall();
+		files_open = false;
+
+		/* We might still be on the sleepers stack */
+		ReadAheadWake();
+	}
+
+	/* We can now handle ereport(ERROR) */
+	PG_exception_stack = &local_sigjmp_buf;
+
+	for (;;)
+	{
+		ReadAheadRequest reqs[READAHEAD_BATCH_SIZE];
+		int			nreqs;
+		int			i;
+		int			rc;
+
+		CHECK_FOR_INTERRUPTS();
+
+		nreqs = ReadAheadDequeue(reqs, READAHEAD_BATCH_SIZE);
+		if (nreqs > 0)
+		{
+			/* Process runs of requests for the same relation fork together */
+			for (i = 0; i < nreqs;)
+			{
+				int			j = i + 1;
+
+				while (j < nreqs &&
+					   reqs[j].lockRelId.relId == reqs[i].lockRelId.relId &&
+					   reqs[j].lockRelId.dbId == reqs[i].lockRelId.dbId &&
+					   RelFileNodeEquals(reqs[j].tag.rnode, reqs[i].tag.rnode) &&
+					   reqs[j].tag.forkNum == reqs[i].tag.forkNum)
+					j++;
+				ReadAheadRelation(&reqs[i], j - i);
+				i = j;
+			}
+			files_open = true;
+			continue;
+		}
+
+		/*
+		 * Nothing to do, so sleep until a request wakes us.  The first time
+		 * round, wake up after a while to close the files we opened.
+		 */
+		rc = WaitLatch(MyLatch,
+					   WL_LATCH_SET | WL_POSTMASTER_DEATH |
+					   (files_open ? WL_TIMEOUT : 0),
+					   READAHEAD_IDLE_CLOSE_TIMEOUT,
+					   WAIT_EVENT_READAHEAD_WORKER_MAIN);
+		if (rc & WL_POSTMASTER_DEATH)
+			proc_exit(1);
+		ResetLatch(MyLatch);
+		ReadAheadWake();
+
+		if (rc & WL_TIMEOUT)
+		{
+			smgrcloseall();
+			files_open = false;
+		}
+	}
+}
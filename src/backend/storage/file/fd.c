@@ -132,6 +132,12 @@
  */
 int			max_files_per_process = 1000;
 
+/*
+ * Which kinds of files to open with O_DIRECT, bypassing the kernel's page
+ * cache; see md.c and xlog.c.  Set from the io_direct GUC.
+ */
+int			io_direct_flags = 0;
+
 /*
  * Maximum number of file descriptors to open for either VFD entries or
  * AllocateFile/AllocateDir/OpenTransientFile operations.  This is initialized
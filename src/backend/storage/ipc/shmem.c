@@ -66,13 +66,20 @@
 #include "postgres.h"
 
 #include "access/transam.h"
+#include "fmgr.h"
+#include "funcapi.h"
 #include "miscadmin.h"
 #include "storage/lwlock.h"
 #include "storage/pg_shmem.h"
 #include "storage/shmem.h"
 #include "storage/spin.h"
+#include "utils/builtins.h"
+#include "utils/tuplestore.h"
 
 
+/* highest number of NUMA nodes pg_get_shmem_numa reports on */
+#define SHMEM_NUMA_MAX_NODES	1024
+
 /* shared memory global variables */
 
 static PGShmemHeader *ShmemSegHdr;	/* shared mem segment header */
@@ -503,3 +510,76 @@ mul_size(Size s1, Size s2)
 				 errmsg("requested shared memory size overflows size_t")));
 	return result;
 }
+
+/*
+ * SQL SRF showing how much of the main shared memory segment resides on each
+ * NUMA node, and how much has not been backed by memory yet (node NULL).
+ * This shows whether numa_interleave took effect.
+ */
+Datum
+pg_get_shmem_numa(PG_FUNCTION_ARGS)
+{
+#define PG_GET_SHMEM_NUMA_COLS	2
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	Size	   *sizes;
+	Size		unallocated;
+	Datum		values[PG_GET_SHMEM_NUMA_COLS];
+	bool		nulls[PG_GET_SHMEM_NUMA_COLS];
+	int			i;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not " \
+						"allowed in this context")));
+
+	sizes = palloc(SHMEM_NUMA_MAX_NODES * sizeof(Size));
+	if (!PGSharedMemoryNumaUsage(sizes, SHMEM_NUMA_MAX_NODES, &unallocated))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("NUMA placement of shared memory cannot be determined on this platform")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	memset(nulls, 0, sizeof(nulls));
+	for (i = 0; i < SHMEM_NUMA_MAX_NODES; i++)
+	{
+		if (sizes[i] == 0)
+			continue;
+		values[0] = Int32GetDatum(i);
+		values[1] = Int64GetDatum((int64) sizes[i]);
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	if (unallocated > 0)
+	{
+		nulls[0] = true;
+		values[1] = Int64GetDatum((int64) unallocated);
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
@@ -1353,6 +1353,20 @@ LockCheckConflicts(LockMethod lockMethodTable,
 		return STATUS_FOUND;
 	}
 
+	/*
+	 * Relation extension and page locks protect physical structures rather
+	 * than anything the group could share, so they conflict even between
+	 * members of a locking group.  Otherwise parallel workers inserting into
+	 * the same relation could extend it at the same time.
+	 */
+	if (lock->tag.locktag_type == LOCKTAG_RELATION_EXTEND ||
+		lock->tag.locktag_type == LOCKTAG_PAGE)
+	{
+		PROCLOCK_PRINT("LockCheckConflicts: conflicting (group)",
+					   proclock);
+		return STATUS_FOUND;
+	}
+
 	/*
 	 * Locks held in conflicting modes by members of our own lock group are
 	 * not real conflicts; we can subtract those out and see if we still have
@@ -521,6 +521,10 @@ RegisterLWLockTranches(void)
 	LWLockRegisterTranche(LWTRANCHE_TBM, "tbm");
 	LWLockRegisterTranche(LWTRANCHE_PARALLEL_APPEND, "parallel_append");
 	LWLockRegisterTranche(LWTRANCHE_PARALLEL_HASH_JOIN, "parallel_hash_join");
+	LWLockRegisterTranche(LWTRANCHE_PARALLEL_TUPLE_HASH,
+						  "parallel_tuple_hash");
+	LWLockRegisterTranche(LWTRANCHE_PARALLEL_COPY_DSA,
+						  "parallel_copy_dsa");
 
 	/* Register named tranches. */
 	for (i = 0; i < NamedLWLockTrancheRequests; i++)
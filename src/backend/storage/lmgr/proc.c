@@ -35,6 +35,7 @@
 #include <unistd.h>
 #include <sys/time.h>
 
+#include "access/parallelredo.h"
 #include "access/transam.h"
 #include "access/twophase.h"
 #include "access/xact.h"
@@ -182,7 +183,8 @@ InitProcGlobal(void)
 	ProcGlobal->bgworkerFreeProcs = NULL;
 	ProcGlobal->startupProc = NULL;
 	ProcGlobal->startupProcPid = 0;
-	ProcGlobal->startupBufferPinWaitBufId = -1;
+	for (i = 0; i < NUM_STARTUP_PIN_WAITERS; i++)
+		ProcGlobal->startupBufferPinWaitBufId[i] = -1;
 	ProcGlobal->walwriterLatch = NULL;
 	ProcGlobal->checkpointerLatch = NULL;
 	pg_atomic_init_u32(&ProcGlobal->procArrayGroupFirst, INVALID_PGPROCNO);
@@ -615,6 +617,9 @@ PublishStartupProcessInformation(void)
  * of recovery conflicts for buffer pins. Set is made before backends look
  * at this value, so locking not required, especially since the set is
  * an atomic integer set operation.
+ *
+ * Parallel redo workers wait for pins too; each one publishes its bufid in
+ * its own slot, after the Startup process's slot 0.
  */
 void
 SetStartupBufferPinWaitBufId(int bufid)
@@ -622,19 +627,22 @@ SetStartupBufferPinWaitBufId(int bufid)
 	/* use volatile pointer to prevent code rearrangement */
 	volatile PROC_HDR *procglobal = ProcGlobal;
 
-	procglobal->startupBufferPinWaitBufId = bufid;
+	procglobal->startupBufferPinWaitBufId[ParallelRedoWorkerNumber + 1] = bufid;
 }
 
 /*
  * Used by backends when they receive a request to check for buffer pin waits.
+ * The caller checks each of the NUM_STARTUP_PIN_WAITERS slots.
  */
 int
-GetStartupBufferPinWaitBufId(void)
+GetStartupBufferPinWaitBufId(int slot)
 {
 	/* use volatile pointer to prevent code rearrangement */
 	volatile PROC_HDR *procglobal = ProcGlobal;
 
-	return procglobal->startupBufferPinWaitBufId;
+	Assert(slot >= 0 && slot < NUM_STARTUP_PIN_WAITERS);
+
+	return procglobal->startupBufferPinWaitBufId[slot];
 }
 
 /*
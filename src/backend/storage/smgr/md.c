@@ -114,6 +114,15 @@ typedef struct _MdfdVec
 
 static MemoryContext MdCxt;		/* context for all MdfdVec objects */
 
+/*
+ * With io_direct = data, permanent relations are opened with O_DIRECT, and
+ * the kernel then requires the memory we read into or write from to be
+ * aligned.  Shared buffers always are, but other callers (index builds,
+ * relation copies and so on) pass pages of their own; we bounce those
+ * through this suitably aligned block.
+ */
+static char *md_io_bounce_buffer = NULL;
+
 
 /*
  * In some contexts (currently, standalone backends and the checkpointer)
@@ -197,6 +206,8 @@ static MdfdVec *_mdfd_getseg(SMgrRelation reln, ForkNumber forkno,
 			 BlockNumber blkno, bool skipFsync, int behavior);
 static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum,
 		   MdfdVec *seg);
+static int	_mdfd_open_flags(SMgrRelation reln);
+static char *_mdfd_io_buffer(SMgrRelation reln, char *buffer);
 
 
 /*
@@ -209,6 +220,15 @@ mdinit(void)
 								  "MdSmgr",
 								  ALLOCSET_DEFAULT_SIZES);
 
+	/*
+	 * Set up the bounce buffer now, rather than on first use, since we might
+	 * be asked to write a page inside a critical section.
+	 */
+	if (io_direct_flags & IO_DIRECT_DATA)
+		md_io_bounce_buffer = (char *)
+			TYPEALIGN(PG_IO_ALIGN_SIZE,
+					  MemoryContextAlloc(MdCxt, BLCKSZ + PG_IO_ALIGN_SIZE));
+
 	/*
 	 * Create pending-operations hashtable if we need it.  Currently, we need
 	 * it if we are standalone (not under a postmaster) or if we are a startup
@@ -304,7 +324,8 @@ mdcreate(SMgrRelation reln, ForkNumber forkNum, bool isRedo)
 
 	path = relpath(reln->smgr_rnode, forkNum);
 
-	fd = PathNameOpenFile(path, O_RDWR | O_CREAT | O_EXCL | PG_BINARY);
+	fd = PathNameOpenFile(path,
+						  _mdfd_open_flags(reln) | O_CREAT | O_EXCL);
 
 	if (fd < 0)
 	{
@@ -317,7 +338,7 @@ mdcreate(SMgrRelation reln, ForkNumber forkNum, bool isRedo)
 		 * already, even if isRedo is not set.  (See also mdopen)
 		 */
 		if (isRedo || IsBootstrapProcessingMode())
-			fd = PathNameOpenFile(path, O_RDWR | PG_BINARY);
+			fd = PathNameOpenFile(path, _mdfd_open_flags(reln));
 		if (fd < 0)
 		{
 			/* be sure to report the error reported by create, not open */
@@ -498,6 +519,7 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	off_t		seekpos;
 	int			nbytes;
 	MdfdVec    *v;
+	char	   *iobuf;
 
 	/* This assert is too expensive to have on normally ... */
 #ifdef CHECK_WRITE_VS_EXTEND
@@ -537,7 +559,11 @@ mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errmsg("could not seek to block %u in file \"%s\": %m",
 						blocknum, FilePathName(v->mdfd_vfd))));
 
-	if ((nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ, WAIT_EVENT_DATA_FILE_EXTEND)) != BLCKSZ)
+	iobuf = _mdfd_io_buffer(reln, buffer);
+	if (iobuf != buffer)
+		memcpy(iobuf, buffer, BLCKSZ);
+
+	if ((nbytes = FileWrite(v->mdfd_vfd, iobuf, BLCKSZ, WAIT_EVENT_DATA_FILE_EXTEND)) != BLCKSZ)
 	{
 		if (nbytes < 0)
 			ereport(ERROR,
@@ -583,7 +609,7 @@ mdopen(SMgrRelation reln, ForkNumber forknum, int behavior)
 
 	path = relpath(reln->smgr_rnode, forknum);
 
-	fd = PathNameOpenFile(path, O_RDWR | PG_BINARY);
+	fd = PathNameOpenFile(path, _mdfd_open_flags(reln));
 
 	if (fd < 0)
 	{
@@ -594,7 +620,8 @@ mdopen(SMgrRelation reln, ForkNumber forknum, int behavior)
 		 * substitute for mdcreate() in bootstrap mode only. (See mdcreate)
 		 */
 		if (IsBootstrapProcessingMode())
-			fd = PathNameOpenFile(path, O_RDWR | O_CREAT | O_EXCL | PG_BINARY);
+			fd = PathNameOpenFile(path,
+								  _mdfd_open_flags(reln) | O_CREAT | O_EXCL);
 		if (fd < 0)
 		{
 			if ((behavior & EXTENSION_RETURN_NULL) &&
@@ -734,6 +761,7 @@ mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	off_t		seekpos;
 	int			nbytes;
 	MdfdVec    *v;
+	char	   *iobuf;
 
 	TRACE_POSTGRESQL_SMGR_MD_READ_START(forknum, blocknum,
 										reln->smgr_rnode.node.spcNode,
@@ -754,7 +782,12 @@ mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errmsg("could not seek to block %u in file \"%s\": %m",
 						blocknum, FilePathName(v->mdfd_vfd))));
 
-	nbytes = FileRead(v->mdfd_vfd, buffer, BLCKSZ, WAIT_EVENT_DATA_FILE_READ);
+	iobuf = _mdfd_io_buffer(reln, buffer);
+
+	nbytes = FileRead(v->mdfd_vfd, iobuf, BLCKSZ, WAIT_EVENT_DATA_FILE_READ);
+
+	if (iobuf != buffer && nbytes > 0)
+		memcpy(buffer, iobuf, nbytes);
 
 	TRACE_POSTGRESQL_SMGR_MD_READ_DONE(forknum, blocknum,
 									   reln->smgr_rnode.node.spcNode,
@@ -805,6 +838,7 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	off_t		seekpos;
 	int			nbytes;
 	MdfdVec    *v;
+	char	   *iobuf;
 
 	/* This assert is too expensive to have on normally ... */
 #ifdef CHECK_WRITE_VS_EXTEND
@@ -830,7 +864,11 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				 errmsg("could not seek to block %u in file \"%s\": %m",
 						blocknum, FilePathName(v->mdfd_vfd))));
 
-	nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ, WAIT_EVENT_DATA_FILE_WRITE);
+	iobuf = _mdfd_io_buffer(reln, buffer);
+	if (iobuf != buffer)
+		memcpy(iobuf, buffer, BLCKSZ);
+
+	nbytes = FileWrite(v->mdfd_vfd, iobuf, BLCKSZ, WAIT_EVENT_DATA_FILE_WRITE);
 
 	TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(forknum, blocknum,
 										reln->smgr_rnode.node.spcNode,
@@ -1802,6 +1840,38 @@ _mdfd_segpath(SMgrRelation reln, ForkNumber forknum, BlockNumber segno)
 	return fullpath;
 }
 
+/*
+ * Flags for opening a segment of the relation.  With io_direct = data,
+ * permanent relations bypass the kernel's page cache; temporary relations
+ * live in local buffers, which aren't aligned and are small enough that the
+ * page cache is welcome to them.
+ */
+static int
+_mdfd_open_flags(SMgrRelation reln)
+{
+	int			flags = O_RDWR | PG_BINARY;
+
+	if ((io_direct_flags & IO_DIRECT_DATA) && !SmgrIsTemp(reln))
+		flags |= PG_O_DIRECT;
+
+	return flags;
+}
+
+/*
+ * Return the memory to hand to the kernel for reading or writing "buffer":
+ * the buffer itself, or the bounce buffer if it isn't aligned well enough
+ * for a file opened with O_DIRECT.  The caller copies data as needed.
+ */
+static char *
+_mdfd_io_buffer(SMgrRelation reln, char *buffer)
+{
+	if (md_io_bounce_buffer == NULL || SmgrIsTemp(reln) ||
+		(uintptr_t) buffer % PG_IO_ALIGN_SIZE == 0)
+		return buffer;
+
+	return md_io_bounce_buffer;
+}
+
 /*
  * Open the specified segment of the relation,
  * and make a MdfdVec object for it.  Returns NULL on failure.
@@ -1817,7 +1887,7 @@ _mdfd_openseg(SMgrRelation reln, ForkNumber forknum, BlockNumber segno,
 	fullpath = _mdfd_segpath(reln, forknum, segno);
 
 	/* open the file */
-	fd = PathNameOpenFile(fullpath, O_RDWR | PG_BINARY | oflags);
+	fd = PathNameOpenFile(fullpath, _mdfd_open_flags(reln) | oflags);
 
 	pfree(fullpath);
 
@@ -14,7 +14,10 @@
  */
 #include "postgres.h"
 
+#include <math.h>
+
 #include "access/htup_details.h"
+#include "access/xlog.h"
 #include "catalog/pg_authid.h"
 #include "catalog/pg_type.h"
 #include "common/ip.h"
@@ -1882,3 +1885,82 @@ pg_stat_get_archiver(PG_FUNCTION_ARGS)
 	PG_RETURN_DATUM(HeapTupleGetDatum(
 									  heap_form_tuple(tupdesc, values, nulls)));
 }
+
+/*
+ * Estimate the given fraction's quantile of WAL flush wait times, in
+ * milliseconds, as the upper bound of the histogram bucket it falls in.
+ */
+static double
+flush_wait_quantile(XLogFlushStats *stats, double fraction)
+{
+	uint64		target = (uint64) ceil(stats->flush_waits * fraction);
+	uint64		seen = 0;
+	int			i;
+
+	for (i = 0; i < XLOG_FLUSH_WAIT_BUCKETS - 1; i++)
+	{
+		seen += stats->flush_wait_hist[i];
+		if (seen >= target)
+			break;
+	}
+
+	return (double) (UINT64CONST(2) << i) / 1000.0;
+}
+
+Datum
+pg_stat_get_wal_flush(PG_FUNCTION_ARGS)
+{
+	TupleDesc	tupdesc;
+	Datum		values[7];
+	bool		nulls[7];
+	XLogFlushStats stats;
+
+	/* Initialise values and NULL flags arrays */
+	MemSet(values, 0, sizeof(values));
+	MemSet(nulls, 0, sizeof(nulls));
+
+	/* Initialise attributes information in the tuple descriptor */
+	tupdesc = CreateTemplateTupleDesc(7, false);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 1, "flushes",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 2, "flush_time",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 3, "flush_waits",
+					   INT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 4, "flush_wait_time",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 5, "flush_wait_p50",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 6, "flush_wait_p99",
+					   FLOAT8OID, -1, 0);
+	TupleDescInitEntry(tupdesc, (AttrNumber) 7, "commit_delay",
+					   FLOAT8OID, -1, 0);
+
+	BlessTupleDesc(tupdesc);
+
+	/* Get statistics about WAL flushes */
+	GetXLogFlushStats(&stats);
+
+	/* Fill values and NULLs; times are shown in milliseconds */
+	values[0] = Int64GetDatum(stats.flushes);
+	values[1] = Float8GetDatum(stats.flush_time / 1000.0);
+	values[2] = Int64GetDatum(stats.flush_waits);
+	values[3] = Float8GetDatum(stats.flush_wait_time / 1000.0);
+
+	if (stats.flush_waits == 0)
+	{
+		nulls[4] = true;
+		nulls[5] = true;
+	}
+	else
+	{
+		values[4] = Float8GetDatum(flush_wait_quantile(&stats, 0.5));
+		values[5] = Float8GetDatum(flush_wait_quantile(&stats, 0.99));
+	}
+
+	values[6] = Float8GetDatum(stats.commit_delay / 1000.0);
+
+	/* Returns the record as Datum */
+	PG_RETURN_DATUM(HeapTupleGetDatum(
+									  heap_form_tuple(tupdesc, values, nulls)));
+}
@@ -36,6 +36,7 @@
 #include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/sysattr.h"
+#include "access/tableam.h"
 #include "access/tupdesc_details.h"
 #include "access/xact.h"
 #include "access/xlog.h"
@@ -270,6 +271,7 @@ static void RelationParseRelOptions(Relation relation, HeapTuple tuple);
 static void RelationBuildTupleDesc(Relation relation);
 static Relation RelationBuildDesc(Oid targetRelId, bool insertIt);
 static void RelationInitPhysicalAddr(Relation relation);
+static void RelationInitTableAccessMethod(Relation relation);
 static void load_critical_index(Oid indexoid, Oid heapoid);
 static TupleDesc GetPgClassDescriptor(void);
 static TupleDesc GetPgIndexDescriptor(void);
@@ -1201,7 +1203,8 @@ RelationBuildDesc(Oid targetRelId, bool insertIt)
 	/*
 	 * if it's an index, initialize index-related information
 	 */
-	if (OidIsValid(relation->rd_rel->relam))
+	if (relation->rd_rel->relkind == RELKIND_INDEX ||
+		relation->rd_rel->relkind == RELKIND_PARTITIONED_INDEX)
 		RelationInitIndexAccessInfo(relation);
 
 	/* extract reloptions if any */
@@ -1217,6 +1220,9 @@ RelationBuildDesc(Oid targetRelId, bool insertIt)
 	 */
 	RelationInitPhysicalAddr(relation);
 
+	/* set up the table access method, if it's a table */
+	RelationInitTableAccessMethod(relation);
+
 	/* make sure relation is marked as having no open file yet */
 	relation->rd_smgr = NULL;
 
@@ -1311,6 +1317,49 @@ RelationInitPhysicalAddr(Relation relation)
 	}
 }
 
+/*
+ * Set up the table access method of a relation with table storage.
+ *
+ * Sequences have no relam and are stored as heaps.  We call heap's handler
+ * without looking at pg_am, which keeps this working for the system
+ * catalogs while bootstrapping and when loading the relcache init file.
+ */
+static void
+RelationInitTableAccessMethod(Relation relation)
+{
+	switch (relation->rd_rel->relkind)
+	{
+		case RELKIND_RELATION:
+		case RELKIND_TOASTVALUE:
+		case RELKIND_MATVIEW:
+		case RELKIND_SEQUENCE:
+			break;
+		default:
+			relation->rd_tableam = NULL;
+			return;
+	}
+
+	if (!OidIsValid(relation->rd_rel->relam) ||
+		relation->rd_rel->relam == HEAP_TABLE_AM_OID)
+		relation->rd_amhandler = F_HEAP_TABLEAM_HANDLER;
+	else
+	{
+		HeapTuple	tuple;
+		Form_pg_am	aform;
+
+		tuple = SearchSysCache1(AMOID,
+								ObjectIdGetDatum(relation->rd_rel->relam));
+		if (!HeapTupleIsValid(tuple))
+			elog(ERROR, "cache lookup failed for access method %u",
+				 relation->rd_rel->relam);
+		aform = (Form_pg_am) GETSTRUCT(tuple);
+		relation->rd_amhandler = aform->amhandler;
+		ReleaseSysCache(tuple);
+	}
+
+	relation->rd_tableam = GetTableAmRoutine(relation->rd_amhandler);
+}
+
 /*
  * Fill in the IndexAmRoutine for an index relation.
  *
@@ -1789,6 +1838,7 @@ formrdesc(const char *relationName, Oid relationReltype,
 	relation->rd_rel->reltuples = 0;
 	relation->rd_rel->relallvisible = 0;
 	relation->rd_rel->relkind = RELKIND_RELATION;
+	relation->rd_rel->relam = HEAP_TABLE_AM_OID;
 	relation->rd_rel->relhasoids = hasoids;
 	relation->rd_rel->relnatts = (int16) natts;
 
@@ -1858,6 +1908,11 @@ formrdesc(const char *relationName, Oid relationReltype,
 	 */
 	RelationInitPhysicalAddr(relation);
 
+	/*
+	 * initialize the table access method; all formrdesc rels are heaps
+	 */
+	RelationInitTableAccessMethod(relation);
+
 	/*
 	 * initialize the rel-has-index flag, using hardwired knowledge
 	 */
@@ -3095,6 +3150,7 @@ RelationBuildLocalRelation(const char *relname,
 						   Oid relnamespace,
 						   TupleDesc tupDesc,
 						   Oid relid,
+						   Oid accessmtd,
 						   Oid relfilenode,
 						   Oid reltablespace,
 						   bool shared_relation,
@@ -3261,6 +3317,7 @@ RelationBuildLocalRelation(const char *relname,
 		TupleDescAttr(rel->rd_att, i)->attrelid = relid;
 
 	rel->rd_rel->reltablespace = reltablespace;
+	rel->rd_rel->relam = accessmtd;
 
 	if (mapped_relation)
 	{
@@ -3275,6 +3332,8 @@ RelationBuildLocalRelation(const char *relname,
 
 	RelationInitPhysicalAddr(rel);
 
+	RelationInitTableAccessMethod(rel);
+
 	/*
 	 * Okay to insert into the relcache hash table.
 	 *
@@ -5692,6 +5751,7 @@ load_relcache_init_file(bool shared)
 		 */
 		RelationInitLockInfo(rel);
 		RelationInitPhysicalAddr(rel);
+		RelationInitTableAccessMethod(rel);
 	}
 
 	/*
@@ -2342,6 +2342,68 @@ tuplesort_skiptuples(Tuplesortstate *state, int64 ntuples, bool forward)
 	}
 }
 
+/*
+ * Advance over the tuples that don't satisfy 'pred', so that the next tuple
+ * fetched forward is the first one that does.
+ *
+ * The caller guarantees that once a tuple satisfies pred, so do all the
+ * tuples sorted after it; pred is handed the stored tuple (a MinimalTuple for
+ * heap tuple sorts) and 'arg'.  We can then gallop ahead with exponentially
+ * growing steps and binary search the last one, which only takes a
+ * logarithmic number of calls to pred.  That only works when the sort was
+ * done in memory; otherwise we return false without doing anything, and the
+ * caller has to read its way forward.
+ */
+bool
+tuplesort_skipto(Tuplesortstate *state, TuplesortSkipPredicate pred,
+				 void *arg)
+{
+	int			lo;
+	int			hi;
+	int64		step;
+
+	Assert(!WORKER(state));
+
+	if (state->status != TSS_SORTEDINMEM)
+		return false;
+
+	/*
+	 * Invariant: the tuples before lo don't satisfy pred, and the one at hi
+	 * (if hi isn't past the end) does.  First probe ever farther tuples to
+	 * find such an hi.
+	 */
+	lo = state->current;
+	hi = state->memtupcount;
+	for (step = 1; lo < state->memtupcount; step *= 2)
+	{
+		int64		probe = lo + step - 1;
+
+		if (probe >= state->memtupcount)
+			break;
+		if (pred(state->memtuples[probe].tuple, arg))
+		{
+			hi = (int) probe;
+			break;
+		}
+		lo = (int) probe + 1;
+	}
+
+	/* Then narrow down the range in between */
+	while (lo < hi)
+	{
+		int			mid = lo + (hi - lo) / 2;
+
+		if (pred(state->memtuples[mid].tuple, arg))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	state->current = lo;
+
+	return true;
+}
+
 /*
  * tuplesort_merge_order - report merge order we'll use for given memory
  * (note: "merge order" just means the number of input tapes in the merge).
@@ -4410,6 +4472,30 @@ tuplesort_attach_shared(Sharedsort *shared, dsm_segment *seg)
 	SharedFileSetAttach(&shared->fileset, seg);
 }
 
+/*
+ * tuplesort_reset_shared - reset shared tuplesort state for another sort
+ *
+ * Must be called from leader process, after all participant tuplesortstates
+ * from the previous sort have been ended and before workers are launched
+ * again.  Temporary files left behind by the previous sort are removed.
+ */
+void
+tuplesort_reset_shared(Sharedsort *shared)
+{
+	int			i;
+
+	SharedFileSetDeleteAll(&shared->fileset);
+
+	SpinLockAcquire(&shared->mutex);
+	shared->currentWorker = 0;
+	shared->workersFinished = 0;
+	for (i = 0; i < shared->nTapes; i++)
+	{
+		shared->tapes[i].firstblocknumber = 0L;
+	}
+	SpinLockRelease(&shared->mutex);
+}
+
 /*
  * worker_get_identifier - Assign and return ordinal identifier for worker
  *
@@ -3140,6 +3140,9 @@ _doSetFixedOutputState(ArchiveHandle *AH)
 	/* Make sure function checking is disabled */
 	ahprintf(AH, "SET check_function_bodies = false;\n");
 
+	/* Tables dumped without a USING clause are heap tables */
+	ahprintf(AH, "SET default_table_access_method = heap;\n");
+
 	/* Avoid annoying notices etc */
 	ahprintf(AH, "SET client_min_messages = warning;\n");
 	if (!AH->public.std_strings)
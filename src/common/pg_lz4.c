@@ -0,0 +1,325 @@
+/* ----------
+ * pg_lz4.c -
+ *
+ *		This is an implementation of the LZ4 block format for PostgreSQL.
+ *		It trades some compression ratio for speed compared to pglz: it
+ *		looks for matches through a single hash table probe, without any
+ *		history chains, and decompresses with plain memory copies.  The
+ *		output can be read by any LZ4 block decoder, and vice versa, but
+ *		no code is shared with the LZ4 library, so it's always available.
+ *
+ *		Entry routines:
+ *
+ *			int32
+ *			pg_lz4_compress(const char *source, int32 slen, char *dest);
+ *
+ *				source is the input data to be compressed.
+ *
+ *				slen is the length of the input data.
+ *
+ *				dest is the output area for the compressed result.
+ *					It must be at least as big as PG_LZ4_MAX_OUTPUT(slen).
+ *
+ *				The return value is the number of bytes written in the
+ *				buffer dest.  It can be larger than slen if the input is
+ *				incompressible; it's up to the caller to decide whether
+ *				the result is worth keeping.
+ *
+ *			int32
+ *			pg_lz4_decompress(const char *source, int32 slen, char *dest,
+ *							  int32 rawsize);
+ *
+ *				source is the compressed input.
+ *
+ *				slen is the length of the compressed input.
+ *
+ *				dest is the area where the uncompressed data will be
+ *					written to. It is the callers responsibility to
+ *					provide enough space.
+ *
+ *				rawsize is the length of the uncompressed data.
+ *
+ *				The return value is the number of bytes written in the
+ *				buffer dest, or -1 if decompression fails.  All accesses
+ *				are bounds-checked, so corrupt input can't cause reads or
+ *				writes outside the given buffers.
+ *
+ *		The block format:
+ *
+ *			The compressed data is a series of sequences.  Each sequence
+ *			starts with a token byte: the high four bits are the number
+ *			of literal bytes that follow, the low four bits the length of
+ *			the match after them minus 4.  A nibble of 15 means the length
+ *			continues in following bytes, each adding its value, until a
+ *			byte less than 255.  The literal length bytes come before the
+ *			literals, then a two-byte little-endian match offset, then
+ *			the match length bytes.  The last sequence has literals only.
+ *
+ *			Decoders may assume the last 5 bytes are literals, and that
+ *			the last match starts at least 12 bytes before the end, so
+ *			the compressor stops looking for matches near the end.
+ *
+ * Copyright (c) 2018, PostgreSQL Global Development Group
+ *
+ * src/common/pg_lz4.c
+ * ----------
+ */
+#ifndef FRONTEND
+#include "postgres.h"
+#else
+#include "postgres_fe.h"
+#endif
+
+#include "common/pg_lz4.h"
+
+
+/* ----------
+ * Local definitions
+ * ----------
+ */
+#define LZ4_MIN_MATCH			4
+#define LZ4_LAST_LITERALS		5	/* last bytes that must be literals */
+#define LZ4_MF_LIMIT			12	/* no match may start after this */
+#define LZ4_MAX_DISTANCE		65535
+#define LZ4_HASH_LOG			12
+#define LZ4_HASH_SIZE			(1 << LZ4_HASH_LOG)
+#define LZ4_SKIP_TRIGGER		6	/* speed up after 2^this misses */
+#define LZ4_RUN_MASK			15
+
+
+static inline uint32
+lz4_read32(const unsigned char *p)
+{
+	uint32		v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32
+lz4_hash(uint32 seq)
+{
+	return (seq * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+/*
+ * Append a length that doesn't fit in a token nibble.  'len' is what remains
+ * after subtracting the nibble's 15.
+ */
+static inline unsigned char *
+lz4_write_length(unsigned char *op, int32 len)
+{
+	while (len >= 255)
+	{
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = (unsigned char) len;
+	return op;
+}
+
+/* ----------
+ * pg_lz4_compress -
+ *
+ *		Compresses source into dest. Returns the number of bytes written
+ *		in buffer dest.
+ * ----------
+ */
+int32
+pg_lz4_compress(const char *source, int32 slen, char *dest)
+{
+	const unsigned char *src = (const unsigned char *) source;
+	const unsigned char *iend = src + slen;
+	const unsigned char *ip = src;
+	const unsigned char *anchor = src;
+	unsigned char *op = (unsigned char *) dest;
+	unsigned char *token;
+	int32		litlen;
+
+	if (slen > LZ4_MF_LIMIT)
+	{
+		const unsigned char *mflimit = iend - LZ4_MF_LIMIT;
+		const unsigned char *matchlimit = iend - LZ4_LAST_LITERALS;
+		int32		hashtable[LZ4_HASH_SIZE];
+		int32		misses = 0;
+
+		/*
+		 * Entries hold positions in the input.  Stale or unset entries are
+		 * harmless, since every candidate is verified before use.
+		 */
+		memset(hashtable, 0, sizeof(hashtable));
+		ip++;
+
+		while (ip < mflimit)
+		{
+			uint32		seq = lz4_read32(ip);
+			uint32		h = lz4_hash(seq);
+			const unsigned char *ref = src + hashtable[h];
+			int32		matchlen;
+			int32		offset;
+
+			hashtable[h] = (int32) (ip - src);
+
+			if (ip - ref > LZ4_MAX_DISTANCE || lz4_read32(ref) != seq)
+			{
+				/* skip ahead faster through incompressible data */
+				ip += 1 + (misses++ >> LZ4_SKIP_TRIGGER);
+				continue;
+			}
+			misses = 0;
+
+			/* extend the match backwards over pending literals */
+			while (ip > anchor && ref > src && ip[-1] == ref[-1])
+			{
+				ip--;
+				ref--;
+			}
+
+			/* and forwards */
+			matchlen = LZ4_MIN_MATCH;
+			while (ip + matchlen < matchlimit && ip[matchlen] == ref[matchlen])
+				matchlen++;
+
+			/* emit the sequence: token, literals, offset, match length */
+			litlen = (int32) (ip - anchor);
+			token = op++;
+			if (litlen >= LZ4_RUN_MASK)
+			{
+				*token = LZ4_RUN_MASK << 4;
+				op = lz4_write_length(op, litlen - LZ4_RUN_MASK);
+			}
+			else
+				*token = (unsigned char) (litlen << 4);
+			memcpy(op, anchor, litlen);
+			op += litlen;
+
+			offset = (int32) (ip - ref);
+			*op++ = (unsigned char) (offset & 0xFF);
+			*op++ = (unsigned char) (offset >> 8);
+
+			if (matchlen - LZ4_MIN_MATCH >= LZ4_RUN_MASK)
+			{
+				*token |= LZ4_RUN_MASK;
+				op = lz4_write_length(op, matchlen - LZ4_MIN_MATCH - LZ4_RUN_MASK);
+			}
+			else
+				*token |= (unsigned char) (matchlen - LZ4_MIN_MATCH);
+
+			ip += matchlen;
+			anchor = ip;
+
+			/* remember a position inside the match, helps repetitive data */
+			if (ip < mflimit)
+				hashtable[lz4_hash(lz4_read32(ip - 2))] = (int32) (ip - 2 - src);
+		}
+	}
+
+	/* the remaining input goes out as literals */
+	litlen = (int32) (iend - anchor);
+	token = op++;
+	if (litlen >= LZ4_RUN_MASK)
+	{
+		*token = LZ4_RUN_MASK << 4;
+		op = lz4_write_length(op, litlen - LZ4_RUN_MASK);
+	}
+	else
+		*token = (unsigned char) (litlen << 4);
+	memcpy(op, anchor, litlen);
+	op += litlen;
+
+	return (int32) (op - (unsigned char *) dest);
+}
+
+
+/* ----------
+ * pg_lz4_decompress -
+ *
+ *		Decompresses source into dest. Returns the number of bytes
+ *		decompressed in the destination buffer, or -1 if decompression
+ *		fails.
+ * ----------
+ */
+int32
+pg_lz4_decompress(const char *source, int32 slen, char *dest, int32 rawsize)
+{
+	const unsigned char *ip = (const unsigned char *) source;
+	const unsigned char *iend = ip + slen;
+	unsigned char *op = (unsigned char *) dest;
+	unsigned char *oend = op + rawsize;
+
+	while (ip < iend)
+	{
+		unsigned char token = *ip++;
+		int32		litlen = token >> 4;
+		int32		matchlen = token & LZ4_RUN_MASK;
+		int32		offset;
+		unsigned char b;
+
+		if (litlen == LZ4_RUN_MASK)
+		{
+			do
+			{
+				if (ip >= iend)
+					return -1;
+				b = *ip++;
+				litlen += b;
+			} while (b == 255);
+		}
+
+		if (litlen > iend - ip || litlen > oend - op)
+			return -1;
+		memcpy(op, ip, litlen);
+		op += litlen;
+		ip += litlen;
+
+		/* the last sequence ends after its literals */
+		if (ip >= iend)
+			break;
+
+		if (iend - ip < 2)
+			return -1;
+		offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > op - (unsigned char *) dest)
+			return -1;
+
+		if (matchlen == LZ4_RUN_MASK)
+		{
+			do
+			{
+				if (ip >= iend)
+					return -1;
+				b = *ip++;
+				matchlen += b;
+			} while (b == 255);
+		}
+		matchlen += LZ4_MIN_MATCH;
+
+		if (matchlen > oend - op)
+			return -1;
+
+		/*
+		 * The match may overlap the output it's copying, which is how runs
+		 * are encoded; copy byte by byte in that case.
+		 */
+		if (offset >= matchlen)
+			memcpy(op, op - offset, matchlen);
+		else
+		{
+			unsigned char *ref = op - offset;
+			int32		i;
+
+			for (i = 0; i < matchlen; i++)
+				op[i] = ref[i];
+		}
+		op += matchlen;
+	}
+
+	/*
+	 * Check we decompressed the right amount.
+	 */
+	if (op != oend)
+		return -1;
+
+	return rawsize;
+}
@@ -0,0 +1,36 @@
+/*-------------------------------------------------------------------------
+ *
+ * parallelredo.h
+ *	  Parallel WAL replay on standby servers
+ *
+ * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/parallelredo.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef PARALLELREDO_H
+#define PARALLELREDO_H
+
+#include "access/xlogreader.h"
+
+/* GUC variable */
+extern int	max_redo_workers;
+
+/* index of this redo worker, or -1 if not a redo worker */
+extern int	ParallelRedoWorkerNumber;
+
+extern Size ParallelRedoShmemSize(void);
+extern void ParallelRedoShmemInit(void);
+
+/* in the startup process */
+extern void ParallelRedoStartWorkers(void);
+extern bool ParallelRedoDispatch(XLogReaderState *record);
+extern void ParallelRedoDrain(void);
+extern void ParallelRedoShutdownWorkers(void);
+
+extern void ParallelRedoWorkerMain(Datum main_arg);
+
+#endif							/* PARALLELREDO_H */
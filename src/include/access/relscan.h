@@ -65,6 +65,12 @@ typedef struct HeapScanDescData
 	BufferAccessStrategy rs_strategy;	/* access strategy for reads */
 	bool		rs_syncscan;	/* report location to syncscan logic? */
 
+	/* sequential prefetch state, see heap_prefetch_ahead */
+	int			rs_prefetch_maximum;	/* max pages to prefetch ahead, or 0 */
+	int			rs_prefetch_target; /* current prefetch distance */
+	int			rs_prefetch_ahead;	/* pages prefetched past rs_prefetch_last */
+	BlockNumber rs_prefetch_last;	/* last page read, if going forward */
+
 	/* scan current state */
 	bool		rs_inited;		/* false = scan not init'd yet */
 	HeapTupleData rs_ctup;		/* current tuple in scan, if any */
@@ -0,0 +1,203 @@
+/*-------------------------------------------------------------------------
+ *
+ * tableam.h
+ *	  API for Postgres table access methods.
+ *
+ * The executor reaches a table's storage through the TableAmRoutine that
+ * the relcache attaches to each relation with storage, rather than calling
+ * heapam.c directly.  Tables pick their AM with CREATE TABLE ... USING or
+ * default_table_access_method; the AM's handler function, recorded in
+ * pg_am, returns its TableAmRoutine.
+ *
+ * Only sequential scans, inserts and COPY go through this API so far.
+ * UPDATE, DELETE, row locking, index, bitmap, TID and sample scans, CLUSTER,
+ * VACUUM, ANALYZE and others still call heapam.c on any table, so the
+ * routine a table AM hands out must for now be heap's own; GetTableAmRoutine
+ * insists on that.  The scan descriptors exchanged through this API are
+ * HeapScanDescs.
+ *
+ * Copyright (c) 2018, PostgreSQL Global Development Group
+ *
+ * src/include/access/tableam.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef TABLEAM_H
+#define TABLEAM_H
+
+#include "access/heapam.h"
+#include "access/relscan.h"
+#include "utils/guc.h"
+#include "utils/rel.h"
+
+
+#define DEFAULT_TABLE_ACCESS_METHOD	"heap"
+
+/* GUCs */
+extern char *default_table_access_method;
+
+
+/*
+ * Callback function signatures.
+ */
+
+/* parallel scan support */
+typedef Size (*parallelscan_estimate_function) (Snapshot snapshot);
+typedef void (*parallelscan_initialize_function) (ParallelHeapScanDesc pscan,
+												  Relation relation,
+												  Snapshot snapshot);
+typedef void (*parallelscan_reinitialize_function) (ParallelHeapScanDesc pscan);
+typedef BlockNumber (*parallelscan_remaining_function) (ParallelHeapScanDesc pscan);
+
+/* sequential scans */
+typedef HeapScanDesc (*scan_begin_function) (Relation relation,
+											 Snapshot snapshot,
+											 int nkeys, ScanKey key);
+typedef HeapScanDesc (*scan_begin_parallel_function) (Relation relation,
+													  ParallelHeapScanDesc pscan);
+typedef void (*scan_rescan_function) (HeapScanDesc scan, ScanKey key);
+typedef void (*scan_end_function) (HeapScanDesc scan);
+typedef HeapTuple (*scan_getnext_function) (HeapScanDesc scan,
+											ScanDirection direction);
+
+/* fetch a single tuple by TID */
+typedef bool (*tuple_fetch_function) (Relation relation, Snapshot snapshot,
+									  HeapTuple tuple, Buffer *userbuf,
+									  bool keep_buf, Relation stats_relation);
+
+/* insert tuples */
+typedef Oid (*tuple_insert_function) (Relation relation, HeapTuple tup,
+									  CommandId cid, int options,
+									  BulkInsertState bistate);
+typedef void (*multi_insert_function) (Relation relation, HeapTuple *tuples,
+									   int ntuples, CommandId cid, int options,
+									   BulkInsertState bistate);
+
+/*
+ * API struct for a table AM.  Note this must be stored in a single palloc'd
+ * chunk of memory, or be a statically allocated constant.
+ */
+typedef struct TableAmRoutine
+{
+	NodeTag		type;
+
+	parallelscan_estimate_function parallelscan_estimate;
+	parallelscan_initialize_function parallelscan_initialize;
+	parallelscan_reinitialize_function parallelscan_reinitialize;
+	parallelscan_remaining_function parallelscan_remaining;	/* can be NULL */
+
+	scan_begin_function scan_begin;
+	scan_begin_parallel_function scan_begin_parallel;
+	scan_rescan_function scan_rescan;
+	scan_end_function scan_end;
+	scan_getnext_function scan_getnext;
+
+	tuple_fetch_function tuple_fetch;
+
+	tuple_insert_function tuple_insert;
+	multi_insert_function multi_insert;
+} TableAmRoutine;
+
+
+/* Functions in access/heap/heapam_handler.c */
+extern const TableAmRoutine *GetHeapamTableAmRoutine(void);
+
+/* Functions in access/table/tableamapi.c */
+extern const TableAmRoutine *GetTableAmRoutine(Oid amhandler);
+extern bool check_default_table_access_method(char **newval, void **extra,
+								  GucSource source);
+
+
+/*
+ * Wrappers that dispatch through a relation's table AM.
+ */
+
+static inline Size
+table_parallelscan_estimate(Relation relation, Snapshot snapshot)
+{
+	return relation->rd_tableam->parallelscan_estimate(snapshot);
+}
+
+static inline void
+table_parallelscan_initialize(Relation relation, ParallelHeapScanDesc pscan,
+							  Snapshot snapshot)
+{
+	relation->rd_tableam->parallelscan_initialize(pscan, relation, snapshot);
+}
+
+static inline void
+table_parallelscan_reinitialize(Relation relation, ParallelHeapScanDesc pscan)
+{
+	relation->rd_tableam->parallelscan_reinitialize(pscan);
+}
+
+/*
+ * Report how many blocks a parallel scan has yet to hand out, as a measure of
+ * the work left in it.  Returns false if the AM can't tell.
+ */
+static inline bool
+table_parallelscan_remaining(Relation relation, ParallelHeapScanDesc pscan,
+							 BlockNumber *nblocks)
+{
+	if (relation->rd_tableam->parallelscan_remaining == NULL)
+		return false;
+	*nblocks = relation->rd_tableam->parallelscan_remaining(pscan);
+	return true;
+}
+
+static inline HeapScanDesc
+table_beginscan(Relation relation, Snapshot snapshot, int nkeys, ScanKey key)
+{
+	return relation->rd_tableam->scan_begin(relation, snapshot, nkeys, key);
+}
+
+static inline HeapScanDesc
+table_beginscan_parallel(Relation relation, ParallelHeapScanDesc pscan)
+{
+	return relation->rd_tableam->scan_begin_parallel(relation, pscan);
+}
+
+static inline void
+table_rescan(HeapScanDesc scan, ScanKey key)
+{
+	scan->rs_rd->rd_tableam->scan_rescan(scan, key);
+}
+
+static inline void
+table_endscan(HeapScanDesc scan)
+{
+	scan->rs_rd->rd_tableam->scan_end(scan);
+}
+
+static inline HeapTuple
+table_getnext(HeapScanDesc scan, ScanDirection direction)
+{
+	return scan->rs_rd->rd_tableam->scan_getnext(scan, direction);
+}
+
+static inline bool
+table_fetch(Relation relation, Snapshot snapshot, HeapTuple tuple,
+			Buffer *userbuf, bool keep_buf, Relation stats_relation)
+{
+	return relation->rd_tableam->tuple_fetch(relation, snapshot, tuple,
+											 userbuf, keep_buf,
+											 stats_relation);
+}
+
+static inline Oid
+table_insert(Relation relation, HeapTuple tup, CommandId cid, int options,
+			 BulkInsertState bistate)
+{
+	return relation->rd_tableam->tuple_insert(relation, tup, cid, options,
+											  bistate);
+}
+
+static inline void
+table_multi_insert(Relation relation, HeapTuple *tuples, int ntuples,
+				   CommandId cid, int options, BulkInsertState bistate)
+{
+	relation->rd_tableam->multi_insert(relation, tuples, ntuples, cid,
+									   options, bistate);
+}
+
+#endif							/* TABLEAM_H */
@@ -85,6 +85,8 @@ typedef struct tupleDesc
 	bool		tdhasoid;		/* tuple has oid attribute in its header */
 	int			tdrefcount;		/* reference count, or -1 if not counting */
 	TupleConstr *constr;		/* constraints, or NULL if none */
+	int			tdfixedprefix;	/* # of leading fixed-width attrs, or -1 if
+								 * not computed yet */
 	/* attrs[N] is the description of Attribute Number N+1 */
 	FormData_pg_attribute attrs[FLEXIBLE_ARRAY_MEMBER];
 }		   *TupleDesc;
@@ -92,6 +94,15 @@ typedef struct tupleDesc
 /* Accessor for the i'th attribute of tupdesc. */
 #define TupleDescAttr(tupdesc, i) (&(tupdesc)->attrs[(i)])
 
+/*
+ * Number of leading attributes that are fixed-width.  For a tuple that has
+ * no NULLs among them, their offsets are given by attcacheoff, which
+ * TupleDescComputeFixedPrefix fills in when first called.
+ */
+#define TupleDescFixedPrefix(tupdesc) \
+	((tupdesc)->tdfixedprefix >= 0 ? (tupdesc)->tdfixedprefix : \
+	 TupleDescComputeFixedPrefix(tupdesc))
+
 extern TupleDesc CreateTemplateTupleDesc(int natts, bool hasoid);
 
 extern TupleDesc CreateTupleDesc(int natts, bool hasoid,
@@ -107,6 +118,8 @@ extern TupleDesc CreateTupleDescCopyConstr(TupleDesc tupdesc);
 
 extern void TupleDescCopy(TupleDesc dst, TupleDesc src);
 
+extern int	TupleDescComputeFixedPrefix(TupleDesc tupdesc);
+
 extern void TupleDescCopyEntry(TupleDesc dst, AttrNumber dstAttno,
 				   TupleDesc src, AttrNumber srcAttno);
 
@@ -99,13 +99,14 @@ extern int	min_wal_size_mb;
 extern int	max_wal_size_mb;
 extern int	wal_keep_segments;
 extern int	XLOGbuffers;
+extern int	num_xloginsert_locks;
 extern int	XLogArchiveTimeout;
 extern int	wal_retrieve_retry_interval;
 extern char *XLogArchiveCommand;
 extern bool EnableHotStandby;
 extern bool fullPageWrites;
 extern bool wal_log_hints;
-extern bool wal_compression;
+extern int	wal_compression;
 extern bool *wal_consistency_checking;
 extern char *wal_consistency_checking_string;
 extern bool log_checkpoints;
@@ -131,6 +132,14 @@ typedef enum WalLevel
 
 extern PGDLLIMPORT int wal_level;
 
+/* Compression methods for wal_compression */
+typedef enum WalCompression
+{
+	WAL_COMPRESSION_NONE = 0,
+	WAL_COMPRESSION_PGLZ,
+	WAL_COMPRESSION_LZ4
+} WalCompression;
+
 /* Is WAL archiving enabled (always or only while server is running normally)? */
 #define XLogArchivingActive() \
 	(AssertMacro(XLogArchiveMode == ARCHIVE_MODE_OFF || wal_level >= WAL_LEVEL_REPLICA), XLogArchiveMode > ARCHIVE_MODE_OFF)
@@ -218,6 +227,23 @@ typedef struct CheckpointStatsData
 
 extern CheckpointStatsData CheckpointStats;
 
+/* Upper limit of commit_delay, in microseconds */
+#define XLOG_MAX_COMMIT_DELAY	100000
+
+/* WAL flush statistics, see GetXLogFlushStats() */
+#define XLOG_FLUSH_WAIT_BUCKETS	24
+
+typedef struct XLogFlushStats
+{
+	uint64		flushes;		/* # of flushes done by flush leaders */
+	uint64		flush_time;		/* time spent in them, in usec */
+	uint64		flush_waits;	/* # of XLogFlush calls that had to wait */
+	uint64		flush_wait_time;	/* time spent waiting, in usec */
+	/* flush waits by duration; bucket i holds waits below 2^(i+1) usec */
+	uint64		flush_wait_hist[XLOG_FLUSH_WAIT_BUCKETS];
+	int			commit_delay;	/* current commit delay, in usec */
+} XLogFlushStats;
+
 struct XLogRecData;
 
 extern XLogRecPtr XLogInsertRecord(struct XLogRecData *rdata,
@@ -245,7 +271,10 @@ extern bool HotStandbyActive(void);
 extern bool HotStandbyActiveInReplay(void);
 extern bool XLogInsertAllowed(void);
 extern void GetXLogReceiptTime(TimestampTz *rtime, bool *fromStream);
+extern void SetXLogReceiptTime(TimestampTz rtime, bool fromStream);
+extern void XLogLoadMinRecoveryPoint(void);
 extern XLogRecPtr GetXLogReplayRecPtr(TimeLineID *replayTLI);
+extern void XLogAdvanceReplayRecPtr(XLogRecPtr recptr);
 extern XLogRecPtr GetXLogInsertRecPtr(void);
 extern XLogRecPtr GetXLogWriteRecPtr(void);
 extern bool RecoveryIsPaused(void);
@@ -275,6 +304,7 @@ extern void GetFullPageWriteInfo(XLogRecPtr *RedoRecPtr_p, bool *doPageWrites_p)
 extern XLogRecPtr GetRedoRecPtr(void);
 extern XLogRecPtr GetInsertRecPtr(void);
 extern XLogRecPtr GetFlushRecPtr(void);
+extern void GetXLogFlushStats(XLogFlushStats *stats);
 extern XLogRecPtr GetLastImportantRecPtr(void);
 extern void GetNextXidAndEpoch(TransactionId *xid, uint32 *epoch);
 extern void RemovePromoteSignalFiles(void);
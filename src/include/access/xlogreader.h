@@ -133,6 +133,13 @@ struct XLogReaderState
 	uint32		main_data_len;	/* main data portion's length */
 	uint32		main_data_bufsz;	/* allocated size of the buffer */
 
+	/*
+	 * Buffer for the decompressed data of a record with XLR_COMPRESSED_DATA.
+	 * Page images of such a record point into it.
+	 */
+	char	   *decompressed_data;
+	uint32		decompressed_data_bufsz;	/* allocated size of the buffer */
+
 	RepOriginId record_origin;
 
 	/* information about blocks referenced by the record. */
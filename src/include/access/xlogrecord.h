@@ -37,6 +37,12 @@
  * The XLogRecordBlockHeader, XLogRecordDataHeaderShort and
  * XLogRecordDataHeaderLong structs all begin with a single 'id' byte. It's
  * used to distinguish between block references, and the main data structs.
+ *
+ * If XLR_COMPRESSED_DATA is set, the headers are followed by an
+ * XLogRecordCompressedHeader, and everything after it (all the block data,
+ * including any page images, and the main data) is stored compressed as a
+ * single unit.  The lengths in the other headers still describe the
+ * uncompressed data.
  */
 typedef struct XLogRecord
 {
@@ -79,6 +85,12 @@ typedef struct XLogRecord
  */
 #define XLR_CHECK_CONSISTENCY	0x02
 
+/*
+ * The record's data portion is compressed; see XLogRecordCompressedHeader.
+ * This is set internally by XLogInsert when wal_compression is enabled.
+ */
+#define XLR_COMPRESSED_DATA		0x04
+
 /*
  * Header info for block data appended to an XLOG record.
  *
@@ -115,7 +127,8 @@ typedef struct XLogRecordBlockHeader
  * present is BLCKSZ - the length of "hole" bytes.
  *
  * When wal_compression is enabled, a full page image which "hole" was
- * removed is additionally compressed using PGLZ compression algorithm.
+ * removed is additionally compressed using the selected compression
+ * method, which is recorded in bimg_info.
  * This can reduce the WAL volume, but at some extra cost of CPU spent
  * on the compression during WAL logging. In this case, since the "hole"
  * length cannot be calculated by subtracting the number of page image bytes
@@ -135,7 +148,7 @@ typedef struct XLogRecordBlockImageHeader
 	uint8		bimg_info;		/* flag bits, see below */
 
 	/*
-	 * If BKPIMAGE_HAS_HOLE and BKPIMAGE_IS_COMPRESSED, an
+	 * If BKPIMAGE_HAS_HOLE and BKPIMAGE_COMPRESSED(), an
 	 * XLogRecordBlockCompressHeader struct follows.
 	 */
 } XLogRecordBlockImageHeader;
@@ -145,9 +158,14 @@ typedef struct XLogRecordBlockImageHeader
 
 /* Information stored in bimg_info */
 #define BKPIMAGE_HAS_HOLE		0x01	/* page image has "hole" */
-#define BKPIMAGE_IS_COMPRESSED		0x02	/* page image is compressed */
+#define BKPIMAGE_COMPRESS_PGLZ	0x02	/* page image is compressed with
+										 * pglz */
 #define BKPIMAGE_APPLY		0x04	/* page image should be restored during
 									 * replay */
+#define BKPIMAGE_COMPRESS_LZ4	0x08	/* page image is compressed with lz4 */
+
+#define BKPIMAGE_COMPRESSED(info) \
+	(((info) & (BKPIMAGE_COMPRESS_PGLZ | BKPIMAGE_COMPRESS_LZ4)) != 0)
 
 /*
  * Extra header information used when page image has "hole" and
@@ -208,6 +226,23 @@ typedef struct XLogRecordDataHeaderLong
 
 #define SizeOfXLogRecordDataHeaderLong (sizeof(uint8) + sizeof(uint32))
 
+/*
+ * Header that marks the end of the headers of a record with compressed data
+ * (XLR_COMPRESSED_DATA).  It always comes last, after the main data header.
+ * The compressed data follows, running to the end of the record.
+ */
+typedef struct XLogRecordCompressedHeader
+{
+	uint8		id;				/* XLR_BLOCK_ID_COMPRESSED */
+	uint8		method;			/* XLR_COMPRESS_* */
+}			XLogRecordCompressedHeader;
+
+#define SizeOfXLogRecordCompressedHeader (sizeof(uint8) * 2)
+
+/* Compression methods for record data */
+#define XLR_COMPRESS_PGLZ			1
+#define XLR_COMPRESS_LZ4			2
+
 /*
  * Block IDs used to distinguish different kinds of record fragments. Block
  * references are numbered from 0 to XLR_MAX_BLOCK_ID. A rmgr is free to use
@@ -224,5 +259,6 @@ typedef struct XLogRecordDataHeaderLong
 #define XLR_BLOCK_ID_DATA_SHORT		255
 #define XLR_BLOCK_ID_DATA_LONG		254
 #define XLR_BLOCK_ID_ORIGIN			253
+#define XLR_BLOCK_ID_COMPRESSED		252
 
 #endif							/* XLOGRECORD_H */
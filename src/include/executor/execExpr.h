@@ -91,6 +91,19 @@ typedef enum ExprEvalOp
 	EEOP_FUNCEXPR_FUSAGE,
 	EEOP_FUNCEXPR_STRICT_FUSAGE,
 
+	/*
+	 * Compute the hash value of the argument in fcinfo_data and combine it
+	 * with the hash value computed by the previous step, to build the hash
+	 * value of a set of keys.  FIRST starts a new hash value, NEXT32 rotates
+	 * the previous one left by one bit and XORs the new one into it.  A NULL
+	 * input hashes as 0, except in the STRICT variants, which make the whole
+	 * expression return NULL.
+	 */
+	EEOP_HASHDATUM_FIRST,
+	EEOP_HASHDATUM_FIRST_STRICT,
+	EEOP_HASHDATUM_NEXT32,
+	EEOP_HASHDATUM_NEXT32_STRICT,
+
 	/*
 	 * Evaluate boolean AND expression, one step per subexpression. FIRST/LAST
 	 * subexpressions are special-cased for performance.  Since AND always has
@@ -318,6 +331,17 @@ typedef struct ExprEvalStep
 			int			nargs;	/* number of arguments */
 		}			func;
 
+		/* for EEOP_HASHDATUM_* */
+		struct
+		{
+			FmgrInfo   *finfo;	/* hash function's lookup data */
+			FunctionCallInfo fcinfo_data;	/* argument etc */
+			/* faster to access without additional indirection: */
+			PGFunction	fn_addr;	/* actual call address */
+			int			jumpdone;	/* jump here on NULL, if STRICT */
+			Datum	   *iresult;	/* hash value computed so far */
+		}			hashdatum;
+
 		/* for EEOP_BOOL_*_STEP */
 		struct
 		{
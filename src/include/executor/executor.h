@@ -97,6 +97,7 @@ struct Path;					/* avoid including relation.h here */
 extern void ExecReScan(PlanState *node);
 extern void ExecMarkPos(PlanState *node);
 extern void ExecRestrPos(PlanState *node);
+extern bool ExecSkipTo(PlanState *node, ScanKey key);
 extern bool ExecSupportsMarkRestore(struct Path *pathnode);
 extern bool ExecSupportsBackwardScan(Plan *node);
 extern bool ExecMaterializesOutput(NodeTag plantype);
@@ -129,6 +130,15 @@ extern TupleHashTable BuildTupleHashTable(PlanState *parent,
 					long nbuckets, Size additionalsize,
 					MemoryContext tablecxt,
 					MemoryContext tempcxt, bool use_variable_hash_iv);
+extern TupleHashTable BuildTupleHashTableExt(PlanState *parent,
+					   TupleDesc inputDesc,
+					   int numCols, AttrNumber *keyColIdx,
+					   Oid *eqfuncoids,
+					   FmgrInfo *hashfunctions,
+					   long nbuckets, Size additionalsize,
+					   MemoryContext metacxt,
+					   MemoryContext tablecxt,
+					   MemoryContext tempcxt, bool use_variable_hash_iv);
 extern TupleHashEntry LookupTupleHashEntry(TupleHashTable hashtable,
 					 TupleTableSlot *slot,
 					 bool *isnew);
@@ -136,6 +146,21 @@ extern TupleHashEntry FindTupleHashEntry(TupleHashTable hashtable,
 				   TupleTableSlot *slot,
 				   ExprState *eqcomp,
 				   FmgrInfo *hashfunctions);
+extern void ResetTupleHashTable(TupleHashTable hashtable);
+extern SharedTupleHashTable BuildSharedTupleHashTable(PlanState *parent,
+						  TupleDesc inputDesc,
+						  int numCols, AttrNumber *keyColIdx,
+						  Oid *eqfuncoids,
+						  FmgrInfo *hashfunctions,
+						  dsa_area *area,
+						  dsa_pointer handle,
+						  MemoryContext metacxt,
+						  MemoryContext tempcxt);
+extern dsa_pointer SharedTupleHashTableGetHandle(SharedTupleHashTable hashtable);
+extern void ReleaseSharedTupleHashTable(SharedTupleHashTable hashtable,
+							bool destroy);
+extern bool LookupSharedTupleHashEntry(SharedTupleHashTable hashtable,
+						   TupleTableSlot *slot, bool *isnew);
 
 /*
  * prototypes from functions in execJunk.c
@@ -253,6 +278,11 @@ extern ExprState *ExecBuildGroupingEqual(TupleDesc ldesc, TupleDesc rdesc,
 					   AttrNumber *keyColIdx,
 					   Oid *eqfunctions,
 					   PlanState *parent);
+extern ExprState *ExecBuildHash32Expr(List *hash_exprs,
+					const Oid *hashfunc_oids,
+					const bool *opstrict,
+					bool keep_nulls,
+					PlanState *parent);
 extern ProjectionInfo *ExecBuildProjectionInfo(List *targetList,
 						ExprContext *econtext,
 						TupleTableSlot *slot,
@@ -330,13 +330,12 @@ typedef struct HashJoinTableData
 	BufFile   **outerBatchFile; /* buffered virtual temp file per batch */
 
 	/*
-	 * Info about the datatype-specific hash functions for the datatypes being
-	 * hashed. These are arrays of the same length as the number of hash join
-	 * clauses (hash keys).
+	 * Info about the datatype-specific hash functions for the outer side's
+	 * datatypes, used to hash the skew MCVs.  This is an array of the same
+	 * length as the number of hash join clauses (hash keys).  The hash values
+	 * of tuples are computed by the expressions built in ExecInitHashJoin.
 	 */
 	FmgrInfo   *outer_hashfunctions;	/* lookup data for hash functions */
-	FmgrInfo   *inner_hashfunctions;	/* lookup data for hash functions */
-	bool	   *hashStrict;		/* is each hash join operator strict? */
 
 	Size		spaceUsed;		/* memory space currently used by tuples */
 	Size		spaceAllowed;	/* upper limit for space used */
@@ -21,6 +21,7 @@ extern IndexOnlyScanState *ExecInitIndexOnlyScan(IndexOnlyScan *node, EState *es
 extern void ExecEndIndexOnlyScan(IndexOnlyScanState *node);
 extern void ExecIndexOnlyMarkPos(IndexOnlyScanState *node);
 extern void ExecIndexOnlyRestrPos(IndexOnlyScanState *node);
+extern bool ExecIndexOnlySkipTo(IndexOnlyScanState *node, ScanKey key);
 extern void ExecReScanIndexOnlyScan(IndexOnlyScanState *node);
 
 /* Support functions for parallel index-only scans */
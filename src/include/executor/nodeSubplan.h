@@ -14,6 +14,7 @@
 #ifndef NODESUBPLAN_H
 #define NODESUBPLAN_H
 
+#include "access/parallel.h"
 #include "nodes/execnodes.h"
 
 extern SubPlanState *ExecInitSubPlan(SubPlan *subplan, PlanState *parent);
@@ -28,4 +29,9 @@ extern void ExecReScanSetParamPlan(SubPlanState *node, PlanState *parent);
 
 extern void ExecSetParamPlan(SubPlanState *node, ExprContext *econtext);
 
+extern void ExecSubPlanEstimate(SubPlanState *node, ParallelContext *pcxt);
+extern void ExecSubPlanInitializeDSM(SubPlanState *node, ParallelContext *pcxt);
+extern void ExecSubPlanInitializeWorker(SubPlanState *node,
+							ParallelWorkerContext *pwcxt);
+
 #endif							/* NODESUBPLAN_H */
@@ -14,10 +14,17 @@
 #ifndef NODEUNIQUE_H
 #define NODEUNIQUE_H
 
+#include "access/parallel.h"
 #include "nodes/execnodes.h"
 
 extern UniqueState *ExecInitUnique(Unique *node, EState *estate, int eflags);
 extern void ExecEndUnique(UniqueState *node);
 extern void ExecReScanUnique(UniqueState *node);
 
+extern void ExecUniqueEstimate(UniqueState *node, ParallelContext *pcxt);
+extern void ExecUniqueInitializeDSM(UniqueState *node, ParallelContext *pcxt);
+extern void ExecUniqueReInitializeDSM(UniqueState *node, ParallelContext *pcxt);
+extern void ExecUniqueInitializeWorker(UniqueState *node,
+						   ParallelWorkerContext *pwcxt);
+
 #endif							/* NODEUNIQUE_H */
@@ -14,10 +14,17 @@
 #ifndef NODEWINDOWAGG_H
 #define NODEWINDOWAGG_H
 
+#include "access/parallel.h"
 #include "nodes/execnodes.h"
 
 extern WindowAggState *ExecInitWindowAgg(WindowAgg *node, EState *estate, int eflags);
 extern void ExecEndWindowAgg(WindowAggState *node);
 extern void ExecReScanWindowAgg(WindowAggState *node);
 
+/* parallel scan support */
+extern void ExecWindowAggEstimate(WindowAggState *node, ParallelContext *pcxt);
+extern void ExecWindowAggInitializeDSM(WindowAggState *node, ParallelContext *pcxt);
+extern void ExecWindowAggReInitializeDSM(WindowAggState *node, ParallelContext *pcxt);
+extern void ExecWindowAggInitializeWorker(WindowAggState *node, ParallelWorkerContext *pwcxt);
+
 #endif							/* NODEWINDOWAGG_H */
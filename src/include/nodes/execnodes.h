@@ -18,6 +18,7 @@
 #include "access/heapam.h"
 #include "access/tupconvert.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -681,6 +682,28 @@ typedef struct TupleHashTableData
 	ExprContext *exprcontext;	/* expression context */
 }			TupleHashTableData;
 
+/*
+ * A SharedTupleHashTable keeps its entries in a dshash table in dynamic
+ * shared memory, so that all the participants of a parallel query can find
+ * or insert entries concurrently.  The table only holds a copy of the first
+ * tuple of each group; there's no per-entry user data, and the table cannot
+ * be scanned.  The rest of the struct is backend-local.
+ */
+typedef struct SharedTupleHashTableData *SharedTupleHashTable;
+
+typedef struct SharedTupleHashTableData
+{
+	struct dshash_table *hashtab;	/* underlying shared hash table */
+	dsa_area   *area;			/* area holding the table and its tuples */
+	int			numCols;		/* number of columns in lookup key */
+	AttrNumber *keyColIdx;		/* attr numbers of key columns */
+	FmgrInfo   *tab_hash_funcs; /* hash functions for table datatype(s) */
+	ExprState  *tab_eq_func;	/* comparator for table datatype(s) */
+	MemoryContext tempcxt;		/* context for function evaluations */
+	TupleTableSlot *tableslot;	/* slot for referencing table entries */
+	ExprContext *exprcontext;	/* expression context */
+}			SharedTupleHashTableData;
+
 typedef tuplehash_iterator TupleHashIterator;
 
 /*
@@ -843,6 +866,14 @@ typedef struct SubPlanState
 	FmgrInfo   *lhs_hash_funcs; /* hash functions for lefthand datatype(s) */
 	FmgrInfo   *cur_eq_funcs;	/* equality functions for LHS vs. table */
 	ExprState  *cur_eq_comp;	/* equality comparator for LHS vs. table */
+	/* these are used if the no-nulls hash table outgrows work_mem: */
+	MemoryContext hashbatchcxt; /* memory context for hashtable's entries */
+	Size		hashspace;		/* approximate size of hashtable's entries */
+	int			nbatch;			/* number of batches, or 0 if not spilled */
+	int			curbatch;		/* batch currently loaded in hashtable */
+	struct BufFile **batchfiles;	/* temp files holding each batch's rows */
+	/* set in a parallel worker, if the leader computed the subselect: */
+	struct SharedSubPlanHash *shared_hash;
 } SubPlanState;
 
 /* ----------------
@@ -1061,6 +1092,15 @@ typedef struct ModifyTableState
 
 	/* Per plan map for tuple conversion from child to root */
 	TupleConversionMap **mt_per_subplan_tupconv_maps;
+
+	/* Buffered rows of an INSERT that uses heap_multi_insert */
+	bool		mt_multi_insert;	/* are we buffering inserted rows? */
+	HeapTuple  *mt_buffered_tuples; /* rows not yet written */
+	int			mt_nbuffered;	/* number of rows in mt_buffered_tuples */
+	Size		mt_buffered_size;	/* total size of the buffered rows */
+	MemoryContext mt_buffer_cxt;	/* memory context holding the rows */
+	TupleTableSlot *mt_buffer_slot; /* slot for inserting index entries */
+	BulkInsertState mt_bistate; /* bulk insert state for the result rel */
 } ModifyTableState;
 
 /* ----------------
@@ -1278,6 +1318,9 @@ typedef struct
  *		OrderByTypByVals   is the datatype of order by expression pass-by-value?
  *		OrderByTypLens	   typlens of the datatypes of order by expressions
  *		pscan_len		   size of parallel index scan descriptor
+ *		SkipScanDesc	   scan descriptor with an extra key, for skipping ahead
+ *		SkipScanKeys	   Skey structures for SkipScanDesc
+ *		PlainScanDesc	   the regular ScanDesc, while SkipScanDesc is in use
  * ----------------
  */
 typedef struct IndexScanState
@@ -1305,6 +1348,9 @@ typedef struct IndexScanState
 	bool	   *iss_OrderByTypByVals;
 	int16	   *iss_OrderByTypLens;
 	Size		iss_PscanLen;
+	IndexScanDesc iss_SkipScanDesc;
+	ScanKey		iss_SkipScanKeys;
+	IndexScanDesc iss_PlainScanDesc;
 } IndexScanState;
 
 /* ----------------
@@ -1323,6 +1369,9 @@ typedef struct IndexScanState
  *		ScanDesc		   index scan descriptor
  *		VMBuffer		   buffer in use for visibility map testing, if any
  *		ioss_PscanLen	   Size of parallel index-only scan descriptor
+ *		SkipScanDesc	   scan descriptor with an extra key, for skipping ahead
+ *		SkipScanKeys	   Skey structures for SkipScanDesc
+ *		PlainScanDesc	   the regular ScanDesc, while SkipScanDesc is in use
  * ----------------
  */
 typedef struct IndexOnlyScanState
@@ -1341,6 +1390,9 @@ typedef struct IndexOnlyScanState
 	IndexScanDesc ioss_ScanDesc;
 	Buffer		ioss_VMBuffer;
 	Size		ioss_PscanLen;
+	IndexScanDesc ioss_SkipScanDesc;
+	ScanKey		ioss_SkipScanKeys;
+	IndexScanDesc ioss_PlainScanDesc;
 } IndexOnlyScanState;
 
 /* ----------------
@@ -1736,6 +1788,12 @@ typedef struct NestLoopState
  *		NullInnerTupleSlot prepared null tuple for left outer joins
  *		OuterEContext	   workspace for computing outer tuple's join values
  *		InnerEContext	   workspace for computing inner tuple's join values
+ *		SkipAhead		   true if we may ask the inner plan to skip ahead
+ *		InnerSkipCount	   number of inner tuples advanced over in a row
+ *		SkipKey			   scan key telling the inner plan where to skip to
+ *		SkipKeyLen		   typlen of the scan key's argument
+ *		SkipKeyByVal	   typbyval of the scan key's argument
+ *		SkipContext		   memory context holding the scan key's argument
  * ----------------
  */
 /* private in nodeMergejoin.c: */
@@ -1761,14 +1819,20 @@ typedef struct MergeJoinState
 	TupleTableSlot *mj_NullInnerTupleSlot;
 	ExprContext *mj_OuterEContext;
 	ExprContext *mj_InnerEContext;
+	bool		mj_SkipAhead;
+	int			mj_InnerSkipCount;
+	ScanKeyData mj_SkipKey;
+	int16		mj_SkipKeyLen;
+	bool		mj_SkipKeyByVal;
+	MemoryContext mj_SkipContext;
 } MergeJoinState;
 
 /* ----------------
  *	 HashJoinState information
  *
  *		hashclauses				original form of the hashjoin condition
- *		hj_OuterHashKeys		the outer hash keys in the hashjoin condition
- *		hj_InnerHashKeys		the inner hash keys in the hashjoin condition
+ *		hj_OuterHash			ExprState computing the hash value of an
+ *								outer tuple's hash keys
  *		hj_HashOperators		the join operators in the hashjoin condition
  *		hj_HashTable			hash table for the hashjoin
  *								(NULL if table not built yet)
@@ -1798,8 +1862,7 @@ typedef struct HashJoinState
 {
 	JoinState	js;				/* its first field is NodeTag */
 	ExprState  *hashclauses;
-	List	   *hj_OuterHashKeys;	/* list of ExprState nodes */
-	List	   *hj_InnerHashKeys;	/* list of ExprState nodes */
+	ExprState  *hj_OuterHash;
 	List	   *hj_HashOperators;	/* list of operator OIDs */
 	HashJoinTable hj_HashTable;
 	uint32		hj_CurHashValue;
@@ -1839,6 +1902,55 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 Instrumentation information for ResultCache
+ * ----------------
+ */
+typedef struct ResultCacheInstrumentation
+{
+	uint64		cache_hits;		/* rescans answered from the cache */
+	uint64		cache_misses;	/* rescans that had to run the subplan */
+	uint64		cache_evictions;	/* entries removed to free memory */
+	uint64		cache_overflows;	/* scans too big to cache at all */
+	uint64		mem_peak;		/* peak memory used by the cache, in bytes */
+} ResultCacheInstrumentation;
+
+/* ----------------
+ *	 ResultCacheState information
+ *
+ *		result cache nodes remember the tuples returned by their subplan
+ *		for each set of parameter values, evicting the least recently used
+ *		entries to stay within work_mem.
+ * ----------------
+ */
+struct resultcache_hash;
+struct ResultCacheEntry;
+struct ResultCacheTuple;
+
+typedef struct ResultCacheState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			rc_status;		/* value of ExecResultCache state machine */
+	int			nkeys;			/* number of cache keys */
+	struct resultcache_hash *hashtable; /* hash table of cache entries */
+	TupleDesc	hashkeydesc;	/* tuple descriptor for cache keys */
+	TupleTableSlot *tableslot;	/* slot for looking at stored keys */
+	TupleTableSlot *probeslot;	/* slot holding the current keys */
+	ExprState **param_exprs;	/* exprs computing the current keys */
+	FmgrInfo   *hashfunctions;	/* hash function for each key */
+	FmgrInfo   *eqfunctions;	/* equality function for each key */
+	MemoryContext tableContext; /* memory context for the cache */
+	dlist_head	lru_list;		/* cache keys, least recently used first */
+	struct ResultCacheTuple *last_tuple;	/* last tuple returned from the
+											 * cache */
+	struct ResultCacheEntry *entry; /* entry being returned or filled */
+	bool		singlerow;		/* entry is complete after its first tuple */
+	Bitmapset  *keyparamids;	/* paramids appearing in param_exprs */
+	uint64		mem_used;		/* bytes of memory used by the cache */
+	uint64		mem_limit;		/* memory limit in bytes for the cache */
+	ResultCacheInstrumentation stats;	/* cache statistics */
+} ResultCacheState;
+
 /* ----------------
  *	 Shared memory container for per-worker sort information
  * ----------------
@@ -1851,8 +1963,14 @@ typedef struct SharedSortInfo
 
 /* ----------------
  *	 SortState information
+ *
+ *		A parallel-aware sort has every participant write one sorted run to
+ *		shared temporary files; the leader then merges all the runs.
  * ----------------
  */
+struct ParallelSortShared;
+typedef struct ParallelSortShared ParallelSortShared;
+
 typedef struct SortState
 {
 	ScanState	ss;				/* its first field is NodeTag */
@@ -1865,8 +1983,47 @@ typedef struct SortState
 	void	   *tuplesortstate; /* private state of tuplesort.c */
 	bool		am_worker;		/* are we a worker? */
 	SharedSortInfo *shared_info;	/* one entry per worker */
+	ParallelSortShared *pshared;	/* parallel coordination info */
+	struct ParallelContext *pcxt;	/* leader's parallel context */
 } SortState;
 
+/* ----------------
+ *	 Instrumentation information for IncrementalSort
+ * ----------------
+ */
+typedef struct IncrementalSortInfo
+{
+	int64		groupCount;		/* number of sort batches performed */
+	long		maxSpaceUsed;	/* peak space used by any batch, in kB */
+	TuplesortSpaceType maxSpaceType;	/* type of space maxSpaceUsed is */
+	bits32		sortMethods;	/* bitmask of TuplesortMethods used */
+} IncrementalSortInfo;
+
+/* ----------------
+ *	 IncrementalSortState information
+ *
+ *		presorted_keys	comparators for the presorted prefix columns
+ *		sortstate		tuplesort for the batch currently being returned
+ *		group_pivot		a tuple of the last prefix group of the batch
+ *		transfer_tuple	first tuple of the next batch, already read
+ *		n_outputted		tuples returned so far (for bounded sorts)
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		bounded;		/* is the result set bounded? */
+	int64		bound;			/* if bounded, how many tuples are needed */
+	bool		outerNodeDone;	/* finished fetching tuples from outer node */
+	bool		have_transfer;	/* is transfer_tuple valid? */
+	int64		n_outputted;	/* number of tuples returned so far */
+	SortSupport presorted_keys; /* array of length nPresortedCols */
+	void	   *sortstate;		/* private state of tuplesort.c */
+	TupleTableSlot *group_pivot;
+	TupleTableSlot *transfer_tuple;
+	IncrementalSortInfo incsort_info;	/* EXPLAIN ANALYZE statistics */
+} IncrementalSortState;
+
 /* ---------------------
  *	GroupState information
  * ---------------------
@@ -1951,11 +2108,16 @@ typedef struct AggState
 
 /* ----------------
  *	WindowAggState information
+ *
+ *		A parallel-aware WindowAgg first redistributes its input among the
+ *		participants by hashing the partitioning columns into buckets, then
+ *		each participant sorts and processes whole buckets on its own.
  * ----------------
  */
 /* these structs are private in nodeWindowAgg.c: */
 typedef struct WindowStatePerFuncData *WindowStatePerFunc;
 typedef struct WindowStatePerAggData *WindowStatePerAgg;
+typedef struct ParallelWindowAggShared ParallelWindowAggShared;
 
 typedef struct WindowAggState
 {
@@ -2031,6 +2193,15 @@ typedef struct WindowAggState
 	TupleTableSlot *agg_row_slot;
 	TupleTableSlot *temp_slot_1;
 	TupleTableSlot *temp_slot_2;
+
+	/* these fields are used by a parallel-aware WindowAgg */
+	ParallelWindowAggShared *pwa_shared;	/* parallel coordination info */
+	struct SharedTuplestoreAccessor **pwa_buckets;	/* one per bucket */
+	MemoryContext pwa_bucketcxt;	/* leader's accessors, rebuilt on rescan */
+	FmgrInfo   *pwa_hashfunctions;	/* for partitioning columns */
+	void	   *pwa_sort;		/* sorts the tuples of the current bucket */
+	TupleTableSlot *pwa_slot;	/* slot for tuples read back and sorted */
+	bool		pwa_started;	/* input redistributed and first sort done? */
 } WindowAggState;
 
 /* ----------------
@@ -2042,12 +2213,28 @@ typedef struct WindowAggState
  *		with the previously fetched tuple (stored in its result slot).
  *		If the two are identical in all interesting fields, then
  *		we just fetch another tuple from the sort and try again.
+ *
+ *		A parallel-aware Unique instead works on unsorted input: it
+ *		remembers the tuples returned so far by any participant in a
+ *		hash table in shared memory, and discards those already in it.
  * ----------------
  */
+typedef struct ParallelUniqueState ParallelUniqueState;
+
 typedef struct UniqueState
 {
 	PlanState	ps;				/* its first field is NodeTag */
 	ExprState  *eqfunction;		/* tuple equality qual */
+
+	/* these fields are used by a parallel-aware Unique */
+	Oid		   *eqfuncoids;		/* per-grouping-field equality fns */
+	FmgrInfo   *hashfunctions;	/* per-grouping-field hash fns */
+	MemoryContext tablecxt;		/* memory context for local hash table */
+	TupleHashTable hashtable;	/* local hash table, if not running in
+								 * parallel */
+	SharedTupleHashTable shared_hashtable;	/* hash table shared with the
+											 * other participants */
+	ParallelUniqueState *pstate;	/* shared state */
 } UniqueState;
 
 /* ----------------
@@ -2062,6 +2249,7 @@ typedef struct GatherState
 	PlanState	ps;				/* its first field is NodeTag */
 	bool		initialized;	/* workers launched? */
 	bool		need_to_scan_locally;	/* need to read from local plan? */
+	bool		leader_merges;	/* local plan merges the workers' output? */
 	int64		tuples_needed;	/* tuple bound, see ExecSetTupleBound */
 	/* these fields are set up once: */
 	TupleTableSlot *funnel_slot;
@@ -2136,8 +2324,8 @@ typedef struct HashState
 {
 	PlanState	ps;				/* its first field is NodeTag */
 	HashJoinTable hashtable;	/* hash table for the hashjoin */
-	List	   *hashkeys;		/* list of ExprState nodes */
-	/* hashkeys is same as parent's hj_InnerHashKeys */
+	ExprState  *hash_expr;		/* computes the hash value of inner tuples */
+	/* hash_expr is built by the parent HashJoin node */
 
 	SharedHashInfo *shared_info;	/* one entry per worker */
 	HashInstrumentation *hinstrument;	/* this worker's entry */
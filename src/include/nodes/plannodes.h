@@ -239,6 +239,7 @@ typedef struct ModifyTable
 	Node	   *onConflictWhere;	/* WHERE for ON CONFLICT UPDATE */
 	Index		exclRelRTI;		/* RTI of the EXCLUDED pseudo relation */
 	List	   *exclRelTlist;	/* tlist of the EXCLUDED pseudo relation */
+	bool		multiInsert;	/* may INSERT buffer rows for multi-insert? */
 } ModifyTable;
 
 struct PartitionPruneInfo;		/* forward reference to struct below */
@@ -732,6 +733,9 @@ typedef struct MergeJoin
 	Oid		   *mergeCollations;	/* per-clause OIDs of collations */
 	int		   *mergeStrategies;	/* per-clause ordering (ASC or DESC) */
 	bool	   *mergeNullsFirst;	/* per-clause nulls ordering */
+	/* to let the inner plan skip ahead on the first mergeclause, if valid: */
+	Oid			mergeSkipOp;	/* btree >= operator, inner OP outer */
+	AttrNumber	mergeSkipAttno; /* inner column, as known to the inner plan */
 } MergeJoin;
 
 /* ----------------
@@ -753,6 +757,24 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		result cache node
+ *
+ * Caches the tuples produced by its subplan for each distinct set of values
+ * of param_exprs, so that rescanning the subplan with parameter values seen
+ * before can be answered from the cache.
+ * ----------------
+ */
+typedef struct ResultCache
+{
+	Plan		plan;
+	int			numKeys;		/* number of cache keys */
+	Oid		   *hashOperators;	/* hash equality operator for each key */
+	List	   *param_exprs;	/* cache keys, as exprs containing Params */
+	bool		singlerow;		/* does each scan return at most one row? */
+	uint32		est_entries;	/* estimated number of cache entries */
+} ResultCache;
+
 /* ----------------
  *		sort node
  * ----------------
@@ -767,6 +789,20 @@ typedef struct Sort
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 } Sort;
 
+/* ----------------
+ *		incremental sort node
+ *
+ * The input is known to be sorted already by the first nPresortedCols of
+ * the sort keys, so only groups of tuples that are equal on those columns
+ * need to be sorted (by the remaining keys).
+ * ----------------
+ */
+typedef struct IncrementalSort
+{
+	Sort		sort;
+	int			nPresortedCols; /* number of presorted columns */
+} IncrementalSort;
+
 /* ---------------
  *	 group node -
  *		Used for queries with GROUP BY (but no aggregates) specified.
@@ -833,6 +869,12 @@ typedef struct WindowAgg
 	Oid			inRangeColl;	/* collation for in_range tests */
 	bool		inRangeAsc;		/* use ASC sort order for in_range tests? */
 	bool		inRangeNullsFirst;	/* nulls sort first for in_range tests? */
+	/* these fields are used by a parallel-aware WindowAgg to sort its input: */
+	int			numSortCols;	/* number of sort-key columns */
+	AttrNumber *sortColIdx;		/* their indexes in the target list */
+	Oid		   *sortOperators;	/* OIDs of operators to sort them by */
+	Oid		   *collations;		/* OIDs of collations */
+	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 } WindowAgg;
 
 /* ----------------
@@ -1366,6 +1366,24 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * ResultCachePath represents use of a ResultCache plan node, i.e., caching
+ * of the results of a parameterized subpath for each set of values of the
+ * parameters.  This is used for the inner side of a nestloop when the outer
+ * side is expected to repeat the same parameter values.
+ */
+typedef struct ResultCachePath
+{
+	Path		path;
+	Path	   *subpath;
+	List	   *hash_operators; /* hash equality operator for each key */
+	List	   *param_exprs;	/* cache keys */
+	bool		singlerow;		/* does each scan return at most one row? */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* estimated number of cache entries, set
+								 * by cost_resultcache_rescan */
+} ResultCachePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
@@ -1559,6 +1577,18 @@ typedef struct SortPath
 	Path	   *subpath;		/* path representing input source */
 } SortPath;
 
+/*
+ * IncrementalSortPath represents an incremental sort step
+ *
+ * This is like a regular sort, except some leading key columns are assumed
+ * to be ordered already.
+ */
+typedef struct IncrementalSortPath
+{
+	SortPath	spath;
+	int			nPresortedCols; /* number of presorted columns */
+} IncrementalSortPath;
+
 /*
  * GroupPath represents grouping (of presorted input)
  *
@@ -78,6 +78,13 @@ extern MergeAppendPath *create_merge_append_path(PlannerInfo *root,
 extern ResultPath *create_result_path(PlannerInfo *root, RelOptInfo *rel,
 				   PathTarget *target, List *resconstantqual);
 extern MaterialPath *create_material_path(RelOptInfo *rel, Path *subpath);
+extern ResultCachePath *create_resultcache_path(PlannerInfo *root,
+						RelOptInfo *rel,
+						Path *subpath,
+						List *param_exprs,
+						List *hash_operators,
+						bool singlerow,
+						double calls);
 extern UniquePath *create_unique_path(PlannerInfo *root, RelOptInfo *rel,
 				   Path *subpath, SpecialJoinInfo *sjinfo);
 extern GatherPath *create_gather_path(PlannerInfo *root,
@@ -175,6 +182,17 @@ extern SortPath *create_sort_path(PlannerInfo *root,
 				 Path *subpath,
 				 List *pathkeys,
 				 double limit_tuples);
+extern SortPath *create_parallel_sort_path(PlannerInfo *root,
+						  RelOptInfo *rel,
+						  Path *subpath,
+						  List *pathkeys,
+						  double rows);
+extern IncrementalSortPath *create_incremental_sort_path(PlannerInfo *root,
+							 RelOptInfo *rel,
+							 Path *subpath,
+							 List *pathkeys,
+							 int presorted_keys,
+							 double limit_tuples);
 extern GroupPath *create_group_path(PlannerInfo *root,
 				  RelOptInfo *rel,
 				  Path *subpath,
@@ -186,6 +204,11 @@ extern UpperUniquePath *create_upper_unique_path(PlannerInfo *root,
 						 Path *subpath,
 						 int numCols,
 						 double numGroups);
+extern UpperUniquePath *create_parallel_unique_path(PlannerInfo *root,
+							RelOptInfo *rel,
+							Path *subpath,
+							int numCols,
+							double numGroups);
 extern AggPath *create_agg_path(PlannerInfo *root,
 				RelOptInfo *rel,
 				Path *subpath,
@@ -215,6 +238,12 @@ extern WindowAggPath *create_windowagg_path(PlannerInfo *root,
 					  PathTarget *target,
 					  List *windowFuncs,
 					  WindowClause *winclause);
+extern WindowAggPath *create_parallel_windowagg_path(PlannerInfo *root,
+							   RelOptInfo *rel,
+							   Path *subpath,
+							   PathTarget *target,
+							   List *windowFuncs,
+							   WindowClause *winclause);
 extern SetOpPath *create_setop_path(PlannerInfo *root,
 				  RelOptInfo *rel,
 				  Path *subpath,
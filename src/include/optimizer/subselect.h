@@ -18,7 +18,9 @@
 extern void SS_process_ctes(PlannerInfo *root);
 extern JoinExpr *convert_ANY_sublink_to_join(PlannerInfo *root,
 							SubLink *sublink,
-							Relids available_rels);
+							bool under_not,
+							Relids available_rels,
+							Node **null_quals);
 extern JoinExpr *convert_EXISTS_sublink_to_join(PlannerInfo *root,
 							   SubLink *sublink,
 							   bool under_not,
@@ -232,6 +232,13 @@
  */
 #define PG_CACHE_LINE_SIZE		128
 
+/*
+ * Alignment required of memory used for direct I/O (see io_direct).  4kB
+ * covers the logical block size of practically all current storage devices,
+ * and of course must not exceed BLCKSZ or XLOG_BLCKSZ.
+ */
+#define PG_IO_ALIGN_SIZE		4096
+
 /*
  *------------------------------------------------------------------------
  * The following symbols are for enabling debugging code, not for
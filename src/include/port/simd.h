@@ -0,0 +1,119 @@
+/*-------------------------------------------------------------------------
+ *
+ * simd.h
+ *	  Support for platform-specific vector operations.
+ *
+ * A Vector8 holds a block of bytes that can be tested all at once, for
+ * example to skip over data that contains none of the characters a parser
+ * is looking for.  On x86-64 we use SSE2 registers, which every such CPU
+ * has, so no runtime check is needed.  Elsewhere we fall back to treating
+ * a uint64 as a vector of eight bytes, using the well-known bit tricks for
+ * finding a zero byte in a word.
+ *
+ * Callers should not assume anything about sizeof(Vector8); loops over
+ * blocks of input must step by sizeof(Vector8) and handle any tail bytes
+ * separately.
+ *
+ * Copyright (c) 2018, PostgreSQL Global Development Group
+ *
+ * src/include/port/simd.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef SIMD_H
+#define SIMD_H
+
+#if defined(__x86_64__) || defined(_M_AMD64)
+/*
+ * SSE2 instructions are part of the spec for the 64-bit x86 ISA.  We assume
+ * that compilers targeting this architecture understand SSE2 intrinsics.
+ */
+#include <emmintrin.h>
+#define USE_SSE2
+typedef __m128i Vector8;
+
+#else
+/*
+ * If no SIMD instructions are available, we can in some cases emulate
+ * vector operations using bitwise operations on unsigned integers.
+ */
+#define USE_NO_SIMD
+typedef uint64 Vector8;
+#endif
+
+
+/*
+ * Load a chunk of memory into the given vector.  The memory need not be
+ * aligned.
+ */
+static inline void
+vector8_load(Vector8 *v, const uint8 *s)
+{
+#ifdef USE_SSE2
+	*v = _mm_loadu_si128((const __m128i *) s);
+#else
+	memcpy(v, s, sizeof(Vector8));
+#endif
+}
+
+/*
+ * Create a vector with all elements set to the same value.
+ */
+static inline Vector8
+vector8_broadcast(const uint8 c)
+{
+#ifdef USE_SSE2
+	return _mm_set1_epi8((char) c);
+#else
+	return ~UINT64CONST(0) / 0xFF * c;
+#endif
+}
+
+/*
+ * Return true if any elements in the vector are equal to the given scalar.
+ */
+static inline bool
+vector8_has(const Vector8 v, const uint8 c)
+{
+#ifdef USE_SSE2
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(v, vector8_broadcast(c))) != 0;
+#else
+	/* any byte of x is zero iff it's zero in v ^ broadcast(c) */
+	Vector8		x = v ^ vector8_broadcast(c);
+
+	return ((x - vector8_broadcast(0x01)) & ~x & vector8_broadcast(0x80)) != 0;
+#endif
+}
+
+/*
+ * Return true if any elements in the vector are less than or equal to the
+ * given scalar, which must be less than 0x80.
+ */
+static inline bool
+vector8_has_le(const Vector8 v, const uint8 c)
+{
+	Assert(c < 0x80);
+#ifdef USE_SSE2
+	/* unsigned saturating subtraction leaves zero only where v <= c */
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(v, vector8_broadcast(c)),
+											_mm_setzero_si128())) != 0;
+#else
+	/* see "haszero" and "hasless" at Sean Anderson's bit twiddling hacks */
+	return ((v - vector8_broadcast(c + 1)) & ~v & vector8_broadcast(0x80)) != 0;
+#endif
+}
+
+/*
+ * Return true if the high bit of any element is set.
+ */
+static inline bool
+vector8_is_highbit_set(const Vector8 v)
+{
+#ifdef USE_SSE2
+	return _mm_movemask_epi8(v) != 0;
+#else
+	return (v & vector8_broadcast(0x80)) != 0;
+#endif
+}
+
+#endif							/* SIMD_H */
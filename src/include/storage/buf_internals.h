@@ -297,6 +297,51 @@ typedef struct CkptSortItem
 
 extern CkptSortItem *CkptBufferIds;
 
+/*
+ * With numa_interleave on a machine with several NUMA nodes, the buffer pool
+ * is split into partitions of consecutive buffers, one per node, each placed
+ * on its node and with its own freelist.  Every partition but the last has
+ * BufferNumaPartitionSize buffers.
+ */
+#define MAX_BUFFER_NUMA_PARTITIONS	64
+
+#define BufferNumaPartitionSize(npartitions) \
+	((NBuffers + (npartitions) - 1) / (npartitions))
+
+/*
+ * Per-node statistics of the buffer pool, as reported by StrategyGetNumaStats.
+ * Accesses are counted by the node of the backend making them, and are local
+ * if the buffer is in that node's partition.
+ */
+typedef struct BufferNumaStats
+{
+	int			node;			/* NUMA node, or -1 if not partitioned */
+	int			buffers;		/* buffers in the node's partition */
+	uint64		local_accesses; /* buffer lookups in the local partition */
+	uint64		remote_accesses;	/* ... in other partitions */
+} BufferNumaStats;
+
+/*
+ * Cumulative counters describing the work of the replacement strategy since
+ * server start, as reported by StrategyGetStats.
+ */
+typedef struct BufferStrategyStats
+{
+	uint64		buffers_alloc;	/* victims chosen outside a strategy ring */
+	uint64		freelist_hits;	/* ... of which taken from the freelist */
+	uint64		ring_reuses;	/* victims recycled from a strategy ring */
+	uint64		clock_ticks;	/* buffers visited by the clock sweep */
+	uint64		clock_pinned;	/* ... that were pinned */
+	uint64		clock_decrements;	/* ... whose usage count was decremented */
+	uint64		clock_protected;	/* ... passed over as protected */
+	uint64		promotions;		/* buffers promoted from probation */
+	uint64		ghost_hits;		/* blocks admitted as protected on reread */
+	uint64		probation_victims;	/* clock victims that were on probation */
+	uint64		protected_victims;	/* clock victims that were protected */
+	uint64		protected_buffers;	/* buffers currently protected */
+	uint64		complete_passes;	/* complete cycles of the clock sweep */
+} BufferStrategyStats;
+
 /*
  * Internal buffer management routines
  */
@@ -309,14 +354,22 @@ extern void ScheduleBufferTagForWriteback(WritebackContext *context, BufferTag *
 extern BufferDesc *StrategyGetBuffer(BufferAccessStrategy strategy,
 				  uint32 *buf_state);
 extern void StrategyFreeBuffer(BufferDesc *buf);
+extern void StrategyAdmitBuffer(BufferDesc *buf, BufferAccessStrategy strategy,
+					bool had_old, uint32 oldHash, uint32 newHash);
+extern void StrategyForgetBuffer(BufferDesc *buf);
+extern bool StrategyBufferIsReusable(BufferDesc *buf, uint32 buf_state);
 extern bool StrategyRejectBuffer(BufferAccessStrategy strategy,
 					 BufferDesc *buf);
 
 extern int	StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc);
 extern void StrategyNotifyBgWriter(int bgwprocno);
+extern void StrategyFlushStats(void);
+extern void StrategyGetStats(BufferStrategyStats *stats);
+extern void StrategyCountAccess(BufferDesc *buf);
+extern int	StrategyGetNumaStats(BufferNumaStats *stats);
 
 extern Size StrategyShmemSize(void);
-extern void StrategyInitialize(bool init);
+extern void StrategyInitialize(bool init, int npartitions, const int *nodes);
 extern bool have_free_buffer(void);
 
 /* buf_table.c */
@@ -324,6 +377,8 @@ extern Size BufTableShmemSize(int size);
 extern void InitBufTable(int size);
 extern uint32 BufTableHashCode(BufferTag *tagPtr);
 extern int	BufTableLookup(BufferTag *tagPtr, uint32 hashcode);
+extern bool BufTableLookupOptimistic(BufferTag *tagPtr, uint32 hashcode,
+						 int *buf_id);
 extern int	BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id);
 extern void BufTableDelete(BufferTag *tagPtr, uint32 hashcode);
 
@@ -70,6 +70,9 @@ extern PGDLLIMPORT char *BufferBlocks;
 /* in guc.c */
 extern int	effective_io_concurrency;
 
+/* in readahead.c */
+extern int	readahead_workers;
+
 /* in localbuf.c */
 extern PGDLLIMPORT int NLocBuffer;
 extern PGDLLIMPORT Block *LocalBufferBlockPointers;
@@ -172,6 +175,8 @@ extern Buffer ReadBufferExtended(Relation reln, ForkNumber forkNum,
 extern Buffer ReadBufferWithoutRelcache(RelFileNode rnode,
 						  ForkNumber forkNum, BlockNumber blockNum,
 						  ReadBufferMode mode, BufferAccessStrategy strategy);
+extern Buffer ReadBufferForReadAhead(RelFileNode rnode, char relpersistence,
+					   ForkNumber forkNum, BlockNumber blockNum, bool *hit);
 extern void ReleaseBuffer(Buffer buffer);
 extern void UnlockReleaseBuffer(Buffer buffer);
 extern void MarkBufferDirty(Buffer buffer);
@@ -52,6 +52,12 @@ typedef int File;
 /* GUC parameter */
 extern PGDLLIMPORT int max_files_per_process;
 
+/* io_direct, as a bitmask of the following flags */
+extern int	io_direct_flags;
+
+#define IO_DIRECT_DATA			0x01
+#define IO_DIRECT_WAL			0x02
+
 /*
  * This is private to fd.c, but exported for save/restore_backend_variables()
  */
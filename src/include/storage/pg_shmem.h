@@ -41,8 +41,9 @@ typedef struct PGShmemHeader	/* standard header for all Postgres shmem */
 #endif
 } PGShmemHeader;
 
-/* GUC variable */
+/* GUC variables */
 extern int	huge_pages;
+extern bool numa_interleave;
 
 /* Possible values for huge_pages */
 typedef enum
@@ -68,5 +69,10 @@ extern PGShmemHeader *PGSharedMemoryCreate(Size size, bool makePrivate,
 					 int port, PGShmemHeader **shim);
 extern bool PGSharedMemoryIsInUse(unsigned long id1, unsigned long id2);
 extern void PGSharedMemoryDetach(void);
+extern bool PGSharedMemoryNumaUsage(Size *sizes, int maxnodes,
+						Size *unallocated);
+extern int	PGSharedMemoryNumaNodes(int *nodes, int maxnodes);
+extern void PGSharedMemoryNumaBind(void *ptr, Size size, int node);
+extern int	PGSharedMemoryLocalNumaNode(void);
 
 #endif							/* PG_SHMEM_H */
@@ -235,6 +235,13 @@ typedef struct PGXACT
 	uint8		nxids;
 } PGXACT;
 
+/*
+ * Upper limit for max_redo_workers.  Recovery conflicts on buffer pins can
+ * involve the Startup process as well as each of the redo workers.
+ */
+#define MAX_REDO_WORKERS		32
+#define NUM_STARTUP_PIN_WAITERS	(MAX_REDO_WORKERS + 1)
+
 /*
  * There is one ProcGlobal struct for the whole database cluster.
  */
@@ -265,8 +272,11 @@ typedef struct PROC_HDR
 	/* The proc of the Startup process, since not in ProcArray */
 	PGPROC	   *startupProc;
 	int			startupProcPid;
-	/* Buffer id of the buffer that Startup process waits for pin on, or -1 */
-	int			startupBufferPinWaitBufId;
+	/*
+	 * Buffer id of the buffer that Startup process waits for pin on, or -1;
+	 * followed by one entry for each parallel redo worker.
+	 */
+	int			startupBufferPinWaitBufId[NUM_STARTUP_PIN_WAITERS];
 } PROC_HDR;
 
 extern PGDLLIMPORT PROC_HDR *ProcGlobal;
@@ -306,7 +316,7 @@ extern void InitAuxiliaryProcess(void);
 
 extern void PublishStartupProcessInformation(void);
 extern void SetStartupBufferPinWaitBufId(int bufid);
-extern int	GetStartupBufferPinWaitBufId(void);
+extern int	GetStartupBufferPinWaitBufId(int slot);
 
 extern bool HaveNFreeProcs(int n);
 extern void ProcReleaseLocks(bool isCommit);
@@ -0,0 +1,29 @@
+/*-------------------------------------------------------------------------
+ *
+ * readahead.h
+ *	  Read-ahead workers, reading pages into shared buffers ahead of scans
+ *
+ *
+ * Portions Copyright (c) 1996-2018, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/readahead.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include "storage/buf_internals.h"
+#include "utils/rel.h"
+
+/* Upper limit for readahead_workers */
+#define MAX_READAHEAD_WORKERS	64
+
+extern Size ReadAheadShmemSize(void);
+extern void ReadAheadShmemInit(void);
+extern void ReadAheadWorkersRegister(void);
+extern bool ReadAheadEnqueue(Relation reln, const BufferTag *tag);
+extern void ReadAheadWorkerMain(Datum main_arg) pg_attribute_noreturn();
+
+#endif							/* READAHEAD_H */
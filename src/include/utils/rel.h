@@ -147,7 +147,8 @@ typedef struct RelationData
 	 * rd_indexcxt.  A relcache reset will include freeing that chunk and
 	 * setting rd_amcache = NULL.
 	 */
-	Oid			rd_amhandler;	/* OID of index AM's handler function */
+	Oid			rd_amhandler;	/* OID of table or index AM's handler
+								 * function */
 	MemoryContext rd_indexcxt;	/* private memory cxt for this stuff */
 	/* use "struct" here to avoid needing to include amapi.h: */
 	struct IndexAmRoutine *rd_amroutine;	/* index AM's API struct */
@@ -164,6 +165,17 @@ typedef struct RelationData
 	void	   *rd_amcache;		/* available for use by index AM */
 	Oid		   *rd_indcollation;	/* OIDs of index collations */
 
+	/*
+	 * table access method support
+	 *
+	 * rd_tableam is set for relations stored as tables (plain tables, TOAST
+	 * tables, materialized views and sequences) and is NULL otherwise.  It
+	 * points to a constant owned by the AM, so a relcache reset needn't free
+	 * it.
+	 */
+	/* use "struct" here to avoid needing to include tableam.h: */
+	const struct TableAmRoutine *rd_tableam;
+
 	/*
 	 * foreign-table support
 	 *
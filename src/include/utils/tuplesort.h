@@ -238,6 +238,11 @@ extern bool tuplesort_getdatum(Tuplesortstate *state, bool forward,
 extern bool tuplesort_skiptuples(Tuplesortstate *state, int64 ntuples,
 					 bool forward);
 
+typedef bool (*TuplesortSkipPredicate) (void *tuple, void *arg);
+
+extern bool tuplesort_skipto(Tuplesortstate *state,
+				 TuplesortSkipPredicate pred, void *arg);
+
 extern void tuplesort_end(Tuplesortstate *state);
 
 extern void tuplesort_get_stats(Tuplesortstate *state,
@@ -251,6 +256,7 @@ extern Size tuplesort_estimate_shared(int nworkers);
 extern void tuplesort_initialize_shared(Sharedsort *shared, int nWorkers,
 							dsm_segment *seg);
 extern void tuplesort_attach_shared(Sharedsort *shared, dsm_segment *seg);
+extern void tuplesort_reset_shared(Sharedsort *shared);
 
 /*
  * These routines may only be called if randomAccess was specified 'true'.
@@ -0,0 +1,14 @@
+CREATE EXTENSION test_wal_insert;
+
+SELECT pg_current_wal_insert_lsn() AS start_lsn \gset
+
+SELECT test_wal_insert(1000);
+SELECT test_wal_insert(100, 8192);
+
+-- every record carries at least its payload
+SELECT pg_current_wal_insert_lsn() - :'start_lsn' >= 1000 * 64 + 100 * 8192
+  AS wal_advanced;
+
+-- bad arguments
+SELECT test_wal_insert(-1);
+SELECT test_wal_insert(1, -1);
@@ -0,0 +1,81 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_wal_insert.c
+ *		Micro-benchmark for concurrent WAL insertion.
+ *
+ * Copyright (c) 2018, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_wal_insert/test_wal_insert.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/xlog.h"
+#include "access/xloginsert.h"
+#include "catalog/pg_control.h"
+#include "fmgr.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+
+PG_MODULE_MAGIC;
+
+/* Upper limit on the payload of a single record */
+#define MAX_RECORD_SIZE		(1024 * 1024)
+
+PG_FUNCTION_INFO_V1(test_wal_insert);
+
+/*
+ * SQL-callable entry point to insert a number of no-op WAL records, each
+ * with a payload of the given size.
+ *
+ * The records are only inserted into the WAL buffers, not flushed, so with
+ * several sessions calling this at once the run time is dominated by WAL
+ * insertion: reserving space and copying the records.  Elapsed time is
+ * reported at DEBUG1.
+ */
+Datum
+test_wal_insert(PG_FUNCTION_ARGS)
+{
+	int32		nrecords = PG_GETARG_INT32(0);
+	int32		record_size = PG_GETARG_INT32(1);
+	char	   *payload;
+	instr_time	start_time;
+	instr_time	elapsed;
+	int32		i;
+
+	if (nrecords < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of records must not be negative")));
+	if (record_size < 0 || record_size > MAX_RECORD_SIZE)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("record size must be between 0 and %d bytes",
+						MAX_RECORD_SIZE)));
+
+	payload = palloc0(Max(record_size, 1));
+
+	INSTR_TIME_SET_CURRENT(start_time);
+
+	for (i = 0; i < nrecords; i++)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		XLogBeginInsert();
+		if (record_size > 0)
+			XLogRegisterData(payload, record_size);
+		(void) XLogInsert(RM_XLOG_ID, XLOG_NOOP);
+	}
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start_time);
+
+	elog(DEBUG1, "inserted %d WAL records of %d bytes in %.3f ms",
+		 nrecords, record_size, INSTR_TIME_GET_MILLISEC(elapsed));
+
+	pfree(payload);
+
+	PG_RETURN_VOID();
+}
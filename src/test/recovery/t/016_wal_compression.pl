@@ -0,0 +1,45 @@
+# Test replay of compressed WAL, with each of the wal_compression methods.
+# Both full-page images and the data of plain records get compressed.
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 2;
+
+# Initialize primary node
+my $node_primary = get_new_node('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->start;
+
+# Create a streaming standby
+$node_primary->backup('my_backup');
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_primary, 'my_backup',
+	has_streaming => 1);
+$node_standby->start;
+
+$node_primary->safe_psql('postgres',
+	"CREATE TABLE tab_compress (id int, t text)");
+
+foreach my $method ('pglz', 'lz4')
+{
+	# The rows are wide enough for their insert records to be compressed,
+	# and the checkpoint makes the update log full-page images.
+	$node_primary->safe_psql(
+		'postgres', qq{
+SET wal_compression = $method;
+INSERT INTO tab_compress
+  SELECT g, repeat('$method ' || g, 40) FROM generate_series(1, 500) g;
+CHECKPOINT;
+UPDATE tab_compress SET t = t || 'x' WHERE id % 10 = 0;
+});
+
+	$node_primary->wait_for_catchup($node_standby, 'replay',
+		$node_primary->lsn('insert'));
+
+	my $query =
+	  "SELECT count(*), md5(string_agg(t, ',' ORDER BY id, t)) FROM tab_compress";
+	is($node_standby->safe_psql('postgres', $query),
+		$node_primary->safe_psql('postgres', $query),
+		"standby matches primary with wal_compression = $method");
+}
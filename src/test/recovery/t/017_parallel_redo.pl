@@ -0,0 +1,89 @@
+# Test parallel WAL replay with max_redo_workers.  Both a hot standby, which
+# keeps the changes that queries can see early in WAL order, and a standby
+# without hot standby have to end up with the same data as the primary.
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 4;
+
+# Initialize primary node, with a second database
+my $node_primary = get_new_node('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->start;
+$node_primary->safe_psql('postgres', 'CREATE DATABASE otherdb');
+
+$node_primary->backup('my_backup');
+
+my $node_hot = get_new_node('hot_standby');
+$node_hot->init_from_backup($node_primary, 'my_backup', has_streaming => 1);
+$node_hot->append_conf('postgresql.conf', 'max_redo_workers = 2');
+$node_hot->start;
+
+my $node_cold = get_new_node('cold_standby');
+$node_cold->init_from_backup($node_primary, 'my_backup', has_streaming => 1);
+$node_cold->append_conf(
+	'postgresql.conf', qq(
+max_redo_workers = 2
+hot_standby = off
+));
+$node_cold->start;
+
+# Mix records for several relations with ones that the startup process has
+# to replay after the workers catch up, like truncations and drops.
+foreach my $db ('postgres', 'otherdb')
+{
+	$node_primary->safe_psql(
+		$db, q{
+CREATE TABLE tab_a (id int PRIMARY KEY, t text);
+CREATE TABLE tab_b (id int, t text);
+CREATE INDEX tab_b_id ON tab_b (id);
+INSERT INTO tab_a SELECT g, 'a' || g FROM generate_series(1, 10000) g;
+INSERT INTO tab_b SELECT g, 'b' || g FROM generate_series(1, 10000) g;
+UPDATE tab_a SET t = t || 'x' WHERE id % 7 = 0;
+DELETE FROM tab_b WHERE id % 5 = 0;
+CREATE TABLE tab_c AS SELECT * FROM tab_a;
+TRUNCATE tab_a;
+INSERT INTO tab_a SELECT id, 'c' || t FROM tab_c WHERE id % 3 = 0;
+DROP TABLE tab_c;
+VACUUM tab_b;
+INSERT INTO tab_b SELECT g, 'd' || g FROM generate_series(1, 2000) g;
+});
+}
+
+my $query = q{
+SELECT (SELECT md5(string_agg(t, ',' ORDER BY id)) FROM tab_a),
+       (SELECT md5(string_agg(t, ',' ORDER BY id, t)) FROM tab_b
+        WHERE id BETWEEN 100 AND 5000)};
+
+$node_primary->wait_for_catchup($node_hot, 'replay',
+	$node_primary->lsn('insert'));
+$node_primary->wait_for_catchup($node_cold, 'replay',
+	$node_primary->lsn('insert'));
+
+foreach my $db ('postgres', 'otherdb')
+{
+	is($node_hot->safe_psql($db, $query),
+		$node_primary->safe_psql($db, $query),
+		"hot standby matches primary in database $db");
+}
+
+is( $node_hot->safe_psql(
+		'postgres',
+		'SELECT count(*), sum(replayed_records) > 0 FROM pg_stat_redo_workers'
+	),
+	'2|t',
+	'redo workers replayed records on hot standby');
+
+# The cold standby can only be queried once promoted, which also makes
+# its workers finish.
+$node_cold->promote;
+
+my $result = '';
+my $expected = '';
+foreach my $db ('postgres', 'otherdb')
+{
+	$result .= $node_cold->safe_psql($db, $query) . "\n";
+	$expected .= $node_primary->safe_psql($db, $query) . "\n";
+}
+is($result, $expected, 'promoted standby matches primary');
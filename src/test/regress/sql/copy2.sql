@@ -412,6 +412,32 @@ test1
 SELECT * FROM instead_of_insert_tbl;
 
 
+-- long values exercise the vectorized scanning paths
+CREATE TEMP TABLE longvals (a text, b text);
+COPY longvals FROM stdin;
+abcdefghijklmnopqrstuvwxyz\tABCDEFGHIJKLMNOP	0123456789012345678901234567890123456789\\
+\.
+COPY longvals FROM stdin WITH (format csv);
+"abcdefghijklmnopqrstuvwxyz""ABCDEFGHIJKLMNOP",0123456789012345678901234567890123456789
+\.
+COPY longvals TO stdout;
+
+-- parallel COPY FROM
+CREATE TABLE parallel_copy (a int PRIMARY KEY, b text CHECK (b <> ''), c int DEFAULT 42);
+COPY parallel_copy (a, b) FROM stdin WITH (parallel 2);
+1	one
+2	two
+3	three
+\.
+COPY parallel_copy FROM stdin WITH (format csv, header, parallel 2);
+a,b,c
+4,"four, quoted",4
+5,five,
+\.
+SELECT * FROM parallel_copy ORDER BY a;
+COPY parallel_copy FROM stdin WITH (parallel -1);
+COPY parallel_copy TO stdout WITH (parallel 2);
+
 -- clean up
 DROP TABLE forcetest;
 DROP TABLE vistest;
@@ -425,3 +451,4 @@ DROP FUNCTION fn_x_after();
 DROP TABLE instead_of_insert_tbl;
 DROP VIEW instead_of_insert_tbl_view;
 DROP FUNCTION fun_instead_of_insert_tbl();
+DROP TABLE parallel_copy;
@@ -0,0 +1,37 @@
+--
+-- INCREMENTAL SORT
+--
+-- An incremental sort needs input that is already sorted by a prefix of
+-- the requested ordering; get that from an index on the leading column.
+-- Within each value of "a" the index returns "b" in insertion order, which
+-- is deliberately not sorted.
+CREATE TABLE incr_sort_tbl (a int, b int);
+INSERT INTO incr_sort_tbl
+  SELECT i / 10, (i * 37) % 10 FROM generate_series(0, 99) i;
+CREATE INDEX incr_sort_tbl_a_idx ON incr_sort_tbl (a);
+ANALYZE incr_sort_tbl;
+
+SET enable_seqscan = off;
+SET enable_sort = off;
+
+EXPLAIN (COSTS OFF)
+SELECT * FROM incr_sort_tbl ORDER BY a, b LIMIT 12;
+SELECT * FROM incr_sort_tbl ORDER BY a, b LIMIT 12;
+
+-- a bound that ends inside a later sort batch
+SELECT * FROM incr_sort_tbl ORDER BY a, b LIMIT 3 OFFSET 40;
+
+-- presorted key in descending order, from a backward index scan
+SELECT * FROM incr_sort_tbl ORDER BY a DESC, b LIMIT 3;
+
+-- the complete output must be in order
+SELECT count(*) AS total,
+       count(*) FILTER (WHERE (prev_a, prev_b) > (a, b)) AS out_of_order
+FROM (SELECT a, b, lag(a) OVER w AS prev_a, lag(b) OVER w AS prev_b
+      FROM (SELECT * FROM incr_sort_tbl ORDER BY a, b OFFSET 0) s
+      WINDOW w AS ()) s2;
+
+RESET enable_seqscan;
+RESET enable_sort;
+
+DROP TABLE incr_sort_tbl;
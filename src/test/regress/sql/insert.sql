@@ -569,3 +569,27 @@ alter table returningwrtest2 drop c;
 alter table returningwrtest attach partition returningwrtest2 for values in (2);
 insert into returningwrtest values (2, 'foo') returning returningwrtest;
 drop table returningwrtest;
+
+-- INSERT ... SELECT and multi-row VALUES write their rows in batches;
+-- check that the indexes, AFTER triggers and constraints still see them all
+create table ins_batch (a int primary key, b text);
+create index on ins_batch (b);
+create function ins_batch_count() returns trigger language plpgsql as
+$$ begin raise notice 'inserted % rows', (select count(*) from newtab); return null; end $$;
+create trigger ins_batch_trig after insert on ins_batch
+  referencing new table as newtab
+  for each statement execute procedure ins_batch_count();
+insert into ins_batch select g, 'row ' || g from generate_series(1, 2500) g;
+insert into ins_batch values (2501, 'row 2501'), (2502, 'row 2502');
+insert into ins_batch values (2503, 'row 2503');
+select count(*), sum(a) from ins_batch;
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select a, b from ins_batch where a in (1, 1000, 1001, 2500, 2502) order by a;
+select count(*) from ins_batch where b in ('row 7', 'row 1999', 'row 2501');
+reset enable_seqscan;
+reset enable_bitmapscan;
+insert into ins_batch select g, 'dup' from generate_series(2400, 2600) g;
+select count(*) from ins_batch;
+drop table ins_batch;
+drop function ins_batch_count();
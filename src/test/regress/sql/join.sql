@@ -2484,4 +2484,66 @@ $$
 $$);
 rollback to settings;
 
+-- multi-column hash keys containing NULLs: the inner join must discard
+-- them, while the outer side of an outer join must keep them
+savepoint settings;
+set max_parallel_workers_per_gather = 0;
+set enable_mergejoin = off;
+set enable_nestloop = off;
+create temp table hjnull (a int, b text);
+insert into hjnull values (1, 'one'), (2, null), (null, 'three'), (null, null);
+select count(*) from hjnull r join hjnull s on r.a = s.a and r.b = s.b;
+select r.a, r.b, s.a as sa
+from hjnull r left join hjnull s on r.a = s.a and r.b = s.b
+order by r.a, r.b;
+rollback to settings;
+
+-- the same with a parallel-aware hash join, whose hash values are computed
+-- by the same expression
+savepoint settings;
+set local max_parallel_workers_per_gather = 2;
+set local enable_parallel_hash = on;
+set local enable_mergejoin = off;
+set local enable_nestloop = off;
+create table hjnull_par as
+  select nullif(g % 101, 0) as a, nullif(g % 7, 0)::text as b
+  from generate_series(1, 20000) g;
+analyze hjnull_par;
+explain (costs off)
+  select count(*) from hjnull_par r join hjnull_par s on r.a = s.a and r.b = s.b;
+select count(*) from hjnull_par r join hjnull_par s on r.a = s.a and r.b = s.b;
+explain (costs off)
+  select count(*), count(s.a)
+  from hjnull_par r left join hjnull_par s on r.a = s.a and r.b = s.b;
+select count(*), count(s.a)
+  from hjnull_par r left join hjnull_par s on r.a = s.a and r.b = s.b;
+rollback to settings;
+
+rollback;
+
+--
+-- merge joins whose inner side skips ahead over long runs of unmatched keys
+--
+begin;
+set local enable_hashjoin = off;
+set local enable_nestloop = off;
+create temp table mj_outer (a int4, t text);
+insert into mj_outer select g * 997, (g * 997)::text from generate_series(1, 20) g;
+insert into mj_outer values (null, null);
+create temp table mj_inner (b int8, t text);
+insert into mj_inner select g / 2, (g / 2)::text from generate_series(0, 40000) g;
+insert into mj_inner values (null, null);
+create index on mj_inner (b);
+create index on mj_inner (t);
+analyze mj_outer;
+analyze mj_inner;
+-- inner side read through the index
+select count(*), sum(b) from mj_outer join mj_inner on a = b;
+select count(*), count(b) from mj_outer left join mj_inner on a = b;
+select count(*) from mj_outer o join mj_inner i on o.t = i.t;
+-- inner side sorted
+set local enable_indexscan = off;
+set local enable_bitmapscan = off;
+select count(*), sum(b) from mj_outer join mj_inner on a = b;
+select count(*) from mj_outer o join mj_inner i on o.t = i.t;
 rollback;
@@ -0,0 +1,10 @@
+--
+-- NUMA placement of shared memory
+--
+-- numa_1.out is the expected output on platforms that can't report it.
+
+-- There must be some memory on some node, and no empty rows.
+SELECT count(*) > 0 AS has_nodes, bool_and(size > 0) AS sizes_ok
+FROM pg_shmem_numa WHERE node IS NOT NULL;
+
+SELECT count(*) <= 1 AS ok FROM pg_shmem_numa WHERE node IS NULL;
@@ -49,6 +49,32 @@ explain (costs off)
 select round(avg(aa)), sum(aa) from a_star a4;
 reset enable_parallel_append;
 
+-- A worker is steered to the partial subplan with the most blocks left, even
+-- if round-robin order would start it on another one.  The small table's
+-- costly filter sorts it first in the Append, but the big table's rows should
+-- reach the Gather first.
+create function sp_slow_filter(int) returns bool as
+  $$begin return true; end$$ language plpgsql parallel safe cost 100000;
+create table sp_steer_small (a int, tag text);
+create table sp_steer_big (a int, tag text) with (fillfactor = 10);
+insert into sp_steer_small select i, 'small' from generate_series(1, 10) i;
+insert into sp_steer_big select i, 'big' from generate_series(1, 5000) i;
+analyze sp_steer_small;
+analyze sp_steer_big;
+set max_parallel_workers_per_gather = 1;
+explain (costs off)
+  select (array_agg(tag))[1] from
+    (select tag from sp_steer_small where sp_slow_filter(a)
+     union all
+     select tag from sp_steer_big) s;
+select (array_agg(tag))[1] from
+  (select tag from sp_steer_small where sp_slow_filter(a)
+   union all
+   select tag from sp_steer_big) s;
+set max_parallel_workers_per_gather = 4;
+drop table sp_steer_small, sp_steer_big;
+drop function sp_slow_filter(int);
+
 -- Parallel Append that runs serially
 create function sp_test_func() returns setof text as
 $$ select 'foo'::varchar union all select 'bar'::varchar $$
@@ -113,6 +139,16 @@ explain (costs off)
 	(select hundred, thousand from tenk2 where thousand > 100);
 select count(*) from tenk1 where (two, four) not in
 	(select hundred, thousand from tenk2 where thousand > 100);
+-- a hashed subplan whose subquery is parallel-restricted is computed by
+-- the leader and shared with the workers (the OR keeps the NOT IN from
+-- becoming an anti join)
+create temp table subplan_nums as select generate_series(1, 1000) as x;
+explain (costs off)
+	select count(*) from tenk1 where unique1 not in
+	(select x from subplan_nums) or ten = 10;
+select count(*) from tenk1 where unique1 not in
+	(select x from subplan_nums) or ten = 10;
+drop table subplan_nums;
 -- this is not parallel-safe due to use of random() within SubLink's testexpr:
 explain (costs off)
 	select * from tenk1 where (unique1 + random())::integer not in
@@ -229,6 +265,61 @@ reset effective_io_concurrency;
 drop table bmscantest;
 drop function explain_parallel_sort_stats();
 
+-- test parallel sort, where each process sorts its share of the input into
+-- a run on disk and the leader merges the runs
+set work_mem = '64kB';
+set enable_gathermerge = off;
+explain (costs off)
+	select four, unique1, stringu1 from tenk1 order by four, unique1 offset 9995;
+select four, unique1, stringu1 from tenk1 order by four, unique1 offset 9995;
+reset enable_gathermerge;
+reset work_mem;
+
+-- test parallel window aggregation, where the processes redistribute their
+-- input by the PARTITION BY columns and each evaluates whole partitions
+explain (costs off)
+	select ten, count(*) over (partition by ten) from tenk1;
+select four, count(*), bool_and(rn = unique1 / 4 + 1)
+  from (select four, unique1,
+               row_number() over (partition by four order by unique1) as rn
+          from tenk1) s
+  group by four order by four;
+
+-- a rescanned parallel window aggregation starts over with new buckets
+set enable_hashjoin = off;
+set enable_mergejoin = off;
+set enable_material = off;
+set enable_resultcache = off;
+explain (costs off)
+	select count(*), sum(w.s)
+	  from (values (1), (2), (3)) v(x)
+	  left join (select four, sum(ten) over (partition by four) s from tenk1) w
+	    on w.four = v.x;
+select count(*), sum(w.s)
+  from (values (1), (2), (3)) v(x)
+  left join (select four, sum(ten) over (partition by four) s from tenk1) w
+    on w.four = v.x;
+reset enable_hashjoin;
+reset enable_mergejoin;
+reset enable_material;
+reset enable_resultcache;
+
+-- test parallel DISTINCT, where the processes share a hash table of the
+-- rows returned so far
+explain (costs off)
+	select distinct ten from tenk1;
+select distinct ten from tenk1 order by ten;
+select count(*) from (select distinct four, ten % 3 from tenk1) s;
+-- groups that are equal without being identical, and groups that all have
+-- the same hash value
+select count(*) from
+  (select distinct (ten::numeric * case when two = 0 then 1.0 else 1.00 end)
+     from tenk1) s;
+explain (costs off)
+	select distinct (hundred::int8 << 32) | hundred from tenk1;
+select count(*) from
+  (select distinct (hundred::int8 << 32) | hundred from tenk1) s;
+
 -- test parallel merge join path.
 set enable_hashjoin to off;
 set enable_nestloop to off;
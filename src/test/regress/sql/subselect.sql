@@ -609,3 +609,71 @@ select * from (select pk,c2 from sq_limit order by c1,pk) as x limit 3;
 drop function explain_sq_limit();
 
 drop table sq_limit;
+
+--
+-- Check that a hashed subplan gives the right answers when its hash table
+-- has to spill to disk.  The planner expects the subquery to return only
+-- a few rows, but it returns 5000, which needs several batches.  A NOT IN
+-- at the top level of WHERE would become an anti join, so put it under OR.
+--
+set work_mem = '64kB';
+
+explain (costs off)
+select count(*) from tenk1
+  where unique1 < 1000 and
+    (unique1 not in (select unique2 from tenk2 where unique2 % 2 = 0) or
+     ten = 10);
+select count(*) from tenk1
+  where unique1 < 1000 and
+    (unique1 not in (select unique2 from tenk2 where unique2 % 2 = 0) or
+     ten = 10);
+
+-- partly-null lefthand rows must search every batch
+select count(*) from tenk1
+  where unique1 < 200 and
+    (unique1, nullif(two, 0)) not in
+    (select unique2, 1 from tenk2 where unique2 % 2 = 0);
+
+-- a wholly null lefthand row is never known to be NOT IN
+select count(*) from tenk1
+  where unique1 < 10 and
+    (nullif(unique1, 5) not in (select unique2 from tenk2 where unique2 % 2 = 0)
+     or ten = 10);
+
+reset work_mem;
+
+--
+-- NOT IN at the top level of WHERE becomes an anti join, plus checks for
+-- NULLs on either side, which need initplans unless the subquery's column
+-- is declared NOT NULL
+--
+create temp table notin_outer (x int);
+create temp table notin_inner (y int);
+create temp table notin_inner_nn (y int not null);
+insert into notin_outer values (1), (2), (null);
+insert into notin_inner values (1);
+insert into notin_inner_nn values (1);
+analyze notin_outer;
+analyze notin_inner;
+analyze notin_inner_nn;
+
+explain (costs off)
+select * from notin_outer where x not in (select y from notin_inner);
+select * from notin_outer where x not in (select y from notin_inner);
+explain (costs off)
+select * from notin_outer where x not in (select y from notin_inner_nn);
+select * from notin_outer where x not in (select y from notin_inner_nn);
+
+-- with no rows in the subquery, NULLs on the left pass too
+select * from notin_outer where x not in (select y from notin_inner where y < 0);
+select * from notin_outer where x not in (select y from notin_inner_nn where y < 0);
+
+-- a NULL in the subquery rejects everything
+insert into notin_inner values (null);
+select * from notin_outer where x not in (select y from notin_inner);
+
+-- not converted: the NOT IN is not at the top level
+explain (costs off)
+select * from notin_outer where x not in (select y from notin_inner) or x = 0;
+
+drop table notin_outer, notin_inner, notin_inner_nn;
@@ -32,6 +32,19 @@ select count(*) = 0 as ok from pg_prepared_statements;
 -- See also prepared_xacts.sql
 select count(*) >= 0 as ok from pg_prepared_xacts;
 
+-- pg_stat_wal_flush always has exactly one row
+select count(*) = 1 as ok from pg_stat_wal_flush;
+select flushes >= 0 and flush_waits >= 0 and commit_delay = 0 as ok
+  from pg_stat_wal_flush;
+
+-- commit_delay = -1 selects the adaptive delay, which the view reports
+set commit_delay = -1;
+show commit_delay;
+select setting, min_val from pg_settings where name = 'commit_delay';
+select commit_delay >= 0 as ok from pg_stat_wal_flush;
+set commit_delay = -2;
+reset commit_delay;
+
 -- This is to record the prevailing planner enable_foo settings during
 -- a regression test run.
 select name, setting from pg_settings where name like 'enable%';
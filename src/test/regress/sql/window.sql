@@ -1241,3 +1241,29 @@ SELECT to_char(SUM(n::float8) OVER (ORDER BY i ROWS BETWEEN CURRENT ROW AND 1 FO
 SELECT i, b, bool_and(b) OVER w, bool_or(b) OVER w
   FROM (VALUES (1,true), (2,true), (3,false), (4,false), (5,true)) v(i,b)
   WINDOW w AS (ORDER BY i ROWS BETWEEN CURRENT ROW AND 1 FOLLOWING);
+
+-- aggregates without an inverse transition function, but with a combine
+-- function, use a segment tree when the frame head moves
+SELECT i, v, min(v) OVER w, max(v) FILTER (WHERE v <> 7) OVER w
+  FROM (SELECT i, (i * 7) % 11 AS v FROM generate_series(1, 11) i) s
+  WINDOW w AS (PARTITION BY i % 2 ORDER BY i ROWS BETWEEN 2 PRECEDING AND 1 FOLLOWING)
+  ORDER BY i;
+
+SELECT i, v, max(v) OVER w, bit_or(v) OVER w
+  FROM (SELECT i, (i * 7) % 11 AS v FROM generate_series(1, 11) i) s
+  WINDOW w AS (ORDER BY i ROWS BETWEEN 1 FOLLOWING AND 3 FOLLOWING);
+
+-- partitions whose segment trees wouldn't fit in work_mem restart the
+-- aggregation instead; the results must be the same
+SET work_mem = '64kB';
+SELECT count(*), sum(mx), sum(bo)
+  FROM (SELECT max(v) OVER w AS mx, bit_or(v) OVER w AS bo
+        FROM (SELECT i, (i * 7) % 11 AS v FROM generate_series(1, 6000) i) s
+        WINDOW w AS (PARTITION BY i > 5000 ORDER BY i
+                     ROWS BETWEEN 2 PRECEDING AND 1 FOLLOWING)) s;
+RESET work_mem;
+SELECT count(*), sum(mx), sum(bo)
+  FROM (SELECT max(v) OVER w AS mx, bit_or(v) OVER w AS bo
+        FROM (SELECT i, (i * 7) % 11 AS v FROM generate_series(1, 6000) i) s
+        WINDOW w AS (PARTITION BY i > 5000 ORDER BY i
+                     ROWS BETWEEN 2 PRECEDING AND 1 FOLLOWING)) s;